@@ -14,6 +14,26 @@ MVMObject * MVM_6model_get_how_obj(MVMThreadContext *tc, MVMObject *obj) {
     return MVM_6model_get_how(tc, STABLE(obj));
 }
 
+/* Gets the WHO, which may be lazily deserialized; NULL if there is none. As
+ * with HOW_sc, WHO_sc is left in place once the WHO has been deserialized,
+ * so that another thread seeing no WHO yet will still find it. */
+MVMObject * MVM_6model_get_who(MVMThreadContext *tc, MVMSTable *st) {
+    MVMObject *WHO = st->WHO;
+    if (!WHO && st->WHO_sc) {
+        MVMSerializationReader *sr = st->WHO_sc->body->sr;
+        WHO = MVM_sc_get_object(tc, st->WHO_sc, st->WHO_idx);
+        MVM_gc_write_barrier(tc, &(st->header), (MVMCollectable *)WHO);
+        if (MVM_casptr(&(st->WHO), NULL, WHO) == NULL) {
+            if (sr)
+                MVM_incr(&(sr->whos_done));
+        }
+        else {
+            WHO = st->WHO;
+        }
+    }
+    return WHO;
+}
+
 /* Obtains the method cache, lazily deserializing if it needed. */
 static MVMObject * get_method_cache(MVMThreadContext *tc, MVMSTable *st) {
     if (!st->method_cache)
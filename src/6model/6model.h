@@ -134,7 +134,11 @@ typedef enum {
     /* Note: if you're hunting for a flag, some day in the future when we
      * have used them all, this one is easy enough to eliminate by having the
      * tiny number of objects marked this way in a remembered set. */
-    MVM_CF_NEVER_REPOSSESS = 2048
+    MVM_CF_NEVER_REPOSSESS = 2048,
+
+    /* A thread doing a parallel nursery collection has claimed this object
+     * in fromspace, and is in the process of copying it. */
+    MVM_CF_GC_CLAIMED = 4096
 } MVMCollectableFlags;
 
 #ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
@@ -342,6 +346,10 @@ struct MVMSTable {
     MVMSerializationContext *HOW_sc;
     MVMuint32                HOW_idx;
 
+    /* Likewise for WHO, which is usually a stash full of further objects. */
+    MVMSerializationContext *WHO_sc;
+    MVMuint32                WHO_idx;
+
     /* Also info we need to lazily deserialize the method cache. */
     MVMuint32                method_cache_offset;
     MVMSerializationContext *method_cache_sc;
@@ -662,6 +670,7 @@ struct MVMREPROps {
 /* Some functions related to 6model core functionality. */
 MVM_PUBLIC MVMObject * MVM_6model_get_how(MVMThreadContext *tc, MVMSTable *st);
 MVM_PUBLIC MVMObject * MVM_6model_get_how_obj(MVMThreadContext *tc, MVMObject *obj);
+MVM_PUBLIC MVMObject * MVM_6model_get_who(MVMThreadContext *tc, MVMSTable *st);
 void MVM_6model_find_method(MVMThreadContext *tc, MVMObject *obj, MVMString *name, MVMRegister *res);
 MVM_PUBLIC MVMObject * MVM_6model_find_method_cache_only(MVMThreadContext *tc, MVMObject *obj, MVMString *name);
 MVMint32 MVM_6model_find_method_spesh(MVMThreadContext *tc, MVMObject *obj, MVMString *name,
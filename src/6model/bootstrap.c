@@ -580,6 +580,7 @@ static void string_consts(MVMThreadContext *tc) {
     string_creator(kind, "kind");
     string_creator(instrumented, "instrumented");
     string_creator(heap, "heap");
+    string_creator(path, "path");
     string_creator(translate_newlines, "translate_newlines");
     string_creator(platform_newline, MVM_TRANSLATE_NEWLINE_OUTPUT ? "\r\n" : "\n");
 }
@@ -3,6 +3,90 @@
 /* This representation's function pointer table. */
 static const MVMREPROps ConcBlockingQueue_this_repr;
 
+/* Marks a slot whose value was taken (or which a dequeuer got to first). */
+static char taken_marker;
+#define TAKEN ((MVMObject *)&taken_marker)
+
+static MVMConcBlockingQueueSegment * alloc_segment(MVMThreadContext *tc) {
+    return MVM_fixed_size_alloc_zeroed(tc, tc->instance->fsa,
+        sizeof(MVMConcBlockingQueueSegment));
+}
+
+/* Adds a value at the tail of the queue. Never allocates GC-able memory, so
+ * the queue will not move while this runs. */
+static void enqueue(MVMThreadContext *tc, MVMConcBlockingQueueBody *cbq, MVMObject *value) {
+    while (1) {
+        MVMConcBlockingQueueSegment *tail = (MVMConcBlockingQueueSegment *)MVM_load(&cbq->tail);
+        AO_t idx = MVM_incr(&tail->enqueue_idx);
+        if (idx < MVM_CBQ_SEGMENT_SLOTS) {
+            /* Fails only if a dequeuer already gave up on the slot. */
+            if (MVM_trycas(&(tail->slots[idx]), NULL, value))
+                return;
+        }
+        else if (tail == (MVMConcBlockingQueueSegment *)MVM_load(&cbq->tail)) {
+            /* The segment is full; try to add one that starts with our
+             * value, or else help move the tail on to the one that was
+             * added. */
+            MVMConcBlockingQueueSegment *next = (MVMConcBlockingQueueSegment *)MVM_load(&tail->next);
+            if (!next) {
+                MVMConcBlockingQueueSegment *seg = alloc_segment(tc);
+                seg->slots[0]    = value;
+                seg->enqueue_idx = 1;
+                if (MVM_trycas(&tail->next, NULL, seg)) {
+                    MVM_trycas(&cbq->tail, tail, seg);
+                    return;
+                }
+                MVM_fixed_size_free(tc, tc->instance->fsa,
+                    sizeof(MVMConcBlockingQueueSegment), seg);
+            }
+            else {
+                MVM_trycas(&cbq->tail, tail, next);
+            }
+        }
+    }
+}
+
+/* Takes the value at the head of the queue, or returns NULL if it is empty.
+ * Like enqueue, never allocates GC-able memory. */
+static MVMObject * dequeue(MVMThreadContext *tc, MVMConcBlockingQueueBody *cbq) {
+    while (1) {
+        MVMConcBlockingQueueSegment *head = (MVMConcBlockingQueueSegment *)MVM_load(&cbq->head);
+        AO_t idx;
+        if (MVM_load(&head->dequeue_idx) >= MVM_load(&head->enqueue_idx) && !MVM_load(&head->next))
+            return NULL;
+        idx = MVM_incr(&head->dequeue_idx);
+        if (idx < MVM_CBQ_SEGMENT_SLOTS) {
+            /* Take the value; if the enqueuer that claimed the slot has not
+             * stored it yet, it will see the marker and go elsewhere. */
+            MVMObject *value;
+            do {
+                value = (MVMObject *)MVM_load(&(head->slots[idx]));
+            } while (!MVM_trycas(&(head->slots[idx]), value, TAKEN));
+            if (value)
+                return value;
+        }
+        else {
+            /* This segment is used up; move the head on if there's a next
+             * one. Other threads may still be looking at the old segment, so
+             * it can only be freed once they have all been to a safepoint. */
+            MVMConcBlockingQueueSegment *next = (MVMConcBlockingQueueSegment *)MVM_load(&head->next);
+            if (!next)
+                return NULL;
+            if (MVM_trycas(&cbq->head, head, next))
+                MVM_fixed_size_free_at_safepoint(tc, tc->instance->fsa,
+                    sizeof(MVMConcBlockingQueueSegment), head);
+        }
+    }
+}
+
+/* Takes a value from the queue, accounting for it in the element count. */
+static MVMObject * take(MVMThreadContext *tc, MVMConcBlockingQueueBody *cbq) {
+    MVMObject *value = dequeue(tc, cbq);
+    if (value)
+        MVM_decr(&cbq->elems);
+    return value;
+}
+
 /* Creates a new type object of this representation, and associates it with
  * the given HOW. */
 static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
@@ -27,15 +111,12 @@ static void initialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, voi
     if ((init_stat = uv_mutex_init(&cbq->locks->head_lock)) < 0)
         MVM_exception_throw_adhoc(tc, "Failed to initialize mutex: %s",
             uv_strerror(init_stat));
-    if ((init_stat = uv_mutex_init(&cbq->locks->tail_lock)) < 0)
-        MVM_exception_throw_adhoc(tc, "Failed to initialize mutex: %s",
-            uv_strerror(init_stat));
     if ((init_stat = uv_cond_init(&cbq->locks->head_cond)) < 0)
         MVM_exception_throw_adhoc(tc, "Failed to initialize condition variable: %s",
             uv_strerror(init_stat));
 
-    /* Head and tail point to a null node. */
-    cbq->tail = cbq->head = MVM_calloc(1, sizeof(MVMConcBlockingQueueNode));
+    /* Head and tail point to an empty segment. */
+    cbq->tail = cbq->head = alloc_segment(tc);
 }
 
 /* Copies the body of one object to another. */
@@ -46,11 +127,15 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
 /* Called by the VM to mark any GCable items. */
 static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
     /* At this point we know the world is stopped, and thus we can safely do a
-     * traversal of the data structure without needing locks. */
+     * traversal of the data structure without needing locks. Segments before
+     * the head have had all of their values taken. */
     MVMConcBlockingQueueBody *cbq = (MVMConcBlockingQueueBody *)data;
-    MVMConcBlockingQueueNode *cur = cbq->head;
+    MVMConcBlockingQueueSegment *cur = cbq->head;
     while (cur) {
-        MVM_gc_worklist_add(tc, worklist, &cur->value);
+        MVMuint32 i;
+        for (i = 0; i < MVM_CBQ_SEGMENT_SLOTS; i++)
+            if (cur->slots[i] && cur->slots[i] != TAKEN)
+                MVM_gc_worklist_add(tc, worklist, &(cur->slots[i]));
         cur = cur->next;
     }
 }
@@ -59,18 +144,17 @@ static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorkli
 static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     MVMConcBlockingQueue *cbq = (MVMConcBlockingQueue *)obj;
 
-    /* First, free all the nodes. */
-    MVMConcBlockingQueueNode *cur = cbq->body.head;
+    /* First, free all the segments. */
+    MVMConcBlockingQueueSegment *cur = cbq->body.head;
     while (cur) {
-        MVMConcBlockingQueueNode *next = cur->next;
-        MVM_free(cur);
+        MVMConcBlockingQueueSegment *next = cur->next;
+        MVM_fixed_size_free(tc, tc->instance->fsa, sizeof(MVMConcBlockingQueueSegment), cur);
         cur = next;
     }
     cbq->body.head = cbq->body.tail = NULL;
 
     /* Clean up locks. */
     uv_mutex_destroy(&cbq->body.locks->head_lock);
-    uv_mutex_destroy(&cbq->body.locks->tail_lock);
     uv_cond_destroy(&cbq->body.locks->head_cond);
     MVM_free(cbq->body.locks);
     cbq->body.locks = NULL;
@@ -97,6 +181,7 @@ static void compose(MVMThreadContext *tc, MVMSTable *st, MVMObject *info) {
 
 static void at_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMint64 index, MVMRegister *value, MVMuint16 kind) {
     MVMConcBlockingQueueBody *cbq = (MVMConcBlockingQueueBody *)data;
+    MVMConcBlockingQueueSegment *cur;
 
     if (index != 0)
         MVM_exception_throw_adhoc(tc,
@@ -105,38 +190,32 @@ static void at_pos(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *d
         MVM_exception_throw_adhoc(tc,
             "Can only get objects from a concurrent blocking queue");
 
-    if (MVM_load(&cbq->elems) > 0) {
-        MVMConcBlockingQueueNode *peeked;
-        unsigned int interval_id;
-        interval_id = MVM_telemetry_interval_start(tc, "ConcBlockingQueue.at_pos");
-        MVMROOT(tc, root, {
-            MVM_gc_mark_thread_blocked(tc);
-            uv_mutex_lock(&cbq->locks->head_lock);
-            MVM_gc_mark_thread_unblocked(tc);
-            data = OBJECT_BODY(root);
-            cbq = (MVMConcBlockingQueueBody *)data;
-        });
-        peeked = cbq->head->next;
-        value->o = peeked ? peeked->value : tc->instance->VMNull;
-        uv_mutex_unlock(&cbq->locks->head_lock);
-        MVM_telemetry_interval_stop(tc, interval_id, "ConcBlockingQueue.at_pos");
-    }
-    else {
-        value->o = tc->instance->VMNull;
+    /* Look for the first slot not yet taken. Segments are only freed at a
+     * safepoint, so those we walk over stay valid. */
+    value->o = tc->instance->VMNull;
+    cur = (MVMConcBlockingQueueSegment *)MVM_load(&cbq->head);
+    while (cur) {
+        AO_t idx;
+        for (idx = MVM_load(&cur->dequeue_idx); idx < MVM_CBQ_SEGMENT_SLOTS; idx++) {
+            MVMObject *peeked = (MVMObject *)MVM_load(&(cur->slots[idx]));
+            if (peeked && peeked != TAKEN) {
+                value->o = peeked;
+                return;
+            }
+        }
+        cur = (MVMConcBlockingQueueSegment *)MVM_load(&cur->next);
     }
 }
 
 static MVMuint64 elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
     MVMConcBlockingQueueBody *cbq = (MVMConcBlockingQueueBody *)data;
-    return MVM_load(cbq->elems);
+    MVMint64 elems = (intptr_t)MVM_load(&cbq->elems);
+    return elems > 0 ? elems : 0;
 }
 
 static void push(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMRegister value, MVMuint16 kind) {
     MVMConcBlockingQueueBody *cbq = (MVMConcBlockingQueueBody *)data;
-    MVMConcBlockingQueueNode *add;
-    AO_t orig_elems;
     MVMObject *to_add = value.o;
-    unsigned int interval_id;
 
     if (kind != MVM_reg_obj)
         MVM_exception_throw_adhoc(tc,
@@ -145,78 +224,63 @@ static void push(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *dat
         MVM_exception_throw_adhoc(tc,
             "Cannot store a null value in a concurrent blocking queue");
 
-    add = MVM_calloc(1, sizeof(MVMConcBlockingQueueNode));
+    MVM_gc_write_barrier(tc, &(root->header), &(to_add->header));
+    enqueue(tc, cbq, to_add);
+    MVM_incr(&cbq->elems);
 
-    interval_id = MVM_telemetry_interval_start(tc, "ConcBlockingQueue.push");
-    MVMROOT(tc, root, {
-    MVMROOT(tc, to_add, {
+    /* If anyone is waiting in shift, wake one of them up. The waiter counts
+     * itself before its last look at the queue, so either it sees the value
+     * we just added or we see it. */
+    if (MVM_load(&cbq->waiters)) {
+        MVMConcBlockingQueueLocks *locks = cbq->locks;
+        unsigned int interval_id;
+        interval_id = MVM_telemetry_interval_start(tc, "ConcBlockingQueue.push");
         MVM_gc_mark_thread_blocked(tc);
-        uv_mutex_lock(&cbq->locks->tail_lock);
+        uv_mutex_lock(&locks->head_lock);
         MVM_gc_mark_thread_unblocked(tc);
-    });
-    });
-    data = OBJECT_BODY(root);
-    cbq = (MVMConcBlockingQueueBody *)data;
-    MVM_ASSIGN_REF(tc, &(root->header), add->value, to_add);
-    cbq->tail->next = add;
-    cbq->tail = add;
-    orig_elems = MVM_incr(&cbq->elems);
-    uv_mutex_unlock(&cbq->locks->tail_lock);
-
-    if (orig_elems == 0) {
-        MVMROOT(tc, root, {
-            MVM_gc_mark_thread_blocked(tc);
-            uv_mutex_lock(&cbq->locks->head_lock);
-            MVM_gc_mark_thread_unblocked(tc);
-        });
-        data = OBJECT_BODY(root);
-        cbq = (MVMConcBlockingQueueBody *)data;
-        uv_cond_signal(&cbq->locks->head_cond);
-        uv_mutex_unlock(&cbq->locks->head_lock);
+        uv_cond_signal(&locks->head_cond);
+        uv_mutex_unlock(&locks->head_lock);
+        MVM_telemetry_interval_stop(tc, interval_id, "ConcBlockingQueue.push");
     }
-    MVM_telemetry_interval_stop(tc, interval_id, "ConcBlockingQueue.push");
 }
 
 static void shift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMRegister *value, MVMuint16 kind) {
     MVMConcBlockingQueueBody *cbq = (MVMConcBlockingQueueBody *)data;
-    MVMConcBlockingQueueNode *taken;
+    MVMConcBlockingQueueLocks *locks = cbq->locks;
+    MVMObject *taken;
     unsigned int interval_id;
 
     if (kind != MVM_reg_obj)
         MVM_exception_throw_adhoc(tc, "Can only shift objects from a ConcBlockingQueue");
 
+    /* Most of the time, there's something there to take. */
+    if ((taken = take(tc, cbq))) {
+        value->o = taken;
+        return;
+    }
+
+    /* Otherwise, wait for a push to wake us up. */
     interval_id = MVM_telemetry_interval_start(tc, "ConcBlockingQueue.shift");
     MVMROOT(tc, root, {
         MVM_gc_mark_thread_blocked(tc);
-        uv_mutex_lock(&cbq->locks->head_lock);
+        uv_mutex_lock(&locks->head_lock);
         MVM_gc_mark_thread_unblocked(tc);
-        data = OBJECT_BODY(root);
-        cbq  = (MVMConcBlockingQueueBody *)data;
-
-        while (MVM_load(&cbq->elems) == 0) {
-                MVM_gc_mark_thread_blocked(tc);
-                uv_cond_wait(&cbq->locks->head_cond, &cbq->locks->head_lock);
-                MVM_gc_mark_thread_unblocked(tc);
-                data = OBJECT_BODY(root);
-                cbq  = (MVMConcBlockingQueueBody *)data;
+        cbq = (MVMConcBlockingQueueBody *)OBJECT_BODY(root);
+
+        MVM_incr(&cbq->waiters);
+        while (!(taken = take(tc, cbq))) {
+            MVM_gc_mark_thread_blocked(tc);
+            uv_cond_wait(&locks->head_cond, &locks->head_lock);
+            MVM_gc_mark_thread_unblocked(tc);
+            cbq = (MVMConcBlockingQueueBody *)OBJECT_BODY(root);
         }
+        MVM_decr(&cbq->waiters);
     });
 
-    taken = cbq->head->next;
-    MVM_free(cbq->head);
-    cbq->head = taken;
-    MVM_barrier();
-    value->o = taken->value;
-    taken->value = NULL;
-    MVM_barrier();
-
-    if (MVM_decr(&cbq->elems) > 1)
-        uv_cond_signal(&cbq->locks->head_cond);
-
-    uv_mutex_unlock(&cbq->locks->head_lock);
+    value->o = taken;
+    uv_mutex_unlock(&locks->head_lock);
     MVM_telemetry_interval_stop(tc, interval_id, "ConcBlockingQueue.shift");
 }
-
 /* Set the size of the STable. */
 static void deserialize_stable_size(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
     st->size = sizeof(MVMConcBlockingQueue);
@@ -275,32 +339,6 @@ static const MVMREPROps ConcBlockingQueue_this_repr = {
 
 /* Polls a queue for a value, returning NULL if none is available. */
 MVMObject * MVM_concblockingqueue_poll(MVMThreadContext *tc, MVMConcBlockingQueue *queue) {
-    MVMConcBlockingQueue *cbq = (MVMConcBlockingQueue *)queue;
-    MVMConcBlockingQueueNode *taken;
-    MVMObject *result = tc->instance->VMNull;
-    unsigned int interval_id;
-
-    interval_id = MVM_telemetry_interval_start(tc, "ConcBlockingQueue.poll");
-    MVMROOT(tc, cbq, {
-        MVM_gc_mark_thread_blocked(tc);
-        uv_mutex_lock(&cbq->body.locks->head_lock);
-        MVM_gc_mark_thread_unblocked(tc);
-    });
-
-    if (MVM_load(&cbq->body.elems) > 0) {
-        taken = cbq->body.head->next;
-        MVM_free(cbq->body.head);
-        cbq->body.head = taken;
-        MVM_barrier();
-        result = taken->value;
-        taken->value = NULL;
-        MVM_barrier();
-        if (MVM_decr(&cbq->body.elems) > 1)
-            uv_cond_signal(&cbq->body.locks->head_cond);
-    }
-
-    uv_mutex_unlock(&cbq->body.locks->head_lock);
-
-    MVM_telemetry_interval_stop(tc, interval_id, "ConcBlockingQueue.poll");
-    return result;
+    MVMObject *taken = take(tc, &(queue->body));
+    return taken ? taken : tc->instance->VMNull;
 }
@@ -1,7 +1,29 @@
-/* A single node in the concurrent blocking queue. */
-struct MVMConcBlockingQueueNode {
-    MVMObject                *value;
-    MVMConcBlockingQueueNode *next;
+/* The concurrent blocking queue is a lock-free multi-producer, multi-consumer
+ * queue made of a linked list of segments, each an array of slots. Pushing
+ * and shifting claim a slot by an atomic increment of the segment's enqueue
+ * or dequeue index, and then race to swap the slot's content; only when a
+ * segment fills up is a new one allocated. A dequeuer that gets to a slot
+ * before its value arrives marks it as taken, and the enqueuer moves on to
+ * another slot. Segments that have been passed over by all dequeuers may
+ * still be looked at by threads that read the head or tail before it moved,
+ * so they are only freed at the next global safepoint. Only a shift on an
+ * empty queue takes the mutex, to wait on the condition variable. */
+
+/* The number of slots in a segment. */
+#define MVM_CBQ_SEGMENT_SLOTS 64
+
+/* A segment of the concurrent blocking queue. */
+struct MVMConcBlockingQueueSegment {
+    /* The next slot to enqueue to and dequeue from; these are incremented
+     * past the end of the segment by threads finding it full. */
+    AO_t enqueue_idx;
+    AO_t dequeue_idx;
+
+    /* The next segment, if any. */
+    MVMConcBlockingQueueSegment *next;
+
+    /* The slots; NULL if not yet filled, or the taken marker if dequeued. */
+    MVMObject *slots[MVM_CBQ_SEGMENT_SLOTS];
 };
 
 /* Memory used for mutexes and cond vars; these can't live in the object body
@@ -9,19 +31,22 @@ struct MVMConcBlockingQueueNode {
  * a single struct means we can malloc a single bit of memory to hold them. */
 struct MVMConcBlockingQueueLocks {
     uv_mutex_t  head_lock;
-    uv_mutex_t  tail_lock;
     uv_cond_t   head_cond;
 };
 
 /* Representation used for concurrent blocking queue. */
 struct MVMConcBlockingQueueBody {
-    /* Head and tail of the queue. */
-    MVMConcBlockingQueueNode *head;
-    MVMConcBlockingQueueNode *tail;
+    /* Segments being dequeued from and enqueued to. */
+    MVMConcBlockingQueueSegment *head;
+    MVMConcBlockingQueueSegment *tail;
 
-    /* Number of elements currently in the queue. */
+    /* Number of elements currently in the queue. This is updated after the
+     * element is pushed or shifted, so may briefly go below zero. */
     AO_t elems;
 
+    /* Number of threads waiting in shift for an element to arrive. */
+    AO_t waiters;
+
     /* Locks and condition variables storage. */
     MVMConcBlockingQueueLocks *locks;
 };
@@ -3,6 +3,13 @@
 /* This representation's function pointer table. */
 static const MVMREPROps HashAttrStore_this_repr;
 
+/* Makes sure an attribute name can be used as a hash key. */
+MVM_STATIC_INLINE void check_name(MVMThreadContext *tc, MVMString *name) {
+    if (MVM_is_null(tc, (MVMObject *)name) || REPR(name)->ID != MVM_REPR_ID_MVMString
+            || !IS_CONCRETE(name))
+        MVM_exception_throw_adhoc(tc, "Hash keys must be concrete strings");
+}
+
 /* Creates a new type object of this representation, and associates it with
  * the given HOW. */
 static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
@@ -21,25 +28,25 @@ static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
 static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *dest_root, void *dest) {
     MVMHashAttrStoreBody *src_body  = (MVMHashAttrStoreBody *)src;
     MVMHashAttrStoreBody *dest_body = (MVMHashAttrStoreBody *)dest;
-    MVMHashEntry *current, *tmp;
-    unsigned bucket_tmp;
+    MVMHashEntry *current;
+    MVMuint32 idx;
 
     /* NOTE: if we really wanted to, we could avoid rehashing... */
-    HASH_ITER(hash_handle, src_body->hash_head, current, tmp, bucket_tmp) {
-        MVMHashEntry *new_entry = MVM_malloc(sizeof(MVMHashEntry));
+    MVM_STR_HASH_ITER(tc, &src_body->hashtable, current, idx) {
+        MVMHashEntry *new_entry = MVM_str_hash_lvalue_fetch(tc, &dest_body->hashtable, current->key);
         MVM_ASSIGN_REF(tc, &(dest_root->header), new_entry->value, current->value);
-        MVM_HASH_BIND(tc, dest_body->hash_head, MVM_HASH_KEY(current), new_entry);
+        MVM_gc_write_barrier(tc, &(dest_root->header), &(new_entry->key->common.header));
     }
 }
 
 /* Adds held objects to the GC worklist. */
 static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
     MVMHashAttrStoreBody *body = (MVMHashAttrStoreBody *)data;
-    MVMHashEntry *current, *tmp;
-    unsigned bucket_tmp;
+    MVMHashEntry *current;
+    MVMuint32 idx;
 
-    HASH_ITER(hash_handle, body->hash_head, current, tmp, bucket_tmp) {
-        MVM_gc_worklist_add(tc, worklist, &current->hash_handle.key);
+    MVM_STR_HASH_ITER(tc, &body->hashtable, current, idx) {
+        MVM_gc_worklist_add(tc, worklist, &current->key);
         MVM_gc_worklist_add(tc, worklist, &current->value);
     }
 }
@@ -47,7 +54,7 @@ static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorkli
 /* Called by the VM in order to free memory associated with this object. */
 static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     MVMHashAttrStore *h = (MVMHashAttrStore *)obj;
-    MVM_HASH_DESTROY(hash_handle, MVMHashEntry, h->body.hash_head);
+    MVM_str_hash_demolish(tc, &h->body.hashtable);
 }
 
 static void get_attribute(MVMThreadContext *tc, MVMSTable *st, MVMObject *root,
@@ -56,7 +63,8 @@ static void get_attribute(MVMThreadContext *tc, MVMSTable *st, MVMObject *root,
     MVMHashAttrStoreBody *body = (MVMHashAttrStoreBody *)data;
     if (kind == MVM_reg_obj) {
         MVMHashEntry *entry;
-        MVM_HASH_GET(tc, body->hash_head, name, entry);
+        check_name(tc, name);
+        entry = MVM_str_hash_fetch(tc, &body->hashtable, name);
         result_reg->o = entry != NULL ? entry->value : tc->instance->VMNull;
     }
     else {
@@ -71,16 +79,10 @@ static void bind_attribute(MVMThreadContext *tc, MVMSTable *st, MVMObject *root,
     MVMHashAttrStoreBody *body = (MVMHashAttrStoreBody *)data;
     if (kind == MVM_reg_obj) {
         MVMHashEntry *entry;
-        MVM_HASH_GET(tc, body->hash_head, name, entry);
-        if (!entry) {
-            entry = MVM_malloc(sizeof(MVMHashEntry));
-            MVM_ASSIGN_REF(tc, &(root->header), entry->value, value_reg.o);
-            MVM_HASH_BIND(tc, body->hash_head, name, entry);
-            MVM_gc_write_barrier(tc, &(root->header), &(name->common.header));
-        }
-        else {
-            MVM_ASSIGN_REF(tc, &(root->header), entry->value, value_reg.o);
-        }
+        check_name(tc, name);
+        entry = MVM_str_hash_lvalue_fetch(tc, &body->hashtable, name);
+        MVM_ASSIGN_REF(tc, &(root->header), entry->value, value_reg.o);
+        MVM_gc_write_barrier(tc, &(root->header), &(entry->key->common.header));
     }
     else {
         MVM_exception_throw_adhoc(tc,
@@ -90,9 +92,8 @@ static void bind_attribute(MVMThreadContext *tc, MVMSTable *st, MVMObject *root,
 
 static MVMint64 is_attribute_initialized(MVMThreadContext *tc, MVMSTable *st, void *data, MVMObject *class_handle, MVMString *name, MVMint64 hint) {
     MVMHashAttrStoreBody *body = (MVMHashAttrStoreBody *)data;
-    MVMHashEntry *entry;
-    MVM_HASH_GET(tc, body->hash_head, name, entry);
-    return entry != NULL;
+    check_name(tc, name);
+    return MVM_str_hash_fetch(tc, &body->hashtable, name) != NULL;
 }
 
 static MVMint64 hint_for(MVMThreadContext *tc, MVMSTable *st, MVMObject *class_handle, MVMString *name) {
@@ -17,6 +17,9 @@ struct MVMAsyncTaskBody {
 
     /* The cancellation notification handler, if any. */
     MVMObject *cancel_notify_schedulee;
+
+    /* The event loop the task is done on; NULL until it's queued. */
+    MVMEventLoop *loop;
 };
 struct MVMAsyncTask {
     MVMObject common;
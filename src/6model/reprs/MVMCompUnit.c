@@ -96,6 +96,8 @@ static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     MVM_free(body->scs_to_resolve);
     MVM_free(body->sc_handle_idxs);
     MVM_free(body->string_heap_fast_table);
+    if (body->image)
+        MVM_platform_unmap_file(body->image, body->image_handle, body->image_size);
     switch (body->deallocate) {
     case MVM_DEALLOCATE_NOOP:
         break;
@@ -97,6 +97,16 @@ struct MVMCompUnitBody {
     MVMuint8  *string_heap_start;
     MVMuint8  *string_heap_read_limit;
 
+    /* If the compilation unit was loaded along with an image (see
+     * compunit.c), the offsets of its strings into the string heap and of
+     * its frames into the bytecode, which point into the mapped image;
+     * otherwise NULL. The image itself is kept so it can be unmapped. */
+    MVMuint32 *string_heap_offsets;
+    MVMuint32 *frame_offsets;
+    void      *image;
+    void      *image_handle;
+    MVMuint32  image_size;
+
     /* Serialized data, if any. */
     /* For its size, see serialized_size above. */
     MVMuint8 *serialized;
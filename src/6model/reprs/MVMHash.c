@@ -27,16 +27,14 @@ static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
 static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *dest_root, void *dest) {
     MVMHashBody *src_body  = (MVMHashBody *)src;
     MVMHashBody *dest_body = (MVMHashBody *)dest;
-    MVMHashEntry *current, *tmp;
-    unsigned bucket_tmp;
+    MVMHashEntry *current;
+    MVMuint32 idx;
 
     /* NOTE: if we really wanted to, we could avoid rehashing... */
-    HASH_ITER(hash_handle, src_body->hash_head, current, tmp, bucket_tmp) {
-        MVMHashEntry *new_entry = MVM_fixed_size_alloc(tc, tc->instance->fsa,
-            sizeof(MVMHashEntry));
-        MVMString *key = MVM_HASH_KEY(current);
+    MVM_STR_HASH_ITER(tc, &src_body->hashtable, current, idx) {
+        MVMString *key = current->key;
+        MVMHashEntry *new_entry = MVM_str_hash_lvalue_fetch(tc, &dest_body->hashtable, key);
         MVM_ASSIGN_REF(tc, &(dest_root->header), new_entry->value, current->value);
-        MVM_HASH_BIND(tc, dest_body->hash_head, key, new_entry);
         MVM_gc_write_barrier(tc, &(dest_root->header), &(key->common.header));
     }
 }
@@ -44,11 +42,11 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
 /* Adds held objects to the GC worklist. */
 static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
     MVMHashBody *body = (MVMHashBody *)data;
-    MVMHashEntry *current, *tmp;
-    unsigned bucket_tmp;
+    MVMHashEntry *current;
+    MVMuint32 idx;
 
-    HASH_ITER(hash_handle, body->hash_head, current, tmp, bucket_tmp) {
-        MVM_gc_worklist_add(tc, worklist, &current->hash_handle.key);
+    MVM_STR_HASH_ITER(tc, &body->hashtable, current, idx) {
+        MVM_gc_worklist_add(tc, worklist, &current->key);
         MVM_gc_worklist_add(tc, worklist, &current->value);
     }
 }
@@ -56,23 +54,13 @@ static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorkli
 /* Called by the VM in order to free memory associated with this object. */
 static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     MVMHash *h = (MVMHash *)obj;
-    MVMHashEntry *current, *tmp;
-    unsigned bucket_tmp;
-    HASH_ITER(hash_handle, h->body.hash_head, current, tmp, bucket_tmp) {
-        if (current != h->body.hash_head)
-            MVM_fixed_size_free(tc, tc->instance->fsa, sizeof(MVMHashEntry), current);
-    }
-    tmp = h->body.hash_head;
-    HASH_CLEAR(hash_handle, h->body.hash_head);
-    if (tmp)
-        MVM_fixed_size_free(tc, tc->instance->fsa, sizeof(MVMHashEntry), tmp);
+    MVM_str_hash_demolish(tc, &h->body.hashtable);
 }
 
 static void at_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj, MVMRegister *result, MVMuint16 kind) {
     MVMHashBody *body = (MVMHashBody *)data;
-    MVMHashEntry *entry;
     MVMString *key = get_string_key(tc, key_obj);
-    MVM_HASH_GET(tc, body->hash_head, key, entry);
+    MVMHashEntry *entry = MVM_str_hash_fetch(tc, &body->hashtable, key);
     if (kind == MVM_reg_obj)
         result->o = entry != NULL ? entry->value : tc->instance->VMNull;
     else
@@ -89,43 +77,27 @@ static void bind_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void
         MVM_exception_throw_adhoc(tc,
             "MVMHash representation does not support native type storage");
 
-    /* first check whether we can must update the old entry. */
-    MVM_HASH_GET(tc, body->hash_head, key, entry);
-    if (!entry) {
-        entry = MVM_fixed_size_alloc(tc, tc->instance->fsa,
-            sizeof(MVMHashEntry));
-        MVM_ASSIGN_REF(tc, &(root->header), entry->value, value.o);
-        MVM_HASH_BIND(tc, body->hash_head, key, entry);
-        MVM_gc_write_barrier(tc, &(root->header), &(key->common.header));
-    }
-    else {
-        MVM_ASSIGN_REF(tc, &(root->header), entry->value, value.o);
-    }
+    /* Finds the existing entry, or makes a new one if there isn't one. */
+    entry = MVM_str_hash_lvalue_fetch(tc, &body->hashtable, key);
+    MVM_ASSIGN_REF(tc, &(root->header), entry->value, value.o);
+    MVM_gc_write_barrier(tc, &(root->header), &(entry->key->common.header));
 }
 
 static MVMuint64 elems(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data) {
     MVMHashBody *body = (MVMHashBody *)data;
-    return HASH_CNT(hash_handle, body->hash_head);
+    return MVM_str_hash_count(tc, &body->hashtable);
 }
 
 static MVMint64 exists_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj) {
     MVMHashBody *body = (MVMHashBody *)data;
     MVMString *key = get_string_key(tc, key_obj);
-    MVMHashEntry *entry;
-    MVM_HASH_GET(tc, body->hash_head, key, entry);
-    return entry != NULL;
+    return MVM_str_hash_fetch(tc, &body->hashtable, key) != NULL;
 }
 
 static void delete_key(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *data, MVMObject *key_obj) {
     MVMHashBody *body = (MVMHashBody *)data;
     MVMString *key = get_string_key(tc, key_obj);
-    MVMHashEntry *old_entry;
-    MVM_HASH_GET(tc, body->hash_head, key, old_entry);
-    if (old_entry) {
-        HASH_DELETE(hash_handle, body->hash_head, old_entry);
-        MVM_fixed_size_free(tc, tc->instance->fsa,
-            sizeof(MVMHashEntry), old_entry);
-    }
+    MVM_str_hash_delete(tc, &body->hashtable, key);
 }
 
 static MVMStorageSpec get_value_storage_spec(MVMThreadContext *tc, MVMSTable *st) {
@@ -166,22 +138,23 @@ static void deserialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, vo
     for (i = 0; i < elems; i++) {
         MVMString *key = MVM_serialization_read_str(tc, reader);
         MVMObject *value = MVM_serialization_read_ref(tc, reader);
-        MVMHashEntry *entry = MVM_fixed_size_alloc(tc, tc->instance->fsa,
-            sizeof(MVMHashEntry));
+        MVMHashEntry *entry;
+        if (MVM_is_null(tc, (MVMObject *)key))
+            MVM_exception_throw_adhoc(tc, "Hash keys must be concrete strings");
+        entry = MVM_str_hash_lvalue_fetch(tc, &body->hashtable, key);
         MVM_ASSIGN_REF(tc, &(root->header), entry->value, value);
-        MVM_HASH_BIND(tc, body->hash_head, key, entry);
+        MVM_gc_write_barrier(tc, &(root->header), &(key->common.header));
     }
 }
 
 /* Serialize the representation. */
 static void serialize(MVMThreadContext *tc, MVMSTable *st, void *data, MVMSerializationWriter *writer) {
     MVMHashBody *body = (MVMHashBody *)data;
-    MVMHashEntry *current, *tmp;
-    unsigned bucket_tmp;
-    MVM_serialization_write_int(tc, writer, HASH_CNT(hash_handle, body->hash_head));
-    HASH_ITER(hash_handle, body->hash_head, current, tmp, bucket_tmp) {
-        MVMString *key = MVM_HASH_KEY(current);
-        MVM_serialization_write_str(tc, writer, key);
+    MVMHashEntry *current;
+    MVMuint32 idx;
+    MVM_serialization_write_int(tc, writer, MVM_str_hash_count(tc, &body->hashtable));
+    MVM_STR_HASH_ITER(tc, &body->hashtable, current, idx) {
+        MVM_serialization_write_str(tc, writer, current->key);
         MVM_serialization_write_ref(tc, writer, current->value);
     }
 }
@@ -213,7 +186,7 @@ static void spesh(MVMThreadContext *tc, MVMSTable *st, MVMSpeshGraph *g, MVMSpes
 static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data) {
     MVMHashBody *body = (MVMHashBody *)data;
 
-    return sizeof(MVMHashEntry) * HASH_CNT(hash_handle, body->hash_head);
+    return MVM_str_hash_allocated_size(tc, &body->hashtable);
 }
 
 /* Initializes the representation. */
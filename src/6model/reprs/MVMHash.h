@@ -1,16 +1,8 @@
 /* Representation used by VM-level hashes. */
 
-struct MVMHashEntry {
-    /* value object */
-    MVMObject *value;
-
-    /* the uthash hash handle inline struct, including the key. */
-    UT_hash_handle hash_handle;
-};
-
 struct MVMHashBody {
-    /* uthash updates this pointer directly. */
-    MVMHashEntry *hash_head;
+    /* The hash table storing the keys and values. */
+    MVMStrHashTable hashtable;
 };
 struct MVMHash {
     MVMObject common;
@@ -20,6 +12,8 @@ struct MVMHash {
 /* Function for REPR setup. */
 const MVMREPROps * MVMHash_initialize(MVMThreadContext *tc);
 
+/* Helpers for the uthash-based hashes keyed on MVMString that are used in
+ * various places inside the VM (VM-level hashes don't use these). */
 #define MVM_HASH_BIND(tc, hash, key, value) \
     do { \
         if (!MVM_is_null(tc, (MVMObject *)key) && REPR(key)->ID == MVM_REPR_ID_MVMString \
@@ -42,8 +36,6 @@ const MVMREPROps * MVMHash_initialize(MVMThreadContext *tc);
         } \
     } while (0);
 
-#define MVM_HASH_KEY(entry) ((MVMString *)(entry)->hash_handle.key)
-
 #define MVM_HASH_DESTROY(hash_handle, hashentry_type, head_node) do { \
     hashentry_type *current, *tmp; \
     unsigned bucket_tmp; \
@@ -104,15 +104,24 @@ static void shift(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, void *da
                 MVM_exception_throw_adhoc(tc, "Wrong register kind in iteration");
             }
             return;
-        case MVM_ITER_MODE_HASH:
-            body->hash_state.curr = body->hash_state.next;
-            if (!body->hash_state.curr)
+        case MVM_ITER_MODE_HASH: {
+            MVMStrHashTable *hashtable = &((MVMHash *)target)->body.hashtable;
+            MVMuint32 idx;
+            if (!body->hash_state.next)
+                MVM_exception_throw_adhoc(tc, "Iteration past end of iterator");
+
+            /* The entry we planned to go to next may since have been
+             * deleted, so skip over any holes. */
+            idx = MVM_str_hash_next_live(tc, hashtable, body->hash_state.next - 1);
+            if (idx >= hashtable->num_entries)
                 MVM_exception_throw_adhoc(tc, "Iteration past end of iterator");
-            body->hash_state.next = HASH_ITER_NEXT_ITEM(
-                &(body->hash_state.next->hash_handle),
-                &(body->hash_state.bucket_state));
+            body->hash_state.curr = idx + 1;
+
+            idx = MVM_str_hash_next_live(tc, hashtable, idx + 1);
+            body->hash_state.next = idx < hashtable->num_entries ? idx + 1 : 0;
             value->o = root;
             return;
+        }
         default:
             MVM_exception_throw_adhoc(tc, "Unknown iteration mode");
     }
@@ -212,16 +221,15 @@ MVMObject * MVM_iter(MVMThreadContext *tc, MVMObject *target) {
             }
         }
         else if (REPR(target)->ID == MVM_REPR_ID_MVMHash) {
+            MVMStrHashTable *hashtable;
+            MVMuint32 first;
             iterator = (MVMIter *)MVM_repr_alloc_init(tc,
                 MVM_hll_current(tc)->hash_iterator_type);
+            hashtable = &((MVMHash *)target)->body.hashtable;
+            first     = MVM_str_hash_next_live(tc, hashtable, 0);
             iterator->body.mode = MVM_ITER_MODE_HASH;
-            iterator->body.hash_state.bucket_state = 0;
-            iterator->body.hash_state.curr         = NULL;
-            iterator->body.hash_state.next         = HASH_ITER_FIRST_ITEM(
-                ((MVMHash *)target)->body.hash_head
-                    ? ((MVMHash *)target)->body.hash_head->hash_handle.tbl
-                    : NULL,
-                &(iterator->body.hash_state.bucket_state));
+            iterator->body.hash_state.curr = 0;
+            iterator->body.hash_state.next = first < hashtable->num_entries ? first + 1 : 0;
             MVM_ASSIGN_REF(tc, &(iterator->common.header), iterator->body.target, target);
         }
         else if (REPR(target)->ID == MVM_REPR_ID_MVMContext) {
@@ -319,20 +327,29 @@ MVMint64 MVM_iter_istrue(MVMThreadContext *tc, MVMIter *iter) {
             return iter->body.array_state.index + 1 < iter->body.array_state.limit ? 1 : 0;
             break;
         case MVM_ITER_MODE_HASH:
-            return iter->body.hash_state.next != NULL ? 1 : 0;
+            return iter->body.hash_state.next != 0 ? 1 : 0;
             break;
         default:
             MVM_exception_throw_adhoc(tc, "Invalid iteration mode used");
     }
 }
 
+/* Gets the hash entry a hash iterator is currently at. */
+static MVMHashEntry * current_hash_entry(MVMThreadContext *tc, MVMIter *iterator) {
+    MVMStrHashTable *hashtable = &((MVMHash *)iterator->body.target)->body.hashtable;
+    MVMuint64 curr = iterator->body.hash_state.curr;
+    if (!curr)
+        MVM_exception_throw_adhoc(tc, "You have not advanced to the first item of the hash iterator, or have gone past the end");
+    if (curr > hashtable->num_entries || !hashtable->entries[curr - 1].key)
+        MVM_exception_throw_adhoc(tc, "The current item of the hash iterator has been deleted");
+    return &hashtable->entries[curr - 1];
+}
+
 MVMString * MVM_iterkey_s(MVMThreadContext *tc, MVMIter *iterator) {
     if (REPR(iterator)->ID != MVM_REPR_ID_MVMIter
             || iterator->body.mode != MVM_ITER_MODE_HASH)
         MVM_exception_throw_adhoc(tc, "This is not a hash iterator, it's a %s (%s)", REPR(iterator)->name, STABLE(iterator)->debug_name);
-    if (!iterator->body.hash_state.curr)
-        MVM_exception_throw_adhoc(tc, "You have not advanced to the first item of the hash iterator, or have gone past the end");
-    return MVM_HASH_KEY(iterator->body.hash_state.curr);
+    return current_hash_entry(tc, iterator)->key;
 }
 
 MVMObject * MVM_iterval(MVMThreadContext *tc, MVMIter *iterator) {
@@ -349,9 +366,7 @@ MVMObject * MVM_iterval(MVMThreadContext *tc, MVMIter *iterator) {
         REPR(target)->pos_funcs.at_pos(tc, STABLE(target), target, OBJECT_BODY(target), body->array_state.index, &result, MVM_reg_obj);
     }
     else if (iterator->body.mode == MVM_ITER_MODE_HASH) {
-        if (!iterator->body.hash_state.curr)
-            MVM_exception_throw_adhoc(tc, "You have not advanced to the first item of the hash iterator, or have gone past the end");
-        result.o = iterator->body.hash_state.curr->value;
+        result.o = current_hash_entry(tc, iterator)->value;
         if (!result.o)
             result.o = tc->instance->VMNull;
     }
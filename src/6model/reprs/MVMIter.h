@@ -16,8 +16,9 @@ struct MVMIterBody {
     /* next hash item to give or next array index */
     union {
         struct {
-            MVMHashEntry *curr, *next;
-            unsigned      bucket_state;
+            /* Positions in the hash's entries array, plus one; 0 means
+             * not advanced yet (curr) or no more entries (next). */
+            MVMuint64 curr, next;
         } hash_state;
         struct {
             MVMint64 index;
@@ -35,6 +35,7 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
             break;
         case MVM_STRING_GRAPHEME_ASCII:
         case MVM_STRING_GRAPHEME_8:
+        case MVM_STRING_GRAPHEME_LATIN1:
             if (dest_body->num_graphs) {
                 dest_body->storage.blob_8 = MVM_malloc(dest_body->num_graphs);
                 memcpy(dest_body->storage.blob_8, src_body->storage.blob_8,
@@ -46,6 +47,12 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
             memcpy(dest_body->storage.strands, src_body->storage.strands,
                 dest_body->num_strands * sizeof(MVMStringStrand));
             break;
+        case MVM_STRING_ROPE:
+            /* The strands of a rope are never changed, only added to, so
+             * can just be shared. */
+            dest_body->storage.rope = src_body->storage.rope;
+            MVM_incr(&(dest_body->storage.rope->refs));
+            break;
         default:
             MVM_exception_throw_adhoc(tc, "Internal string corruption");
     }
@@ -54,9 +61,11 @@ static void copy_to(MVMThreadContext *tc, MVMSTable *st, void *src, MVMObject *d
 /* Adds held objects to the GC worklist. */
 static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorklist *worklist) {
     MVMStringBody *body = (MVMStringBody *)data;
-    if (body->storage_type == MVM_STRING_STRAND) {
-        MVMStringStrand *strands = body->storage.strands;
-        MVMuint16 i;
+    if (body->storage_type == MVM_STRING_STRAND || body->storage_type == MVM_STRING_ROPE) {
+        MVMStringStrand *strands = body->storage_type == MVM_STRING_ROPE
+            ? body->storage.rope->strands
+            : body->storage.strands;
+        MVMuint32 i;
         for (i = 0; i < body->num_strands; i++)
             MVM_gc_worklist_add(tc, worklist, &(strands[i].blob_string));
     }
@@ -65,7 +74,17 @@ static void gc_mark(MVMThreadContext *tc, MVMSTable *st, void *data, MVMGCWorkli
 /* Called by the VM in order to free memory associated with this object. */
 static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
     MVMString *str = (MVMString *)obj;
-    MVM_free(str->body.storage.any);
+    if (str->body.storage_type == MVM_STRING_ROPE) {
+        MVMStringRope *rope = str->body.storage.rope;
+        if (rope && MVM_decr(&(rope->refs)) == 1) {
+            MVM_free(rope->strands);
+            MVM_free(rope->offsets);
+            MVM_free(rope);
+        }
+    }
+    else {
+        MVM_free(str->body.storage.any);
+    }
     str->body.num_graphs = str->body.num_strands = 0;
 }
 
@@ -96,6 +115,8 @@ static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data)
             return sizeof(MVMGrapheme32) * body->num_graphs;
         case MVM_STRING_STRAND:
             return sizeof(MVMStringStrand) * body->num_strands;
+        case MVM_STRING_ROPE:
+            return (sizeof(MVMStringStrand) + sizeof(MVMStringIndex)) * body->num_strands;
         default:
             return body->num_graphs;
     }
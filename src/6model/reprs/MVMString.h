@@ -1,30 +1,47 @@
 /* Representation used by VM-level strings.
  *
- * Strings come in one of 3 forms today, with 1 expected future form:
+ * Strings come in one of 6 forms today:
  *   - 32-bit buffer of graphemes (Unicode codepoints or synthetic codepoints)
  *   - 8-bit buffer of codepoints that all fall in the ASCII range
+ *   - 8-bit buffer of codepoints in the ASCII range, with negatives as
+ *     synthetics (so that, for example, \r\n fits)
+ *   - 8-bit buffer of codepoints that all fall in the Latin-1 range (0-255),
+ *     with no synthetics, which covers most Western European text
  *   - Buffer of strands
- *   - (LATER) 8-bit buffer of codepoints with negatives as synthetics (we
- *     draw out a distinction with the ASCII range buffer because we can do
- *     some I/O simplifications when we know all is in the ASCII range).
+ *   - Rope: a buffer of strands too long to be worth flattening
+ *
+ * The two 8-bit forms can not be compared bytewise with each other when
+ * either holds anything outside of the ASCII range.
  *
  * A buffer of strands represents a string made up of other non-strand
  * strings. That is, there's no recursive strands. This simplifies the
  * process of iteration enormously. A strand may refer to just part of
  * another string by specifying offsets. Furthermore, it may specify a
  * repetition count.
+ *
+ * Once a string would have more than MVM_STRING_MAX_STRANDS strands, it is
+ * made into a rope rather than being flattened. The strands of a rope live
+ * in an MVMStringRope, which may be shared by many ropes: a rope made by
+ * concatenating onto another one can add its strands after those of the
+ * original, in place, so long as no other rope already did so. Each rope
+ * only ever looks at the first num_strands strands. The rope also keeps the
+ * grapheme offset at which each strand starts, so that indexing into it is
+ * a binary search rather than a walk over all of the strands.
  */
 
 /* Kinds of grapheme we may hold in a string. */
 typedef MVMint32 MVMGrapheme32;
 typedef MVMint8  MVMGraphemeASCII;
-typedef MVMint8  MVMGrapheme8;       /* Future use */
+typedef MVMint8  MVMGrapheme8;
+typedef MVMuint8 MVMGraphemeLatin1;
 
 /* What kind of data is a string storing? */
 #define MVM_STRING_GRAPHEME_32      0
 #define MVM_STRING_GRAPHEME_ASCII   1
 #define MVM_STRING_GRAPHEME_8       2
 #define MVM_STRING_STRAND           3
+#define MVM_STRING_ROPE             4
+#define MVM_STRING_GRAPHEME_LATIN1  5
 
 /* String index data type, for when we talk about indexes. */
 typedef MVMuint32 MVMStringIndex;
@@ -32,20 +49,22 @@ typedef MVMuint32 MVMStringIndex;
 /* Data type for a Unicode codepoint. */
 typedef MVMint32 MVMCodepoint;
 
-/* Maximum number of strands we will have. */
+/* Maximum number of strands we will have before making a rope. */
 #define MVM_STRING_MAX_STRANDS  64
 
 /* The body of a string. */
 struct MVMStringBody {
     union {
-        MVMGrapheme32    *blob_32;
-        MVMGraphemeASCII *blob_ascii;
-        MVMGrapheme8     *blob_8;
-        MVMStringStrand  *strands;
-        void             *any;
+        MVMGrapheme32     *blob_32;
+        MVMGraphemeASCII  *blob_ascii;
+        MVMGrapheme8      *blob_8;
+        MVMGraphemeLatin1 *blob_latin1;
+        MVMStringStrand   *strands;
+        MVMStringRope     *rope;
+        void              *any;
     } storage;
     MVMuint16 storage_type;
-    MVMuint16 num_strands;
+    MVMuint32 num_strands;
     MVMuint32 num_graphs;
     MVMint32  cached_hash_code;
 };
@@ -63,6 +82,22 @@ struct MVMStringStrand {
     MVMuint32 repetitions;
 };
 
+/* The strands of one or more ropes. */
+struct MVMStringRope {
+    /* The strands, and the number of graphemes before each of them. */
+    MVMStringStrand *strands;
+    MVMStringIndex  *offsets;
+
+    /* The number of strands allocated, and the number in use by the rope
+     * with the most strands. Ropes may only add strands at the end if the
+     * latter is the number of strands they have. */
+    MVMuint32 alloc_strands;
+    AO_t      num_strands;
+
+    /* The number of ropes sharing these strands. */
+    AO_t      refs;
+};
+
 /* The MVMString, with header and body. */
 struct MVMString {
     MVMObject common;
@@ -3,6 +3,9 @@
 /* This representation's function pointer table. */
 static const MVMREPROps NFA_this_repr;
 
+static void dfa_destroy(MVMNFADFA *dfa);
+static void compute_first(MVMThreadContext *tc, MVMNFABody *nfa);
+
 /* Creates a new type object of this representation, and associates it with
  * the given HOW. */
 static MVMObject * type_object_for(MVMThreadContext *tc, MVMObject *HOW) {
@@ -50,6 +53,11 @@ static void gc_free(MVMThreadContext *tc, MVMObject *obj) {
             MVM_free(nfa->body.states[i]);
     MVM_free(nfa->body.states);
     MVM_free(nfa->body.num_state_edges);
+    if (nfa->body.dfa)
+        dfa_destroy(nfa->body.dfa);
+    MVM_free(nfa->body.first_low);
+    MVM_free(nfa->body.first_high);
+    MVM_free(nfa->body.prefix);
 }
 
 
@@ -215,6 +223,8 @@ static void deserialize(MVMThreadContext *tc, MVMSTable *st, MVMObject *root, vo
             }
         }
     }
+
+    compute_first(tc, body);
 }
 
 /* Compose the representation. */
@@ -237,6 +247,11 @@ static MVMuint64 unmanaged_size(MVMThreadContext *tc, MVMSTable *st, void *data)
     total += body->num_states * sizeof(MVMNFAStateInfo *); /* for states level 1 */
     for (i = 0; i < body->num_states; i++)
         total += body->num_state_edges[i] * sizeof(MVMNFAStateInfo);
+    if (body->dfa)
+        total += sizeof(MVMNFADFA) + body->dfa->memory;
+    if (body->first_low)
+        total += 8 * sizeof(MVMuint32) + body->num_first_high * sizeof(MVMGrapheme32)
+            + body->prefix_len * sizeof(MVMGrapheme32);
 
     return total;
 }
@@ -389,46 +404,572 @@ MVMObject * MVM_nfa_from_statelist(MVMThreadContext *tc, MVMObject *states, MVMO
                 cur_edge++;
             }
         }
+        compute_first(tc, nfa);
     });
     });
 
     return nfa_obj;
 }
 
-/* Does a run of the NFA. Produces a list of integers indicating the
- * chosen ordering. */
-static MVMint32 in_done(MVMuint32 *done, MVMuint32 numdone, MVMuint32 st) {
-    MVMuint32 i = 0;
-    for (i = 0; i < numdone; i++)
-        if (done[i] == st)
-            return 1;
-    return 0;
+/* Running the NFA. At each position in the target, we have a set of active
+ * NFA states. Following the epsilon edges from them gives the fates that
+ * match up to the position, and the edges that may consume the next
+ * character, which take us to the set of states at the next position.
+ *
+ * Sets of NFA states are turned into DFA states as they are met, which keep
+ * what following the epsilon edges leads to, and which states the next
+ * grapheme takes us to, so that the common case is a table lookup for each
+ * grapheme. The DFA is per NFA; if another thread is using it, we do the
+ * same work without caching. */
+
+/* Checks if an edge that consumes a character matches the grapheme at the
+ * offset in the target. */
+static MVMint32 edge_matches(MVMThreadContext *tc, MVMNFAStateInfo *edge, MVMint64 act,
+                             MVMString *target, MVMint64 offset, MVMGrapheme32 g) {
+    switch (act) {
+        case MVM_NFA_EDGE_CODEPOINT_LL:
+        case MVM_NFA_EDGE_CODEPOINT:
+            return g == edge->arg.g;
+        case MVM_NFA_EDGE_CODEPOINT_NEG:
+            return g != edge->arg.g;
+        case MVM_NFA_EDGE_CHARCLASS:
+            return MVM_string_is_cclass(tc, edge->arg.i, target, offset) ? 1 : 0;
+        case MVM_NFA_EDGE_CHARCLASS_NEG:
+            return MVM_string_is_cclass(tc, edge->arg.i, target, offset) ? 0 : 1;
+        case MVM_NFA_EDGE_CHARLIST:
+            return MVM_string_index_of_grapheme(tc, edge->arg.s, g) >= 0;
+        case MVM_NFA_EDGE_CHARLIST_NEG:
+            return MVM_string_index_of_grapheme(tc, edge->arg.s, g) < 0;
+        case MVM_NFA_EDGE_CODEPOINT_I_LL:
+        case MVM_NFA_EDGE_CODEPOINT_I:
+            return g == edge->arg.uclc.lc || g == edge->arg.uclc.uc;
+        case MVM_NFA_EDGE_CODEPOINT_I_NEG:
+            return g != edge->arg.uclc.lc && g != edge->arg.uclc.uc;
+        case MVM_NFA_EDGE_CHARRANGE:
+            return g >= edge->arg.uclc.lc && g <= edge->arg.uclc.uc;
+        case MVM_NFA_EDGE_CHARRANGE_NEG:
+            return g < edge->arg.uclc.lc || g > edge->arg.uclc.uc;
+        case MVM_NFA_EDGE_CODEPOINT_M:
+        case MVM_NFA_EDGE_CODEPOINT_M_NEG: {
+            MVMNormalizer norm;
+            MVMint32 ready;
+            MVMGrapheme32 ga = edge->arg.g;
+            MVMGrapheme32 gb = MVM_string_ord_basechar_at(tc, target, offset);
+
+            MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
+            ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, ga, &ga);
+            MVM_unicode_normalizer_eof(tc, &norm);
+            if (!ready)
+                ga = MVM_unicode_normalizer_get_grapheme(tc, &norm);
+            MVM_unicode_normalizer_cleanup(tc, &norm);
+
+            return act == MVM_NFA_EDGE_CODEPOINT_M ? ga == gb : ga != gb;
+        }
+        case MVM_NFA_EDGE_CODEPOINT_IM:
+        case MVM_NFA_EDGE_CODEPOINT_IM_NEG: {
+            MVMNormalizer norm;
+            MVMint32 ready;
+            MVMGrapheme32 uc_arg = edge->arg.uclc.uc;
+            MVMGrapheme32 lc_arg = edge->arg.uclc.lc;
+            MVMGrapheme32 ord    = MVM_string_ord_basechar_at(tc, target, offset);
+
+            MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
+            ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, uc_arg, &uc_arg);
+            MVM_unicode_normalizer_eof(tc, &norm);
+            if (!ready)
+                uc_arg = MVM_unicode_normalizer_get_grapheme(tc, &norm);
+            MVM_unicode_normalizer_cleanup(tc, &norm);
+
+            MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
+            ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, lc_arg, &lc_arg);
+            MVM_unicode_normalizer_eof(tc, &norm);
+            if (!ready)
+                lc_arg = MVM_unicode_normalizer_get_grapheme(tc, &norm);
+            MVM_unicode_normalizer_cleanup(tc, &norm);
+
+            return act == MVM_NFA_EDGE_CODEPOINT_IM
+                ? ord == lc_arg || ord == uc_arg
+                : ord != lc_arg && ord != uc_arg;
+        }
+        case MVM_NFA_EDGE_CHARRANGE_M: {
+            MVMGrapheme32 ord = MVM_string_ord_basechar_at(tc, target, offset);
+            return ord >= edge->arg.uclc.lc && ord <= edge->arg.uclc.uc;
+        }
+        case MVM_NFA_EDGE_CHARRANGE_M_NEG: {
+            MVMGrapheme32 ord = MVM_string_ord_basechar_at(tc, target, offset);
+            return ord < edge->arg.uclc.lc || ord > edge->arg.uclc.uc;
+        }
+        default:
+            /* Subrule and generic variable edges are ignored. */
+            return 0;
+    }
 }
-static MVMint64 * nqp_nfa_run(MVMThreadContext *tc, MVMNFABody *nfa, MVMString *target, MVMint64 offset, MVMint64 *total_fates_out) {
-    MVMint64  eos     = MVM_string_graphs(tc, target);
-    MVMuint32 gen     = 1;
-    MVMint64  numcur  = 0;
-    MVMint64  numnext = 0;
-    MVMint64  numdone = 0;
-    MVMuint32 *done, *curst, *nextst;
-    MVMint64  *fates, *longlit;
-    MVMint64  i, fate_arr_len, num_states, total_fates, prev_fates, usedlonglit;
-    MVMint64  orig_offset = offset;
-    int nfadeb = tc->instance->nfa_debug_enabled;
 
-    /* Obtain or (re)allocate "done states", "current states" and "next
-     * states" arrays. */
-    num_states = nfa->num_states;
+/* Makes sure the per-thread "done states", "current states" and "next
+ * states" arrays are big enough for an NFA with the given number of states. */
+static void ensure_states(MVMThreadContext *tc, MVMint64 num_states) {
     if (tc->nfa_alloc_states < num_states) {
         size_t alloc   = (num_states + 1) * sizeof(MVMuint32);
         tc->nfa_done   = (MVMuint32 *)MVM_realloc(tc->nfa_done, alloc);
         tc->nfa_curst  = (MVMuint32 *)MVM_realloc(tc->nfa_curst, alloc);
         tc->nfa_nextst = (MVMuint32 *)MVM_realloc(tc->nfa_nextst, alloc);
         tc->nfa_alloc_states = num_states;
+        memset(tc->nfa_done, 0, alloc);
+        tc->nfa_done_gen = 0;
+    }
+}
+
+/* Gets a new generation for marking NFA states as seen in the per-thread
+ * done array. */
+static MVMuint32 next_gen(MVMThreadContext *tc) {
+    if (++tc->nfa_done_gen == 0) {
+        memset(tc->nfa_done, 0, (tc->nfa_alloc_states + 1) * sizeof(MVMuint32));
+        tc->nfa_done_gen = 1;
+    }
+    return tc->nfa_done_gen;
+}
+
+/* Makes sure the per-thread edge working memory can hold the given number of
+ * edges. */
+static void ensure_edges(MVMThreadContext *tc, MVMint64 num_edges) {
+    if (tc->nfa_edges_len < num_edges) {
+        MVMint64 len = tc->nfa_edges_len ? tc->nfa_edges_len : 16;
+        while (len < num_edges)
+            len *= 2;
+        tc->nfa_edges      = MVM_realloc(tc->nfa_edges, len * sizeof(MVMNFAStateInfo *));
+        tc->nfa_edge_fates = MVM_realloc(tc->nfa_edge_fates, len * sizeof(MVMint64));
+        tc->nfa_edges_len  = len;
+    }
+}
+
+/* Follows epsilon edges from a set of NFA states. The fates crossed are put
+ * in the thread's nfa_closure_fates, with the count in *num_fates_out, and
+ * the edges that consume a character in nfa_edges, the count of which is
+ * returned. Uses nfa_nextst as a stack, so the set must not live there. */
+static MVMint64 follow_epsilons(MVMThreadContext *tc, MVMNFABody *nfa, MVMuint32 *set,
+                                MVMint64 num, MVMint64 *num_fates_out) {
+    MVMuint32 *done      = tc->nfa_done;
+    MVMuint32 *stack     = tc->nfa_nextst;
+    MVMuint32  gen       = next_gen(tc);
+    MVMint64   top       = 0;
+    MVMint64   num_edges = 0;
+    MVMint64   num_fates = 0;
+    MVMint64   i;
+
+    for (i = 0; i < num; i++) {
+        stack[top++] = set[i];
+        done[set[i]] = gen;
+    }
+    while (top) {
+        MVMuint32        st        = stack[--top];
+        MVMNFAStateInfo *edge_info = nfa->states[st - 1];
+        MVMint64         edges     = nfa->num_state_edges[st - 1];
+        for (i = 0; i < edges; i++) {
+            MVMint64 act = edge_info[i].act;
+            MVMint64 to  = edge_info[i].to;
+            if (act == MVM_NFA_EDGE_FATE) {
+                if (num_fates == tc->nfa_closure_fates_len) {
+                    tc->nfa_closure_fates_len = num_fates ? 2 * num_fates : 16;
+                    tc->nfa_closure_fates = MVM_realloc(tc->nfa_closure_fates,
+                        tc->nfa_closure_fates_len * sizeof(MVMint64));
+                }
+                tc->nfa_closure_fates[num_fates++] = edge_info[i].arg.i;
+            }
+            else if (act == MVM_NFA_EDGE_EPSILON) {
+                if (to > 0 && to <= nfa->num_states && done[to] != gen) {
+                    done[to] = gen;
+                    stack[top++] = to;
+                }
+            }
+            else {
+                /* A negative act has a fate encoded along with the edge type. */
+                if (act < 0)
+                    act &= 0xff;
+                if (act >= MVM_NFA_EDGE_CODEPOINT && act != MVM_NFA_EDGE_SUBRULE &&
+                        act != MVM_NFA_EDGE_GENERIC_VAR) {
+                    ensure_edges(tc, num_edges + 1);
+                    tc->nfa_edges[num_edges++] = &(edge_info[i]);
+                }
+            }
+        }
+    }
+
+    *num_fates_out = num_fates;
+    return num_edges;
+}
+
+static int compare_states(const void *a, const void *b) {
+    MVMuint32 sa = *(const MVMuint32 *)a;
+    MVMuint32 sb = *(const MVMuint32 *)b;
+    return sa < sb ? -1 : sa > sb ? 1 : 0;
+}
+
+/* Follows the edges that match the grapheme at the offset, putting the set
+ * of NFA states reached, sorted, in the thread's nfa_nextst and returning how
+ * many there are. Fates whose longest literal ends with the grapheme are put
+ * in nfa_edge_fates, with the count in *num_ll_out. */
+static MVMint64 follow_edges(MVMThreadContext *tc, MVMNFABody *nfa, MVMNFAStateInfo **edges,
+                             MVMint64 num_edges, MVMString *target, MVMint64 offset,
+                             MVMGrapheme32 g, MVMint64 *num_ll_out) {
+    MVMuint32 *done   = tc->nfa_done;
+    MVMuint32 *next   = tc->nfa_nextst;
+    MVMuint32  gen    = next_gen(tc);
+    MVMint64   num    = 0;
+    MVMint64   num_ll = 0;
+    MVMint64   i;
+
+    ensure_edges(tc, num_edges);
+    for (i = 0; i < num_edges; i++) {
+        MVMNFAStateInfo *edge = edges[i];
+        MVMint64         act  = edge->act < 0 ? edge->act & 0xff : edge->act;
+        MVMint64         to   = edge->to;
+        if (!edge_matches(tc, edge, act, target, offset, g))
+            continue;
+        if (act == MVM_NFA_EDGE_CODEPOINT_LL || act == MVM_NFA_EDGE_CODEPOINT_I_LL)
+            tc->nfa_edge_fates[num_ll++] = (edge->act >> 8) & 0xfffff;
+        if (to > 0 && to <= nfa->num_states && done[to] != gen) {
+            done[to] = gen;
+            next[num++] = to;
+        }
+    }
+    if (num > 1)
+        qsort(next, num, sizeof(MVMuint32), compare_states);
+
+    *num_ll_out = num_ll;
+    return num;
+}
+
+/* Gets the DFA of an NFA for use by this thread, creating it if needed.
+ * Returns NULL if another thread is using it. */
+static MVMNFADFA * dfa_acquire(MVMThreadContext *tc, MVMNFABody *nfa) {
+    MVMNFADFA *dfa = nfa->dfa;
+    if (!dfa) {
+        dfa = MVM_calloc(1, sizeof(MVMNFADFA));
+        dfa->buckets = MVM_calloc(MVM_NFA_DFA_BUCKETS, sizeof(MVMuint32));
+        if (!MVM_trycas(&(nfa->dfa), NULL, dfa)) {
+            MVM_free(dfa->buckets);
+            MVM_free(dfa);
+            dfa = nfa->dfa;
+        }
+    }
+    return MVM_trycas(&(dfa->in_use), 0, 1) ? dfa : NULL;
+}
+
+/* Throws away all of the states of a DFA. */
+static void dfa_flush(MVMNFADFA *dfa) {
+    MVMuint32 i;
+    for (i = 0; i < dfa->num_states; i++) {
+        MVMNFADFAState *s = &(dfa->states[i]);
+        MVM_free(s->nfa_states);
+        MVM_free(s->fates);
+        MVM_free(s->edges);
+        MVM_free(s->next);
+        MVM_free(s->ll);
+    }
+    dfa->num_states = 0;
+    dfa->num_ll     = 0;
+    dfa->memory     = 0;
+    memset(dfa->buckets, 0, MVM_NFA_DFA_BUCKETS * sizeof(MVMuint32));
+}
+
+static void dfa_destroy(MVMNFADFA *dfa) {
+    dfa_flush(dfa);
+    MVM_free(dfa->states);
+    MVM_free(dfa->buckets);
+    MVM_free(dfa->ll_pool);
+    MVM_free(dfa);
+}
+
+static MVMuint32 hash_states(MVMuint32 *set, MVMint64 num) {
+    MVMuint32 hash = 2166136261u;
+    MVMint64  i;
+    for (i = 0; i < num; i++)
+        hash = (hash ^ set[i]) * 16777619u;
+    return hash;
+}
+
+/* Finds the DFA state for a (sorted) set of NFA states, or adds it. If the
+ * DFA is over its memory limit, it is thrown away first, and *flushed set,
+ * as any DFA state indexes held are no longer valid. */
+static MVMuint32 dfa_state_for(MVMThreadContext *tc, MVMNFABody *nfa, MVMNFADFA *dfa,
+                               MVMuint32 *set, MVMint64 num, MVMint32 *flushed) {
+    MVMuint32       hash   = hash_states(set, num);
+    MVMuint32       bucket = hash % MVM_NFA_DFA_BUCKETS;
+    MVMuint32       idx    = dfa->buckets[bucket];
+    MVMNFADFAState *s;
+    MVMint64        num_edges, num_fates;
+
+    *flushed = 0;
+    while (idx) {
+        s = &(dfa->states[idx - 1]);
+        if (s->hash == hash && s->num_nfa_states == num &&
+                memcmp(s->nfa_states, set, num * sizeof(MVMuint32)) == 0)
+            return idx - 1;
+        idx = s->chain;
+    }
+
+    if (dfa->memory > MVM_NFA_DFA_MAX_MEMORY) {
+        dfa_flush(dfa);
+        *flushed = 1;
     }
-    done   = tc->nfa_done;
-    curst  = tc->nfa_curst;
-    nextst = tc->nfa_nextst;
+    if (dfa->num_states == dfa->alloc_states) {
+        dfa->alloc_states = dfa->alloc_states ? 2 * dfa->alloc_states : 16;
+        dfa->states = MVM_realloc(dfa->states, dfa->alloc_states * sizeof(MVMNFADFAState));
+    }
+    s = &(dfa->states[dfa->num_states]);
+    memset(s, 0, sizeof(MVMNFADFAState));
+
+    /* Copy the set first, as it may be in the space used for following
+     * epsilon edges. */
+    s->nfa_states     = MVM_malloc((num ? num : 1) * sizeof(MVMuint32));
+    s->num_nfa_states = num;
+    memcpy(s->nfa_states, set, num * sizeof(MVMuint32));
+    num_edges    = follow_epsilons(tc, nfa, s->nfa_states, num, &num_fates);
+    s->num_fates = num_fates;
+    s->num_edges = num_edges;
+    if (num_fates) {
+        s->fates = MVM_malloc(num_fates * sizeof(MVMint64));
+        memcpy(s->fates, tc->nfa_closure_fates, num_fates * sizeof(MVMint64));
+    }
+    if (num_edges) {
+        s->edges = MVM_malloc(num_edges * sizeof(MVMNFAStateInfo *));
+        memcpy(s->edges, tc->nfa_edges, num_edges * sizeof(MVMNFAStateInfo *));
+    }
+
+    s->hash = hash;
+    s->chain = dfa->buckets[bucket];
+    dfa->buckets[bucket] = dfa->num_states + 1;
+    dfa->memory += sizeof(MVMNFADFAState) + num * sizeof(MVMuint32)
+        + num_fates * sizeof(MVMint64) + num_edges * sizeof(MVMNFAStateInfo *);
+    return dfa->num_states++;
+}
+
+/* Records a transition of a DFA state on a grapheme. */
+static void dfa_add_transition(MVMThreadContext *tc, MVMNFADFA *dfa, MVMuint32 from,
+                               MVMGrapheme32 g, MVMuint32 to, MVMint64 *ll, MVMint64 num_ll) {
+    MVMNFADFAState *s = &(dfa->states[from]);
+    if (!s->next) {
+        s->next = MVM_calloc(MVM_NFA_DFA_TABLE_SIZE, sizeof(MVMuint32));
+        s->ll   = MVM_calloc(MVM_NFA_DFA_TABLE_SIZE, sizeof(MVMuint32));
+        dfa->memory += 2 * MVM_NFA_DFA_TABLE_SIZE * sizeof(MVMuint32);
+    }
+    if (num_ll) {
+        if (dfa->num_ll + num_ll + 1 > dfa->alloc_ll) {
+            while (dfa->num_ll + num_ll + 1 > dfa->alloc_ll)
+                dfa->alloc_ll = dfa->alloc_ll ? 2 * dfa->alloc_ll : 64;
+            dfa->ll_pool = MVM_realloc(dfa->ll_pool, dfa->alloc_ll * sizeof(MVMint64));
+        }
+        s->ll[g] = dfa->num_ll + 1;
+        dfa->ll_pool[dfa->num_ll++] = num_ll;
+        memcpy(dfa->ll_pool + dfa->num_ll, ll, num_ll * sizeof(MVMint64));
+        dfa->num_ll += num_ll;
+        dfa->memory += (num_ll + 1) * sizeof(MVMint64);
+    }
+    s->next[g] = to + 1;
+}
+
+/* Adds a grapheme that a match may start with. */
+static void add_first_grapheme(MVMuint32 *low, MVMGrapheme32 **high, MVMuint32 *num_high,
+                               MVMGrapheme32 g) {
+    if (g >= 0 && g < 256) {
+        low[g >> 5] |= 1 << (g & 31);
+    }
+    else {
+        if (*num_high % 16 == 0)
+            *high = MVM_realloc(*high, (*num_high + 16) * sizeof(MVMGrapheme32));
+        (*high)[(*num_high)++] = g;
+    }
+}
+
+/* Adds the graphemes an edge may consume to the set of those a match may
+ * start with. Returns zero if we can't easily tell what they are. */
+static MVMint32 add_first_edge(MVMThreadContext *tc, MVMNFAStateInfo *edge, MVMuint32 *low,
+                               MVMGrapheme32 **high, MVMuint32 *num_high) {
+    MVMint64 act = edge->act < 0 ? edge->act & 0xff : edge->act;
+    switch (act) {
+        case MVM_NFA_EDGE_CODEPOINT:
+        case MVM_NFA_EDGE_CODEPOINT_LL:
+            add_first_grapheme(low, high, num_high, edge->arg.g);
+            break;
+        case MVM_NFA_EDGE_CODEPOINT_I:
+        case MVM_NFA_EDGE_CODEPOINT_I_LL:
+            add_first_grapheme(low, high, num_high, edge->arg.uclc.lc);
+            add_first_grapheme(low, high, num_high, edge->arg.uclc.uc);
+            break;
+        case MVM_NFA_EDGE_CHARRANGE: {
+            MVMGrapheme32 lc = edge->arg.uclc.lc;
+            MVMGrapheme32 uc = edge->arg.uclc.uc;
+            MVMGrapheme32 g;
+            if (uc >= 256 && uc - lc >= 64)
+                return 0;
+            for (g = lc; g <= uc; g++)
+                add_first_grapheme(low, high, num_high, g);
+            break;
+        }
+        case MVM_NFA_EDGE_CHARLIST: {
+            MVMString *list  = edge->arg.s;
+            MVMint64   elems = MVM_string_graphs(tc, list);
+            MVMint64   i;
+            if (elems > MVM_NFA_MAX_FIRST_HIGH)
+                return 0;
+            for (i = 0; i < elems; i++)
+                add_first_grapheme(low, high, num_high,
+                    MVM_string_get_grapheme_at_nocheck(tc, list, i));
+            break;
+        }
+        case MVM_NFA_EDGE_CODEPOINT_M_LL:
+        case MVM_NFA_EDGE_CODEPOINT_IM_LL:
+            /* These never match. */
+            break;
+        default:
+            /* Negations, character classes and matches ignoring marks may
+             * match most anything. */
+            return 0;
+    }
+    return *num_high <= MVM_NFA_MAX_FIRST_HIGH;
+}
+
+static int compare_graphemes(const void *a, const void *b) {
+    MVMGrapheme32 ga = *(const MVMGrapheme32 *)a;
+    MVMGrapheme32 gb = *(const MVMGrapheme32 *)b;
+    return ga < gb ? -1 : ga > gb ? 1 : 0;
+}
+
+/* Works out what a match of the NFA must start with: the graphemes it may
+ * start with, and the literal prefix shared by all of its alternatives. We
+ * only do so if no alternative matches without consuming anything, and all
+ * of the edges leaving the start state (after following epsilons) are ones
+ * we can easily tell the graphemes of. */
+static void compute_first(MVMThreadContext *tc, MVMNFABody *nfa) {
+    MVMuint32     *set, *low;
+    MVMGrapheme32 *high     = NULL;
+    MVMuint32      num_high = 0;
+    MVMGrapheme32  prefix[MVM_NFA_MAX_PREFIX];
+    MVMuint32      prefix_len = 0;
+    MVMint64       num_edges, num_fates, i;
+
+    if (nfa->num_states < 1)
+        return;
+    ensure_states(tc, nfa->num_states);
+    set = MVM_malloc((nfa->num_states + 1) * sizeof(MVMuint32));
+    set[0] = 1;
+    num_edges = follow_epsilons(tc, nfa, set, 1, &num_fates);
+    if (num_fates) {
+        MVM_free(set);
+        return;
+    }
+
+    /* Collect the graphemes the first edges may consume. */
+    low = MVM_calloc(8, sizeof(MVMuint32));
+    for (i = 0; i < num_edges; i++) {
+        if (!add_first_edge(tc, tc->nfa_edges[i], low, &high, &num_high)) {
+            MVM_free(low);
+            MVM_free(high);
+            MVM_free(set);
+            return;
+        }
+    }
+    if (num_high > 1) {
+        MVMuint32 j, k = 1;
+        qsort(high, num_high, sizeof(MVMGrapheme32), compare_graphemes);
+        for (j = 1; j < num_high; j++)
+            if (high[j] != high[k - 1])
+                high[k++] = high[j];
+        num_high = k;
+    }
+
+    /* See how far all paths consume the same graphemes. */
+    while (prefix_len < MVM_NFA_MAX_PREFIX && num_edges && !num_fates) {
+        MVMGrapheme32 g = tc->nfa_edges[0]->arg.g;
+        MVMuint32     gen;
+        MVMint64      num_next = 0;
+        for (i = 0; i < num_edges; i++) {
+            MVMNFAStateInfo *edge = tc->nfa_edges[i];
+            MVMint64         act  = edge->act < 0 ? edge->act & 0xff : edge->act;
+            if ((act != MVM_NFA_EDGE_CODEPOINT && act != MVM_NFA_EDGE_CODEPOINT_LL) ||
+                    edge->arg.g != g)
+                break;
+        }
+        if (i < num_edges)
+            break;
+        prefix[prefix_len++] = g;
+        gen = next_gen(tc);
+        for (i = 0; i < num_edges; i++) {
+            MVMint64 to = tc->nfa_edges[i]->to;
+            if (to > 0 && to <= nfa->num_states && tc->nfa_done[to] != gen) {
+                tc->nfa_done[to] = gen;
+                set[num_next++] = to;
+            }
+        }
+        num_edges = follow_epsilons(tc, nfa, set, num_next, &num_fates);
+    }
+    MVM_free(set);
+
+    nfa->first_low      = low;
+    nfa->first_high     = high;
+    nfa->num_first_high = num_high;
+    if (prefix_len > 1) {
+        nfa->prefix     = MVM_malloc(prefix_len * sizeof(MVMGrapheme32));
+        nfa->prefix_len = prefix_len;
+        memcpy(nfa->prefix, prefix, prefix_len * sizeof(MVMGrapheme32));
+    }
+}
+
+/* Checks if the NFA may match at the offset in the target, going by what
+ * a match must start with. */
+static MVMint32 may_match(MVMThreadContext *tc, MVMNFABody *nfa, MVMString *target,
+                          MVMint64 offset, MVMint64 eos) {
+    MVMGrapheme32 g;
+    MVMuint32     i;
+    if (!nfa->first_low || offset < 0)
+        return 1;
+    if (offset >= eos)
+        return 0;
+
+    g = MVM_string_get_grapheme_at_nocheck(tc, target, offset);
+    if (g >= 0 && g < 256) {
+        if (!(nfa->first_low[g >> 5] & (1 << (g & 31))))
+            return 0;
+    }
+    else if (!bsearch(&g, nfa->first_high, nfa->num_first_high, sizeof(MVMGrapheme32),
+            compare_graphemes)) {
+        return 0;
+    }
+
+    if (nfa->prefix_len) {
+        if (offset + nfa->prefix_len > eos)
+            return 0;
+        for (i = 1; i < nfa->prefix_len; i++)
+            if (MVM_string_get_grapheme_at_nocheck(tc, target, offset + i) != nfa->prefix[i])
+                return 0;
+    }
+    return 1;
+}
+
+/* Does a run of the NFA. Produces a list of integers indicating the
+ * chosen ordering. */
+static MVMint64 * nqp_nfa_run(MVMThreadContext *tc, MVMNFABody *nfa, MVMString *target, MVMint64 offset, MVMint64 *total_fates_out) {
+    MVMint64   eos     = MVM_string_graphs(tc, target);
+    MVMint64   numcur  = 0;
+    MVMuint32  cur     = 0;
+    MVMint32   flushed;
+    MVMNFADFA *dfa;
+    MVMint64  *fates, *longlit;
+    MVMint64   i, fate_arr_len, num_states, total_fates, prev_fates, usedlonglit;
+    MVMint64   orig_offset = offset;
+    int nfadeb = tc->instance->nfa_debug_enabled;
+
+    /* Give up right away if the NFA can't match here. */
+    if (!may_match(tc, nfa, target, offset, eos)) {
+        if (nfadeb) fprintf(stderr,"======================================\nNo match possible at offset %"PRId64"\n", offset);
+        *total_fates_out = 0;
+        return tc->nfa_fates;
+    }
+
+    /* Obtain or (re)allocate "done states", "current states" and "next
+     * states" arrays. */
+    num_states = nfa->num_states;
+    ensure_states(tc, num_states);
 
     /* Allocate fates array. */
     fate_arr_len = 1 + MVM_repr_elems(tc, nfa->fates);
@@ -449,15 +990,40 @@ static MVMint64 * nqp_nfa_run(MVMThreadContext *tc, MVMNFABody *nfa, MVMString *
     longlit = tc->nfa_longlit;
     usedlonglit = 0;
 
-    nextst[numnext++] = 1;
-    while (numnext && offset <= eos) {
-        /* Swap next and current */
-        MVMuint32 *temp = curst;
-        curst   = nextst;
-        nextst  = temp;
-        numcur  = numnext;
-        numnext = 0;
-        numdone = 0;
+    /* Start out in the first state. */
+    if (num_states > 0)
+        tc->nfa_curst[numcur++] = 1;
+    /* Matching an edge may throw, in which case we must give up the DFA. */
+    dfa = dfa_acquire(tc, nfa);
+    if (dfa) {
+        MVM_tc_set_ex_release_flag(tc, &(dfa->in_use));
+        cur = dfa_state_for(tc, nfa, dfa, tc->nfa_curst, numcur, &flushed);
+    }
+
+    while (offset <= eos) {
+        MVMNFADFAState  uncached;
+        MVMNFADFAState *state;
+        MVMGrapheme32   g;
+        MVMint64       *ll;
+        MVMint64        num_ll;
+
+        /* Get what following the epsilon edges from the current states leads
+         * to, from the DFA if we can. */
+        if (dfa) {
+            state = &(dfa->states[cur]);
+        }
+        else {
+            MVMint64 num_fates;
+            uncached.nfa_states     = tc->nfa_curst;
+            uncached.num_nfa_states = numcur;
+            uncached.num_edges      = follow_epsilons(tc, nfa, tc->nfa_curst, numcur, &num_fates);
+            uncached.num_fates      = num_fates;
+            uncached.fates          = tc->nfa_closure_fates;
+            uncached.edges          = tc->nfa_edges;
+            state = &uncached;
+        }
+        if (!state->num_nfa_states)
+            break;
 
         /* Save how many fates we have before this position is considered. */
         prev_fates = total_fates;
@@ -465,269 +1031,103 @@ static MVMint64 * nqp_nfa_run(MVMThreadContext *tc, MVMNFABody *nfa, MVMString *
         if (nfadeb) {
             if (offset < eos) {
                 MVMGrapheme32 cp = MVM_string_get_grapheme_at_nocheck(tc, target, offset);
-                fprintf(stderr,"%c with %ds target %lx offset %"PRId64"\n",cp,(int)numcur, (long)target, offset);
+                fprintf(stderr,"%c with %ds target %lx offset %"PRId64"\n",cp,(int)state->num_nfa_states, (long)target, offset);
             }
             else {
-                fprintf(stderr,"EOS with %ds\n",(int)numcur);
+                fprintf(stderr,"EOS with %ds\n",(int)state->num_nfa_states);
             }
         }
-        while (numcur) {
-            MVMNFAStateInfo *edge_info;
-            MVMint64         edge_info_elems;
-
-            MVMint64 st = curst[--numcur];
-            if (st <= num_states) {
-                if (in_done(done, numdone, st))
-                    continue;
-                done[numdone++] = st;
-            }
 
-            edge_info = nfa->states[st - 1];
-            edge_info_elems = nfa->num_state_edges[st - 1];
+        for (i = 0; i < state->num_fates; i++) {
+            /* Crossed a fate edge. Check if we already saw this fate, and
+             * if so remove the entry so we can re-add at the new token length. */
+            MVMint64 arg = state->fates[i];
+            MVMint64 j;
+            MVMint64 found_fate = 0;
             if (nfadeb)
-                fprintf(stderr,"\t%d\t%d\t",(int)st, (int)edge_info_elems);
-            for (i = 0; i < edge_info_elems; i++) {
-                MVMint64 act = edge_info[i].act;
-                MVMint64 to  = edge_info[i].to;
-
-                /* All the special cases are under one test. */
-                if (act <= MVM_NFA_EDGE_EPSILON) {
-                    if (act < 0) {
-                        /* Negative indicates a fate is encoded in the act of the codepoint edge. */
-                        /* These will redispatch to one of the _LL cases below */
-                        act &= 0xff;
-                    }
-                    else if (act == MVM_NFA_EDGE_FATE) {
-                        /* Crossed a fate edge. Check if we already saw this fate, and
-                         * if so remove the entry so we can re-add at the new token length. */
-                        MVMint64 arg = edge_info[i].arg.i;
-                        MVMint64 j;
-                        MVMint64 found_fate = 0;
-                        if (nfadeb)
-                            fprintf(stderr, "fate(%016llx) ", (long long unsigned int)arg);
-                        for (j = 0; j < total_fates; j++) {
-                            if (found_fate)
-                                fates[j - found_fate] = fates[j];
-                            if ((fates[j] & 0xffffff) == arg) {
-                                found_fate++;
-                                if (j < prev_fates)
-                                    prev_fates--;
-                            }
-                        }
-                        total_fates -= found_fate;
-                        if (arg < usedlonglit)
-                            arg -= longlit[arg] << 24;
-                        if (++total_fates > fate_arr_len) {
-                            /* should never happen if nfa->fates is correct and dedup above works right */
-                            fprintf(stderr, "oops adding %016llx to\n", (long long unsigned int)arg);
-                            for (j = 0; j < total_fates - 1; j++) {
-                                fprintf(stderr, "  %016llx\n", (long long unsigned int)fates[j]);
-                            }
-                            fate_arr_len      = total_fates + 10;
-                            tc->nfa_fates     = (MVMint64 *)MVM_realloc(tc->nfa_fates,
-                                sizeof(MVMint64) * fate_arr_len);
-                            tc->nfa_fates_len = fate_arr_len;
-                            fates             = tc->nfa_fates;
-                        }
-                        /* a small insertion sort */
-                        j = total_fates - 1;
-                        while (--j >= prev_fates && fates[j] < arg) {
-                            fates[j + 1] = fates[j];
-                        }
-                        fates[++j] = arg;
-                        continue;
-                    }
-                    else if (act == MVM_NFA_EDGE_EPSILON && to <= num_states &&
-                            !in_done(done, numdone, to)) {
-                        if (to)
-                            curst[numcur++] = to;
-                        else if (nfadeb)  /* XXX should turn into a "can't happen" after rebootstrap */
-                            fprintf(stderr, "  oops, ignoring epsilon to 0\n");
-                        continue;
-                    }
+                fprintf(stderr, "fate(%016llx) ", (long long unsigned int)arg);
+            for (j = 0; j < total_fates; j++) {
+                if (found_fate)
+                    fates[j - found_fate] = fates[j];
+                if ((fates[j] & 0xffffff) == arg) {
+                    found_fate++;
+                    if (j < prev_fates)
+                        prev_fates--;
                 }
-
-                if (offset >= eos) {
-                    /* Can't match, so drop state. */
-                    continue;
-                }
-                else {
-                    switch (act) {
-                        case MVM_NFA_EDGE_CODEPOINT_LL: {
-                            MVMGrapheme32 arg = edge_info[i].arg.g;
-                            if (MVM_string_get_grapheme_at_nocheck(tc, target, offset) == arg) {
-                                MVMint64 fate = (edge_info[i].act >> 8) & 0xfffff;
-                                nextst[numnext++] = to;
-                                while (usedlonglit <= fate)
-                                    longlit[usedlonglit++] = 0;
-                                longlit[fate] = offset - orig_offset + 1;
-                                if (nfadeb)
-                                    fprintf(stderr, "%d->%d ", (int)i, (int)to);
-                            }
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT: {
-                            MVMGrapheme32 arg = edge_info[i].arg.g;
-                            if (MVM_string_get_grapheme_at_nocheck(tc, target, offset) == arg) {
-                                nextst[numnext++] = to;
-                                if (nfadeb)
-                                    fprintf(stderr, "%d->%d ", (int)i, (int)to);
-                            }
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT_NEG: {
-                            MVMGrapheme32 arg = edge_info[i].arg.g;
-                            if (MVM_string_get_grapheme_at_nocheck(tc, target, offset) != arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARCLASS: {
-                            MVMint64 arg = edge_info[i].arg.i;
-                            if (MVM_string_is_cclass(tc, arg, target, offset))
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARCLASS_NEG: {
-                            MVMint64 arg = edge_info[i].arg.i;
-                            if (!MVM_string_is_cclass(tc, arg, target, offset))
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARLIST: {
-                            MVMString *arg    = edge_info[i].arg.s;
-                            MVMGrapheme32 cp = MVM_string_get_grapheme_at_nocheck(tc, target, offset);
-                            if (MVM_string_index_of_grapheme(tc, arg, cp) >= 0)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARLIST_NEG: {
-                            MVMString *arg    = edge_info[i].arg.s;
-                            MVMGrapheme32 cp = MVM_string_get_grapheme_at_nocheck(tc, target, offset);
-                            if (MVM_string_index_of_grapheme(tc, arg, cp) < 0)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT_I_LL: {
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            MVMGrapheme32 ord    = MVM_string_get_grapheme_at_nocheck(tc, target, offset);
-                            if (ord == lc_arg || ord == uc_arg) {
-                                MVMint64 fate = (edge_info[i].act >> 8) & 0xfffff;
-                                nextst[numnext++] = to;
-                                while (usedlonglit <= fate)
-                                    longlit[usedlonglit++] = 0;
-                                longlit[fate] = offset - orig_offset + 1;
-                            }
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT_I: {
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            MVMGrapheme32 ord    = MVM_string_get_grapheme_at_nocheck(tc, target, offset);
-                            if (ord == lc_arg || ord == uc_arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT_I_NEG: {
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            MVMGrapheme32 ord    = MVM_string_get_grapheme_at_nocheck(tc, target, offset);
-                            if (ord != lc_arg && ord != uc_arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARRANGE: {
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            MVMGrapheme32 ord    = MVM_string_get_grapheme_at_nocheck(tc, target, offset);
-                            if (ord >= lc_arg && ord <= uc_arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARRANGE_NEG: {
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            MVMGrapheme32 ord    = MVM_string_get_grapheme_at_nocheck(tc, target, offset);
-                            if (ord < lc_arg || ord > uc_arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_SUBRULE:
-                            if (nfadeb)
-                                fprintf(stderr, "IGNORING SUBRULE\n");
-                            continue;
-                        case MVM_NFA_EDGE_CODEPOINT_M:
-                        case MVM_NFA_EDGE_CODEPOINT_M_NEG: {
-                            MVMNormalizer norm;
-                            MVMint32 ready;
-                            MVMGrapheme32 ga = edge_info[i].arg.g;
-                            MVMGrapheme32 gb = MVM_string_ord_basechar_at(tc, target, offset);
-
-                            MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
-                            ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, ga, &ga);
-                            MVM_unicode_normalizer_eof(tc, &norm);
-                            if (!ready)
-                                ga = MVM_unicode_normalizer_get_grapheme(tc, &norm);
-
-                            if (((act == MVM_NFA_EDGE_CODEPOINT_M)     && (ga == gb))
-                             || ((act == MVM_NFA_EDGE_CODEPOINT_M_NEG) && (ga != gb)))
-                                nextst[numnext++] = to;
-                            MVM_unicode_normalizer_cleanup(tc, &norm);
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CODEPOINT_IM:
-                        case MVM_NFA_EDGE_CODEPOINT_IM_NEG: {
-                            MVMNormalizer norm;
-                            MVMint32 ready;
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            MVMGrapheme32 ord    = MVM_string_ord_basechar_at(tc, target, offset);
-
-                            MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
-                            ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, uc_arg, &uc_arg);
-                            MVM_unicode_normalizer_eof(tc, &norm);
-                            if (!ready)
-                                uc_arg = MVM_unicode_normalizer_get_grapheme(tc, &norm);
-                            MVM_unicode_normalizer_cleanup(tc, &norm);
-
-                            MVM_unicode_normalizer_init(tc, &norm, MVM_NORMALIZE_NFD);
-                            ready = MVM_unicode_normalizer_process_codepoint_to_grapheme(tc, &norm, lc_arg, &lc_arg);
-                            MVM_unicode_normalizer_eof(tc, &norm);
-                            if (!ready)
-                                lc_arg = MVM_unicode_normalizer_get_grapheme(tc, &norm);
-
-                            if (((act == MVM_NFA_EDGE_CODEPOINT_IM)     && (ord == lc_arg || ord == uc_arg))
-                             || ((act == MVM_NFA_EDGE_CODEPOINT_IM_NEG) && (ord != lc_arg && ord != uc_arg)))
-                                nextst[numnext++] = to;
-                            MVM_unicode_normalizer_cleanup(tc, &norm);
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARRANGE_M: {
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            MVMGrapheme32 ord    = MVM_string_ord_basechar_at(tc, target, offset);
-                            if (ord >= lc_arg && ord <= uc_arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                        case MVM_NFA_EDGE_CHARRANGE_M_NEG: {
-                            MVMGrapheme32 uc_arg = edge_info[i].arg.uclc.uc;
-                            MVMGrapheme32 lc_arg = edge_info[i].arg.uclc.lc;
-                            MVMGrapheme32 ord    = MVM_string_ord_basechar_at(tc, target, offset);
-                            if (ord < lc_arg || ord > uc_arg)
-                                nextst[numnext++] = to;
-                            continue;
-                        }
-                    }
+            }
+            total_fates -= found_fate;
+            if (arg < usedlonglit)
+                arg -= longlit[arg] << 24;
+            if (++total_fates > fate_arr_len) {
+                /* should never happen if nfa->fates is correct and dedup above works right */
+                fprintf(stderr, "oops adding %016llx to\n", (long long unsigned int)arg);
+                for (j = 0; j < total_fates - 1; j++) {
+                    fprintf(stderr, "  %016llx\n", (long long unsigned int)fates[j]);
                 }
+                fate_arr_len      = total_fates + 10;
+                tc->nfa_fates     = (MVMint64 *)MVM_realloc(tc->nfa_fates,
+                    sizeof(MVMint64) * fate_arr_len);
+                tc->nfa_fates_len = fate_arr_len;
+                fates             = tc->nfa_fates;
+            }
+            /* a small insertion sort */
+            j = total_fates - 1;
+            while (--j >= prev_fates && fates[j] < arg) {
+                fates[j + 1] = fates[j];
+            }
+            fates[++j] = arg;
+        }
+        if (nfadeb) fprintf(stderr,"\n");
+
+        /* Nothing more can match at the end of the string. */
+        if (offset >= eos)
+            break;
+
+        /* Move on to the states the grapheme takes us to. */
+        g = MVM_string_get_grapheme_at_nocheck(tc, target, offset);
+        if (dfa && g >= 0 && g < MVM_NFA_DFA_TABLE_SIZE && state->next && state->next[g]) {
+            MVMuint32 ll_idx = state->ll[g];
+            cur    = state->next[g] - 1;
+            ll     = ll_idx ? dfa->ll_pool + ll_idx : NULL;
+            num_ll = ll_idx ? dfa->ll_pool[ll_idx - 1] : 0;
+        }
+        else {
+            MVMint64 numnext = follow_edges(tc, nfa, state->edges, state->num_edges,
+                target, offset, g, &num_ll);
+            if (dfa) {
+                /* Adding a DFA state may move the literal fates along with
+                 * the edges, so only look for them afterwards. */
+                MVMuint32 next = dfa_state_for(tc, nfa, dfa, tc->nfa_nextst, numnext, &flushed);
+                ll = tc->nfa_edge_fates;
+                if (!flushed && g >= 0 && g < MVM_NFA_DFA_TABLE_SIZE)
+                    dfa_add_transition(tc, dfa, cur, g, next, ll, num_ll);
+                cur = next;
+            }
+            else {
+                MVMuint32 *temp = tc->nfa_curst;
+                tc->nfa_curst   = tc->nfa_nextst;
+                tc->nfa_nextst  = temp;
+                numcur          = numnext;
+                ll              = tc->nfa_edge_fates;
             }
-            if (nfadeb) fprintf(stderr,"\n");
         }
 
-        /* Move to next character and generation. */
+        /* Note the length of literals that ended here. */
+        for (i = 0; i < num_ll; i++) {
+            MVMint64 fate = ll[i];
+            while (usedlonglit <= fate)
+                longlit[usedlonglit++] = 0;
+            longlit[fate] = offset - orig_offset + 1;
+        }
+
+        /* Move to next character. */
         offset++;
-        gen++;
     }
+    if (dfa) {
+        MVM_tc_clear_ex_release_flag(tc);
+        MVM_store(&(dfa->in_use), 0);
+    }
+
     /* strip any literal lengths, leaving only fates */
     if (usedlonglit || nfadeb) {
         if (nfadeb) fprintf(stderr,"Final\n");
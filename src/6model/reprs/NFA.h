@@ -39,12 +39,93 @@ struct MVMNFAStateInfo {
     } arg;
 };
 
+/* A state of the DFA that is built lazily as an NFA is run. It stands for a
+ * set of NFA states that are active at a position, and holds what following
+ * the epsilon edges from them leads to: the fates crossed, and the edges that
+ * consume a character. */
+struct MVMNFADFAState {
+    /* The NFA states, sorted. */
+    MVMuint32        *nfa_states;
+    MVMuint32         num_nfa_states;
+
+    /* Fates crossed, and edges that consume a character, in the order the
+     * NFA simulation would meet them. */
+    MVMuint32         num_fates;
+    MVMint64         *fates;
+    MVMNFAStateInfo **edges;
+    MVMuint32         num_edges;
+
+    /* Transitions on graphemes below MVM_NFA_DFA_TABLE_SIZE, allocated on
+     * first use. next holds the index of the next DFA state plus one, or 0 if
+     * the transition wasn't worked out yet. ll holds the index plus one in the
+     * literal length pool of the fates whose longest literal ends with the
+     * grapheme, or 0 if there are none. */
+    MVMuint32        *next;
+    MVMuint32        *ll;
+
+    /* Hash of the NFA states, and index plus one of the next state in the
+     * same hash bucket. */
+    MVMuint32         hash;
+    MVMuint32         chain;
+};
+
+/* The lazily built DFA of an NFA. Only one thread at a time may use it; any
+ * others run the NFA without caching. */
+struct MVMNFADFA {
+    /* Non-zero if a thread is using the DFA. */
+    AO_t in_use;
+
+    /* The DFA states, and hash buckets of them (holding index plus one). */
+    MVMNFADFAState *states;
+    MVMuint32       num_states;
+    MVMuint32       alloc_states;
+    MVMuint32      *buckets;
+
+    /* Pool of lists of fates whose literal length is updated by a transition;
+     * each list is a count followed by the fates. */
+    MVMint64  *ll_pool;
+    MVMuint32  num_ll;
+    MVMuint32  alloc_ll;
+
+    /* Approximate memory used; when it goes over MVM_NFA_DFA_MAX_MEMORY, the
+     * DFA is thrown away and built up again. */
+    size_t memory;
+};
+
+/* Graphemes below this have transition tables in DFA states. */
+#define MVM_NFA_DFA_TABLE_SIZE 256
+
+/* Hash buckets for DFA states. */
+#define MVM_NFA_DFA_BUCKETS 256
+
+/* Memory a DFA may use before it is thrown away. */
+#define MVM_NFA_DFA_MAX_MEMORY (1024 * 1024)
+
+/* Limits on the graphemes (other than those below 256) that may start a
+ * match and on the literal prefix that we keep for an NFA. */
+#define MVM_NFA_MAX_FIRST_HIGH 256
+#define MVM_NFA_MAX_PREFIX     16
+
 /* Body of an NFA. */
 struct MVMNFABody {
     MVMObject        *fates;
     MVMint64          num_states;
     MVMint64         *num_state_edges;
     MVMNFAStateInfo **states;
+
+    /* DFA built as the NFA is run; NULL until it first is. */
+    MVMNFADFA        *dfa;
+
+    /* What a match must start with, worked out when the NFA is made, so we
+     * can quickly give up on runs that can't match. If first_low is NULL,
+     * we don't know. Otherwise the first grapheme must either be in the
+     * bitmap of those below 256 or in the sorted list of others, and if there
+     * is a prefix, the target must start with all of it. */
+    MVMuint32        *first_low;
+    MVMGrapheme32    *first_high;
+    MVMuint32         num_first_high;
+    MVMGrapheme32    *prefix;
+    MVMuint32         prefix_len;
 };
 
 struct MVMNFA {
@@ -924,6 +924,20 @@ static void serialize_how_lazy(MVMThreadContext *tc, MVMSerializationWriter *wri
     }
 }
 
+/* Serializes the possibly-not-deserialized WHO. */
+static void serialize_who_lazy(MVMThreadContext *tc, MVMSerializationWriter *writer, MVMSTable *st) {
+    if (st->WHO || !st->WHO_sc) {
+        MVM_serialization_write_ref(tc, writer, st->WHO);
+    }
+    else {
+        MVMint32 sc_id = get_sc_id(tc, writer, st->WHO_sc);
+        expand_storage_if_needed(tc, writer, 1);
+        *(*(writer->cur_write_buffer) + *(writer->cur_write_offset)) = REFVAR_OBJECT;
+        ++*(writer->cur_write_offset);
+        write_locate_sc_and_index(tc, writer, sc_id, st->WHO_idx);
+    }
+}
+
 /* Adds an entry to the parameterized type intern section. */
 static void add_param_intern(MVMThreadContext *tc, MVMSerializationWriter *writer,
                              MVMObject *type, MVMObject *ptype, MVMObject *params) {
@@ -1002,7 +1016,7 @@ static void serialize_stable(MVMThreadContext *tc, MVMSerializationWriter *write
     /* Write HOW, WHAT and WHO. */
     serialize_how_lazy(tc, writer, st);
     write_obj_ref(tc, writer, st->WHAT);
-    MVM_serialization_write_ref(tc, writer, st->WHO);
+    serialize_who_lazy(tc, writer, st);
 
     /* Method cache and v-table. */
     if (!st->method_cache)
@@ -2227,6 +2241,7 @@ static void deserialize_context(MVMThreadContext *tc, MVMSerializationReader *re
         locate_sc(tc, reader, static_sc_id), static_idx);
 
     /* Create context. */
+    reader->contexts_done++;
     sf = ((MVMCode *)static_code)->body.sf;
     f  = MVM_frame_create_context_only(tc, sf, static_code);
 
@@ -2303,6 +2318,7 @@ static void deserialize_closure(MVMThreadContext *tc, MVMSerializationReader *re
 
     /* Clone it and add it to the SC's code refs list. */
     MVMObject *closure = MVM_repr_clone(tc, static_code);
+    reader->closures_done++;
     MVM_repr_bind_pos_o(tc, reader->codes_list,
         reader->num_static_codes + i, closure);
 
@@ -2336,6 +2352,25 @@ static void deserialize_how_lazy(MVMThreadContext *tc, MVMSTable *st, MVMSeriali
     MVM_ASSIGN_REF(tc, &(st->header), st->HOW_sc, sc);
 }
 
+/* Reads in what we need to lazily deserialize ->WHO later, provided it is an
+ * object reference; anything else is deserialized right away. The WHO is
+ * usually a stash, and deserializing it means deserializing everything in
+ * it, which is wasted work for the many types whose WHO is never looked at. */
+static void deserialize_who_lazy(MVMThreadContext *tc, MVMSTable *st, MVMSerializationReader *reader) {
+    if (read_discrim(tc, reader) == REFVAR_OBJECT) {
+        MVMSerializationContext *sc;
+        *(reader->cur_read_offset) += 1;
+        sc = read_locate_sc_and_index(tc, reader, (MVMint32 *) &st->WHO_idx);
+        st->WHO = NULL;
+        MVM_ASSIGN_REF(tc, &(st->header), st->WHO_sc, sc);
+        reader->whos_lazy++;
+    }
+    else {
+        st->WHO_sc = NULL;
+        MVM_ASSIGN_REF(tc, &(st->header), st->WHO, MVM_serialization_read_ref(tc, reader));
+    }
+}
+
 /* calculate needed bytes for int, it is a simple version of MVM_serialization_read_int. */
 static MVMuint8 calculate_int_bytes(MVMThreadContext *tc, MVMSerializationReader *reader) {
     const MVMuint8 *read_at = (MVMuint8 *) *(reader->cur_read_buffer) + *(reader->cur_read_offset);
@@ -2467,6 +2502,7 @@ static void deserialize_method_cache_lazy(MVMThreadContext *tc, MVMSTable *st, M
 
         /* If all was valid then just stash what we need for later. */
         if (valid) {
+            reader->method_caches_lazy++;
             st->method_cache = NULL;
             MVM_ASSIGN_REF(tc, &(st->header), st->method_cache_sc, reader->root.sc);
             st->method_cache_offset = before;
@@ -2515,6 +2551,8 @@ static void deserialize_stable(MVMThreadContext *tc, MVMSerializationReader *rea
     MVMuint8 flags;
     MVMuint8 mode;
 
+    reader->stables_done++;
+
     /* Set STable read position, and set current read buffer to the correct thing. */
     reader->stables_data_offset = read_int32(st_table_row, 4);
     reader->cur_read_buffer     = &(reader->root.stables_data);
@@ -2540,7 +2578,7 @@ static void deserialize_stable(MVMThreadContext *tc, MVMSerializationReader *rea
     /* Read the HOW, WHAT and WHO. */
     deserialize_how_lazy(tc, st, reader);
     MVM_ASSIGN_REF(tc, &(st->header), st->WHAT, read_obj_ref(tc, reader));
-    MVM_ASSIGN_REF(tc, &(st->header), st->WHO, MVM_serialization_read_ref(tc, reader));
+    deserialize_who_lazy(tc, st, reader);
 
     /* Method cache. */
     deserialize_method_cache_lazy(tc, st, reader);
@@ -2666,6 +2704,8 @@ static void deserialize_stable(MVMThreadContext *tc, MVMSerializationReader *rea
 
 /* Deserializes a single object. */
 static void deserialize_object(MVMThreadContext *tc, MVMSerializationReader *reader, MVMint32 i, MVMObject *obj) {
+    reader->objects_done++;
+
     /* We've no more to do for type objects. */
     if (IS_CONCRETE(obj)) {
         /* Calculate location of object's table row. */
@@ -2883,6 +2923,7 @@ void MVM_serialization_finish_deserialize_method_cache(MVMThreadContext *tc, MVM
             MVM_gc_allocate_gen2_default_set(tc);
 
             /* Deserialize what we need. */
+            sr->method_caches_done++;
             cache = MVM_serialization_read_ref(tc, sr);
             if (sr->working == 1)
                 work_loop(tc, sr);
@@ -2897,6 +2938,64 @@ void MVM_serialization_finish_deserialize_method_cache(MVMThreadContext *tc, MVM
     }
 }
 
+/* Writes out, for each SC that was deserialized and is still around, how
+ * many of its objects, STables, closures and contexts were ever needed, and
+ * how many of its lazily deserialized method caches and WHOs were; then
+ * closes the file. */
+void MVM_serialization_write_stats(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    FILE        *fh       = instance->deserialize_stats_fh;
+    MVMuint64    totals[12] = { 0 };
+    MVMuint32    i, j;
+    if (!fh)
+        return;
+    instance->deserialize_stats_fh = NULL;
+
+    fprintf(fh, "%-15s %-15s %-15s %-15s %-15s %-15s %s\n", "objects", "stables",
+        "closures", "contexts", "method caches", "whos", "sc");
+    uv_mutex_lock(&instance->mutex_sc_weakhash);
+    for (i = 1; i < instance->all_scs_next_idx; i++) {
+        MVMSerializationContextBody *scb = instance->all_scs[i];
+        MVMSerializationReader      *sr  = scb ? scb->sr : NULL;
+        MVMuint64 counts[12];
+        char *handle, *desc;
+        if (!sr)
+            continue;
+        counts[0]  = sr->objects_done;
+        counts[1]  = sr->root.num_objects;
+        counts[2]  = sr->stables_done;
+        counts[3]  = sr->root.num_stables;
+        counts[4]  = sr->closures_done;
+        counts[5]  = sr->root.num_closures;
+        counts[6]  = sr->contexts_done;
+        counts[7]  = sr->root.num_contexts;
+        counts[8]  = sr->method_caches_done;
+        counts[9]  = sr->method_caches_lazy;
+        counts[10] = (MVMuint64)MVM_load(&sr->whos_done);
+        counts[11] = sr->whos_lazy;
+        for (j = 0; j < 12; j += 2) {
+            char pair[32];
+            snprintf(pair, sizeof(pair), "%"PRIu64"/%"PRIu64, counts[j], counts[j + 1]);
+            fprintf(fh, "%-15s ", pair);
+            totals[j]     += counts[j];
+            totals[j + 1] += counts[j + 1];
+        }
+        handle = scb->handle ? MVM_string_utf8_encode_C_string(tc, scb->handle) : NULL;
+        desc   = scb->description ? MVM_string_utf8_encode_C_string(tc, scb->description) : NULL;
+        fprintf(fh, "%s %s\n", handle ? handle : "<anon>", desc ? desc : "");
+        MVM_free(handle);
+        MVM_free(desc);
+    }
+    uv_mutex_unlock(&instance->mutex_sc_weakhash);
+    for (j = 0; j < 12; j += 2) {
+        char pair[32];
+        snprintf(pair, sizeof(pair), "%"PRIu64"/%"PRIu64, totals[j], totals[j + 1]);
+        fprintf(fh, "%-15s ", pair);
+    }
+    fprintf(fh, "total\n");
+    fclose(fh);
+}
+
 /* Repossess an object or STable. Ignores those not matching the specified
  * type (where 0 = object, 1 = STable). */
 static void repossess(MVMThreadContext *tc, MVMSerializationReader *reader, MVMint64 i,
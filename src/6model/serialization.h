@@ -118,6 +118,20 @@ struct MVMSerializationReader {
      * indicates when it should be. */
     char      *data;
     MVMuint32  data_needs_free;
+
+    /* How many objects, STables, closures and contexts were deserialized,
+     * and how many method caches and WHOs were left to be deserialized
+     * lazily and how many of those were then needed after all. Written out
+     * at exit if MVM_DESERIALIZE_STATS is set. WHOs may be deserialized by
+     * any thread, so that count is updated atomically. */
+    MVMuint32 objects_done;
+    MVMuint32 stables_done;
+    MVMuint32 closures_done;
+    MVMuint32 contexts_done;
+    MVMuint32 method_caches_lazy;
+    MVMuint32 method_caches_done;
+    MVMuint32 whos_lazy;
+    AO_t      whos_done;
 };
 
 /* Represents the serialization writer and the various functions available
@@ -184,6 +198,7 @@ MVMObject * MVM_serialization_demand_object(MVMThreadContext *tc, MVMSerializati
 MVMSTable * MVM_serialization_demand_stable(MVMThreadContext *tc, MVMSerializationContext *sc, MVMint64 idx);
 MVMObject * MVM_serialization_demand_code(MVMThreadContext *tc, MVMSerializationContext *sc, MVMint64 idx);
 void MVM_serialization_finish_deserialize_method_cache(MVMThreadContext *tc, MVMSTable *st);
+void MVM_serialization_write_stats(MVMThreadContext *tc);
 
 /* Reader/writer functions. */
 MVMint64 MVM_serialization_read_int64(MVMThreadContext *tc, MVMSerializationReader *reader);
@@ -379,6 +379,82 @@ MVMArgInfo MVM_args_get_named_uint(MVMThreadContext *tc, MVMArgProcContext *ctx,
     autounbox(tc, MVM_CALLSITE_ARG_INT, "unsigned integer", result);
     return result;
 }
+
+/* Gets a named argument of the kind a param_* op wants. */
+static MVMArgInfo get_named_of_kind(MVMThreadContext *tc, MVMArgProcContext *ctx,
+                                    MVMString *name, MVMCallsiteEntry kind, MVMuint8 required) {
+    switch (kind) {
+        case MVM_CALLSITE_ARG_INT: return MVM_args_get_named_int(tc, ctx, name, required);
+        case MVM_CALLSITE_ARG_NUM: return MVM_args_get_named_num(tc, ctx, name, required);
+        case MVM_CALLSITE_ARG_STR: return MVM_args_get_named_str(tc, ctx, name, required);
+        default:                   return MVM_args_get_named_obj(tc, ctx, name, required);
+    }
+}
+
+/* Does the work of the param_* ops that the JIT has no specialized code for.
+ * The operand is the argument index for positional ops; for named ops, it is
+ * the string heap index of the name, with that of the alternative name (for
+ * the param_*2_* ops) in the upper 32 bits. The value is stored in result if
+ * the argument was passed, and the return value says whether it was; for
+ * required parameters, that is always so. */
+MVMint64 MVM_args_param_for_jit(MVMThreadContext *tc, MVMuint16 op, MVMuint64 operand,
+                                MVMRegister *result) {
+    MVMArgProcContext *ctx = &tc->cur_frame->params;
+    MVMCompUnit       *cu  = tc->cur_frame->static_info->body.cu;
+    MVMArgInfo param;
+    MVMCallsiteEntry kind;
+    MVMuint8 required = MVM_ARG_OPTIONAL;
+    switch (op) {
+        case MVM_OP_param_rp_s:
+            param = MVM_args_get_pos_str(tc, ctx, (MVMuint32)operand, MVM_ARG_REQUIRED);
+            break;
+        case MVM_OP_param_op_i:
+            param = MVM_args_get_optional_pos_int(tc, ctx, (MVMuint32)operand);
+            break;
+        case MVM_OP_param_op_n:
+            param = MVM_args_get_pos_num(tc, ctx, (MVMuint32)operand, MVM_ARG_OPTIONAL);
+            break;
+        case MVM_OP_param_op_s:
+            param = MVM_args_get_pos_str(tc, ctx, (MVMuint32)operand, MVM_ARG_OPTIONAL);
+            break;
+        case MVM_OP_param_op_o:
+            param = MVM_args_get_optional_pos_obj(tc, ctx, (MVMuint32)operand);
+            break;
+        case MVM_OP_param_rn_i: required = MVM_ARG_REQUIRED;
+        case MVM_OP_param_on_i: kind = MVM_CALLSITE_ARG_INT; goto named;
+        case MVM_OP_param_rn_n: required = MVM_ARG_REQUIRED;
+        case MVM_OP_param_on_n: kind = MVM_CALLSITE_ARG_NUM; goto named;
+        case MVM_OP_param_rn_s: required = MVM_ARG_REQUIRED;
+        case MVM_OP_param_on_s: kind = MVM_CALLSITE_ARG_STR; goto named;
+        case MVM_OP_param_rn_o: required = MVM_ARG_REQUIRED;
+        case MVM_OP_param_on_o: kind = MVM_CALLSITE_ARG_OBJ; goto named;
+        named:
+            param = get_named_of_kind(tc, ctx, MVM_cu_string(tc, cu, (MVMuint32)operand),
+                kind, required);
+            break;
+        case MVM_OP_param_rn2_i: required = MVM_ARG_REQUIRED;
+        case MVM_OP_param_on2_i: kind = MVM_CALLSITE_ARG_INT; goto named2;
+        case MVM_OP_param_rn2_n: required = MVM_ARG_REQUIRED;
+        case MVM_OP_param_on2_n: kind = MVM_CALLSITE_ARG_NUM; goto named2;
+        case MVM_OP_param_rn2_s: required = MVM_ARG_REQUIRED;
+        case MVM_OP_param_on2_s: kind = MVM_CALLSITE_ARG_STR; goto named2;
+        case MVM_OP_param_rn2_o: required = MVM_ARG_REQUIRED;
+        case MVM_OP_param_on2_o: kind = MVM_CALLSITE_ARG_OBJ; goto named2;
+        named2:
+            param = get_named_of_kind(tc, ctx, MVM_cu_string(tc, cu, (MVMuint32)operand),
+                kind, MVM_ARG_OPTIONAL);
+            if (!param.exists)
+                param = get_named_of_kind(tc, ctx,
+                    MVM_cu_string(tc, cu, (MVMuint32)(operand >> 32)), kind, required);
+            break;
+        default:
+            MVM_oops(tc, "JIT: no parameter access for op %s", MVM_op_get_op(op)->name);
+    }
+    if (param.exists)
+        *result = param.arg;
+    return param.exists;
+}
+
 MVMint64 MVM_args_has_named(MVMThreadContext *tc, MVMArgProcContext *ctx, MVMString *name) {
     MVMuint32 flag_pos, arg_pos;
     for (flag_pos = arg_pos = ctx->num_pos; arg_pos < ctx->arg_count; flag_pos++, arg_pos += 2)
@@ -797,11 +873,11 @@ static void flatten_args(MVMThreadContext *tc, MVMArgProcContext *ctx) {
 
             if (arg_info.arg.o && REPR(arg_info.arg.o)->ID == MVM_REPR_ID_MVMHash) {
                 MVMHashBody *body = &((MVMHash *)arg_info.arg.o)->body;
-                MVMHashEntry *current, *tmp;
-                unsigned bucket_tmp;
+                MVMHashEntry *current;
+                MVMuint32 idx;
 
-                HASH_ITER(hash_handle, body->hash_head, current, tmp, bucket_tmp) {
-                    MVMString *arg_name = MVM_HASH_KEY(current);
+                MVM_STR_HASH_ITER(tc, &body->hashtable, current, idx) {
+                    MVMString *arg_name = current->key;
                     if (!seen_name(tc, arg_name, new_args, new_num_pos, new_arg_pos)) {
                         if (new_arg_pos + 1 >= new_args_size) {
                             new_args = MVM_realloc(new_args, (new_args_size *= 2) * sizeof(MVMRegister));
@@ -75,6 +75,7 @@ MVMArgInfo MVM_args_get_named_num(MVMThreadContext *tc, MVMArgProcContext *ctx,
 MVMArgInfo MVM_args_get_named_str(MVMThreadContext *tc, MVMArgProcContext *ctx, MVMString *name, MVMuint8 required);
 MVMArgInfo MVM_args_get_named_uint(MVMThreadContext *tc, MVMArgProcContext *ctx, MVMString *name, MVMuint8 required);
 MVMObject * MVM_args_slurpy_named(MVMThreadContext *tc, MVMArgProcContext *ctx);
+MVMint64 MVM_args_param_for_jit(MVMThreadContext *tc, MVMuint16 op, MVMuint64 operand, MVMRegister *result);
 MVMint64 MVM_args_has_named(MVMThreadContext *tc, MVMArgProcContext *ctx, MVMString *name);
 void MVM_args_assert_nameds_used(MVMThreadContext *tc, MVMArgProcContext *ctx);
 
@@ -464,6 +464,17 @@ static MVMStaticFrame ** deserialize_frames(MVMThreadContext *tc, MVMCompUnit *c
         MVMStaticFrame *static_frame;
         MVMStaticFrameBody *static_frame_body;
 
+        /* If we have an image, it tells us where the frame starts. */
+        if (cu->body.frame_offsets) {
+            MVMuint32 offset = cu->body.frame_offsets[i];
+            if (offset < (MVMuint32)(rs->frame_seg - cu->body.data_start)
+                    || (i > 0 && cu->body.data_start + offset < pos)) {
+                cleanup_all(tc, rs);
+                MVM_exception_throw_adhoc(tc, "Frame offset in image out of range");
+            }
+            pos = cu->body.data_start + offset;
+        }
+
         /* Ensure we can read a frame here. */
         ensure_can_read(tc, cu, rs, pos, FRAME_HEADER_SIZE);
 
@@ -530,8 +541,19 @@ static MVMStaticFrame ** deserialize_frames(MVMThreadContext *tc, MVMCompUnit *c
         /* Stash position for lazy deserialization of the rest. */
         static_frame_body->frame_data_pos = pos;
 
-        /* Skip over the rest, making sure it's readable. */
-        {
+        /* Skip over the rest, making sure it's readable. With an image, we
+         * know where the next frame starts, so there's no need to walk the
+         * handlers; just make sure there's at least room for everything. */
+        if (cu->body.frame_offsets) {
+            MVMuint16 slvs = read_int16(pos, 40);
+            pos += FRAME_HEADER_SIZE;
+            ensure_can_read(tc, cu, rs, pos,
+                2 * static_frame_body->num_locals +
+                6 * static_frame_body->num_lexicals +
+                FRAME_HANDLER_SIZE * static_frame_body->num_handlers +
+                FRAME_SLV_SIZE * slvs);
+        }
+        else {
             MVMuint32 skip = 2 * static_frame_body->num_locals +
                              6 * static_frame_body->num_lexicals;
             MVMuint16 slvs = read_int16(pos, 40);
@@ -849,17 +871,22 @@ void MVM_bytecode_unpack(MVMThreadContext *tc, MVMCompUnit *cu) {
     /* Allocate directly in generation 2 so the object is not moving around. */
     MVM_gc_allocate_gen2_default_set(tc);
 
-    /* Dissect the bytecode into its parts. */
+    /* Dissect the bytecode into its parts, and make sure any image we have
+     * goes with it. */
     rs = dissect_bytecode(tc, cu);
+    MVM_cu_check_image(tc, cu, rs->expected_strings, rs->expected_frames);
 
-    /* Allocate space for the strings heap; we deserialize it lazily. */
+    /* Allocate space for the strings heap; we deserialize it lazily. Unless
+     * the image tells us where each string is, we'll need a table to find
+     * them quickly. */
     cu_body->strings = MVM_fixed_size_alloc_zeroed(tc, tc->instance->fsa,
         rs->expected_strings * sizeof(MVMString *));
     cu_body->num_strings = rs->expected_strings;
     cu_body->orig_strings = rs->expected_strings;
-    cu_body->string_heap_fast_table = MVM_calloc(
-        (rs->expected_strings / MVM_STRING_FAST_TABLE_SPAN) + 1,
-        sizeof(MVMuint32));
+    if (!cu_body->string_heap_offsets)
+        cu_body->string_heap_fast_table = MVM_calloc(
+            (rs->expected_strings / MVM_STRING_FAST_TABLE_SPAN) + 1,
+            sizeof(MVMuint32));
     cu_body->string_heap_start = rs->string_seg;
     cu_body->string_heap_read_limit = rs->read_limit;
 
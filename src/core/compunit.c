@@ -1,13 +1,217 @@
 #include "moar.h"
 #include "platform/mmap.h"
+#include <sha1.h>
 
 #ifdef _WIN32
 #include <fcntl.h>
 #define O_RDONLY _O_RDONLY
 #endif
 
-/* Creates a compilation unit from a byte array. */
-MVMCompUnit * MVM_cu_from_bytes(MVMThreadContext *tc, MVMuint8 *bytes, MVMuint32 size) {
+/* Reads an uint32 from the string heap. */
+static MVMuint32 read_uint32(MVMuint8 *src) {
+#ifdef MVM_BIGENDIAN
+    MVMuint32 value;
+    size_t i;
+    MVMuint8 *destbytes = (MVMuint8 *)&value;
+    for (i = 0; i < 4; i++)
+         destbytes[4 - i - 1] = src[i];
+    return value;
+#else
+    return *((MVMuint32 *)src);
+#endif
+}
+
+/* Loading a compilation unit means finding where each of its strings and
+ * frames start, which involves walking through the string heap and the frames
+ * segment. If MVM_CU_IMAGE_DIR is set, then after a bytecode file has been
+ * loaded, an image holding those offsets is written to that directory, and
+ * later loads of the same file map it (read only, so it is shared by all the
+ * processes using it) and look the offsets up directly. Only the offsets are
+ * kept: the strings, static frames, code objects and callsites themselves are
+ * garbage collected or interned per process, so they are still made on load
+ * (strings lazily).
+ *
+ * An image is named after the SHA-1 of the resolved path of the bytecode file
+ * and the offset of the bytecode within it, and only used if it was written
+ * by the same MoarVM version for the same file (by device and inode) of the
+ * same size, modification time and bytecode header. */
+#define IMAGE_MAGIC         "MOARIMG\n"
+#define IMAGE_VERSION_SIZE  32
+#define IMAGE_BC_HEADER     92
+#define IMAGE_BYTE_ORDER    0x01020304
+typedef struct {
+    char      magic[8];
+    char      version[IMAGE_VERSION_SIZE];
+    MVMuint64 device;
+    MVMuint64 inode;
+    MVMuint64 offset;
+    MVMuint64 bytecode_size;
+    MVMint64  mtime_sec;
+    MVMint64  mtime_nsec;
+    MVMuint32 byte_order;
+    MVMuint32 num_strings;
+    MVMuint32 num_frames;
+    MVMuint8  bytecode_header[IMAGE_BC_HEADER];
+} ImageHeader;
+
+/* A mapped image, before it is handed to the compilation unit. */
+typedef struct {
+    void      *block;
+    void      *handle;
+    MVMuint32  size;
+} LoadedImage;
+
+/* Forms the name of the image file for bytecode at an offset in a file.
+ * Returns NULL if the path can't be resolved. */
+static char * image_filename(MVMThreadContext *tc, const char *filename, MVMuint64 offset) {
+    const char *dir = tc->instance->cu_image_dir;
+    char sha1[SHA1_DIGEST_SIZE * 2 + 1];
+    char offset_str[24];
+    char *name;
+    SHA1Context context;
+    uv_fs_t req;
+
+    if (uv_fs_realpath(tc->loop, &req, filename, NULL) < 0) {
+        uv_fs_req_cleanup(&req);
+        return NULL;
+    }
+    snprintf(offset_str, sizeof(offset_str), "@%"PRIu64, offset);
+    SHA1Init(&context);
+    SHA1Update(&context, (const unsigned char *)req.ptr, strlen((char *)req.ptr));
+    SHA1Update(&context, (const unsigned char *)offset_str, strlen(offset_str));
+    SHA1Final(&context, sha1);
+    uv_fs_req_cleanup(&req);
+
+    name = MVM_malloc(strlen(dir) + sizeof(sha1) + 10);
+    sprintf(name, "%s/%s.moarimg", dir, sha1);
+    return name;
+}
+
+/* Fills out an image header for bytecode at an offset in a file. */
+static void form_image_header(ImageHeader *header, uv_stat_t *statbuf, MVMuint64 offset,
+                              MVMuint8 *bytes) {
+    memset(header, 0, sizeof(ImageHeader));
+    memcpy(header->magic, IMAGE_MAGIC, 8);
+    strncpy(header->version, MVM_VERSION, IMAGE_VERSION_SIZE - 1);
+    header->device        = statbuf->st_dev;
+    header->inode         = statbuf->st_ino;
+    header->offset        = offset;
+    header->bytecode_size = statbuf->st_size;
+    header->mtime_sec     = statbuf->st_mtim.tv_sec;
+    header->mtime_nsec    = statbuf->st_mtim.tv_nsec;
+    header->byte_order    = IMAGE_BYTE_ORDER;
+    memcpy(header->bytecode_header, bytes, IMAGE_BC_HEADER);
+}
+
+/* Maps the image for bytecode at an offset in a file, if there is one that
+ * matches it. Returns zero if there is none. */
+static MVMint32 map_image(MVMThreadContext *tc, const char *image_name, uv_stat_t *statbuf,
+                          MVMuint64 offset, MVMuint8 *bytes, LoadedImage *image) {
+    ImageHeader  expected, *found;
+    uv_fs_t      req;
+    uv_file      fd;
+    MVMuint64    size;
+
+    if (uv_fs_stat(tc->loop, &req, image_name, NULL) < 0)
+        return 0;
+    size = req.statbuf.st_size;
+    if (size < sizeof(ImageHeader) || size > 0xFFFFFFFF)
+        return 0;
+    if ((fd = uv_fs_open(tc->loop, &req, image_name, O_RDONLY, 0, NULL)) < 0)
+        return 0;
+    image->block = MVM_platform_map_file(fd, &(image->handle), (size_t)size, 0);
+    uv_fs_close(tc->loop, &req, fd, NULL);
+    if (!image->block)
+        return 0;
+    image->size = (MVMuint32)size;
+
+    /* Make sure it's for this very bytecode file, and has all the offsets. */
+    form_image_header(&expected, statbuf, offset, bytes);
+    found = (ImageHeader *)image->block;
+    if (memcmp(found, &expected, offsetof(ImageHeader, num_strings)) != 0
+            || memcmp(found->bytecode_header, expected.bytecode_header, IMAGE_BC_HEADER) != 0
+            || size != sizeof(ImageHeader) +
+                ((MVMuint64)found->num_strings + found->num_frames) * sizeof(MVMuint32)) {
+        MVM_platform_unmap_file(image->block, image->handle, image->size);
+        return 0;
+    }
+    return 1;
+}
+
+/* Writes an image for a compilation unit that was just loaded from a file.
+ * It is written under a temporary name and then renamed, so that processes
+ * loading the same file at the same time never see a partial image. Any
+ * failure just means there is no image next time. */
+static void write_image(MVMThreadContext *tc, MVMCompUnit *cu, const char *image_name,
+                        uv_stat_t *statbuf, MVMuint64 offset) {
+    MVMCompUnitBody *body        = &cu->body;
+    MVMuint32        num_strings = body->orig_strings;
+    MVMuint32        num_frames  = body->orig_frames;
+    MVMuint32       *offsets;
+    MVMuint8        *cur_pos     = body->string_heap_start;
+    MVMuint8        *limit       = body->string_heap_read_limit;
+    ImageHeader      header;
+    MVMuint32        i;
+    uv_fs_t          req;
+    char            *temp_name;
+    FILE            *fh;
+    size_t           written;
+
+    /* Find where each string and frame starts. */
+    offsets = MVM_malloc((num_strings + num_frames + 1) * sizeof(MVMuint32));
+    for (i = 0; i < num_strings; i++) {
+        MVMuint32 bytes;
+        if (cur_pos + 4 >= limit) {
+            MVM_free(offsets);
+            return;
+        }
+        offsets[i] = (MVMuint32)(cur_pos - body->string_heap_start);
+        bytes = read_uint32(cur_pos) >> 1;
+        cur_pos += 4 + bytes + (bytes & 3 ? 4 - (bytes & 3) : 0);
+    }
+    for (i = 0; i < num_frames; i++) {
+        MVMStaticFrame *sf = ((MVMCode *)body->coderefs[i])->body.sf;
+        offsets[num_strings + i] = (MVMuint32)(sf->body.frame_data_pos - body->data_start);
+    }
+
+    /* Write it out. */
+    form_image_header(&header, statbuf, offset, body->data_start);
+    header.num_strings = num_strings;
+    header.num_frames  = num_frames;
+    temp_name = MVM_malloc(strlen(image_name) + 32);
+    sprintf(temp_name, "%s.%"PRId64".tmp", image_name, MVM_proc_getpid(tc));
+    fh = fopen(temp_name, "wb");
+    if (fh) {
+        written = fwrite(&header, sizeof(ImageHeader), 1, fh);
+        if (num_strings + num_frames)
+            written += fwrite(offsets, (num_strings + num_frames) * sizeof(MVMuint32), 1, fh);
+        else
+            written++;
+        if (fclose(fh) == 0 && written == 2)
+            if (uv_fs_rename(tc->loop, &req, temp_name, image_name, NULL) >= 0)
+                fh = NULL;
+        if (fh)
+            uv_fs_unlink(tc->loop, &req, temp_name, NULL);
+    }
+    MVM_free(temp_name);
+    MVM_free(offsets);
+}
+
+/* Called once the bytecode has been dissected, to make sure the image really
+ * has offsets for all the strings and frames; if not, it goes unused. */
+void MVM_cu_check_image(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 num_strings,
+                        MVMuint32 num_frames) {
+    ImageHeader *header = (ImageHeader *)cu->body.image;
+    if (header && (header->num_strings != num_strings || header->num_frames != num_frames)) {
+        cu->body.string_heap_offsets = NULL;
+        cu->body.frame_offsets       = NULL;
+    }
+}
+
+/* Creates a compilation unit from a byte array, along with its image if it
+ * has one. */
+static MVMCompUnit * from_bytes(MVMThreadContext *tc, MVMuint8 *bytes, MVMuint32 size,
+                                LoadedImage *image) {
     /* Create compilation unit data structure. Allocate it in gen2 always, so
      * it will never move (the JIT relies on this). */
     MVMCompUnit *cu;
@@ -15,6 +219,14 @@ MVMCompUnit * MVM_cu_from_bytes(MVMThreadContext *tc, MVMuint8 *bytes, MVMuint32
     cu = (MVMCompUnit *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTCompUnit);
     cu->body.data_start = bytes;
     cu->body.data_size  = size;
+    if (image) {
+        ImageHeader *header = (ImageHeader *)image->block;
+        cu->body.image               = image->block;
+        cu->body.image_handle        = image->handle;
+        cu->body.image_size          = image->size;
+        cu->body.string_heap_offsets = (MVMuint32 *)(header + 1);
+        cu->body.frame_offsets       = cu->body.string_heap_offsets + header->num_strings;
+    }
     MVM_gc_allocate_gen2_default_clear(tc);
 
     /* Process the input. */
@@ -30,6 +242,39 @@ MVMCompUnit * MVM_cu_from_bytes(MVMThreadContext *tc, MVMuint8 *bytes, MVMuint32
     return cu;
 }
 
+/* Creates a compilation unit from a byte array. */
+MVMCompUnit * MVM_cu_from_bytes(MVMThreadContext *tc, MVMuint8 *bytes, MVMuint32 size) {
+    return from_bytes(tc, bytes, size, NULL);
+}
+
+/* Creates a compilation unit from bytecode mapped from an offset in a file,
+ * using its image if we keep those and there is one, and writing one for it
+ * if there is not. */
+static MVMCompUnit * from_file_bytes(MVMThreadContext *tc, MVMuint8 *bytes, MVMuint32 size,
+                                     const char *filename, uv_stat_t *statbuf, MVMuint64 offset) {
+    MVMCompUnit *cu;
+    char        *image_name = NULL;
+    LoadedImage  image;
+    MVMint32     have_image = 0;
+
+    if (tc->instance->cu_image_dir && filename && size >= IMAGE_BC_HEADER) {
+        image_name = image_filename(tc, filename, offset);
+        if (image_name)
+            have_image = map_image(tc, image_name, statbuf, offset, bytes, &image);
+    }
+
+    cu = from_bytes(tc, bytes, size, have_image ? &image : NULL);
+    if (image_name) {
+        if (!have_image) {
+            MVMROOT(tc, cu, {
+                write_image(tc, cu, image_name, statbuf, offset);
+            });
+        }
+        MVM_free(image_name);
+    }
+    return cu;
+}
+
 /* Loads a compilation unit from a bytecode file, mapping it into memory. */
 MVMCompUnit * MVM_cu_map_from_file(MVMThreadContext *tc, const char *filename) {
     MVMCompUnit *cu          = NULL;
@@ -38,13 +283,15 @@ MVMCompUnit * MVM_cu_map_from_file(MVMThreadContext *tc, const char *filename) {
     uv_file      fd;
     MVMuint64    size;
     uv_fs_t req;
+    uv_stat_t    statbuf;
 
     /* Ensure the file exists, and get its size. */
     if (uv_fs_stat(tc->loop, &req, filename, NULL) < 0) {
         MVM_exception_throw_adhoc(tc, "While looking for '%s': %s", filename, uv_strerror(req.result));
     }
 
-    size = req.statbuf.st_size;
+    statbuf = req.statbuf;
+    size = statbuf.st_size;
 
     /* Map the bytecode file into memory. */
     if ((fd = uv_fs_open(tc->loop, &req, filename, O_RDONLY, 0, NULL)) < 0) {
@@ -61,26 +308,30 @@ MVMCompUnit * MVM_cu_map_from_file(MVMThreadContext *tc, const char *filename) {
     }
 
     /* Turn it into a compilation unit. */
-    cu = MVM_cu_from_bytes(tc, (MVMuint8 *)block, (MVMuint32)size);
+    cu = from_file_bytes(tc, (MVMuint8 *)block, (MVMuint32)size, filename, &statbuf, 0);
     cu->body.handle = handle;
     cu->body.deallocate = MVM_DEALLOCATE_UNMAP;
     return cu;
 }
 
-/* Loads a compilation unit from a bytecode file handle, mapping it into memory. */
-MVMCompUnit * MVM_cu_map_from_file_handle(MVMThreadContext *tc, uv_file fd, MVMuint64 pos) {
+/* Loads a compilation unit from a bytecode file handle, mapping it into
+ * memory. The file name, if given, is only used to find its image. */
+MVMCompUnit * MVM_cu_map_from_file_handle(MVMThreadContext *tc, uv_file fd, MVMuint64 pos,
+                                          const char *filename) {
     MVMCompUnit *cu          = NULL;
     void        *block       = NULL;
     void        *handle      = NULL;
     MVMuint64    size;
     uv_fs_t req;
+    uv_stat_t    statbuf;
 
     /* Ensure the file exists, and get its size. */
     if (uv_fs_fstat(tc->loop, &req, fd, NULL) < 0) {
         MVM_exception_throw_adhoc(tc, "Trying to stat: %s", uv_strerror(req.result));
     }
 
-    size = req.statbuf.st_size;
+    statbuf = req.statbuf;
+    size = statbuf.st_size;
 
     if ((block = MVM_platform_map_file(fd, &handle, (size_t)size, 0)) == NULL) {
         /* FIXME: check errno or GetLastError() */
@@ -90,7 +341,7 @@ MVMCompUnit * MVM_cu_map_from_file_handle(MVMThreadContext *tc, uv_file fd, MVMu
     block = ((char*)block) + pos;
 
     /* Turn it into a compilation unit. */
-    cu = MVM_cu_from_bytes(tc, (MVMuint8 *)block, (MVMuint32)size);
+    cu = from_file_bytes(tc, (MVMuint8 *)block, (MVMuint32)(size - pos), filename, &statbuf, pos);
     cu->body.handle = handle;
     cu->body.deallocate = MVM_DEALLOCATE_UNMAP;
     return cu;
@@ -165,18 +416,6 @@ MVMuint32 MVM_cu_string_add(MVMThreadContext *tc, MVMCompUnit *cu, MVMString *st
 
 /* Used when we try to read a string from the string heap, but it's not there.
  * Decodes it "on-demand" and stores it in the string heap. */
-static MVMuint32 read_uint32(MVMuint8 *src) {
-#ifdef MVM_BIGENDIAN
-    MVMuint32 value;
-    size_t i;
-    MVMuint8 *destbytes = (MVMuint8 *)&value;
-    for (i = 0; i < 4; i++)
-         destbytes[4 - i - 1] = src[i];
-    return value;
-#else
-    return *((MVMuint32 *)src);
-#endif
-}
 static void compute_fast_table_upto(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint32 end_bin) {
     MVMuint32  cur_bin = cu->body.string_heap_fast_table_top;
     MVMuint8  *cur_pos = cu->body.string_heap_start + cu->body.string_heap_fast_table[cur_bin];
@@ -204,16 +443,23 @@ MVMString * MVM_cu_obtain_string(MVMThreadContext *tc, MVMCompUnit *cu, MVMuint3
     MVMuint32  cur_idx;
     MVMuint8  *cur_pos;
     MVMuint8  *limit = cu->body.string_heap_read_limit;
+    MVMuint32  fast_bin;
 
-    /* Make sure we've enough entries in the fast table to jump close to where
-     * the string will be. */
-    MVMuint32 fast_bin = idx / MVM_STRING_FAST_TABLE_SPAN;
-    if (fast_bin > cu->body.string_heap_fast_table_top)
-        compute_fast_table_upto(tc, cu, fast_bin);
+    /* If we have an image, it tells us right where the string is. */
+    if (cu->body.string_heap_offsets) {
+        cur_idx = idx;
+        cur_pos = cu->body.string_heap_start + cu->body.string_heap_offsets[idx];
+    }
 
-    /* Scan from that position to find the string we need. */
-    cur_idx = fast_bin * MVM_STRING_FAST_TABLE_SPAN;
-    cur_pos = cu->body.string_heap_start + cu->body.string_heap_fast_table[fast_bin];
+    /* Otherwise, make sure we've enough entries in the fast table to jump
+     * close to where the string will be, and scan from there. */
+    else {
+        fast_bin = idx / MVM_STRING_FAST_TABLE_SPAN;
+        if (fast_bin > cu->body.string_heap_fast_table_top)
+            compute_fast_table_upto(tc, cu, fast_bin);
+        cur_idx = fast_bin * MVM_STRING_FAST_TABLE_SPAN;
+        cur_pos = cu->body.string_heap_start + cu->body.string_heap_fast_table[fast_bin];
+    }
     while (cur_idx != idx) {
         if (cur_pos + 4 < limit) {
             MVMuint32 bytes = read_uint32(cur_pos) >> 1;
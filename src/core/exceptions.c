@@ -636,6 +636,31 @@ void MVM_exception_throwpayload(MVMThreadContext *tc, MVMuint8 mode, MVMuint32 c
     run_handler(tc, lh, NULL, cat, payload);
 }
 
+/* Checks an object is a VM exception, for the ops that access one. */
+static MVMException * get_exception(MVMThreadContext *tc, MVMObject *ex_obj, const char *op) {
+    if (IS_CONCRETE(ex_obj) && REPR(ex_obj)->ID == MVM_REPR_ID_MVMException)
+        return (MVMException *)ex_obj;
+    MVM_exception_throw_adhoc(tc, "%s needs a VMException, got %s (%s)", op,
+        REPR(ex_obj)->name, STABLE(ex_obj)->debug_name);
+}
+
+MVMString * MVM_exception_get_message(MVMThreadContext *tc, MVMObject *ex_obj) {
+    return get_exception(tc, ex_obj, "getexmessage")->body.message;
+}
+
+MVMObject * MVM_exception_get_payload(MVMThreadContext *tc, MVMObject *ex_obj) {
+    MVMObject *payload = get_exception(tc, ex_obj, "getexpayload")->body.payload;
+    return payload ? payload : tc->instance->VMNull;
+}
+
+MVMint64 MVM_exception_get_category(MVMThreadContext *tc, MVMObject *ex_obj) {
+    return get_exception(tc, ex_obj, "getexcategory")->body.category;
+}
+
+void MVM_exception_bind_category(MVMThreadContext *tc, MVMObject *ex_obj, MVMint64 category) {
+    get_exception(tc, ex_obj, "bindexcategory")->body.category = category;
+}
+
 void MVM_exception_resume(MVMThreadContext *tc, MVMObject *ex_obj) {
     MVMException     *ex;
     MVMFrame         *target;
@@ -806,9 +831,10 @@ void MVM_exception_throw_adhoc_free_va(MVMThreadContext *tc, char **waste, const
     run_handler(tc, lh, (MVMObject *)ex, MVM_EX_CAT_CATCH, NULL);
 
     /* Clear any C stack temporaries that code may have pushed before throwing
-     * the exception, and release any needed mutex. */
+     * the exception, and release any needed mutex or flag. */
     MVM_gc_root_temp_pop_all(tc);
     MVM_tc_release_ex_release_mutex(tc);
+    MVM_tc_release_ex_release_flag(tc);
 
     /* Jump back into the interpreter. */
     longjmp(tc->interp_jump, 1);
@@ -83,6 +83,10 @@ void MVM_exception_throwcat(MVMThreadContext *tc, MVMuint8 mode, MVMuint32 cat,
 void MVM_exception_die(MVMThreadContext *tc, MVMString *str, MVMRegister *rr);
 void MVM_exception_throwobj(MVMThreadContext *tc, MVMuint8 mode, MVMObject *exObj, MVMRegister *resume_result);
 void MVM_exception_throwpayload(MVMThreadContext *tc, MVMuint8 mode, MVMuint32 cat, MVMObject *payload, MVMRegister *resume_result);
+MVMString * MVM_exception_get_message(MVMThreadContext *tc, MVMObject *ex_obj);
+MVMObject * MVM_exception_get_payload(MVMThreadContext *tc, MVMObject *ex_obj);
+MVMint64 MVM_exception_get_category(MVMThreadContext *tc, MVMObject *ex_obj);
+void MVM_exception_bind_category(MVMThreadContext *tc, MVMObject *ex_obj, MVMint64 category);
 void MVM_exception_resume(MVMThreadContext *tc, MVMObject *exObj);
 MVM_PUBLIC MVM_NO_RETURN void MVM_panic_allocation_failed(size_t len) MVM_NO_RETURN_GCC;
 MVM_PUBLIC MVM_NO_RETURN void MVM_panic(MVMint32 exitCode, const char *messageFormat, ...) MVM_NO_RETURN_GCC MVM_FORMAT(printf, 2, 3);
@@ -3,11 +3,13 @@
 #include "memdebug.h"
 
 /* The fixed size allocator provides a thread-safe mechanism for getting and
- * releasing fixed-size chunks of memory. Requests larger blocks from the
- * operating system, and then allocates out of them. Can certainly be further
- * improved. The free list works like a stack, so you get the most recently
- * freed piece of memory of a given size, which should give good cache
- * behavior. */
+ * releasing fixed-size chunks of memory. Each thread has pages of its own
+ * for each size class, carved out of larger blocks requested from the
+ * operating system, so that allocating and freeing on one thread needs no
+ * locks or atomic operations; only memory freed by a thread other than the
+ * one that owns it is handed back through an atomic list. The free list
+ * works like a stack, so you get the most recently freed piece of memory of
+ * a given size, which should give good cache behavior. */
 
 /* Turn this on to switch to a mode where we debug by size. */
 #define FSA_SIZE_DEBUG 0
@@ -18,7 +20,15 @@ typedef struct {
 } MVMFixedSizeAllocDebug;
 #endif
 
-/* Creates the allocator data structure with bins. */
+/* Makes a new, empty, per-thread allocator. */
+static MVMFixedSizeAllocThread * new_thread_allocator(void) {
+    MVMFixedSizeAllocThread *al = MVM_calloc(1, sizeof(MVMFixedSizeAllocThread));
+    al->size_classes = MVM_calloc(MVM_FSA_BINS, sizeof(MVMFixedSizeAllocThreadSizeClass));
+    return al;
+}
+
+/* Creates the allocator data structure with bins. The thread creating it
+ * already has its own allocator, which goes into the list of them. */
 MVMFixedSizeAlloc * MVM_fixed_size_create(MVMThreadContext *tc) {
     int init_stat;
 #ifdef MVM_VALGRIND_SUPPORT
@@ -26,11 +36,12 @@ MVMFixedSizeAlloc * MVM_fixed_size_create(MVMThreadContext *tc) {
 #endif
     MVMFixedSizeAlloc *al = MVM_malloc(sizeof(MVMFixedSizeAlloc));
     al->size_classes = MVM_calloc(MVM_FSA_BINS, sizeof(MVMFixedSizeAllocSizeClass));
-    if ((init_stat = uv_mutex_init(&(al->complex_alloc_mutex))) < 0)
+    if ((init_stat = uv_mutex_init(&(al->threads_mutex))) < 0)
         MVM_exception_throw_adhoc(tc, "Failed to initialize mutex: %s",
             uv_strerror(init_stat));
-    al->freelist_spin = 0;
+    al->threads = tc->thread_fsa;
     al->free_at_next_safepoint_overflows = NULL;
+    al->stats_fh = NULL;
 
     /* All other places where we use valgrind macros are very likely
      * thrown out by dead code elimination. Not 100% sure about this,
@@ -43,30 +54,56 @@ MVMFixedSizeAlloc * MVM_fixed_size_create(MVMThreadContext *tc) {
     return al;
 }
 
-/* Creates the per-thread fixed size allocator state. */
+/* Creates the per-thread fixed size allocator state, taking over that of a
+ * thread that ended if there is one. (The main thread is created before the
+ * global allocator, and is added to it when that is created.) */
 void MVM_fixed_size_create_thread(MVMThreadContext *tc) {
-    MVMFixedSizeAllocThread *al = MVM_malloc(sizeof(MVMFixedSizeAllocThread));
-    al->size_classes = MVM_calloc(MVM_FSA_BINS, sizeof(MVMFixedSizeAllocThreadSizeClass));
+    MVMFixedSizeAlloc       *fsa = tc->instance->fsa;
+    MVMFixedSizeAllocThread *al  = NULL;
+    if (fsa) {
+        uv_mutex_lock(&(fsa->threads_mutex));
+        for (al = fsa->threads; al; al = al->next)
+            if (!al->tc)
+                break;
+        if (!al) {
+            al = new_thread_allocator();
+            al->next = fsa->threads;
+            fsa->threads = al;
+        }
+        al->tc = tc;
+        uv_mutex_unlock(&(fsa->threads_mutex));
+    }
+    else {
+        al = new_thread_allocator();
+        al->tc = tc;
+    }
     tc->thread_fsa = al;
 }
 
 /* Destroys the global fixed size allocator data structure and all of
- * the memory held within it. */
+ * the memory held within it, including that of all threads. */
 void MVM_fixed_size_destroy(MVMFixedSizeAlloc *al) {
+    MVMFixedSizeAllocThread *thread_al = al->threads;
     int bin_no;
 
-    for (bin_no = 0; bin_no < MVM_FSA_BINS; bin_no++) {
-        int page_no;
-        int num_pages = al->size_classes[bin_no].num_pages;
+    while (thread_al) {
+        MVMFixedSizeAllocThread *next = thread_al->next;
+        MVMuint32 block_no;
+        if (thread_al->tc)
+            thread_al->tc->thread_fsa = NULL;
+        for (block_no = 0; block_no < thread_al->num_blocks; block_no++)
+            MVM_free(thread_al->blocks[block_no]);
+        MVM_free(thread_al->blocks);
+        MVM_free(thread_al->size_classes);
+        MVM_free(thread_al);
+        thread_al = next;
+    }
 
+    for (bin_no = 0; bin_no < MVM_FSA_BINS; bin_no++)
         VALGRIND_DESTROY_MEMPOOL(&al->size_classes[bin_no]);
-
-        for (page_no = 0; page_no < num_pages; page_no++) {
-            MVM_free(al->size_classes[bin_no].pages[page_no]);
-        }
-        MVM_free(al->size_classes[bin_no].pages);
-    }
-    uv_mutex_destroy(&(al->complex_alloc_mutex));
+    uv_mutex_destroy(&(al->threads_mutex));
+    if (al->stats_fh)
+        fclose(al->stats_fh);
 
     MVM_free(al->size_classes);
     MVM_free(al);
@@ -82,97 +119,74 @@ static MVMuint32 bin_for(size_t bytes) {
     return bin;
 }
 
-/* Sets up a size class bin in the second generation. */
-static void setup_bin(MVMFixedSizeAlloc *al, MVMuint32 bin) {
-    /* Work out page size we want. */
-    MVMuint32 page_size = MVM_FSA_PAGE_ITEMS * ((bin + 1) << MVM_FSA_BIN_BITS) + MVM_FSA_REDZONE_BYTES * 2 * MVM_FSA_PAGE_ITEMS;
-
-    /* We'll just allocate a single page to start off with. */
-    al->size_classes[bin].num_pages = 1;
-    al->size_classes[bin].pages     = MVM_malloc(sizeof(void *) * al->size_classes[bin].num_pages);
-    al->size_classes[bin].pages[0]  = MVM_malloc(page_size);
-
-    /* Set up allocation position and limit. */
-    al->size_classes[bin].alloc_pos = al->size_classes[bin].pages[0];
-    al->size_classes[bin].alloc_limit = al->size_classes[bin].alloc_pos + page_size;
+/* Finds the page that a piece of memory from the FSA is in. */
+static MVMFixedSizeAllocPage * page_of(void *ptr) {
+    return (MVMFixedSizeAllocPage *)((uintptr_t)ptr & ~(uintptr_t)(MVM_FSA_PAGE_SIZE - 1));
 }
 
-/* Adds a new page to a size class bin. */
-static void add_page(MVMFixedSizeAlloc *al, MVMuint32 bin) {
-    /* Work out page size. */
-    MVMuint32 page_size = MVM_FSA_PAGE_ITEMS * ((bin + 1) << MVM_FSA_BIN_BITS) + MVM_FSA_REDZONE_BYTES * 2 * MVM_FSA_PAGE_ITEMS;
-
-    /* Add the extra page. */
-    MVMuint32 cur_page = al->size_classes[bin].num_pages;
-    al->size_classes[bin].num_pages++;
-    al->size_classes[bin].pages = MVM_realloc(al->size_classes[bin].pages,
-        sizeof(void *) * al->size_classes[bin].num_pages);
-    al->size_classes[bin].pages[cur_page] = MVM_malloc(page_size);
+/* Starts a new page for a size class of a thread's allocator, taking it from
+ * the current block, or from a new block if that one is used up. Blocks get
+ * one page extra, so that they have room for the wanted number of pages
+ * aligned to the page size. */
+static void add_page(MVMFixedSizeAllocThread *al, MVMuint32 bin) {
+    MVMFixedSizeAllocThreadSizeClass *bin_ptr = &(al->size_classes[bin]);
+    MVMFixedSizeAllocPage            *page;
+
+    if (!al->pages_left) {
+        char *block = MVM_malloc((MVM_FSA_BLOCK_PAGES + 1) * MVM_FSA_PAGE_SIZE);
+        if (al->num_blocks == al->alloc_blocks) {
+            al->alloc_blocks = al->alloc_blocks ? al->alloc_blocks * 2 : 4;
+            al->blocks = MVM_realloc(al->blocks, al->alloc_blocks * sizeof(char *));
+        }
+        al->blocks[al->num_blocks++] = block;
+        al->next_page  = (char *)page_of(block + MVM_FSA_PAGE_SIZE - 1);
+        al->pages_left = MVM_FSA_BLOCK_PAGES;
+    }
 
-    /* Set up allocation position and limit. */
-    al->size_classes[bin].alloc_pos = al->size_classes[bin].pages[cur_page];
-    al->size_classes[bin].alloc_limit = al->size_classes[bin].alloc_pos + page_size;
+    page = (MVMFixedSizeAllocPage *)al->next_page;
+    page->owner = al;
+    page->bin   = bin;
+    al->next_page += MVM_FSA_PAGE_SIZE;
+    al->pages_left--;
 
-    /* set the cur_page to a proper value */
-    al->size_classes[bin].cur_page = cur_page;
+    bin_ptr->alloc_pos   = (char *)page + MVM_FSA_PAGE_START;
+    bin_ptr->alloc_limit = (char *)page + MVM_FSA_PAGE_SIZE;
+    bin_ptr->num_pages++;
 }
 
-/* Allocates a piece of memory of the specified size, using the FSA. */
-static void * alloc_slow_path(MVMThreadContext *tc, MVMFixedSizeAlloc *al, MVMuint32 bin) {
-    void *result;
-
-    /* Lock. */
-    uv_mutex_lock(&(al->complex_alloc_mutex));
-
-    /* If we've no pages yet, never encountered this bin; set it up. */
-    if (al->size_classes[bin].pages == NULL)
-        setup_bin(al, bin);
+/* Allocates a piece of memory when the thread's free list for the bin is
+ * empty: first by taking over what other threads freed, and otherwise from
+ * the current page. */
+static void * alloc_slow_path(MVMThreadContext *tc, MVMFixedSizeAllocThread *al, MVMuint32 bin) {
+    MVMFixedSizeAllocThreadSizeClass *bin_ptr   = &(al->size_classes[bin]);
+    MVMuint32                         item_size = ((bin + 1) << MVM_FSA_BIN_BITS) + 2 * MVM_FSA_REDZONE_BYTES;
+    MVMFixedSizeAllocFreeListEntry   *fle;
+    void                             *result;
+
+    /* Take the whole remote free list; as nobody else ever takes from it,
+     * there's no ABA issue. */
+    do {
+        fle = bin_ptr->remote_free_list;
+    } while (fle && !MVM_trycas(&(bin_ptr->remote_free_list), fle, NULL));
+    if (fle) {
+        bin_ptr->free_list = fle->next;
+        bin_ptr->allocs++;
+        return (void *)fle;
+    }
 
-    /* If we're at the page limit, add a new page. */
-    if (al->size_classes[bin].alloc_pos == al->size_classes[bin].alloc_limit) {
+    /* If we've no page yet, or it is full, start a new one. */
+    if (!bin_ptr->alloc_pos || bin_ptr->alloc_pos + item_size > bin_ptr->alloc_limit)
         add_page(al, bin);
-    }
 
     /* Now we can allocate. */
-    result = (void *)(al->size_classes[bin].alloc_pos + MVM_FSA_REDZONE_BYTES);
-    al->size_classes[bin].alloc_pos += ((bin + 1) << MVM_FSA_BIN_BITS) + 2 * MVM_FSA_REDZONE_BYTES;
-
-    VALGRIND_MEMPOOL_ALLOC(&al->size_classes[bin], result, (bin + 1) << MVM_FSA_BIN_BITS);
+    result = (void *)(bin_ptr->alloc_pos + MVM_FSA_REDZONE_BYTES);
+    bin_ptr->alloc_pos += item_size;
+    bin_ptr->allocs++;
 
-    /* Unlock. */
-    uv_mutex_unlock(&(al->complex_alloc_mutex));
+    VALGRIND_MEMPOOL_ALLOC(&tc->instance->fsa->size_classes[bin], result, (bin + 1) << MVM_FSA_BIN_BITS);
 
     return result;
 }
-static void * alloc_from_global(MVMThreadContext *tc, MVMFixedSizeAlloc *al, MVMuint32 bin) {
-    /* Try and take from the global free list (fast path). */
-    MVMFixedSizeAllocSizeClass     *bin_ptr = &(al->size_classes[bin]);
-    MVMFixedSizeAllocFreeListEntry *fle = NULL;
-    /* Multi-threaded, so take a lock. Note that the lock is needed in
-     * addition to the atomic operations: the atomics allow us to add
-     * to the free list in a lock-free way, and the lock allows us to
-     * avoid the ABA issue we'd have with only the atomics. */
-    while (!MVM_trycas(&(al->freelist_spin), 0, 1)) {
-        MVMint32 i = 0;
-        while (i < 1024)
-            i++;
-    }
-    do {
-        fle = bin_ptr->free_list;
-        if (!fle)
-            break;
-    } while (!MVM_trycas(&(bin_ptr->free_list), fle, fle->next));
-    MVM_barrier();
-    al->freelist_spin = 0;
-    if (fle) {
-        VALGRIND_MEMPOOL_ALLOC(&al->size_classes[bin], ((void *)fle),
-                (bin + 1) << MVM_FSA_BIN_BITS);
-        return (void *)fle;
-    }
-
-    /* Failed to take from free list; slow path with the lock. */
-    return alloc_slow_path(tc, al, bin);
-}
 void * MVM_fixed_size_alloc(MVMThreadContext *tc, MVMFixedSizeAlloc *al, size_t bytes) {
 #if FSA_SIZE_DEBUG
     MVMFixedSizeAllocDebug *dbg = MVM_malloc(bytes + sizeof(MVMuint64));
@@ -186,10 +200,10 @@ void * MVM_fixed_size_alloc(MVMThreadContext *tc, MVMFixedSizeAlloc *al, size_t
         MVMFixedSizeAllocFreeListEntry *fle = bin_ptr->free_list;
         if (fle) {
             bin_ptr->free_list = fle->next;
-            bin_ptr->items--;
+            bin_ptr->allocs++;
             return (void *)fle;
         }
-        return alloc_from_global(tc, al, bin);
+        return alloc_slow_path(tc, tc->thread_fsa, bin);
     }
     return MVM_malloc(bytes);
 #endif
@@ -203,33 +217,27 @@ void * MVM_fixed_size_alloc_zeroed(MVMThreadContext *tc, MVMFixedSizeAlloc *al,
     return allocd;
 }
 
-/* Frees a piece of memory of the specified size, using the FSA. */
-static void add_to_global_bin_freelist(MVMThreadContext *tc, MVMFixedSizeAlloc *al,
-                                       MVMint32 bin, void *to_free) {
-    MVMFixedSizeAllocSizeClass     *bin_ptr = &(al->size_classes[bin]);
-    MVMFixedSizeAllocFreeListEntry *to_add  = (MVMFixedSizeAllocFreeListEntry *)to_free;
-    MVMFixedSizeAllocFreeListEntry *orig;
-
-    VALGRIND_MEMPOOL_FREE(bin_ptr, to_add);
-    VALGRIND_MAKE_MEM_DEFINED(to_add, sizeof(MVMFixedSizeAllocFreeListEntry));
-
-    /* Multi-threaded; race to add it. */
-    do {
-        orig = bin_ptr->free_list;
-        to_add->next = orig;
-    } while (!MVM_trycas(&(bin_ptr->free_list), orig, to_add));
-}
-static void add_to_bin_freelist(MVMThreadContext *tc, MVMFixedSizeAlloc *al,
-                                MVMint32 bin, void *to_free) {
-    MVMFixedSizeAllocThreadSizeClass *bin_ptr = &(tc->thread_fsa->size_classes[bin]);
-    if (bin_ptr->items < MVM_FSA_THREAD_FREELIST_LIMIT) {
-        MVMFixedSizeAllocFreeListEntry *to_add  = (MVMFixedSizeAllocFreeListEntry *)to_free;
+/* Frees a piece of memory from a bin back to the thread that owns the page it
+ * is in: straight on to its free list if that's us, and otherwise by racing
+ * to add it to the owner's remote free list. The bin is taken from the page,
+ * not the size the caller gives. */
+static void free_to_owner(MVMThreadContext *tc, void *to_free) {
+    MVMFixedSizeAllocPage            *page    = page_of(to_free);
+    MVMFixedSizeAllocThread          *owner   = page->owner;
+    MVMFixedSizeAllocThreadSizeClass *bin_ptr = &(owner->size_classes[page->bin]);
+    MVMFixedSizeAllocFreeListEntry   *to_add  = (MVMFixedSizeAllocFreeListEntry *)to_free;
+    if (owner == tc->thread_fsa) {
         to_add->next = bin_ptr->free_list;
         bin_ptr->free_list = to_add;
-        bin_ptr->items++;
+        bin_ptr->frees++;
     }
     else {
-        add_to_global_bin_freelist(tc, al, bin, to_free);
+        MVMFixedSizeAllocFreeListEntry *orig;
+        do {
+            orig = bin_ptr->remote_free_list;
+            to_add->next = orig;
+        } while (!MVM_trycas(&(bin_ptr->remote_free_list), orig, to_add));
+        MVM_incr(&(bin_ptr->remote_frees));
     }
 }
 void MVM_fixed_size_free(MVMThreadContext *tc, MVMFixedSizeAlloc *al, size_t bytes, void *to_free) {
@@ -241,8 +249,8 @@ void MVM_fixed_size_free(MVMThreadContext *tc, MVMFixedSizeAlloc *al, size_t byt
 #else
     MVMuint32 bin = bin_for(bytes);
     if (bin < MVM_FSA_BINS) {
-        /* Add to freelist chained through a bin. */
-        add_to_bin_freelist(tc, al, bin, to_free);
+        /* Add to freelist of the owning thread. */
+        free_to_owner(tc, to_free);
     }
     else {
         /* Was malloc'd due to being oversize, so just free it. */
@@ -306,7 +314,7 @@ void MVM_fixed_size_safepoint(MVMThreadContext *tc, MVMFixedSizeAlloc *al) {
         cur = al->size_classes[bin].free_at_next_safepoint_list;
         while (cur) {
             next = cur->next;
-            add_to_bin_freelist(tc, al, bin, cur->to_free);
+            free_to_owner(tc, cur->to_free);
             MVM_fixed_size_free(tc, al, sizeof(MVMFixedSizeAllocSafepointFreeListEntry), cur);
             cur = next;
         }
@@ -324,20 +332,50 @@ void MVM_fixed_size_safepoint(MVMThreadContext *tc, MVMFixedSizeAlloc *al) {
     al->free_at_next_safepoint_overflows = NULL;
 }
 
-/* Destroys per-thread fixed size allocator state. All freelists will be
- * contributed back to the global freelists for the bin size. */
+/* Destroys per-thread fixed size allocator state. Memory from its pages may
+ * still be in use (and be freed by other threads), so the allocator is kept,
+ * with everything in it, for a new thread to take over. */
 void MVM_fixed_size_destroy_thread(MVMThreadContext *tc) {
-    MVMFixedSizeAllocThread *al = tc->thread_fsa;
-    int bin;
-    for (bin = 0; bin < MVM_FSA_BINS; bin++) {
-        MVMFixedSizeAllocThreadSizeClass *bin_ptr = &(al->size_classes[bin]);
-        MVMFixedSizeAllocFreeListEntry *fle = bin_ptr->free_list;
-        while (fle) {
-            MVMFixedSizeAllocFreeListEntry *next = fle->next;
-            add_to_global_bin_freelist(tc, tc->instance->fsa, bin, (void *)fle);
-            fle = next;
+    MVMFixedSizeAllocThread *al  = tc->thread_fsa;
+    MVMFixedSizeAlloc       *fsa = tc->instance->fsa;
+    if (!al)
+        return;
+    uv_mutex_lock(&(fsa->threads_mutex));
+    al->thread_id = tc->thread_id;
+    al->tc        = NULL;
+    uv_mutex_unlock(&(fsa->threads_mutex));
+    tc->thread_fsa = NULL;
+}
+
+/* Writes out how much memory each per-thread allocator holds for each size
+ * class it has pages for, and how much of that is in use (which includes
+ * anything freed by other threads that the owner didn't take over yet), then
+ * closes the file. Later calls do nothing. */
+void MVM_fixed_size_write_stats(MVMThreadContext *tc, MVMFixedSizeAlloc *al) {
+    MVMFixedSizeAllocThread *thread_al;
+    FILE *fh;
+    uv_mutex_lock(&(al->threads_mutex));
+    fh = al->stats_fh;
+    al->stats_fh = NULL;
+    if (fh) {
+        fprintf(fh, "thread\tbin\titem_size\tpages\tbytes_reserved\tbytes_in_use\tallocs\tfrees\tremote_frees\n");
+        for (thread_al = al->threads; thread_al; thread_al = thread_al->next) {
+            MVMuint32 thread_id = thread_al->tc ? thread_al->tc->thread_id : thread_al->thread_id;
+            MVMuint32 bin;
+            for (bin = 0; bin < MVM_FSA_BINS; bin++) {
+                MVMFixedSizeAllocThreadSizeClass *bin_ptr = &(thread_al->size_classes[bin]);
+                MVMuint64 item_size    = (bin + 1) << MVM_FSA_BIN_BITS;
+                MVMuint64 remote_frees = (MVMuint64)MVM_load(&(bin_ptr->remote_frees));
+                if (!bin_ptr->num_pages)
+                    continue;
+                fprintf(fh, "%u\t%u\t%"PRIu64"\t%u\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\n",
+                    thread_id, bin, item_size, bin_ptr->num_pages,
+                    (MVMuint64)bin_ptr->num_pages * MVM_FSA_PAGE_SIZE,
+                    (bin_ptr->allocs - bin_ptr->frees - remote_frees) * item_size,
+                    bin_ptr->allocs, bin_ptr->frees, remote_frees);
+            }
         }
+        fclose(fh);
     }
-    MVM_free(al->size_classes);
-    MVM_free(al);
+    uv_mutex_unlock(&(al->threads_mutex));
 }
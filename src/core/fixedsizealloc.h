@@ -1,20 +1,24 @@
 /* The global, top-level data structure for the fixed size allocator. */
 struct MVMFixedSizeAlloc {
-    /* Size classes for the fixed size allocator. Each one represents a bunch
-     * of objects of the same size. The allocated sizes are rounded and then
-     * one of these buckets is used (more size classes are allocated if a
-     * need arises). */
+    /* Size classes for the fixed size allocator. The memory itself is owned
+     * by the per-thread allocators; these just hold what is to be freed at
+     * the next safepoint. */
     MVMFixedSizeAllocSizeClass *size_classes;
 
-    /* Spin lock used for reading from the free list, to avoid ABA. */
-    AO_t freelist_spin;
+    /* All of the per-thread allocators, including those of threads that have
+     * ended, which are kept (as memory from them may still be in use) and
+     * taken over by new threads. */
+    MVMFixedSizeAllocThread *threads;
 
-    /* Mutex for when we can't do a cheap/simple allocation. */
-    uv_mutex_t complex_alloc_mutex;
+    /* Mutex protecting the list of per-thread allocators. */
+    uv_mutex_t threads_mutex;
 
     /* Head of the "free at next safepoint" list of overflows (that is,
      * items that don't fit in a fixed size allocator bin). */
     MVMFixedSizeAllocSafepointFreeListEntry *free_at_next_safepoint_overflows;
+
+    /* File to write per-thread, per-bin statistics to at exit, if any. */
+    FILE *stats_fh;
 };
 
 /* Free list entry. Must be no bigger than the smallest size class. */
@@ -28,47 +32,65 @@ struct MVMFixedSizeAllocSafepointFreeListEntry {
     MVMFixedSizeAllocSafepointFreeListEntry *next;
 };
 
-/* Pages of objects of a particular size class. */
+/* Global state of a size class. */
 struct MVMFixedSizeAllocSizeClass {
-    /* Each page holds allocated chunks of memory. */
-    char **pages;
-
-    /* Head of the free list. */
-    MVMFixedSizeAllocFreeListEntry *free_list;
-
-    /* The current allocation position if we've nothing on the
-     * free list. */
-    char *alloc_pos;
-
-    /* The current page allocation limit (once we hit this, we need
-     * to go to the next page) Also just used when no free list. */
-    char *alloc_limit;
-
-    /* The current page number that we're allocating in. */
-    MVMuint32 cur_page;
-
-    /* The number of pages allocated. */
-    MVMuint32 num_pages;
-
     /* Head of the "free at next safepoint" list. */
     MVMFixedSizeAllocSafepointFreeListEntry *free_at_next_safepoint_list;
 };
 
+/* The header at the start of each page. Pages are aligned to their size, so
+ * the page a piece of memory is in, and so the thread that owns it, can be
+ * found from its address. */
+struct MVMFixedSizeAllocPage {
+    MVMFixedSizeAllocThread *owner;
+    MVMuint32                bin;
+};
+
 /* The per-thread data structure for the fixed size allocator, hung off the
- * thread context. Holds a free list per size bin. Allocations on the thread
- * will preferentially use the thread free list, and threads will free to
- * their own free lists, up to a length limit. On hitting the limit, they
- * will free back to the global allocator. This helps ensure patterns like
- * producer/consumer don't end up with a "leak". */
+ * thread context. Each thread allocates from pages of its own, and memory
+ * freed on the owning thread goes on its free list, so neither needs any
+ * synchronization. Memory freed by another thread is pushed on to the
+ * owner's remote free list for the size class, which the owner takes over
+ * when its own free list runs dry. This means patterns like producer and
+ * consumer return memory to the producer, rather than it "leaking" into the
+ * consumer's free lists. */
 struct MVMFixedSizeAllocThread {
     MVMFixedSizeAllocThreadSizeClass *size_classes;
+
+    /* Blocks of memory pages are carved out of, the next page to hand out,
+     * and how many more pages the current block has. */
+    char      **blocks;
+    MVMuint32   num_blocks;
+    MVMuint32   alloc_blocks;
+    char       *next_page;
+    MVMuint32   pages_left;
+
+    /* The thread using this allocator, or NULL if that thread ended and no
+     * other took it over yet; also the ID of the last thread to use it. */
+    MVMThreadContext *tc;
+    MVMuint32         thread_id;
+
+    /* The next allocator in the global list. */
+    MVMFixedSizeAllocThread *next;
 };
 struct MVMFixedSizeAllocThreadSizeClass {
     /* Head of the free list. */
     MVMFixedSizeAllocFreeListEntry *free_list;
 
-    /* How many items are on this thread's free list. */
-    MVMuint32 items;
+    /* Head of the list of items freed by other threads. */
+    MVMFixedSizeAllocFreeListEntry *remote_free_list;
+
+    /* The current allocation position and limit in the current page, for
+     * when the free lists are empty. */
+    char *alloc_pos;
+    char *alloc_limit;
+
+    /* Statistics: pages in use, items allocated, and items freed by this
+     * thread and by others. */
+    MVMuint32 num_pages;
+    MVMuint64 allocs;
+    MVMuint64 frees;
+    AO_t      remote_frees;
 };
 
 /* The number of bits we discard from the requested size when binning
@@ -88,11 +110,15 @@ struct MVMFixedSizeAllocThreadSizeClass {
 /* Number of bins in the FSA. Beyond this, we just degrade to malloc/free. */
 #define MVM_FSA_BINS       96
 
-/* The number of items that go into each page. */
-#define MVM_FSA_PAGE_ITEMS 128
+/* The size of a page, which is also what it is aligned to; must be a power
+ * of two, and hold a header and a good few items of the biggest bin. */
+#define MVM_FSA_PAGE_SIZE  16384
+
+/* Where in a page the first item goes. */
+#define MVM_FSA_PAGE_START 16
 
-/* The length limit for the per-thread free list. */
-#define MVM_FSA_THREAD_FREELIST_LIMIT   1024
+/* The number of pages in each block allocated for a thread. */
+#define MVM_FSA_BLOCK_PAGES 8
 
 /* Functions. */
 MVMFixedSizeAlloc * MVM_fixed_size_create(MVMThreadContext *tc);
@@ -104,3 +130,4 @@ void MVM_fixed_size_destroy_thread(MVMThreadContext *tc);
 void MVM_fixed_size_free(MVMThreadContext *tc, MVMFixedSizeAlloc *fsa, size_t bytes, void *free);
 void MVM_fixed_size_free_at_safepoint(MVMThreadContext *tc, MVMFixedSizeAlloc *fsa, size_t bytes, void *free);
 void MVM_fixed_size_safepoint(MVMThreadContext *tc, MVMFixedSizeAlloc *al);
+void MVM_fixed_size_write_stats(MVMThreadContext *tc, MVMFixedSizeAlloc *al);
@@ -81,6 +81,7 @@ struct MVMStringConsts {
     MVMString *kind;
     MVMString *instrumented;
     MVMString *heap;
+    MVMString *path;
     MVMString *translate_newlines;
     MVMString *platform_newline;
 };
@@ -176,6 +177,45 @@ struct MVMInstance {
     /* Whether the current GC run is a full collection. */
     MVMuint32 gc_full_collect;
 
+    /* The bounds within which the size of each thread's nursery adapts. */
+    MVMuint32 nursery_min_size;
+    MVMuint32 nursery_max_size;
+
+    /* Whether nursery collections are done in parallel, with threads
+     * stealing work from each other (enabled by MVM_GC_PARALLEL). */
+    MVMuint32 gc_parallel;
+
+    /* State for a parallel nursery collection: the threads taking part (as
+     * they register themselves), how many will take part in total, how many
+     * have registered so far, and how many are still busy doing work. */
+    MVMThreadContext **gc_parallel_workers;
+    MVMuint32          alloc_gc_parallel_workers;
+    AO_t               gc_parallel_participants;
+    AO_t               gc_parallel_ready;
+    AO_t               gc_parallel_active;
+
+    /* Incremental marking of gen2 (see gc/incremental.h). The pause target
+     * in nanoseconds (0 if full collections are done in one pause), when the
+     * current GC run started, whether a marking cycle should start in this
+     * run or is in progress, and the stack of gen2 objects that were marked
+     * but not yet scanned. */
+    MVMuint64          gc_pause_target;
+    MVMuint64          gc_pause_start;
+    MVMuint32          gc_mark_requested;
+    MVMuint32          gc_marking;
+    MVMCollectable   **gc_mark_stack;
+    MVMuint32          num_gc_mark_stack;
+    MVMuint32          alloc_gc_mark_stack;
+
+    /* Counters of incremental marking progress: completed marking cycles,
+     * slices of the current cycle, objects and bytes marked in the current
+     * cycle, and gen2 objects shaded by the write barrier in it. */
+    MVMuint64          gc_mark_cycles;
+    MVMuint64          gc_mark_slices;
+    MVMuint64          gc_marked_objects;
+    MVMuint64          gc_marked_bytes;
+    MVMuint64          gc_mark_barrier_hits;
+
     /* How many bytes of data have we promoted from the nursery to gen2
      * since we last did a full collection? */
     AO_t gc_promoted_bytes_since_last_full;
@@ -219,6 +259,10 @@ struct MVMInstance {
     MVMuint32                     all_scs_next_idx;
     MVMuint32                     all_scs_alloc;
 
+    /* File to write how much of each SC was deserialized to at exit, if
+     * any. */
+    FILE *deserialize_stats_fh;
+
     /************************************************************************
      * Specializer (dynamic optimization)
      ************************************************************************/
@@ -245,15 +289,31 @@ struct MVMInstance {
      * is enabled. */
     MVMObject *spesh_queue;
 
-    /* The current specialization plan; hung off here so we can mark it. */
-    MVMSpeshPlan *spesh_plan;
+    /* The number of specialization worker threads. */
+    MVMuint32 spesh_num_workers;
+
+    /* The specialization plan cache, if enabled. */
+    MVMSpeshPlanCache *spesh_plan_cache;
 
     /* The latest statistics version (incremented each time a spesh log is
-     * received by the worker thread). */
+     * received by a worker thread). */
     MVMuint32 spesh_stats_version;
 
+    /* Coordination between specialization workers. Logs are numbered as
+     * they are taken from the queue, and statistics are updated strictly in
+     * that order, since the stack simulation depends on it. Producing
+     * specializations reads the statistics, so can go on in parallel with
+     * other productions but not with a statistics update. */
+    uv_mutex_t mutex_spesh_workers;
+    uv_cond_t cond_spesh_workers;
+    uv_mutex_t mutex_spesh_dequeue;
+    MVMuint64 spesh_next_log_number;
+    MVMuint64 spesh_stats_log_number;
+    MVMuint32 spesh_stats_busy;
+    MVMuint32 spesh_producers;
+
     /* Lock and condition variable for when something needs to wait for the
-     * specialization worker to finish what it's doing before continuing.
+     * specialization workers to finish what they're doing before continuing.
      * Used by the profiler, which doesn't want the specializer tripping over
      * frame bytecode changing to instrumented versions. */
     uv_mutex_t mutex_spesh_sync;
@@ -267,9 +327,15 @@ struct MVMInstance {
     /* Flag for if jit is enabled */
     MVMint32 jit_enabled;
 
+    /* Flag for if runs of integer ops are compiled as expression trees */
+    MVMint32 jit_expr_enabled;
+
     /* File for JIT logging */
     FILE *jit_log_fh;
 
+    /* Report of frames the JIT bailed on, if enabled */
+    MVMJitBailReport *jit_bail_report;
+
     /* Directory name for JIT bytecode dumps */
     char *jit_bytecode_dir;
 
@@ -283,18 +349,16 @@ struct MVMInstance {
      * I/O and process state
      ************************************************************************/
 
-    /* The event loop thread, a mutex to avoid start-races, a concurrent
-     * queue of tasks that need to be processed by the event loop thread
-     * and an array of active tasks, for the purpose of keeping them GC
-     * marked. */
-    MVMThreadContext *event_loop_thread;
+    /* The event loops, which are all started on first use, and the next one
+     * to hand a task to. Also a mutex to avoid start-races, and the loop
+     * whose thread is being started. */
+    MVMEventLoop     *event_loops;
+    MVMuint32         num_event_loops;
+    AO_t              event_loops_started;
+    AO_t              event_loop_next;
     uv_mutex_t        mutex_event_loop_start;
     uv_sem_t          sem_event_loop_started;
-    MVMObject        *event_loop_todo_queue;
-    MVMObject        *event_loop_permit_queue;
-    MVMObject        *event_loop_cancel_queue;
-    MVMObject        *event_loop_active;
-    uv_async_t       *event_loop_wakeup;
+    MVMEventLoop     *event_loop_starting;
 
     /* Standard file handles. */
     MVMObject *stdin_handle;
@@ -410,6 +474,9 @@ struct MVMInstance {
     MVMLoadedCompUnitName *loaded_compunits;
     uv_mutex_t       mutex_loaded_compunits;
 
+    /* Directory to keep compilation unit images in, if any. */
+    char *cu_image_dir;
+
     /* Hash of all loaded DLLs. */
     MVMDLLRegistry  *dll_registry;
     uv_mutex_t mutex_dll_registry;
@@ -439,6 +506,9 @@ struct MVMInstance {
     /* Heap snapshots, if we're doing heap snapshotting. */
     MVMHeapSnapshotCollection *heap_snapshots;
 
+    /* The sampling profiler, if it's enabled. */
+    MVMProfileSampler *sampling_profiler;
+
     /* Whether cross-thread write logging is turned on or not, and an output
      * mutex for it. */
     MVMuint32  cross_thread_write_logging;
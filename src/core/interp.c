@@ -1205,44 +1205,22 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 cur_op += 4;
                 goto NEXT;
             }
-            OP(bindexcategory): {
-                MVMObject *ex = GET_REG(cur_op, 0).o;
-                if (IS_CONCRETE(ex) && REPR(ex)->ID == MVM_REPR_ID_MVMException)
-                    ((MVMException *)ex)->body.category = GET_REG(cur_op, 2).i64;
-                else
-                    MVM_exception_throw_adhoc(tc, "bindexcategory needs a VMException, got %s (%s)", REPR(ex)->name, STABLE(ex)->debug_name);
+            OP(bindexcategory):
+                MVM_exception_bind_category(tc, GET_REG(cur_op, 0).o, GET_REG(cur_op, 2).i64);
                 cur_op += 4;
                 goto NEXT;
-            }
-            OP(getexmessage): {
-                MVMObject *ex = GET_REG(cur_op, 2).o;
-                if (IS_CONCRETE(ex) && REPR(ex)->ID == MVM_REPR_ID_MVMException)
-                    GET_REG(cur_op, 0).s = ((MVMException *)ex)->body.message;
-                else
-                    MVM_exception_throw_adhoc(tc, "getexmessage needs a VMException, got %s (%s)", REPR(ex)->name, STABLE(ex)->debug_name);
+            OP(getexmessage):
+                GET_REG(cur_op, 0).s = MVM_exception_get_message(tc, GET_REG(cur_op, 2).o);
                 cur_op += 4;
                 goto NEXT;
-            }
-            OP(getexpayload): {
-                MVMObject *ex = GET_REG(cur_op, 2).o;
-                if (IS_CONCRETE(ex) && REPR(ex)->ID == MVM_REPR_ID_MVMException)
-                    GET_REG(cur_op, 0).o = ((MVMException *)ex)->body.payload;
-                else
-                    MVM_exception_throw_adhoc(tc, "getexpayload needs a VMException, got %s (%s)", REPR(ex)->name, STABLE(ex)->debug_name);
-                if (!GET_REG(cur_op, 0).o)
-                    GET_REG(cur_op, 0).o = tc->instance->VMNull;
+            OP(getexpayload):
+                GET_REG(cur_op, 0).o = MVM_exception_get_payload(tc, GET_REG(cur_op, 2).o);
                 cur_op += 4;
                 goto NEXT;
-            }
-            OP(getexcategory): {
-                MVMObject *ex = GET_REG(cur_op, 2).o;
-                if (IS_CONCRETE(ex) && REPR(ex)->ID == MVM_REPR_ID_MVMException)
-                    GET_REG(cur_op, 0).i64 = ((MVMException *)ex)->body.category;
-                else
-                    MVM_exception_throw_adhoc(tc, "getexcategory needs a VMException, got %s (%s)", REPR(ex)->name, STABLE(ex)->debug_name);
+            OP(getexcategory):
+                GET_REG(cur_op, 0).i64 = MVM_exception_get_category(tc, GET_REG(cur_op, 2).o);
                 cur_op += 4;
                 goto NEXT;
-            }
             OP(throwdyn): {
                 MVMRegister *rr     = &GET_REG(cur_op, 0);
                 MVMObject   *ex_obj = GET_REG(cur_op, 2).o;
@@ -1922,7 +1900,7 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 cur_op += 4;
                 goto NEXT;
             OP(getwho): {
-                MVMObject *who = STABLE(GET_REG(cur_op, 2).o)->WHO;
+                MVMObject *who = MVM_6model_get_who(tc, STABLE(GET_REG(cur_op, 2).o));
                 GET_REG(cur_op, 0).o = who ? who : tc->instance->VMNull;
                 cur_op += 4;
                 goto NEXT;
@@ -1930,6 +1908,7 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
             OP(setwho): {
                 MVMSTable *st = STABLE(GET_REG(cur_op, 2).o);
                 MVM_ASSIGN_REF(tc, &(st->header), st->WHO, GET_REG(cur_op, 4).o);
+                st->WHO_sc = NULL;
                 GET_REG(cur_op, 0).o = GET_REG(cur_op, 2).o;
                 cur_op += 6;
                 goto NEXT;
@@ -3740,6 +3719,10 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
                 goto NEXT;
             OP(exit): {
                 MVMint64 exit_code = GET_REG(cur_op, 0).i64;
+                if (tc->instance->spesh_plan_cache)
+                    MVM_spesh_plan_cache_save(tc);
+                if (tc->instance->jit_bail_report)
+                    MVM_jit_bail_report_write(tc);
                 exit(exit_code);
             }
             OP(cwd):
@@ -5709,7 +5692,7 @@ void MVM_interp_run(MVMThreadContext *tc, void (*initial_invoke)(MVMThreadContex
             OP(sp_boolify_iter_hash): {
                 MVMIter *iter = (MVMIter *)GET_REG(cur_op, 2).o;
 
-                GET_REG(cur_op, 0).i64 = iter->body.hash_state.next != NULL ? 1 : 0;
+                GET_REG(cur_op, 0).i64 = iter->body.hash_state.next != 0 ? 1 : 0;
 
                 cur_op += 4;
                 goto NEXT;
@@ -9,6 +9,9 @@
 #define GC_SYNC_POINT(tc) \
     if (tc->gc_status) { \
         MVM_gc_enter_from_interrupt(tc); \
+    } \
+    else if (tc->prof_sample_requested) { \
+        MVM_profile_sampling_take(tc); \
     }
 
 /* Different views of a register. */
@@ -8,6 +8,10 @@ static void mark_sr_data(MVMThreadContext *tc, MVMFrame *frame, MVMGCWorklist *w
     MVM_gc_worklist_add(tc, worklist, &frame->extra->special_return_data);
 }
 static void run_comp_unit(MVMThreadContext *tc, MVMCompUnit *cu) {
+    /* Let the specialization plan cache know about it. */
+    if (tc->instance->spesh_plan_cache)
+        MVM_spesh_plan_cache_cu_loaded(tc, cu);
+
     /* If there's a deserialization frame, need to run that. */
     if (cu->body.deserialize_frame) {
         /* Set up special return to delegate to running the load frame,
@@ -92,8 +96,12 @@ void MVM_load_bytecode_fh(MVMThreadContext *tc, MVMObject *oshandle, MVMString *
         MVM_exception_throw_adhoc(tc, "loadbytecodefh requires an object with REPR MVMOSHandle");
 
     MVMROOT(tc, filename, {
-        MVMuint64 pos = MVM_io_tell(tc, oshandle);
-        cu = MVM_cu_map_from_file_handle(tc, MVM_io_fileno(tc, oshandle), pos);
+        MVMuint64 pos        = MVM_io_tell(tc, oshandle);
+        char     *c_filename = filename
+            ? MVM_string_utf8_c8_encode_C_string(tc, filename)
+            : NULL;
+        cu = MVM_cu_map_from_file_handle(tc, MVM_io_fileno(tc, oshandle), pos, c_filename);
+        MVM_free(c_filename);
         cu->body.filename = filename;
 
         run_comp_unit(tc, cu);
@@ -0,0 +1,191 @@
+#include "moar.h"
+
+/* Gets the hash code of a string key, computing it if needed. */
+MVM_STATIC_INLINE MVMuint32 hash_for_key(MVMThreadContext *tc, MVMString *key) {
+    MVMuint32 hash = (MVMuint32)key->body.cached_hash_code;
+    if (!hash) {
+        MVM_string_compute_hash_code(tc, key);
+        hash = (MVMuint32)key->body.cached_hash_code;
+    }
+    return hash;
+}
+
+/* How far a slot holding the given hash is from its ideal position. */
+MVM_STATIC_INLINE MVMuint32 probe_distance(MVMuint32 hash, MVMuint32 pos, MVMuint32 mask) {
+    return (pos - (hash & mask)) & mask;
+}
+
+/* Places an entry into the slots, Robin Hood style: whenever we come across
+ * a slot whose occupant is closer to its ideal position than we are to ours,
+ * we take its place and carry on looking for somewhere to put it instead. */
+static void insert_slot(MVMStrHashTable *hashtable, MVMuint32 hash, MVMuint32 entry) {
+    MVMStrHashSlot *slots = hashtable->slots;
+    MVMuint32 mask        = hashtable->num_slots - 1;
+    MVMuint32 pos         = hash & mask;
+    MVMuint32 distance    = 0;
+    while (1) {
+        MVMStrHashSlot *slot = &slots[pos];
+        MVMuint32 slot_distance;
+        if (!slot->entry) {
+            slot->entry = entry;
+            slot->hash  = hash;
+            return;
+        }
+        slot_distance = probe_distance(slot->hash, pos, mask);
+        if (slot_distance < distance) {
+            MVMuint32 displaced_entry = slot->entry;
+            MVMuint32 displaced_hash  = slot->hash;
+            slot->entry = entry;
+            slot->hash  = hash;
+            entry       = displaced_entry;
+            hash        = displaced_hash;
+            distance    = slot_distance;
+        }
+        pos = (pos + 1) & mask;
+        distance++;
+    }
+}
+
+/* Finds the slot holding the given key, or returns -1 if it's not there. */
+static MVMint64 find_slot(MVMThreadContext *tc, MVMStrHashTable *hashtable, MVMString *key, MVMuint32 hash) {
+    MVMStrHashSlot *slots = hashtable->slots;
+    MVMuint32 mask        = hashtable->num_slots - 1;
+    MVMuint32 pos         = hash & mask;
+    MVMuint32 distance    = 0;
+    while (1) {
+        MVMStrHashSlot *slot = &slots[pos];
+        if (!slot->entry)
+            return -1;
+
+        /* If we've probed further than the occupant of this slot had to, then
+         * the key would have displaced it if it were present. */
+        if (probe_distance(slot->hash, pos, mask) < distance)
+            return -1;
+
+        if (slot->hash == hash) {
+            MVMString *candidate = hashtable->entries[slot->entry - 1].key;
+            if (candidate == key || MVM_string_equal(tc, candidate, key))
+                return pos;
+        }
+        pos = (pos + 1) & mask;
+        distance++;
+    }
+}
+
+/* Rebuilds the table with the given number of slots, dropping deleted
+ * entries while preserving the order of the live ones. */
+static void rebuild(MVMThreadContext *tc, MVMStrHashTable *hashtable, MVMuint32 num_slots) {
+    MVMHashEntry *old_entries = hashtable->entries;
+    MVMuint32 old_num_entries = hashtable->num_entries;
+    MVMuint32 i;
+
+    MVM_free(hashtable->slots);
+    hashtable->slots       = MVM_calloc(num_slots, sizeof(MVMStrHashSlot));
+    hashtable->entries     = MVM_malloc(MVM_STR_HASH_MAX_ENTRIES(num_slots) * sizeof(MVMHashEntry));
+    hashtable->num_slots   = num_slots;
+    hashtable->num_entries = 0;
+
+    for (i = 0; i < old_num_entries; i++) {
+        MVMString *key = old_entries[i].key;
+        if (key) {
+            MVMuint32 idx = hashtable->num_entries++;
+            hashtable->entries[idx] = old_entries[i];
+            insert_slot(hashtable, hash_for_key(tc, key), idx + 1);
+        }
+    }
+    MVM_free(old_entries);
+}
+
+/* Looks up the entry for a key, returning NULL if there is none. */
+MVMHashEntry * MVM_str_hash_fetch(MVMThreadContext *tc, MVMStrHashTable *hashtable, MVMString *key) {
+    MVMint64 pos;
+    if (!hashtable->num_items)
+        return NULL;
+    pos = find_slot(tc, hashtable, key, hash_for_key(tc, key));
+    return pos >= 0 ? &hashtable->entries[hashtable->slots[pos].entry - 1] : NULL;
+}
+
+/* Looks up the entry for a key, adding an entry with a NULL value if there
+ * is none. The caller is responsible for assigning the value and for any
+ * write barrier that storing the key requires. The returned pointer is only
+ * valid until the next addition to the table. */
+MVMHashEntry * MVM_str_hash_lvalue_fetch(MVMThreadContext *tc, MVMStrHashTable *hashtable, MVMString *key) {
+    MVMuint32 hash = hash_for_key(tc, key);
+    MVMHashEntry *entry;
+    MVMuint32 idx;
+
+    if (hashtable->num_items) {
+        MVMint64 pos = find_slot(tc, hashtable, key, hash);
+        if (pos >= 0)
+            return &hashtable->entries[hashtable->slots[pos].entry - 1];
+    }
+
+    /* Need a new entry; make space if the entries array is full. If a good
+     * share of it is deleted entries, then compacting is enough. */
+    if (hashtable->num_entries == MVM_STR_HASH_MAX_ENTRIES(hashtable->num_slots)) {
+        MVMuint32 num_slots = hashtable->num_slots;
+        if (num_slots == 0)
+            num_slots = MVM_STR_HASH_INITIAL_SLOTS;
+        else if (hashtable->num_items >= hashtable->num_entries - (hashtable->num_entries >> 2))
+            num_slots *= 2;
+        rebuild(tc, hashtable, num_slots);
+    }
+
+    idx          = hashtable->num_entries++;
+    entry        = &hashtable->entries[idx];
+    entry->key   = key;
+    entry->value = NULL;
+    insert_slot(hashtable, hash, idx + 1);
+    hashtable->num_items++;
+    return entry;
+}
+
+/* Deletes the entry for a key, if there is one. The entry is left behind as
+ * a hole, so that iteration positions stay valid; its slot is freed up by
+ * shifting back any following slots that were displaced from their ideal
+ * position, so no tombstones are needed in the metadata. */
+void MVM_str_hash_delete(MVMThreadContext *tc, MVMStrHashTable *hashtable, MVMString *key) {
+    MVMStrHashSlot *slots;
+    MVMHashEntry *entry;
+    MVMuint32 mask, pos, next;
+    MVMint64 found;
+
+    if (!hashtable->num_items)
+        return;
+    found = find_slot(tc, hashtable, key, hash_for_key(tc, key));
+    if (found < 0)
+        return;
+
+    slots = hashtable->slots;
+    mask  = hashtable->num_slots - 1;
+    pos   = (MVMuint32)found;
+
+    entry        = &hashtable->entries[slots[pos].entry - 1];
+    entry->key   = NULL;
+    entry->value = NULL;
+    hashtable->num_items--;
+
+    next = (pos + 1) & mask;
+    while (slots[next].entry && probe_distance(slots[next].hash, next, mask) != 0) {
+        slots[pos] = slots[next];
+        pos  = next;
+        next = (next + 1) & mask;
+    }
+    slots[pos].entry = 0;
+    slots[pos].hash  = 0;
+
+    /* Note that num_entries is left alone even once the table is empty, as
+     * an iterator may still be holding a position into the entries; the
+     * holes are squeezed out by the next rebuild. */
+}
+
+/* Frees all memory associated with the hash table. */
+void MVM_str_hash_demolish(MVMThreadContext *tc, MVMStrHashTable *hashtable) {
+    MVM_free(hashtable->entries);
+    MVM_free(hashtable->slots);
+    hashtable->entries     = NULL;
+    hashtable->slots       = NULL;
+    hashtable->num_items   = 0;
+    hashtable->num_entries = 0;
+    hashtable->num_slots   = 0;
+}
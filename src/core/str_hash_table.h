@@ -0,0 +1,86 @@
+/* An open-addressing hash table keyed on MVMString, used as the storage
+ * engine for VM-level hashes (the VMHash and HashAttrStore REPRs).
+ *
+ * Entries (key/value pairs) live in a single contiguous array, in insertion
+ * order. Deleting an entry leaves a hole (NULL key) behind, so positions in
+ * the entries array stay stable; that is what lets an iterator just hold an
+ * index. Holes are only squeezed out when the table is rebuilt on growth.
+ *
+ * Lookup goes through a separate metadata array of slots, each holding the
+ * full hash of the key and the (1-based) index of its entry; 0 means the
+ * slot is empty. Collisions are resolved by linear probing with Robin Hood
+ * placement, so probe sequences stay short and a lookup typically touches
+ * one or two cache lines of metadata before doing a single key comparison.
+ * Since the hash is stored, a mismatch never has to chase the key pointer.
+ *
+ * The number of slots is a power of two; at most 3/4 of them are used, and
+ * the entries array is sized to exactly that many entries. */
+
+/* A key/value pair. A NULL key marks a deleted entry. */
+struct MVMHashEntry {
+    MVMString *key;
+    MVMObject *value;
+};
+
+/* A slot in the metadata array. */
+struct MVMStrHashSlot {
+    /* Index into the entries array plus one; 0 if the slot is free. */
+    MVMuint32 entry;
+
+    /* The hash code of the key. */
+    MVMuint32 hash;
+};
+
+struct MVMStrHashTable {
+    /* Entries in insertion order; NULL until the first bind. */
+    MVMHashEntry *entries;
+
+    /* The slots used for lookup. */
+    MVMStrHashSlot *slots;
+
+    /* The number of live entries. */
+    MVMuint32 num_items;
+
+    /* The number of entries used, including deleted ones. */
+    MVMuint32 num_entries;
+
+    /* The number of slots; always a power of two, or 0 if not allocated. */
+    MVMuint32 num_slots;
+};
+
+/* The initial number of slots allocated, and the fill limit (entries can
+ * take up at most this fraction of the slots). */
+#define MVM_STR_HASH_INITIAL_SLOTS  8
+#define MVM_STR_HASH_MAX_ENTRIES(num_slots) ((num_slots) - ((num_slots) >> 2))
+
+MVMHashEntry * MVM_str_hash_fetch(MVMThreadContext *tc, MVMStrHashTable *hashtable, MVMString *key);
+MVMHashEntry * MVM_str_hash_lvalue_fetch(MVMThreadContext *tc, MVMStrHashTable *hashtable, MVMString *key);
+void MVM_str_hash_delete(MVMThreadContext *tc, MVMStrHashTable *hashtable, MVMString *key);
+void MVM_str_hash_demolish(MVMThreadContext *tc, MVMStrHashTable *hashtable);
+
+/* Finds the first live entry at or after the given entry index. Returns the
+ * index, or the number of entries used if there is none. */
+MVM_STATIC_INLINE MVMuint32 MVM_str_hash_next_live(MVMThreadContext *tc, MVMStrHashTable *hashtable, MVMuint32 idx) {
+    while (idx < hashtable->num_entries && !hashtable->entries[idx].key)
+        idx++;
+    return idx;
+}
+
+/* Number of live entries. */
+MVM_STATIC_INLINE MVMuint64 MVM_str_hash_count(MVMThreadContext *tc, MVMStrHashTable *hashtable) {
+    return hashtable->num_items;
+}
+
+/* Amount of memory allocated outside of the owning object. */
+MVM_STATIC_INLINE MVMuint64 MVM_str_hash_allocated_size(MVMThreadContext *tc, MVMStrHashTable *hashtable) {
+    return (MVMuint64)hashtable->num_slots * sizeof(MVMStrHashSlot) +
+        (MVMuint64)MVM_STR_HASH_MAX_ENTRIES(hashtable->num_slots) * sizeof(MVMHashEntry);
+}
+
+/* Iterates over the live entries of a hash table. Entries may be deleted
+ * (including the current one) during iteration. Adding entries may cause
+ * the table to be rebuilt, which renumbers the entries. */
+#define MVM_STR_HASH_ITER(tc, hashtable, current, idx) \
+    for ((idx) = MVM_str_hash_next_live((tc), (hashtable), 0); \
+         (idx) < (hashtable)->num_entries && ((current) = &(hashtable)->entries[(idx)]); \
+         (idx) = MVM_str_hash_next_live((tc), (hashtable), (idx) + 1))
@@ -27,9 +27,16 @@ MVMThreadContext * MVM_tc_create(MVMThreadContext *parent, MVMInstance *instance
 
     /* Set up GC nursery. We only allocate tospace initially, and allocate
      * fromspace the first time this thread GCs, provided it ever does. */
-    tc->nursery_tospace     = MVM_calloc(1, MVM_NURSERY_SIZE);
-    tc->nursery_alloc       = tc->nursery_tospace;
-    tc->nursery_alloc_limit = (char *)tc->nursery_alloc + MVM_NURSERY_SIZE;
+    tc->nursery_size = MVM_NURSERY_SIZE;
+    if (tc->nursery_size < instance->nursery_min_size)
+        tc->nursery_size = instance->nursery_min_size;
+    if (tc->nursery_size > instance->nursery_max_size)
+        tc->nursery_size = instance->nursery_max_size;
+    tc->nursery_tospace_size  = tc->nursery_size;
+    tc->nursery_tospace       = MVM_calloc(1, tc->nursery_tospace_size);
+    tc->nursery_alloc         = tc->nursery_tospace;
+    tc->nursery_alloc_limit   = (char *)tc->nursery_alloc + tc->nursery_tospace_size;
+    tc->nursery_last_collect  = uv_hrtime();
 
     /* Set up temporary root handling. */
     tc->num_temproots   = 0;
@@ -61,6 +68,10 @@ MVMThreadContext * MVM_tc_create(MVMThreadContext *parent, MVMInstance *instance
      * need to check. */
     tc->last_payload = instance->VMNull;
 
+    /* Sample the thread's call stack if the sampling profiler is on. */
+    if (instance->sampling_profiler)
+        MVM_profile_sampling_register_thread(tc);
+
     return tc;
 }
 
@@ -76,6 +87,10 @@ void MVM_tc_destroy(MVMThreadContext *tc) {
     /* Free specialization state. */
     MVM_spesh_sim_stack_destroy(tc, tc->spesh_sim_stack);
 
+    /* Stop sampling the thread, keeping what was sampled. */
+    if (tc->prof_samples)
+        MVM_profile_sampling_unregister_thread(tc);
+
     /* Free the nursery and finalization queue. */
     MVM_free(tc->nursery_fromspace);
     MVM_free(tc->nursery_tospace);
@@ -92,6 +107,9 @@ void MVM_tc_destroy(MVMThreadContext *tc) {
 
     /* Free the thread-specific storage */
     MVM_free(tc->gc_work);
+    if (tc->gc_deque)
+        MVM_gc_deque_destroy(tc, tc->gc_deque);
+    MVM_free(tc->gc_mark_queue);
     MVM_free(tc->temproots);
     MVM_free(tc->gen2roots);
     MVM_free(tc->finalize);
@@ -100,6 +118,9 @@ void MVM_tc_destroy(MVMThreadContext *tc) {
     MVM_free(tc->nfa_done);
     MVM_free(tc->nfa_curst);
     MVM_free(tc->nfa_nextst);
+    MVM_free(tc->nfa_edges);
+    MVM_free(tc->nfa_edge_fates);
+    MVM_free(tc->nfa_closure_fates);
     MVM_free(tc->nfa_fates);
     MVM_free(tc->nfa_longlit);
     MVM_free(tc->multi_dim_indices);
@@ -126,3 +147,16 @@ void MVM_tc_release_ex_release_mutex(MVMThreadContext *tc) {
 void MVM_tc_clear_ex_release_mutex(MVMThreadContext *tc) {
     tc->ex_release_mutex = NULL;
 }
+
+/* Setting and clearing flag to clear on exception throw. */
+void MVM_tc_set_ex_release_flag(MVMThreadContext *tc, AO_t *flag) {
+    tc->ex_release_flag = flag;
+}
+void MVM_tc_release_ex_release_flag(MVMThreadContext *tc) {
+    if (tc->ex_release_flag)
+        MVM_store(tc->ex_release_flag, 0);
+    tc->ex_release_flag = NULL;
+}
+void MVM_tc_clear_ex_release_flag(MVMThreadContext *tc) {
+    tc->ex_release_flag = NULL;
+}
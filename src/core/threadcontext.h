@@ -60,6 +60,18 @@ struct MVMThreadContext {
     /* The end of the space we're allowed to allocate to. */
     void *nursery_alloc_limit;
 
+    /* The sizes of fromspace and tospace, which differ for a while after the
+     * nursery was resized, and the size tospace will get when it is next
+     * swapped with fromspace. */
+    MVMuint32 nursery_fromspace_size;
+    MVMuint32 nursery_tospace_size;
+    MVMuint32 nursery_size;
+
+    /* When the nursery was last collected, and the number of collections in
+     * a row that found it mostly unused; used to decide on its size. */
+    MVMuint64 nursery_last_collect;
+    MVMuint32 nursery_idle_collects;
+
     /* This thread's GC status. */
     AO_t gc_status;
 
@@ -110,6 +122,17 @@ struct MVMThreadContext {
     MVMuint32        gc_work_size;
     MVMuint32        gc_work_count;
 
+    /* Work-stealing deque used when collecting the nursery in parallel;
+     * created on first use. */
+    MVMGCDeque      *gc_deque;
+
+    /* Gen2 objects queued for marking by the write barrier or by promotion
+     * while an incremental marking cycle is in progress; moved over to the
+     * instance-wide mark stack in the next GC run. */
+    MVMuint32        num_gc_mark_queue;
+    MVMuint32        alloc_gc_mark_queue;
+    MVMCollectable **gc_mark_queue;
+
     /* Per-thread fixed size allocator state. */
     MVMFixedSizeAllocThread *thread_fsa;
 
@@ -183,6 +206,10 @@ struct MVMThreadContext {
     /* The spesh stack simulation, perserved between processing logs. */
     MVMSpeshSimStack *spesh_sim_stack;
 
+    /* If this is a specialization worker, the plan it is currently carrying
+     * out; hung off here so we can mark it. */
+    MVMSpeshPlan *spesh_plan;
+
     /* We try to do better at OSR by creating a fresh log when we enter a new
      * compilation unit. However, for things that EVAL or do a ton of BEGIN,
      * this does more harm than good. Use this to throttle it back. */
@@ -215,6 +242,10 @@ struct MVMThreadContext {
      * like I/O, which grab a mutex but may throw an exception. */
     uv_mutex_t *ex_release_mutex;
 
+    /* Likewise, a flag that must be cleared if we throw an exception. Used
+     * by the NFA to give up the DFA it is using. */
+    AO_t *ex_release_flag;
+
     /* Memory buffer pointing to the last thing we serialized, intended to go
      * into the next compilation unit we write. Also the serialized string
      * heap, which will be used to seed the compilation unit string heap. */
@@ -243,9 +274,15 @@ struct MVMThreadContext {
 
     /* NFA evaluator memory cache, to avoid many allocations; see NFA.c. */
     MVMuint32 *nfa_done;
+    MVMuint32  nfa_done_gen;
     MVMuint32 *nfa_curst;
     MVMuint32 *nfa_nextst;
     MVMint64   nfa_alloc_states;
+    MVMNFAStateInfo **nfa_edges;
+    MVMint64  *nfa_edge_fates;
+    MVMint64   nfa_edges_len;
+    MVMint64  *nfa_closure_fates;
+    MVMint64   nfa_closure_fates_len;
     MVMint64 *nfa_fates;
     MVMint64  nfa_fates_len;
     MVMint64 *nfa_longlit;
@@ -255,8 +292,16 @@ struct MVMThreadContext {
     MVMint64 *multi_dim_indices;
     MVMint64  num_multi_dim_indices;
 
+    /* The event loop this thread runs, if it's an event loop thread. */
+    MVMEventLoop *event_loop;
+
     /* Profiling data collected for this thread, if profiling is on. */
     MVMProfileThreadData *prof_data;
+
+    /* Samples of this thread's call stack, if the sampling profiler is on,
+     * and a flag set when the next sample is due. */
+    MVMProfileSampleThread *prof_samples;
+    AO_t prof_sample_requested;
 };
 
 MVMThreadContext * MVM_tc_create(MVMThreadContext *parent, MVMInstance *instance);
@@ -264,3 +309,6 @@ void MVM_tc_destroy(MVMThreadContext *tc);
 void MVM_tc_set_ex_release_mutex(MVMThreadContext *tc, uv_mutex_t *mutex);
 void MVM_tc_release_ex_release_mutex(MVMThreadContext *tc);
 void MVM_tc_clear_ex_release_mutex(MVMThreadContext *tc);
+void MVM_tc_set_ex_release_flag(MVMThreadContext *tc, AO_t *flag);
+void MVM_tc_release_ex_release_flag(MVMThreadContext *tc);
+void MVM_tc_clear_ex_release_flag(MVMThreadContext *tc);
@@ -27,8 +27,15 @@ void * MVM_gc_allocate_nursery(MVMThreadContext *tc, size_t size) {
          * second generation. Note that this circumstance is exceptionally
          * unlikely in any non-contrived situation. */
         while ((char *)tc->nursery_alloc + size >= (char *)tc->nursery_alloc_limit) {
-            if (size > MVM_NURSERY_SIZE)
-                MVM_panic(MVM_exitcode_gcalloc, "Attempt to allocate more than the maximum nursery size");
+            if (size > tc->nursery_tospace_size) {
+                /* Make sure that tospace will be big enough after the GC. */
+                if (size > tc->instance->nursery_max_size)
+                    MVM_panic(MVM_exitcode_gcalloc, "Attempt to allocate more than the maximum nursery size");
+                while (tc->nursery_size < size)
+                    tc->nursery_size *= 2;
+                if (tc->nursery_size > tc->instance->nursery_max_size)
+                    tc->nursery_size = tc->instance->nursery_max_size;
+            }
             MVM_gc_enter_from_allocator(tc);
         }
 
@@ -8,7 +8,12 @@ void MVM_gc_allocate_gen2_default_set(MVMThreadContext *tc);
 void MVM_gc_allocate_gen2_default_clear(MVMThreadContext *tc);
 
 MVM_STATIC_INLINE void * MVM_gc_allocate(MVMThreadContext *tc, size_t size) {
-    return tc->allocate_in_gen2
-        ? MVM_gc_gen2_allocate_zeroed(tc->gen2, size)
-        : MVM_gc_allocate_nursery(tc, size);
+    if (tc->allocate_in_gen2) {
+        /* Objects allocated while gen2 is being marked are considered live. */
+        MVMCollectable *c = MVM_gc_gen2_allocate_zeroed(tc->gen2, size);
+        if (tc->instance->gc_marking)
+            c->flags |= MVM_CF_GEN2_LIVE;
+        return c;
+    }
+    return MVM_gc_allocate_nursery(tc, size);
 }
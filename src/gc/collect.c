@@ -1,4 +1,5 @@
 #include "moar.h"
+#include <platform/threads.h>
 
 /* Combines a piece of work that will be passed to another thread with the
  * ID of the target thread to pass it to. */
@@ -19,6 +20,29 @@ static void pass_work_item(MVMThreadContext *tc, WorkToPass *wtp, MVMCollectable
 static void pass_leftover_work(MVMThreadContext *tc, WorkToPass *wtp);
 static void add_in_tray_to_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist);
 
+/* Swaps fromspace and tospace, allocating the new tospace if that didn't yet
+ * happen (we don't allocate it at startup, to cut memory use for threads
+ * that quit before a GC) or if the nursery was resized, and resets
+ * allocation to the start of it. */
+static void swap_nursery(MVMThreadContext *tc) {
+    void *fromspace = tc->nursery_tospace;
+    void *tospace   = tc->nursery_fromspace;
+    if (tospace && tc->nursery_fromspace_size != tc->nursery_size) {
+        MVM_free(tospace);
+        tospace = NULL;
+    }
+    if (!tospace)
+        tospace = MVM_calloc(1, tc->nursery_size);
+    tc->nursery_fromspace      = fromspace;
+    tc->nursery_fromspace_size = tc->nursery_tospace_size;
+    tc->nursery_tospace        = tospace;
+    tc->nursery_tospace_size   = tc->nursery_size;
+
+    /* Reset nursery allocation pointers to the new tospace. */
+    tc->nursery_alloc       = tospace;
+    tc->nursery_alloc_limit = (char *)tc->nursery_alloc + tc->nursery_tospace_size;
+}
+
 /* Does a garbage collection run. Exactly what it does is configured by the
  * couple of arguments that it takes.
  *
@@ -64,19 +88,8 @@ void MVM_gc_collect(MVMThreadContext *tc, MVMuint8 what_to_do, MVMuint8 gen) {
         process_worklist(tc, worklist, &wtp, gen);
     }
     else {
-        /* Main collection run. Swap fromspace and tospace, allocating the
-         * new tospace if that didn't yet happen (we don't allocate it at
-         * startup, to cut memory use for threads that quit before a GC). */
-        void *fromspace = tc->nursery_tospace;
-        void *tospace   = tc->nursery_fromspace;
-        if (!tospace)
-            tospace = MVM_calloc(1, MVM_NURSERY_SIZE);
-        tc->nursery_fromspace = fromspace;
-        tc->nursery_tospace   = tospace;
-
-        /* Reset nursery allocation pointers to the new tospace. */
-        tc->nursery_alloc       = tospace;
-        tc->nursery_alloc_limit = (char *)tc->nursery_alloc + MVM_NURSERY_SIZE;
+        /* Main collection run. Swap fromspace and tospace. */
+        swap_nursery(tc);
 
         /* Add permanent roots and process them; only one thread will do
         * this, since they are instance-wide. */
@@ -238,8 +251,10 @@ static void process_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, Work
             }
 
             /* Did we see it in the nursery before, or should we move it to
-             * gen2 anyway since it a persistent ID was requested? */
-            if (item->flags & (MVM_CF_NURSERY_SEEN | MVM_CF_HAS_OBJECT_ID)) {
+             * gen2 anyway since it a persistent ID was requested, or since
+             * tospace is full (which can happen when the nursery shrinks)? */
+            if ((item->flags & (MVM_CF_NURSERY_SEEN | MVM_CF_HAS_OBJECT_ID)) ||
+                    (char *)tc->nursery_alloc + item->size > (char *)tc->nursery_alloc_limit) {
                 /* Yes; we should move it to the second generation. Allocate
                  * space in the second generation. */
                 to_gen2 = 1;
@@ -275,9 +290,12 @@ static void process_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist, Work
                 }
 
                 /* If we're going to sweep the second generation, also need
-                 * to mark it as live. */
+                 * to mark it as live. If it's being marked incrementally,
+                 * it also needs scanning. */
                 if (gen == MVMGCGenerations_Both)
                     new_addr->flags |= MVM_CF_GEN2_LIVE;
+                else if (tc->instance->gc_marking)
+                    MVM_gc_incremental_promoted(tc, new_addr);
             }
             else {
                 /* No, so it will live in the nursery for another GC
@@ -366,6 +384,7 @@ void MVM_gc_mark_collectable(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMC
         MVM_gc_worklist_add(tc, worklist, &new_addr_st->WHAT);
         MVM_gc_worklist_add(tc, worklist, &new_addr_st->HOW);
         MVM_gc_worklist_add(tc, worklist, &new_addr_st->HOW_sc);
+        MVM_gc_worklist_add(tc, worklist, &new_addr_st->WHO_sc);
         MVM_gc_worklist_add(tc, worklist, &new_addr_st->method_cache_sc);
         if (new_addr_st->mode_flags & MVM_PARAMETRIC_TYPE) {
             MVM_gc_worklist_add(tc, worklist, &new_addr_st->paramet.ric.parameterizer);
@@ -401,6 +420,266 @@ void MVM_gc_mark_collectable(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMC
     }
 }
 
+/* Claims an object in fromspace for copying during a parallel nursery
+ * collection. Two threads may reach the same object at once, so this is done
+ * by a CAS on the machine word that holds the flags. Returns non-zero if we
+ * got it, and zero if another thread already claimed it. */
+static MVMint32 claim_for_copy(MVMCollectable *item) {
+    size_t  word_offset  = offsetof(MVMCollectable, flags) & ~(sizeof(AO_t) - 1);
+    size_t  flags_offset = offsetof(MVMCollectable, flags) - word_offset;
+    AO_t   *word         = (AO_t *)((char *)item + word_offset);
+    while (1) {
+        AO_t      old_word = MVM_load(word);
+        AO_t      new_word = old_word;
+        MVMuint16 flags;
+        memcpy(&flags, (char *)&old_word + flags_offset, sizeof(MVMuint16));
+        if (flags & (MVM_CF_GC_CLAIMED | MVM_CF_FORWARDER_VALID))
+            return 0;
+        flags |= MVM_CF_GC_CLAIMED;
+        memcpy((char *)&new_word + flags_offset, &flags, sizeof(MVMuint16));
+        if (MVM_trycas(word, old_word, new_word))
+            return 1;
+    }
+}
+
+/* Gets the forwarding address of an object that another thread claimed,
+ * waiting for it to finish copying the object if needed. */
+static MVMCollectable * await_forwarder(MVMCollectable *item) {
+    while (!(((volatile MVMCollectable *)item)->flags & MVM_CF_FORWARDER_VALID))
+        MVM_platform_thread_yield();
+    MVM_barrier();
+    return item->sc_forward_u.forwarder;
+}
+
+/* Checks if an object is in the tospace of any of the threads taking part in
+ * a parallel nursery collection, meaning it was already copied. */
+static MVMint32 in_parallel_tospace(MVMThreadContext *tc, MVMCollectable *item) {
+    MVMThreadContext **workers = tc->instance->gc_parallel_workers;
+    MVMuint32 num_workers = (MVMuint32)MVM_load(&tc->instance->gc_parallel_participants);
+    MVMuint32 i;
+    for (i = 0; i < num_workers; i++) {
+        char *tospace = (char *)workers[i]->nursery_tospace;
+        if ((char *)item >= tospace && (char *)item < tospace + workers[i]->nursery_tospace_size)
+            return 1;
+    }
+    return 0;
+}
+
+/* Processes a single item during a parallel nursery collection. Any objects
+ * that we copy end up in our own tospace or gen2, and are re-owned by us, no
+ * matter which thread allocated them; that is what lets any thread pick up
+ * any piece of work, rather than passing it to the owner. Things that need
+ * visiting as a result are added to the (non-gen2) worklist. */
+static void process_item_parallel(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMCollectable **item_ptr) {
+    MVMCollectable *item = *item_ptr;
+    MVMCollectable *new_addr;
+    MVMuint8        to_gen2 = 0;
+    MVMuint32       gen2count;
+
+    /* Nothing to do for NULLs and gen2 objects; if it was already copied
+     * then just update the pointer. */
+    if (item == NULL || (item->flags & MVM_CF_SECOND_GEN))
+        return;
+    if (item->flags & MVM_CF_FORWARDER_VALID) {
+        *item_ptr = await_forwarder(item);
+        return;
+    }
+    if (in_parallel_tospace(tc, item))
+        return;
+
+    /* Try to claim it; if another thread beat us to it, then use the address
+     * it copies it to. */
+    if (!claim_for_copy(item)) {
+        *item_ptr = await_forwarder(item);
+        return;
+    }
+
+    /* If it was seen before or has a persistent ID, promote it; we also do
+     * so if our tospace is full, which can happen since we may be copying
+     * objects from other threads' nurseries. */
+    if ((item->flags & (MVM_CF_NURSERY_SEEN | MVM_CF_HAS_OBJECT_ID)) ||
+            (char *)tc->nursery_alloc + item->size > (char *)tc->nursery_alloc_limit) {
+        to_gen2 = 1;
+        if (item->flags & MVM_CF_HAS_OBJECT_ID) {
+            new_addr = MVM_gc_object_id_use_allocation(tc, item);
+            memcpy(new_addr, item, item->size);
+        }
+        else {
+            new_addr = MVM_gc_gen2_allocate(tc->gen2, item->size);
+            memcpy(new_addr, item, item->size);
+            new_addr->owner = tc->thread_id;
+        }
+        tc->gc_promoted_bytes += item->size;
+        new_addr->flags &= ~(MVM_CF_NURSERY_SEEN | MVM_CF_GC_CLAIMED);
+        new_addr->flags |= MVM_CF_SECOND_GEN;
+        if (tc->instance->gc_marking)
+            MVM_gc_incremental_promoted(tc, new_addr);
+
+        /* If it's a frame with an active work area, we need to keep on
+         * visiting it. Also add on object's unmanaged size. */
+        if (new_addr->flags & MVM_CF_FRAME) {
+            if (((MVMFrame *)new_addr)->work)
+                MVM_gc_root_gen2_add(tc, (MVMCollectable *)new_addr);
+        }
+        else if (!(new_addr->flags & (MVM_CF_TYPE_OBJECT | MVM_CF_STABLE))) {
+            MVMObject *new_obj_addr = (MVMObject *)new_addr;
+            if (REPR(new_obj_addr)->unmanaged_size)
+                tc->gc_promoted_bytes += REPR(new_obj_addr)->unmanaged_size(tc,
+                    STABLE(new_obj_addr), OBJECT_BODY(new_obj_addr));
+        }
+    }
+    else {
+        new_addr = (MVMCollectable *)tc->nursery_alloc;
+        tc->nursery_alloc = (char *)tc->nursery_alloc + item->size;
+        memcpy(new_addr, item, item->size);
+        new_addr->flags &= ~MVM_CF_GC_CLAIMED;
+        new_addr->flags |= MVM_CF_NURSERY_SEEN;
+        new_addr->owner = tc->thread_id;
+    }
+    GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : parallel copy of object %p of size %d to %p\n",
+        item, item->size, new_addr);
+
+    /* Publish the forwarding pointer before flagging it valid, since other
+     * threads may be waiting on it. */
+    item->sc_forward_u.forwarder = new_addr;
+    MVM_barrier();
+    item->flags |= MVM_CF_FORWARDER_VALID;
+    *item_ptr = new_addr;
+
+    /* Mark it, applying the write barrier if it went to gen2 and points to
+     * nursery objects. */
+    gen2count = worklist->items;
+    MVM_gc_mark_collectable(tc, worklist, new_addr);
+    if (to_gen2) {
+        MVMuint32 max = worklist->items, k;
+        for (k = gen2count; k < max; k++) {
+            MVMCollectable **j = worklist->list[k];
+            if (*j)
+                MVM_gc_write_barrier(tc, new_addr, *j);
+        }
+    }
+}
+
+/* Processes the worklist and our work-stealing deque until both are empty,
+ * moving things from the worklist onto the deque so that other threads can
+ * steal them. */
+static void process_parallel(MVMThreadContext *tc, MVMGCWorklist *worklist) {
+    MVMGCDeque       *deque = tc->gc_deque;
+    MVMCollectable  **item_ptr;
+    while (1) {
+        while ((item_ptr = MVM_gc_worklist_get(tc, worklist)))
+            MVM_gc_deque_push(tc, deque, item_ptr);
+        item_ptr = MVM_gc_deque_pop(tc, deque);
+        if (!item_ptr)
+            break;
+        process_item_parallel(tc, worklist, item_ptr);
+    }
+}
+
+/* Once we've run out of work of our own, steal it from other threads until
+ * all of them are idle too. A thread only ever adds work to its deque when
+ * it is counted as active, so once the active count reaches zero all of the
+ * deques are empty and the collection is done. */
+static void steal_parallel(MVMThreadContext *tc, MVMGCWorklist *worklist) {
+    MVMInstance       *instance    = tc->instance;
+    MVMThreadContext **workers     = instance->gc_parallel_workers;
+    MVMuint32          num_workers = (MVMuint32)MVM_load(&instance->gc_parallel_participants);
+    MVMuint32          i;
+
+    MVM_decr(&instance->gc_parallel_active);
+    while (MVM_load(&instance->gc_parallel_active)) {
+        MVMuint32 found = 0;
+        for (i = 0; i < num_workers; i++) {
+            MVMThreadContext *victim = workers[(i + tc->thread_id) % num_workers];
+            if (victim != tc && !MVM_gc_deque_is_empty(tc, victim->gc_deque)) {
+                MVMCollectable **item_ptr;
+                MVM_incr(&instance->gc_parallel_active);
+                item_ptr = MVM_gc_deque_steal(tc, victim->gc_deque);
+                if (item_ptr) {
+                    process_item_parallel(tc, worklist, item_ptr);
+                    process_parallel(tc, worklist);
+                    found = 1;
+                }
+                MVM_decr(&instance->gc_parallel_active);
+                break;
+            }
+        }
+        if (!found)
+            MVM_platform_thread_yield();
+    }
+}
+
+/* Does the main collection run of a nursery collection in parallel with the
+ * other threads taking part in the GC run. Rather than each thread copying
+ * only the objects it allocated, and passing pointers to other objects over
+ * to the owning thread, each thread starts from its own roots and then takes
+ * work from threads that have more than they do. Objects are claimed with
+ * an atomic operation before being copied. This is only used for nursery
+ * collections; full collections are still done by MVM_gc_collect. */
+void MVM_gc_collect_parallel(MVMThreadContext *tc, MVMuint8 what_to_do) {
+    MVMInstance   *instance = tc->instance;
+    MVMGCWorklist *worklist;
+    MVMuint32      num_workers, i;
+
+    /* Swap the semi-spaces of ourself and any thread we're doing the work
+     * of, then register ourself as a worker. Nobody may start copying until
+     * every worker has done so, since a stale tospace would make an object
+     * look like it was already copied. */
+    if (tc->gc_deque)
+        MVM_gc_deque_reset(tc, tc->gc_deque);
+    else
+        tc->gc_deque = MVM_gc_deque_create(tc);
+    for (i = 0; i < tc->gc_work_count; i++)
+        swap_nursery(tc->gc_work[i].tc);
+    MVM_store(&instance->gc_parallel_workers[MVM_incr(&instance->gc_parallel_ready)], tc);
+    num_workers = (MVMuint32)MVM_load(&instance->gc_parallel_participants);
+    for (i = 0; i < num_workers; i++)
+        while (!MVM_load(&instance->gc_parallel_workers[i]))
+            MVM_platform_thread_yield();
+
+    /* Add the roots of ourself and the threads we're doing the work of, and
+     * process them. */
+    worklist = MVM_gc_worklist_create(tc, 0);
+    for (i = 0; i < tc->gc_work_count; i++) {
+        MVMThreadContext *other = tc->gc_work[i].tc;
+        if (other == tc && what_to_do != MVMGCWhatToDo_NoInstance) {
+            MVM_gc_root_add_permanents_to_worklist(tc, worklist, NULL);
+            process_parallel(tc, worklist);
+            MVM_gc_root_add_instance_roots_to_worklist(tc, worklist, NULL);
+            process_parallel(tc, worklist);
+        }
+        MVM_gc_root_add_tc_roots_to_worklist(other, worklist, NULL);
+        process_parallel(tc, worklist);
+        if (other->cur_frame && MVM_FRAME_IS_ON_CALLSTACK(other, other->cur_frame)) {
+            MVMFrame *cur_frame = other->cur_frame;
+            while (cur_frame && MVM_FRAME_IS_ON_CALLSTACK(other, cur_frame)) {
+                MVM_gc_root_add_frame_roots_to_worklist(other, worklist, cur_frame);
+                process_parallel(tc, worklist);
+                cur_frame = cur_frame->caller;
+            }
+        }
+        else {
+            MVM_gc_worklist_add(tc, worklist, &other->cur_frame);
+            process_parallel(tc, worklist);
+        }
+        MVM_gc_root_add_temps_to_worklist(other, worklist, NULL);
+        process_parallel(tc, worklist);
+        MVM_gc_root_add_gen2s_to_worklist(other, worklist);
+        process_parallel(tc, worklist);
+    }
+
+    /* Help out the other threads until everyone is done. */
+    steal_parallel(tc, worklist);
+    MVM_gc_worklist_destroy(tc, worklist);
+
+    /* Nobody else will copy into our tospace now; zero out what's left of
+     * it, and of the tospaces of any threads we did the work of. */
+    for (i = 0; i < tc->gc_work_count; i++) {
+        MVMThreadContext *other = tc->gc_work[i].tc;
+        memset(other->nursery_alloc, 0, (char *)other->nursery_alloc_limit - (char *)other->nursery_alloc);
+    }
+}
+
 /* Adds a chunk of work to another thread's in-tray. */
 static void push_work_to_thread_in_tray(MVMThreadContext *tc, MVMuint32 target, MVMGCPassedWork *work) {
     MVMGCPassedWork * volatile *target_tray;
@@ -592,6 +871,57 @@ void MVM_gc_collect_free_nursery_uncopied(MVMThreadContext *tc, void *limit) {
     }
 }
 
+/* Decides on the size the nursery will have after its next collection, from
+ * how full it was at this one, how much of what was allocated survived (to
+ * tospace or gen2), and how long it was since the previous one. Each thread
+ * can take any part in a GC run; only a thread that allocates quickly will
+ * have filled its nursery in a short time, and only one that allocates very
+ * little will have used just a bit of it. The sizes and any resize go into
+ * the telemetry, under the thread whose nursery it is. */
+void MVM_gc_collect_size_nursery(MVMThreadContext *tc, void *limit) {
+    MVMuint64 now      = uv_hrtime();
+    MVMuint64 interval = now - tc->nursery_last_collect;
+    MVMuint64 size     = tc->nursery_fromspace_size;
+    MVMuint64 used     = (char *)limit - (char *)tc->nursery_fromspace;
+    MVMuint64 survived = ((char *)tc->nursery_alloc - (char *)tc->nursery_tospace)
+        + tc->gc_promoted_bytes;
+    MVMuint32 new_size = tc->nursery_size;
+    unsigned int interval_id;
+
+    tc->nursery_last_collect = now;
+
+    if (100 * used >= MVM_NURSERY_GROW_FULL_PERCENT * size
+            && interval < MVM_NURSERY_GROW_INTERVAL
+            && 100 * survived < MVM_NURSERY_GROW_SURVIVAL_PERCENT * used) {
+        tc->nursery_idle_collects = 0;
+        if (size * 2 > new_size)
+            new_size = size * 2 < tc->instance->nursery_max_size
+                ? size * 2
+                : tc->instance->nursery_max_size;
+    }
+    else if (100 * used < MVM_NURSERY_SHRINK_USED_PERCENT * size) {
+        if (++tc->nursery_idle_collects >= MVM_NURSERY_SHRINK_COLLECTIONS) {
+            tc->nursery_idle_collects = 0;
+            new_size = size / 2 > tc->instance->nursery_min_size
+                ? size / 2
+                : tc->instance->nursery_min_size;
+        }
+    }
+    else {
+        tc->nursery_idle_collects = 0;
+    }
+
+    interval_id = MVM_telemetry_interval_start(tc, "nursery sizing");
+    MVM_telemetry_interval_annotate(size, interval_id, "nursery size");
+    MVM_telemetry_interval_annotate(used, interval_id, "nursery bytes used");
+    MVM_telemetry_interval_annotate(survived, interval_id, "nursery bytes survived");
+    if (new_size != tc->nursery_size) {
+        MVM_telemetry_interval_annotate(new_size, interval_id, "nursery resized to");
+        tc->nursery_size = new_size;
+    }
+    MVM_telemetry_interval_stop(tc, interval_id, "nursery sizing");
+}
+
 /* Free STables (in any thread/generation!) queued to be freed. */
 void MVM_gc_collect_free_stables(MVMThreadContext *tc) {
     MVMSTable *st = tc->instance->stables_to_free;
@@ -604,124 +934,127 @@ void MVM_gc_collect_free_stables(MVMThreadContext *tc) {
     tc->instance->stables_to_free = NULL;
 }
 
-/* Goes through the unmarked objects in the second generation heap and builds
- * free lists out of them. Also does any required finalization. */
-void MVM_gc_collect_free_gen2_unmarked(MVMThreadContext *tc, MVMint32 global_destruction) {
-    /* Visit each of the size class bins. */
-    MVMGen2Allocator *gen2 = tc->gen2;
-    MVMuint32 bin, obj_size, page, i;
+/* Goes through the unmarked objects in a size class bin of the second
+ * generation heap and builds a free list out of them, up to the given number
+ * of pages and allocation position in the last of those. Also does any
+ * required finalization. */
+static void free_gen2_unmarked_bin(MVMThreadContext *tc, MVMGen2Allocator *gen2, MVMuint32 bin,
+        MVMuint32 num_pages, char *last_alloc_pos, MVMint32 global_destruction) {
+    MVMuint32 obj_size, page;
     char ***freelist_insert_pos;
-    for (bin = 0; bin < MVM_GEN2_BINS; bin++) {
-        /* If we've nothing allocated in this size class, skip it. */
-        if (gen2->size_classes[bin].pages == NULL)
-            continue;
 
-        /* Calculate object size for this bin. */
-        obj_size = (bin + 1) << MVM_GEN2_BIN_BITS;
-
-        /* freelist_insert_pos is a pointer to a memory location that
-         * stores the address of the last traversed free list node (char **). */
-        /* Initialize freelist insertion position to free list head. */
-        freelist_insert_pos = &gen2->size_classes[bin].free_list;
-
-        /* Visit each page. */
-        for (page = 0; page < gen2->size_classes[bin].num_pages; page++) {
-            /* Visit all the objects, looking for dead ones and reset the
-             * mark for each of them. */
-            char *cur_ptr = gen2->size_classes[bin].pages[page];
-            char *end_ptr = page + 1 == gen2->size_classes[bin].num_pages
-                ? gen2->size_classes[bin].alloc_pos
-                : cur_ptr + obj_size * MVM_GEN2_PAGE_ITEMS;
-            while (cur_ptr < end_ptr) {
-                MVMCollectable *col = (MVMCollectable *)cur_ptr;
-
-                /* Is this already a free list slot? If so, it becomes the
-                 * new free list insert position. */
-                if (*freelist_insert_pos == (char **)cur_ptr) {
-                    freelist_insert_pos = (char ***)cur_ptr;
-                }
+    /* Calculate object size for this bin. */
+    obj_size = (bin + 1) << MVM_GEN2_BIN_BITS;
+
+    /* freelist_insert_pos is a pointer to a memory location that
+     * stores the address of the last traversed free list node (char **). */
+    /* Initialize freelist insertion position to free list head. */
+    freelist_insert_pos = &gen2->size_classes[bin].free_list;
+
+    /* Visit each page. */
+    for (page = 0; page < num_pages; page++) {
+        /* Visit all the objects, looking for dead ones and reset the
+         * mark for each of them. */
+        char *cur_ptr = gen2->size_classes[bin].pages[page];
+        char *end_ptr = page + 1 == num_pages
+            ? last_alloc_pos
+            : cur_ptr + obj_size * MVM_GEN2_PAGE_ITEMS;
+        while (cur_ptr < end_ptr) {
+            MVMCollectable *col = (MVMCollectable *)cur_ptr;
+
+            /* Is this already a free list slot? If so, it becomes the
+             * new free list insert position. */
+            if (*freelist_insert_pos == (char **)cur_ptr) {
+                freelist_insert_pos = (char ***)cur_ptr;
+            }
 
-                /* Otherwise, it must be a collectable of some kind. Is it
-                 * live? */
-                else if (col->flags & MVM_CF_GEN2_LIVE) {
-                    /* Yes; clear the mark. */
-                    col->flags &= ~MVM_CF_GEN2_LIVE;
+            /* Otherwise, it must be a collectable of some kind. Is it
+             * live? */
+            else if (col->flags & MVM_CF_GEN2_LIVE) {
+                /* Yes; clear the mark. */
+                col->flags &= ~MVM_CF_GEN2_LIVE;
+            }
+            else {
+                GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : collecting an object %p in the gen2\n", col);
+                /* No, it's dead. Do any cleanup. */
+                if (col->flags & MVM_CF_TYPE_OBJECT) {
+#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
+                    if (col->flags & MVM_CF_SERIALZATION_INDEX_ALLOCATED)
+                        MVM_free(col->sc_forward_u.sci);
+#endif
                 }
-                else {
-                    GCDEBUG_LOG(tc, MVM_GC_DEBUG_COLLECT, "Thread %d run %d : collecting an object %p in the gen2\n", col);
-                    /* No, it's dead. Do any cleanup. */
-                    if (col->flags & MVM_CF_TYPE_OBJECT) {
+                else if (col->flags & MVM_CF_STABLE) {
+                    if (
 #ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
-                        if (col->flags & MVM_CF_SERIALZATION_INDEX_ALLOCATED)
-                            MVM_free(col->sc_forward_u.sci);
+                        !(col->flags & MVM_CF_SERIALZATION_INDEX_ALLOCATED) &&
 #endif
+                        col->sc_forward_u.sc.sc_idx == 0
+                        && col->sc_forward_u.sc.idx == MVM_DIRECT_SC_IDX_SENTINEL) {
+                        /* We marked it dead last time, kill it. */
+                        MVM_6model_stable_gc_free(tc, (MVMSTable *)col);
                     }
-                    else if (col->flags & MVM_CF_STABLE) {
-                        if (
+                    else {
 #ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
-                            !(col->flags & MVM_CF_SERIALZATION_INDEX_ALLOCATED) &&
-#endif
-                            col->sc_forward_u.sc.sc_idx == 0
-                            && col->sc_forward_u.sc.idx == MVM_DIRECT_SC_IDX_SENTINEL) {
-                            /* We marked it dead last time, kill it. */
-                            MVM_6model_stable_gc_free(tc, (MVMSTable *)col);
+                        if (col->flags & MVM_CF_SERIALZATION_INDEX_ALLOCATED) {
+                            /* Whatever happens next, we can free this
+                               memory immediately, because no-one will be
+                               serializing a dead STable. */
+                            assert(!(col->sc_forward_u.sci->sc_idx == 0
+                                     && col->sc_forward_u.sci->idx
+                                     == MVM_DIRECT_SC_IDX_SENTINEL));
+                            MVM_free(col->sc_forward_u.sci);
+                            col->flags &= ~MVM_CF_SERIALZATION_INDEX_ALLOCATED;
                         }
-                        else {
-#ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
-                            if (col->flags & MVM_CF_SERIALZATION_INDEX_ALLOCATED) {
-                                /* Whatever happens next, we can free this
-                                   memory immediately, because no-one will be
-                                   serializing a dead STable. */
-                                assert(!(col->sc_forward_u.sci->sc_idx == 0
-                                         && col->sc_forward_u.sci->idx
-                                         == MVM_DIRECT_SC_IDX_SENTINEL));
-                                MVM_free(col->sc_forward_u.sci);
-                                col->flags &= ~MVM_CF_SERIALZATION_INDEX_ALLOCATED;
-                            }
 #endif
-                            if (global_destruction) {
-                                /* We're in global destruction, so enqueue to the end
-                                 * like we do in the nursery */
-                                MVM_gc_collect_enqueue_stable_for_deletion(tc, (MVMSTable *)col);
-                            } else {
-                                /* There will definitely be another gc run, so mark it as "died last time". */
-                                col->sc_forward_u.sc.sc_idx = 0;
-                                col->sc_forward_u.sc.idx = MVM_DIRECT_SC_IDX_SENTINEL;
-                            }
-                            /* Skip the freelist updating. */
-                            cur_ptr += obj_size;
-                            continue;
+                        if (global_destruction) {
+                            /* We're in global destruction, so enqueue to the end
+                             * like we do in the nursery */
+                            MVM_gc_collect_enqueue_stable_for_deletion(tc, (MVMSTable *)col);
+                        } else {
+                            /* There will definitely be another gc run, so mark it as "died last time". */
+                            col->sc_forward_u.sc.sc_idx = 0;
+                            col->sc_forward_u.sc.idx = MVM_DIRECT_SC_IDX_SENTINEL;
                         }
+                        /* Skip the freelist updating. */
+                        cur_ptr += obj_size;
+                        continue;
                     }
-                    else if (col->flags & MVM_CF_FRAME) {
-                        MVM_frame_destroy(tc, (MVMFrame *)col);
-                    }
-                    else {
-                        /* Object instance; call gc_free if needed. */
-                        MVMObject *obj = (MVMObject *)col;
-                        if (STABLE(obj) && REPR(obj)->gc_free)
-                            REPR(obj)->gc_free(tc, obj);
+                }
+                else if (col->flags & MVM_CF_FRAME) {
+                    MVM_frame_destroy(tc, (MVMFrame *)col);
+                }
+                else {
+                    /* Object instance; call gc_free if needed. */
+                    MVMObject *obj = (MVMObject *)col;
+                    if (STABLE(obj) && REPR(obj)->gc_free)
+                        REPR(obj)->gc_free(tc, obj);
 #ifdef MVM_USE_OVERFLOW_SERIALIZATION_INDEX
-                        if (col->flags & MVM_CF_SERIALZATION_INDEX_ALLOCATED)
-                            MVM_free(col->sc_forward_u.sci);
+                    if (col->flags & MVM_CF_SERIALZATION_INDEX_ALLOCATED)
+                        MVM_free(col->sc_forward_u.sci);
 #endif
-                    }
-
-                    /* Chain in to the free list. */
-                    *((char **)cur_ptr) = (char *)*freelist_insert_pos;
-                    *freelist_insert_pos = (char **)cur_ptr;
-
-                    /* Update the pointer to the insert position to point to us */
-                    freelist_insert_pos = (char ***)cur_ptr;
                 }
 
-                /* Move to the next object. */
-                cur_ptr += obj_size;
+                /* Chain in to the free list. */
+                *((char **)cur_ptr) = (char *)*freelist_insert_pos;
+                *freelist_insert_pos = (char **)cur_ptr;
+
+                /* Update the pointer to the insert position to point to us */
+                freelist_insert_pos = (char ***)cur_ptr;
             }
+
+            /* Move to the next object. */
+            cur_ptr += obj_size;
         }
     }
-    
-    /* Also need to consider overflows. */
+
+    /* The bin is no longer waiting to be swept. */
+    gen2->size_classes[bin].sweep_pages     = 0;
+    gen2->size_classes[bin].sweep_alloc_pos = NULL;
+}
+
+/* Frees unmarked over-sized objects in the second generation. */
+static void free_gen2_unmarked_overflows(MVMThreadContext *tc, MVMGen2Allocator *gen2) {
+    MVMuint32 i;
     for (i = 0; i < gen2->num_overflows; i++) {
         if (gen2->overflows[i]) {
             MVMCollectable *col = gen2->overflows[i];
@@ -753,3 +1086,53 @@ void MVM_gc_collect_free_gen2_unmarked(MVMThreadContext *tc, MVMint32 global_des
     /* And finally compact the overflow list */
     MVM_gc_gen2_compact_overflows(gen2);
 }
+
+/* Goes through the unmarked objects in the second generation heap and builds
+ * free lists out of them. Also does any required finalization. */
+void MVM_gc_collect_free_gen2_unmarked(MVMThreadContext *tc, MVMint32 global_destruction) {
+    /* Visit each of the size class bins. */
+    MVMGen2Allocator *gen2 = tc->gen2;
+    MVMuint32 bin;
+    for (bin = 0; bin < MVM_GEN2_BINS; bin++) {
+        /* If we've nothing allocated in this size class, skip it. */
+        if (gen2->size_classes[bin].pages == NULL)
+            continue;
+        free_gen2_unmarked_bin(tc, gen2, bin, gen2->size_classes[bin].num_pages,
+            gen2->size_classes[bin].alloc_pos, global_destruction);
+    }
+
+    /* Also need to consider overflows. */
+    free_gen2_unmarked_overflows(tc, gen2);
+}
+
+/* Called when an incremental marking cycle completes. Frees the unmarked
+ * over-sized objects right away, but only notes how far each size class bin
+ * should be swept; that is done by MVM_gc_collect_free_gen2_pending. */
+void MVM_gc_collect_free_gen2_unmarked_lazily(MVMThreadContext *tc) {
+    MVMGen2Allocator *gen2 = tc->gen2;
+    MVMuint32 bin;
+    for (bin = 0; bin < MVM_GEN2_BINS; bin++) {
+        if (gen2->size_classes[bin].pages == NULL)
+            continue;
+        gen2->size_classes[bin].sweep_pages     = gen2->size_classes[bin].num_pages;
+        gen2->size_classes[bin].sweep_alloc_pos = gen2->size_classes[bin].alloc_pos;
+    }
+    free_gen2_unmarked_overflows(tc, gen2);
+}
+
+/* Sweeps size class bins that are waiting for it, until they're all done or
+ * the deadline (compared with uv_hrtime; 0 for none) has passed. Returns
+ * non-zero if there are bins still waiting to be swept. */
+MVMint32 MVM_gc_collect_free_gen2_pending(MVMThreadContext *tc, MVMuint64 deadline) {
+    MVMGen2Allocator *gen2 = tc->gen2;
+    MVMuint32 bin;
+    for (bin = 0; bin < MVM_GEN2_BINS; bin++) {
+        if (!gen2->size_classes[bin].sweep_pages)
+            continue;
+        if (deadline && uv_hrtime() >= deadline)
+            return 1;
+        free_gen2_unmarked_bin(tc, gen2, bin, gen2->size_classes[bin].sweep_pages,
+            gen2->size_classes[bin].sweep_alloc_pos, 0);
+    }
+    return 0;
+}
@@ -1,7 +1,24 @@
 /* How big is the nursery area? Note that since it's semi-space copying, we
- * actually have double this amount allocated. Also it is per thread. (In
- * the future, we'll make this adaptive rather than a constant.) */
+ * actually have double this amount allocated. Also it is per thread. This is
+ * the size a thread starts out with; after that, it adapts to how the thread
+ * allocates, within the bounds below (which can be changed with the
+ * MVM_NURSERY_MIN_SIZE and MVM_NURSERY_MAX_SIZE environment variables). */
 #define MVM_NURSERY_SIZE 4194304
+#define MVM_NURSERY_MIN_SIZE 524288
+#define MVM_NURSERY_MAX_SIZE 33554432
+
+/* A nursery is doubled in size when it filled up (to at least this percent)
+ * within this many nanoseconds of its last collection, and fewer than this
+ * percent of the bytes allocated in it survived. Collecting it less often
+ * then costs little more per collection, since few objects get copied. */
+#define MVM_NURSERY_GROW_FULL_PERCENT       75
+#define MVM_NURSERY_GROW_INTERVAL           50000000
+#define MVM_NURSERY_GROW_SURVIVAL_PERCENT   10
+
+/* A nursery is halved in size after this many collections in a row found
+ * less than this percent of it used, as is typical of idle threads. */
+#define MVM_NURSERY_SHRINK_USED_PERCENT     12
+#define MVM_NURSERY_SHRINK_COLLECTIONS      4
 
 /* How many bytes should have been promoted into gen2 before we decide to
  * do a full GC run? This defaults to a percentage of the resident set, with
@@ -48,7 +65,11 @@ struct MVMGCPassedWork {
 
 /* Functions. */
 void MVM_gc_collect(MVMThreadContext *tc, MVMuint8 what_to_do, MVMuint8 gen);
+void MVM_gc_collect_parallel(MVMThreadContext *tc, MVMuint8 what_to_do);
 void MVM_gc_collect_free_nursery_uncopied(MVMThreadContext *tc, void *limit);
+void MVM_gc_collect_size_nursery(MVMThreadContext *tc, void *limit);
 void MVM_gc_collect_free_gen2_unmarked(MVMThreadContext *tc, MVMint32 global_destruction);
+void MVM_gc_collect_free_gen2_unmarked_lazily(MVMThreadContext *tc);
+MVMint32 MVM_gc_collect_free_gen2_pending(MVMThreadContext *tc, MVMuint64 deadline);
 void MVM_gc_mark_collectable(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMCollectable *item);
 void MVM_gc_collect_free_stables(MVMThreadContext *tc);
@@ -95,6 +95,10 @@ static void walk_thread_finalize_queue(MVMThreadContext *tc, MVMuint8 gen) {
                 add_to_finalizing(tc, tc->finalize[i]);
             }
         }
+        else {
+            /* In gen2, and we're only collecting the nursery; keep it. */
+            tc->finalize[collapse_pos++] = tc->finalize[i];
+        }
     }
     tc->num_finalize = collapse_pos;
 }
@@ -111,3 +115,37 @@ void MVM_finalize_walk_queues(MVMThreadContext *tc, MVMuint8 gen) {
         cur_thread = cur_thread->body.next;
     }
 }
+
+/* Walks the finalize queues at the end of an incremental marking cycle. The
+ * nursery objects in them were already handled by the nursery collection,
+ * so this just looks for gen2 objects that were not marked. Those are moved
+ * to the finalizing list, and marked (along with all they reference) so
+ * they stay around until the finalize handler has been run. */
+void MVM_finalize_walk_queues_gen2(MVMThreadContext *tc) {
+    MVMThread *cur_thread = (MVMThread *)MVM_load(&tc->instance->threads);
+    while (cur_thread) {
+        MVMThreadContext *other = cur_thread->body.tc;
+        if (other) {
+            MVMuint32 had_finalizing = other->num_finalizing;
+            MVMuint32 collapse_pos   = 0;
+            MVMuint32 i;
+            for (i = 0; i < other->num_finalize; i++) {
+                MVMuint32 flags = other->finalize[i]->header.flags;
+                if ((flags & (MVM_CF_SECOND_GEN | MVM_CF_GEN2_LIVE)) == MVM_CF_SECOND_GEN) {
+                    add_to_finalizing(other, other->finalize[i]);
+                    MVM_gc_incremental_shade(tc, (MVMCollectable *)other->finalize[i]);
+                }
+                else {
+                    other->finalize[collapse_pos++] = other->finalize[i];
+                }
+            }
+            other->num_finalize = collapse_pos;
+            if (other->num_finalizing > had_finalizing) {
+                MVM_gc_incremental_drain(tc);
+                if (!had_finalizing)
+                    setup_finalize_handler_call(other);
+            }
+        }
+        cur_thread = cur_thread->body.next;
+    }
+}
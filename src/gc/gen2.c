@@ -73,8 +73,9 @@ void * MVM_gc_gen2_allocate(MVMGen2Allocator *al, MVMuint32 size) {
         if (al->size_classes[bin].pages == NULL)
             setup_bin(al, bin);
 
-        /* If there's a free list entry, use that. */
-        if (al->size_classes[bin].free_list) {
+        /* If there's a free list entry, use that (unless the bin is waiting
+         * to be swept, since sweeping relies on the free list). */
+        if (al->size_classes[bin].free_list && !al->size_classes[bin].sweep_pages) {
             result = (void *)al->size_classes[bin].free_list;
             al->size_classes[bin].free_list = (char **)*(al->size_classes[bin].free_list);
         }
@@ -20,6 +20,13 @@ struct MVMGen2SizeClass {
 
     /* The number of pages allocated. */
     MVMuint32 num_pages;
+
+    /* If an incremental full collection marked this bin but it was not yet
+     * swept, the number of pages and the allocation position in the last of
+     * them when marking completed; only that part of the bin is swept, and
+     * the free list is not used until it has been. Otherwise, 0 and NULL. */
+    MVMuint32 sweep_pages;
+    char     *sweep_alloc_pos;
 };
 
 /* An "instance" of the fixed size allocator. */
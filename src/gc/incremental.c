@@ -0,0 +1,274 @@
+#include "moar.h"
+
+/* Pushes a gen2 object that has been marked live onto the mark stack, so it
+ * will be scanned in this or a later slice. */
+static void push(MVMInstance *instance, MVMCollectable *c) {
+    if (instance->num_gc_mark_stack == instance->alloc_gc_mark_stack) {
+        instance->alloc_gc_mark_stack = instance->alloc_gc_mark_stack
+            ? instance->alloc_gc_mark_stack * 2
+            : 4096;
+        instance->gc_mark_stack = MVM_realloc(instance->gc_mark_stack,
+            instance->alloc_gc_mark_stack * sizeof(MVMCollectable *));
+    }
+    instance->gc_mark_stack[instance->num_gc_mark_stack++] = c;
+}
+
+/* Shades a collectable: if it's in gen2 and not yet marked live, marks it
+ * and puts it on the mark stack. Must only be called while the world is
+ * stopped. */
+void MVM_gc_incremental_shade(MVMThreadContext *tc, MVMCollectable *c) {
+    if (c && (c->flags & (MVM_CF_SECOND_GEN | MVM_CF_GEN2_LIVE)) == MVM_CF_SECOND_GEN) {
+        c->flags |= MVM_CF_GEN2_LIVE;
+        push(tc->instance, c);
+    }
+}
+
+/* Queues an object on the thread's own mark queue; the mutator can't touch
+ * the instance-wide mark stack, but these are picked up at the next pause. */
+static void queue(MVMThreadContext *tc, MVMCollectable *c) {
+    if (tc->num_gc_mark_queue == tc->alloc_gc_mark_queue) {
+        tc->alloc_gc_mark_queue = tc->alloc_gc_mark_queue
+            ? tc->alloc_gc_mark_queue * 2
+            : 256;
+        tc->gc_mark_queue = MVM_realloc(tc->gc_mark_queue,
+            tc->alloc_gc_mark_queue * sizeof(MVMCollectable *));
+    }
+    tc->gc_mark_queue[tc->num_gc_mark_queue++] = c;
+}
+
+/* Called by the write barrier while marking, with a gen2 object that has not
+ * yet been marked live. */
+void MVM_gc_incremental_barrier_hit(MVMThreadContext *tc, MVMCollectable *referenced) {
+    queue(tc, referenced);
+}
+
+/* Called when a nursery collection promotes an object while marking. It is
+ * considered live for this cycle, but it still needs scanning, since stores
+ * into it while it was in the nursery were not barriered. */
+void MVM_gc_incremental_promoted(MVMThreadContext *tc, MVMCollectable *c) {
+    c->flags |= MVM_CF_GEN2_LIVE;
+    queue(tc, c);
+}
+
+/* Moves everything from the threads' mark queues onto the mark stack. */
+static void take_queues(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    MVMThread *cur_thread = (MVMThread *)MVM_load(&instance->threads);
+    while (cur_thread) {
+        MVMThreadContext *other = cur_thread->body.tc;
+        if (other) {
+            MVMuint32 i;
+            for (i = 0; i < other->num_gc_mark_queue; i++) {
+                MVMCollectable *c = other->gc_mark_queue[i];
+                if (c->flags & MVM_CF_GEN2_LIVE) {
+                    /* Promoted; already marked but not scanned. */
+                    push(instance, c);
+                }
+                else {
+                    MVM_gc_incremental_shade(tc, c);
+                    instance->gc_mark_barrier_hits++;
+                }
+            }
+            other->num_gc_mark_queue = 0;
+        }
+        cur_thread = cur_thread->body.next;
+    }
+}
+
+/* Shades the gen2 objects referenced from the slots on a worklist. Nursery
+ * objects are of no interest; the nurseries are scanned in full at the end
+ * of the marking cycle. */
+static void shade_worklist(MVMThreadContext *tc, MVMGCWorklist *worklist) {
+    MVMCollectable **item_ptr;
+    while ((item_ptr = MVM_gc_worklist_get(tc, worklist)))
+        MVM_gc_incremental_shade(tc, *item_ptr);
+}
+
+/* Shades everything directly referenced by the roots and by the objects in
+ * the nurseries. None of these references are covered by the write barrier,
+ * so this is done at the start and again at the end of a marking cycle. */
+static void shade_roots(MVMThreadContext *tc, MVMGCWorklist *worklist) {
+    MVMThread *cur_thread = (MVMThread *)MVM_load(&tc->instance->threads);
+
+    MVM_gc_root_add_permanents_to_worklist(tc, worklist, NULL);
+    MVM_gc_root_add_instance_roots_to_worklist(tc, worklist, NULL);
+    shade_worklist(tc, worklist);
+
+    while (cur_thread) {
+        MVMThreadContext *other = cur_thread->body.tc;
+        if (other) {
+            char *scan;
+            MVMuint32 i;
+
+            MVM_gc_root_add_tc_roots_to_worklist(other, worklist, NULL);
+            if (other->cur_frame && MVM_FRAME_IS_ON_CALLSTACK(other, other->cur_frame)) {
+                MVMFrame *cur_frame = other->cur_frame;
+                while (cur_frame && MVM_FRAME_IS_ON_CALLSTACK(other, cur_frame)) {
+                    MVM_gc_root_add_frame_roots_to_worklist(other, worklist, cur_frame);
+                    cur_frame = cur_frame->caller;
+                }
+            }
+            else {
+                MVM_gc_worklist_add(tc, worklist, &other->cur_frame);
+            }
+            MVM_gc_root_add_temps_to_worklist(other, worklist, NULL);
+            for (i = 0; i < other->num_finalizing; i++)
+                MVM_gc_worklist_add(tc, worklist, &(other->finalizing[i]));
+            shade_worklist(tc, worklist);
+
+            scan = (char *)other->nursery_tospace;
+            while (scan < (char *)other->nursery_alloc) {
+                MVMCollectable *c = (MVMCollectable *)scan;
+                MVM_gc_mark_collectable(other, worklist, c);
+                shade_worklist(tc, worklist);
+                scan += c->size;
+            }
+        }
+        cur_thread = cur_thread->body.next;
+    }
+}
+
+/* Re-scans the heap frames that may be running, or were running and have
+ * callees that return to them. Their registers are written without a write
+ * barrier, so a frame that was scanned earlier in the cycle may since have
+ * picked up a reference to an object that nothing else now references. This
+ * covers the heap part of each thread's call chain, and the frames among the
+ * gen2 roots, which are those with a work area. */
+static void rescan_frames(MVMThreadContext *tc, MVMGCWorklist *worklist) {
+    MVMThread *cur_thread = (MVMThread *)MVM_load(&tc->instance->threads);
+    while (cur_thread) {
+        MVMThreadContext *other = cur_thread->body.tc;
+        if (other) {
+            MVMFrame *cur_frame = other->cur_frame;
+            MVMuint32 i;
+            while (cur_frame) {
+                if (!MVM_FRAME_IS_ON_CALLSTACK(other, cur_frame)) {
+                    MVM_gc_mark_collectable(other, worklist, (MVMCollectable *)cur_frame);
+                    shade_worklist(tc, worklist);
+                }
+                cur_frame = cur_frame->caller;
+            }
+            for (i = 0; i < other->num_gen2roots; i++) {
+                MVMCollectable *c = other->gen2roots[i];
+                if ((c->flags & MVM_CF_FRAME) && ((MVMFrame *)c)->work) {
+                    MVM_gc_mark_collectable(other, worklist, c);
+                    shade_worklist(tc, worklist);
+                }
+            }
+        }
+        cur_thread = cur_thread->body.next;
+    }
+}
+
+/* Scans objects from the mark stack, shading what they reference, until the
+ * stack is empty or the deadline (compared with uv_hrtime; 0 for none) has
+ * passed. At least min_objects are scanned before the deadline is honored. */
+static void mark(MVMThreadContext *tc, MVMGCWorklist *worklist, MVMuint64 deadline,
+        MVMuint64 min_objects) {
+    MVMInstance *instance = tc->instance;
+    MVMuint64    marked   = 0;
+    while (instance->num_gc_mark_stack) {
+        MVMCollectable *c = instance->gc_mark_stack[--instance->num_gc_mark_stack];
+        MVM_gc_mark_collectable(tc, worklist, c);
+        shade_worklist(tc, worklist);
+        instance->gc_marked_bytes += c->size;
+        marked++;
+        if (deadline && marked >= min_objects && marked % MVM_GC_INCREMENTAL_CHECK_INTERVAL == 0)
+            if (uv_hrtime() >= deadline)
+                break;
+    }
+    instance->gc_marked_objects += marked;
+}
+
+/* Marks until there's nothing left to mark. */
+void MVM_gc_incremental_drain(MVMThreadContext *tc) {
+    MVMGCWorklist *worklist = MVM_gc_worklist_create(tc, 1);
+    mark(tc, worklist, 0, 0);
+    MVM_gc_worklist_destroy(tc, worklist);
+}
+
+/* Completes a marking cycle: re-scans the roots, nurseries and heap frames,
+ * marks all that is left, deals with gen2 objects needing finalization, and
+ * then sets up the gen2 heaps to be swept. */
+static void finish_marking(MVMThreadContext *tc, MVMGCWorklist *worklist) {
+    MVMInstance *instance = tc->instance;
+    MVMThread *cur_thread;
+
+    shade_roots(tc, worklist);
+    rescan_frames(tc, worklist);
+    take_queues(tc);
+    mark(tc, worklist, 0, 0);
+    MVM_finalize_walk_queues_gen2(tc);
+
+    instance->gc_marking = 0;
+    cur_thread = (MVMThread *)MVM_load(&instance->threads);
+    while (cur_thread) {
+        if (cur_thread->body.tc) {
+            MVM_gc_root_gen2_cleanup(cur_thread->body.tc);
+            MVM_gc_collect_free_gen2_unmarked_lazily(cur_thread->body.tc);
+        }
+        cur_thread = cur_thread->body.next;
+    }
+    instance->gc_mark_cycles++;
+}
+
+/* Sweeps what is left to sweep from the last marking cycle, until the
+ * deadline. Returns non-zero if there's still sweeping to do. */
+static MVMint32 sweep(MVMThreadContext *tc, MVMuint64 deadline) {
+    MVMThread *cur_thread = (MVMThread *)MVM_load(&tc->instance->threads);
+    MVMint32   pending    = 0;
+    while (cur_thread) {
+        if (cur_thread->body.tc && !pending)
+            pending = MVM_gc_collect_free_gen2_pending(cur_thread->body.tc, deadline);
+        cur_thread = cur_thread->body.next;
+    }
+    return pending;
+}
+
+/* Does the gen2 work for this pause when collecting incrementally; called by
+ * the co-ordinator after the nursery collection is complete, with the world
+ * still stopped. */
+void MVM_gc_incremental_step(MVMThreadContext *tc) {
+    MVMInstance   *instance = tc->instance;
+    MVMuint64      deadline = instance->gc_pause_start + instance->gc_pause_target;
+    MVMGCWorklist *worklist;
+    unsigned int   interval_id;
+
+    /* If we're not marking, any time left goes on sweeping. A new marking
+     * cycle can only start once the last one is completely swept, since the
+     * sweep is also what clears the live marks. */
+    if (!instance->gc_marking) {
+        if (sweep(tc, deadline) || !instance->gc_mark_requested)
+            return;
+    }
+
+    interval_id = MVM_telemetry_interval_start(tc, "incremental gen2 marking");
+    worklist = MVM_gc_worklist_create(tc, 1);
+
+    if (!instance->gc_marking) {
+        instance->gc_mark_requested    = 0;
+        instance->gc_marked_objects    = 0;
+        instance->gc_marked_bytes      = 0;
+        instance->gc_mark_slices       = 0;
+        instance->gc_mark_barrier_hits = 0;
+        MVM_store(&instance->gc_promoted_bytes_since_last_full, 0);
+        shade_roots(tc, worklist);
+        instance->gc_marking = 1;
+        MVM_telemetry_interval_annotate(instance->gc_mark_cycles, interval_id, "started marking cycle");
+    }
+
+    take_queues(tc);
+    mark(tc, worklist, deadline, MVM_GC_INCREMENTAL_MIN_SLICE);
+    instance->gc_mark_slices++;
+    MVM_telemetry_interval_annotate(instance->gc_marked_objects, interval_id, "objects marked so far");
+    MVM_telemetry_interval_annotate(instance->num_gc_mark_stack, interval_id, "objects left to scan");
+
+    if (!instance->num_gc_mark_stack) {
+        finish_marking(tc, worklist);
+        MVM_telemetry_interval_annotate(instance->gc_mark_barrier_hits, interval_id, "write barrier hits");
+        MVM_telemetry_interval_annotate(instance->gc_mark_slices, interval_id, "finished marking cycle after slices");
+    }
+
+    MVM_gc_worklist_destroy(tc, worklist);
+    MVM_telemetry_interval_stop(tc, interval_id, "incremental gen2 marking");
+}
@@ -0,0 +1,24 @@
+/* Incremental marking of the second generation. When a pause target is set
+ * (with MVM_GC_PAUSE_TARGET_MS), full collections are not done in a single
+ * stop-the-world pause. Instead, a marking cycle is started, and each of the
+ * following nursery collections does as much gen2 marking as fits in what is
+ * left of the pause target. Once there's no more marking to do, a final
+ * pause re-scans the roots and the nurseries, completes the marking, and
+ * leaves the gen2 size class bins to be swept lazily in later pauses.
+ *
+ * While marking, the write barrier shades (marks live, and queues for
+ * scanning) both the gen2 object a reference was overwritten to point away
+ * from (snapshot-at-the-beginning) and the gen2 object it now points to. */
+
+/* How many objects we mark between checks of the clock. */
+#define MVM_GC_INCREMENTAL_CHECK_INTERVAL   256
+
+/* The least number of objects marked in a slice, even if the nursery part of
+ * the pause already used up the pause target. */
+#define MVM_GC_INCREMENTAL_MIN_SLICE        4096
+
+/* Functions. */
+void MVM_gc_incremental_step(MVMThreadContext *tc);
+void MVM_gc_incremental_promoted(MVMThreadContext *tc, MVMCollectable *c);
+void MVM_gc_incremental_shade(MVMThreadContext *tc, MVMCollectable *c);
+void MVM_gc_incremental_drain(MVMThreadContext *tc);
@@ -26,6 +26,8 @@ MVMuint64 MVM_gc_object_id(MVMThreadContext *tc, MVMObject *obj) {
             entry            = MVM_calloc(1, sizeof(MVMObjectId));
             entry->current   = obj;
             entry->gen2_addr = MVM_gc_gen2_allocate_zeroed(tc->gen2, obj->header.size);
+            if (tc->instance->gc_marking)
+                entry->gen2_addr->flags |= MVM_CF_GEN2_LIVE;
             HASH_ADD_KEYPTR(hash_handle, tc->instance->object_ids, &(entry->current),
                 sizeof(MVMObject *), entry);
             obj->header.flags |= MVM_CF_HAS_OBJECT_ID;
@@ -161,6 +161,12 @@ static void finish_gc(MVMThreadContext *tc, MVMuint8 gen, MVMuint8 is_coordinato
         MVM_finalize_walk_queues(tc, gen);
         clear_intrays(tc, gen);
 
+        if (tc->instance->gc_pause_target) {
+            GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
+                "Thread %d run %d : Co-ordinator doing incremental gen2 work\n");
+            MVM_gc_incremental_step(tc);
+        }
+
         if (gen == MVMGCGenerations_Both) {
             MVMThread *cur_thread = (MVMThread *)MVM_load(&tc->instance->threads);
             GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
@@ -204,6 +210,8 @@ static void finish_gc(MVMThreadContext *tc, MVMuint8 gen, MVMuint8 is_coordinato
         if (MVM_load(&thread_obj->body.stage) == MVM_thread_stage_clearing_nursery) {
             GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
                 "Thread %d run %d : transferring gen2 of thread %d\n", other->thread_id);
+            MVM_gc_collect_free_gen2_pending(other, 0);
+            MVM_gc_collect_free_gen2_pending(tc, 0);
             MVM_gc_gen2_transfer(other, tc);
             GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE,
                 "Thread %d run %d : destroying thread %d\n", other->thread_id);
@@ -229,6 +237,9 @@ static void finish_gc(MVMThreadContext *tc, MVMuint8 gen, MVMuint8 is_coordinato
                 other->thread_id);
             MVM_gc_collect_free_nursery_uncopied(other, tc->gc_work[i].limit);
 
+            /* Decide on the nursery size for its next collection. */
+            MVM_gc_collect_size_nursery(other, tc->gc_work[i].limit);
+
             /* Handle exited threads. */
             if (MVM_load(&thread_obj->body.stage) == MVM_thread_stage_exited) {
                 /* Don't bother freeing gen2; we'll do it next time */
@@ -324,8 +335,23 @@ static MVMint32 is_full_collection(MVMThreadContext *tc) {
     return percent_growth >= MVM_GC_GEN2_THRESHOLD_PERCENT;
 }
 
+/* Sets up the state for a parallel nursery collection; called by the
+ * co-ordinator before it signals the other threads to start. */
+static void prepare_parallel(MVMThreadContext *tc, MVMuint32 participants) {
+    MVMInstance *instance = tc->instance;
+    if (instance->alloc_gc_parallel_workers < participants) {
+        instance->alloc_gc_parallel_workers = participants * 2;
+        instance->gc_parallel_workers = MVM_realloc(instance->gc_parallel_workers,
+            instance->alloc_gc_parallel_workers * sizeof(MVMThreadContext *));
+    }
+    memset(instance->gc_parallel_workers, 0, participants * sizeof(MVMThreadContext *));
+    MVM_store(&instance->gc_parallel_participants, participants);
+    MVM_store(&instance->gc_parallel_ready, 0);
+    MVM_store(&instance->gc_parallel_active, participants);
+}
+
 static void run_gc(MVMThreadContext *tc, MVMuint8 what_to_do) {
-    MVMuint8   gen;
+    MVMuint8   gen, parallel;
     MVMuint32  i, n;
 
     unsigned int interval_id;
@@ -337,6 +363,7 @@ static void run_gc(MVMThreadContext *tc, MVMuint8 what_to_do) {
 
     /* Decide nursery or full collection. */
     gen = tc->instance->gc_full_collect ? MVMGCGenerations_Both : MVMGCGenerations_Nursery;
+    parallel = tc->instance->gc_parallel && gen == MVMGCGenerations_Nursery;
 
     if (tc->instance->gc_full_collect) {
         interval_id = MVM_telemetry_interval_start(tc, "start full collection");
@@ -351,8 +378,11 @@ static void run_gc(MVMThreadContext *tc, MVMuint8 what_to_do) {
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE, "Thread %d run %d : starting collection for thread %d\n",
             other->thread_id);
         other->gc_promoted_bytes = 0;
-        MVM_gc_collect(other, (other == tc ? what_to_do : MVMGCWhatToDo_NoInstance), gen);
+        if (!parallel)
+            MVM_gc_collect(other, (other == tc ? what_to_do : MVMGCWhatToDo_NoInstance), gen);
     }
+    if (parallel)
+        MVM_gc_collect_parallel(tc, what_to_do);
 
     /* Wait for everybody to agree we're done. */
     finish_gc(tc, gen, what_to_do == MVMGCWhatToDo_All);
@@ -389,8 +419,17 @@ void MVM_gc_enter_from_allocator(MVMThreadContext *tc) {
             "Thread %d run %d : GC thread elected coordinator: starting gc seq %d\n",
             (int)MVM_load(&tc->instance->gc_seq_number));
 
-        /* Decide if it will be a full collection. */
-        tc->instance->gc_full_collect = is_full_collection(tc);
+        /* Decide if it will be a full collection. With a pause target, gen2
+         * is instead marked incrementally, over a number of nursery runs. */
+        tc->instance->gc_pause_start = uv_hrtime();
+        if (tc->instance->gc_pause_target) {
+            tc->instance->gc_full_collect = 0;
+            if (!tc->instance->gc_marking && is_full_collection(tc))
+                tc->instance->gc_mark_requested = 1;
+        }
+        else {
+            tc->instance->gc_full_collect = is_full_collection(tc);
+        }
 
         MVM_telemetry_timestamp(tc, "won the gc starting race");
 
@@ -419,9 +458,8 @@ void MVM_gc_enter_from_allocator(MVMThreadContext *tc) {
         uv_cond_broadcast(&tc->instance->cond_gc_start);
         uv_mutex_unlock(&tc->instance->mutex_gc_orchestrate);
 
-        /* If there's an event loop thread, wake it up to participate. */
-        if (tc->instance->event_loop_wakeup)
-            uv_async_send(tc->instance->event_loop_wakeup);
+        /* If there are event loop threads, wake them up to participate. */
+        MVM_io_eventloop_wake_all(tc);
 
         /* Wait for other threads to be ready. */
         uv_mutex_lock(&tc->instance->mutex_gc_orchestrate);
@@ -441,6 +479,11 @@ void MVM_gc_enter_from_allocator(MVMThreadContext *tc) {
         GCDEBUG_LOG(tc, MVM_GC_DEBUG_ORCHESTRATE, "Thread %d run %d : finish votes is %d\n",
             (int)MVM_load(&tc->instance->gc_finish));
 
+        /* If we'll collect the nursery in parallel, everyone who votes to
+         * finish is also a worker in that. */
+        if (tc->instance->gc_parallel && !tc->instance->gc_full_collect)
+            prepare_parallel(tc, num_threads + 1);
+
         /* Now we're ready to start, zero promoted since last full collection
          * counter if this is a full collect. */
         if (tc->instance->gc_full_collect)
@@ -529,12 +572,16 @@ void MVM_gc_enter_from_interrupt(MVMThreadContext *tc) {
 /* Run the global destruction phase. */
 void MVM_gc_global_destruction(MVMThreadContext *tc) {
     char *nursery_tmp;
+    MVMuint32 nursery_tmp_size;
 
     /* Fake a nursery collection run by swapping the semi-
      * space nurseries. */
     nursery_tmp = tc->nursery_fromspace;
     tc->nursery_fromspace = tc->nursery_tospace;
     tc->nursery_tospace = nursery_tmp;
+    nursery_tmp_size = tc->nursery_fromspace_size;
+    tc->nursery_fromspace_size = tc->nursery_tospace_size;
+    tc->nursery_tospace_size = nursery_tmp_size;
 
     /* Run the objects' finalizers */
     MVM_gc_collect_free_nursery_uncopied(tc, tc->nursery_alloc);
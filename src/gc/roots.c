@@ -75,17 +75,20 @@ void MVM_gc_root_add_instance_roots_to_worklist(MVMThreadContext *tc, MVMGCWorkl
     add_collectable(tc, worklist, snapshot, tc->instance->compiler_registry, "Compiler registry");
     add_collectable(tc, worklist, snapshot, tc->instance->hll_syms, "HLL symbols");
     add_collectable(tc, worklist, snapshot, tc->instance->clargs, "Command line args");
-    add_collectable(tc, worklist, snapshot, tc->instance->event_loop_todo_queue,
-        "Event loop todo queue");
-    add_collectable(tc, worklist, snapshot, tc->instance->event_loop_permit_queue,
-        "Event loop permit queue");
-    add_collectable(tc, worklist, snapshot, tc->instance->event_loop_cancel_queue,
-        "Event loop cancel queue");
-    add_collectable(tc, worklist, snapshot, tc->instance->event_loop_active, "Event loop active");
+    for (i = 0; i < tc->instance->num_event_loops; i++) {
+        MVMEventLoop *loop = &(tc->instance->event_loops[i]);
+        add_collectable(tc, worklist, snapshot, loop->todo_queue, "Event loop todo queue");
+        add_collectable(tc, worklist, snapshot, loop->permit_queue, "Event loop permit queue");
+        add_collectable(tc, worklist, snapshot, loop->cancel_queue, "Event loop cancel queue");
+        add_collectable(tc, worklist, snapshot, loop->active, "Event loop active");
+    }
 
     add_collectable(tc, worklist, snapshot, tc->instance->spesh_queue,
         "Specialization log queue");
-    MVM_spesh_plan_gc_mark(tc, tc->instance->spesh_plan, worklist);
+    if (worklist) {
+        MVM_spesh_plan_cache_gc_mark(tc, tc->instance->spesh_plan_cache, worklist);
+        MVM_profile_sampling_gc_mark(tc, tc->instance->sampling_profiler, worklist);
+    }
 
     int_to_str_cache = tc->instance->int_to_str_cache;
     for (i = 0; i < MVM_INT_TO_STR_CACHE_SIZE; i++)
@@ -171,8 +174,9 @@ void MVM_gc_root_add_tc_roots_to_worklist(MVMThreadContext *tc, MVMGCWorklist *w
     }
 
     /* Profiling data. */
-    if (worklist)
+    if (worklist) {
         MVM_profile_instrumented_mark_data(tc, worklist);
+    }
 
     /* Serialized string heap, if any. */
     add_collectable(tc, worklist, snapshot, tc->serialized_string_heap,
@@ -181,6 +185,7 @@ void MVM_gc_root_add_tc_roots_to_worklist(MVMThreadContext *tc, MVMGCWorklist *w
     /* Specialization log and stack simulation. */
     add_collectable(tc, worklist, snapshot, tc->spesh_log, "Specialization log");
     MVM_spesh_sim_stack_gc_mark(tc, tc->spesh_sim_stack, worklist);
+    MVM_spesh_plan_gc_mark(tc, tc->spesh_plan, worklist);
 }
 
 /* Pushes a temporary root onto the thread-local roots list. */
@@ -11,3 +11,13 @@ void MVM_gc_write_barrier_hit(MVMThreadContext *tc, MVMCollectable *update_root)
     if (!(update_root->flags & MVM_CF_IN_GEN2_ROOT_LIST))
         MVM_gc_root_gen2_add(tc, update_root);
 }
+
+/* Applies the full barrier for storing referenced at update_addr within
+ * update_root, as MVM_ASSIGN_REF does, taking the previous referent from
+ * update_addr; the store itself is left to the caller. Used by the JIT while
+ * gen2 is being marked incrementally. */
+void MVM_gc_write_barrier_marking(MVMThreadContext *tc, MVMCollectable *update_root,
+        MVMCollectable **update_addr, MVMCollectable *referenced) {
+    MVM_gc_write_barrier(tc, update_root, referenced);
+    MVM_gc_mark_barrier(tc, update_root, *update_addr);
+}
@@ -1,5 +1,16 @@
 /* Functions for if the write barriers are hit. */
 MVM_PUBLIC void MVM_gc_write_barrier_hit(MVMThreadContext *tc, MVMCollectable *update_root);
+MVM_PUBLIC void MVM_gc_incremental_barrier_hit(MVMThreadContext *tc, MVMCollectable *referenced);
+MVM_PUBLIC void MVM_gc_write_barrier_marking(MVMThreadContext *tc, MVMCollectable *update_root,
+    MVMCollectable **update_addr, MVMCollectable *referenced);
+
+/* While gen2 is being marked incrementally, ensures that a gen2 object that
+ * a gen2 object references (or referenced, before an update) gets marked. */
+MVM_STATIC_INLINE void MVM_gc_mark_barrier(MVMThreadContext *tc, const MVMCollectable *update_root, const MVMCollectable *referenced) {
+    if (tc->instance->gc_marking && (update_root->flags & MVM_CF_SECOND_GEN) && referenced
+            && (referenced->flags & (MVM_CF_SECOND_GEN | MVM_CF_GEN2_LIVE)) == MVM_CF_SECOND_GEN)
+        MVM_gc_incremental_barrier_hit(tc, (MVMCollectable *)referenced);
+}
 
 /* Ensures that if a generation 2 object comes to hold a reference to a
  * nursery object, then the generation 2 object becomes an inter-generational
@@ -7,6 +18,8 @@ MVM_PUBLIC void MVM_gc_write_barrier_hit(MVMThreadContext *tc, MVMCollectable *u
 MVM_STATIC_INLINE void MVM_gc_write_barrier(MVMThreadContext *tc, MVMCollectable *update_root, const MVMCollectable *referenced) {
     if (((update_root->flags & MVM_CF_SECOND_GEN) && referenced && !(referenced->flags & MVM_CF_SECOND_GEN)))
         MVM_gc_write_barrier_hit(tc, update_root);
+    else
+        MVM_gc_mark_barrier(tc, update_root, referenced);
 }
 
 /* Does an assignment, but makes sure the write barrier MVM_WB is applied
@@ -21,6 +34,7 @@ MVM_STATIC_INLINE void MVM_gc_write_barrier(MVMThreadContext *tc, MVMCollectable
             MVM_panic(1, "Invalid assignment (maybe of heap frame to stack frame?)"); \
         MVM_ASSERT_NOT_FROMSPACE(tc, _r); \
         MVM_gc_write_barrier(tc, update_root, (MVMCollectable *)_r); \
+        MVM_gc_mark_barrier(tc, update_root, (MVMCollectable *)(update_addr)); \
         update_addr = _r; \
     }
 #else
@@ -28,6 +42,7 @@ MVM_STATIC_INLINE void MVM_gc_write_barrier(MVMThreadContext *tc, MVMCollectable
     { \
         void *_r = referenced; \
         MVM_gc_write_barrier(tc, update_root, (MVMCollectable *)_r); \
+        MVM_gc_mark_barrier(tc, update_root, (MVMCollectable *)(update_addr)); \
         update_addr = _r; \
     }
 #endif
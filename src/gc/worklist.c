@@ -33,3 +33,120 @@ void MVM_gc_worklist_destroy(MVMThreadContext *tc, MVMGCWorklist *worklist) {
     MVM_free(worklist->list);
     MVM_free(worklist);
 }
+
+/* Allocates a buffer for a work-stealing deque. */
+static MVMGCDequeArray * deque_array_create(MVMThreadContext *tc, AO_t size) {
+    MVMGCDequeArray *array = MVM_malloc(sizeof(MVMGCDequeArray));
+    array->size  = size;
+    array->items = MVM_malloc(size * sizeof(MVMCollectable **));
+    array->prev  = NULL;
+    return array;
+}
+
+/* Allocates a new, empty, work-stealing deque. */
+MVMGCDeque * MVM_gc_deque_create(MVMThreadContext *tc) {
+    MVMGCDeque *deque = MVM_malloc(sizeof(MVMGCDeque));
+    deque->top    = 0;
+    deque->bottom = 0;
+    deque->array  = deque_array_create(tc, MVM_GC_DEQUE_START_SIZE);
+    return deque;
+}
+
+/* Pushes an item onto the bottom of a deque. Only the owning thread may
+ * call this. */
+void MVM_gc_deque_push(MVMThreadContext *tc, MVMGCDeque *deque, MVMCollectable **item) {
+    AO_t bottom = deque->bottom;
+    AO_t top    = MVM_load(&deque->top);
+    MVMGCDequeArray *array = deque->array;
+    if (bottom - top >= array->size - 1) {
+        /* Full; move over to a buffer twice the size. Thieves only ever
+         * look at indexes between top and bottom, which we copy over. */
+        MVMGCDequeArray *grown = deque_array_create(tc, array->size * 2);
+        AO_t i;
+        for (i = top; i < bottom; i++)
+            grown->items[i & (grown->size - 1)] = array->items[i & (array->size - 1)];
+        grown->prev = array;
+        MVM_barrier();
+        deque->array = array = grown;
+    }
+    array->items[bottom & (array->size - 1)] = item;
+    MVM_barrier();
+    deque->bottom = bottom + 1;
+}
+
+/* Pops an item from the bottom of a deque, or returns NULL if it is empty.
+ * Only the owning thread may call this. */
+MVMCollectable ** MVM_gc_deque_pop(MVMThreadContext *tc, MVMGCDeque *deque) {
+    AO_t bottom = deque->bottom;
+    AO_t top;
+    MVMGCDequeArray *array;
+    MVMCollectable **item;
+
+    if (bottom == MVM_load(&deque->top))
+        return NULL;
+
+    /* Claim the bottom item, then check we didn't race with a thief. */
+    bottom--;
+    MVM_store(&deque->bottom, bottom);
+    top = MVM_load(&deque->top);
+    if ((MVMint64)(bottom - top) < 0) {
+        /* A thief got the last item. */
+        deque->bottom = top;
+        return NULL;
+    }
+    array = deque->array;
+    item  = array->items[bottom & (array->size - 1)];
+    if (bottom != top)
+        return item;
+
+    /* It's the last item, so we have to compete with thieves for it. */
+    if (!MVM_trycas(&deque->top, top, top + 1))
+        item = NULL;
+    MVM_store(&deque->bottom, top + 1);
+    return item;
+}
+
+/* Tries to steal an item from the top of a deque owned by another thread.
+ * Returns NULL if it is empty or we lost a race for the item. */
+MVMCollectable ** MVM_gc_deque_steal(MVMThreadContext *tc, MVMGCDeque *deque) {
+    AO_t top    = MVM_load(&deque->top);
+    AO_t bottom = MVM_load(&deque->bottom);
+    MVMGCDequeArray *array;
+    MVMCollectable **item;
+    if ((MVMint64)(bottom - top) <= 0)
+        return NULL;
+    array = deque->array;
+    item  = array->items[top & (array->size - 1)];
+    if (!MVM_trycas(&deque->top, top, top + 1))
+        return NULL;
+    return item;
+}
+
+/* Checks if a deque looks empty (it may stop being so at any moment, if we
+ * are not the owner). */
+MVMint32 MVM_gc_deque_is_empty(MVMThreadContext *tc, MVMGCDeque *deque) {
+    return (MVMint64)(MVM_load(&deque->bottom) - MVM_load(&deque->top)) <= 0;
+}
+
+/* Empties a deque at the end of a collection, freeing any buffers that it
+ * grew out of. */
+void MVM_gc_deque_reset(MVMThreadContext *tc, MVMGCDeque *deque) {
+    MVMGCDequeArray *prev = deque->array->prev;
+    while (prev) {
+        MVMGCDequeArray *next = prev->prev;
+        MVM_free(prev->items);
+        MVM_free(prev);
+        prev = next;
+    }
+    deque->array->prev = NULL;
+    deque->top    = 0;
+    deque->bottom = 0;
+}
+
+/* Frees a work-stealing deque. */
+void MVM_gc_deque_destroy(MVMThreadContext *tc, MVMGCDeque *deque) {
+    MVM_gc_deque_reset(tc, deque);
+    MVM_free(deque->array->items);
+    MVM_free(deque->array);
+    MVM_free(deque);
+}
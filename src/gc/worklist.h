@@ -80,3 +80,42 @@ void MVM_gc_worklist_destroy(MVMThreadContext *tc, MVMGCWorklist *worklist);
 /* The number of pointers we assume the list may need to hold initially;
  * it will be resized as needed. */
 #define MVM_GC_WORKLIST_START_SIZE      256
+
+/* A work-stealing deque (after Chase and Lev), used when collecting the
+ * nursery in parallel. Each thread taking part in the collection owns one,
+ * pushing and popping work at the bottom end; other threads that run out of
+ * work steal from the top end. The items are the same as in a worklist:
+ * addresses of pointers to collectables. */
+struct MVMGCDequeArray {
+    /* The size of the circular buffer; always a power of two. */
+    AO_t size;
+
+    /* The circular buffer itself. */
+    MVMCollectable ***items;
+
+    /* Buffers that we grew out of. A thief may still be reading from one of
+     * these, so they are kept until the end of the collection. */
+    MVMGCDequeArray *prev;
+};
+struct MVMGCDeque {
+    /* Index that thieves steal from; only ever grows. */
+    volatile AO_t top;
+
+    /* Index that the owner pushes to and pops from. */
+    volatile AO_t bottom;
+
+    /* The current buffer. */
+    MVMGCDequeArray * volatile array;
+};
+
+/* The number of items a deque can hold initially; it will grow as needed. */
+#define MVM_GC_DEQUE_START_SIZE         1024
+
+/* Functions for work-stealing deque manipulation. */
+MVMGCDeque * MVM_gc_deque_create(MVMThreadContext *tc);
+void MVM_gc_deque_push(MVMThreadContext *tc, MVMGCDeque *deque, MVMCollectable **item);
+MVMCollectable ** MVM_gc_deque_pop(MVMThreadContext *tc, MVMGCDeque *deque);
+MVMCollectable ** MVM_gc_deque_steal(MVMThreadContext *tc, MVMGCDeque *deque);
+MVMint32 MVM_gc_deque_is_empty(MVMThreadContext *tc, MVMGCDeque *deque);
+void MVM_gc_deque_reset(MVMThreadContext *tc, MVMGCDeque *deque);
+void MVM_gc_deque_destroy(MVMThreadContext *tc, MVMGCDeque *deque);
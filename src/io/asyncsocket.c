@@ -1,9 +1,16 @@
 #include "moar.h"
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 /* Data that we keep for an asynchronous socket handle. */
 typedef struct {
     /* The libuv handle to the socket. */
     uv_stream_t *handle;
+
+    /* The event loop the handle belongs to, where all work on it is done. */
+    MVMEventLoop *loop;
 } MVMIOAsyncSocketData;
 
 /* Info we convey about a read task. */
@@ -15,11 +22,9 @@ typedef struct {
     int               work_idx;
 } ReadInfo;
 
-/* Allocates a buffer of the suggested size. */
+/* Gets a buffer to read into from the event loop's pool. */
 static void on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
-    size_t size = suggested_size > 0 ? suggested_size : 4;
-    buf->base   = MVM_malloc(size);
-    buf->len    = size;
+    MVM_io_eventloop_alloc_read_buffer(((ReadInfo *)handle->data)->tc, suggested_size, buf);
 }
 
 /* Callback used to simply free memory on close. */
@@ -46,9 +51,9 @@ static void on_read(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf) {
 
             /* Produce a buffer and push it. */
             res_buf      = (MVMArray *)MVM_repr_alloc_init(tc, ri->buf_type);
-            res_buf->body.slots.i8 = (MVMint8 *)buf->base;
+            res_buf->body.slots.i8 = (MVMint8 *)MVM_io_eventloop_take_read_buffer(tc,
+                buf, nread, &(res_buf->body.ssize));
             res_buf->body.start    = 0;
-            res_buf->body.ssize    = buf->len;
             res_buf->body.elems    = nread;
             MVM_repr_push_o(tc, arr, (MVMObject *)res_buf);
 
@@ -67,8 +72,7 @@ static void on_read(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf) {
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
         });
         });
-        if (buf->base)
-            MVM_free(buf->base);
+        MVM_io_eventloop_release_read_buffer(tc, buf);
         uv_read_stop(handle);
         MVM_io_eventloop_remove_active_work(tc, &(ri->work_idx));
     }
@@ -84,8 +88,7 @@ static void on_read(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf) {
             MVM_repr_push_o(tc, arr, msg_box);
         });
         });
-        if (buf->base)
-            MVM_free(buf->base);
+        MVM_io_eventloop_release_read_buffer(tc, buf);
         uv_read_stop(handle);
         MVM_io_eventloop_remove_active_work(tc, &(ri->work_idx));
     }
@@ -217,6 +220,7 @@ static MVMAsyncTask * read_bytes(MVMThreadContext *tc, MVMOSHandle *h, MVMObject
     MVM_ASSIGN_REF(tc, &(task->common.header), ri->buf_type, buf_type);
     MVM_ASSIGN_REF(tc, &(task->common.header), ri->handle, h);
     task->body.data = ri;
+    task->body.loop = ((MVMIOAsyncSocketData *)h->body.data)->loop;
 
     /* Hand the task off to the event loop. */
     MVMROOT(tc, task, {
@@ -395,6 +399,7 @@ static MVMAsyncTask * write_bytes(MVMThreadContext *tc, MVMOSHandle *h, MVMObjec
     MVM_ASSIGN_REF(tc, &(task->common.header), wi->handle, h);
     MVM_ASSIGN_REF(tc, &(task->common.header), wi->buf_data, buffer);
     task->body.data = wi;
+    task->body.loop = ((MVMIOAsyncSocketData *)h->body.data)->loop;
 
     /* Hand the task off to the event loop. */
     MVMROOT(tc, task, {
@@ -453,6 +458,7 @@ static MVMint64 close_socket(MVMThreadContext *tc, MVMOSHandle *h) {
     ci = MVM_calloc(1, sizeof(CloseInfo));
     MVM_ASSIGN_REF(tc, &(task->common.header), ci->handle, h);
     task->body.data = ci;
+    task->body.loop = ((MVMIOAsyncSocketData *)h->body.data)->loop;
     MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
 
     return 0;
@@ -538,6 +544,7 @@ static void on_connect(uv_connect_t* req, int status) {
             MVMOSHandle          *result = (MVMOSHandle *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIO);
             MVMIOAsyncSocketData *data   = MVM_calloc(1, sizeof(MVMIOAsyncSocketData));
             data->handle                 = (uv_stream_t *)ci->socket;
+            data->loop                   = tc->event_loop;
             result->body.ops             = &op_table;
             result->body.data            = data;
             MVM_repr_push_o(tc, arr, (MVMObject *)result);
@@ -685,6 +692,93 @@ typedef struct {
 } ListenInfo;
 
 
+#ifndef _WIN32
+/* Info we convey about a task taking over an accepted connection on another
+ * event loop. */
+typedef struct {
+    MVMOSHandle *handle;
+    int          fd;
+} AdoptInfo;
+
+/* Opens the connection on this loop. If that fails, the socket is left
+ * closed, which reads and writes will report. */
+static void adopt_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_task, void *data) {
+    AdoptInfo            *ai          = (AdoptInfo *)data;
+    MVMIOAsyncSocketData *handle_data = (MVMIOAsyncSocketData *)ai->handle->body.data;
+    uv_tcp_t             *client      = MVM_malloc(sizeof(uv_tcp_t));
+    uv_tcp_init(loop, client);
+    if (uv_tcp_open(client, ai->fd) == 0) {
+        handle_data->handle = (uv_stream_t *)client;
+    }
+    else {
+        close(ai->fd);
+        uv_close((uv_handle_t *)client, free_on_close_cb);
+    }
+    ai->fd = -1;
+}
+
+static void adopt_gc_mark(MVMThreadContext *tc, void *data, MVMGCWorklist *worklist) {
+    AdoptInfo *ai = (AdoptInfo *)data;
+    MVM_gc_worklist_add(tc, worklist, &ai->handle);
+}
+
+static void adopt_gc_free(MVMThreadContext *tc, MVMObject *t, void *data) {
+    AdoptInfo *ai = (AdoptInfo *)data;
+    if (ai) {
+        if (ai->fd >= 0)
+            close(ai->fd);
+        MVM_free(ai);
+    }
+}
+
+/* Operations table for taking over an accepted connection. */
+static const MVMAsyncTaskOps adopt_op_table = {
+    adopt_setup,
+    NULL,
+    NULL,
+    adopt_gc_mark,
+    adopt_gc_free
+};
+
+/* Hands an accepted connection over to the next event loop in turn, if that
+ * is not this one, so connections are spread over the loops. libuv handles
+ * can't move between loops, so the socket is duplicated and opened by a task
+ * on the other loop. That task is queued before anyone else can see the
+ * handle, so it is set up before any work done on the connection. */
+static void spread_connection(MVMThreadContext *tc, MVMOSHandle *result, uv_tcp_t *client) {
+    MVMIOAsyncSocketData *data   = (MVMIOAsyncSocketData *)result->body.data;
+    MVMEventLoop         *target;
+    MVMAsyncTask         *task;
+    AdoptInfo            *ai;
+    uv_os_fd_t            fd;
+    int                   dup_fd;
+
+    if (tc->instance->num_event_loops == 1)
+        return;
+    target = MVM_io_eventloop_next(tc);
+    if (target == tc->event_loop)
+        return;
+    if (uv_fileno((uv_handle_t *)client, &fd) != 0 || (dup_fd = dup(fd)) < 0)
+        return;
+
+    uv_close((uv_handle_t *)client, free_on_close_cb);
+    data->handle = NULL;
+    data->loop   = target;
+
+    MVMROOT(tc, result, {
+        task = (MVMAsyncTask *)MVM_repr_alloc_init(tc,
+            tc->instance->boot_types.BOOTAsync);
+    });
+    task->body.ops  = &adopt_op_table;
+    ai              = MVM_calloc(1, sizeof(AdoptInfo));
+    ai->fd          = dup_fd;
+    MVM_ASSIGN_REF(tc, &(task->common.header), ai->handle, result);
+    task->body.data = ai;
+    task->body.loop = target;
+    MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
+}
+#endif
+
 /* Handles an incoming connection. */
 static void on_connection(uv_stream_t *server, int status) {
     ListenInfo       *li     = (ListenInfo *)server->data;
@@ -704,6 +798,7 @@ static void on_connection(uv_stream_t *server, int status) {
             MVMOSHandle          *result = (MVMOSHandle *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIO);
             MVMIOAsyncSocketData *data   = MVM_calloc(1, sizeof(MVMIOAsyncSocketData));
             data->handle                 = (uv_stream_t *)client;
+            data->loop                   = tc->event_loop;
             result->body.ops             = &op_table;
             result->body.data            = data;
 
@@ -719,6 +814,10 @@ static void on_connection(uv_stream_t *server, int status) {
 
                 uv_tcp_getsockname(client, (struct sockaddr *)&sockaddr, &name_len);
                 push_name_and_port(tc, &sockaddr, arr);
+
+#ifndef _WIN32
+                spread_connection(tc, result, client);
+#endif
             });
         });
         });
@@ -7,6 +7,9 @@
 typedef struct {
     /* The libuv handle to the socket. */
     uv_udp_t *handle;
+
+    /* The event loop the handle belongs to, where all work on it is done. */
+    MVMEventLoop *loop;
 } MVMIOAsyncUDPSocketData;
 
 /* Info we convey about a read task. */
@@ -18,11 +21,9 @@ typedef struct {
     int               work_idx;
 } ReadInfo;
 
-/* Allocates a buffer of the suggested size. */
+/* Gets a buffer to read into from the event loop's pool. */
 static void on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
-    size_t size = suggested_size > 0 ? suggested_size : 4;
-    buf->base   = MVM_malloc(size);
-    buf->len    = size;
+    MVM_io_eventloop_alloc_read_buffer(((ReadInfo *)handle->data)->tc, suggested_size, buf);
 }
 
 /* Callback used to simply free memory on close. */
@@ -49,9 +50,9 @@ static void on_read(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const
 
             /* Produce a buffer and push it. */
             res_buf      = (MVMArray *)MVM_repr_alloc_init(tc, ri->buf_type);
-            res_buf->body.slots.i8 = (MVMint8 *)buf->base;
+            res_buf->body.slots.i8 = (MVMint8 *)MVM_io_eventloop_take_read_buffer(tc,
+                buf, nread, &(res_buf->body.ssize));
             res_buf->body.start    = 0;
-            res_buf->body.ssize    = buf->len;
             res_buf->body.elems    = nread;
             MVM_repr_push_o(tc, arr, (MVMObject *)res_buf);
 
@@ -70,8 +71,7 @@ static void on_read(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
         });
         });
-        if (buf->base)
-            MVM_free(buf->base);
+        MVM_io_eventloop_release_read_buffer(tc, buf);
         uv_udp_recv_stop(handle);
         MVM_io_eventloop_remove_active_work(tc, &(ri->work_idx));
     }
@@ -87,8 +87,7 @@ static void on_read(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const
             MVM_repr_push_o(tc, arr, msg_box);
         });
         });
-        if (buf->base)
-            MVM_free(buf->base);
+        MVM_io_eventloop_release_read_buffer(tc, buf);
         uv_udp_recv_stop(handle);
         MVM_io_eventloop_remove_active_work(tc, &(ri->work_idx));
     }
@@ -188,6 +187,7 @@ static MVMAsyncTask * read_bytes(MVMThreadContext *tc, MVMOSHandle *h, MVMObject
     MVM_ASSIGN_REF(tc, &(task->common.header), ri->buf_type, buf_type);
     MVM_ASSIGN_REF(tc, &(task->common.header), ri->handle, h);
     task->body.data = ri;
+    task->body.loop = ((MVMIOAsyncUDPSocketData *)h->body.data)->loop;
 
     /* Hand the task off to the event loop. */
     MVMROOT(tc, task, {
@@ -360,6 +360,7 @@ static MVMAsyncTask * write_bytes_to(MVMThreadContext *tc, MVMOSHandle *h, MVMOb
     MVM_ASSIGN_REF(tc, &(task->common.header), wi->buf_data, buffer);
     wi->dest_addr = dest_addr;
     task->body.data = wi;
+    task->body.loop = ((MVMIOAsyncUDPSocketData *)h->body.data)->loop;
 
     /* Hand the task off to the event loop. */
     MVMROOT(tc, task, {
@@ -398,6 +399,7 @@ static MVMint64 close_socket(MVMThreadContext *tc, MVMOSHandle *h) {
     });
     task->body.ops  = &close_op_table;
     task->body.data = data->handle;
+    task->body.loop = data->loop;
     MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
 
     return 0;
@@ -453,6 +455,7 @@ static void setup_setup(MVMThreadContext *tc, uv_loop_t *loop, MVMObject *async_
             MVMOSHandle          *result = (MVMOSHandle *)MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTIO);
             MVMIOAsyncUDPSocketData *data   = MVM_calloc(1, sizeof(MVMIOAsyncUDPSocketData));
             data->handle                 = udp_handle;
+            data->loop                   = tc->event_loop;
             result->body.ops             = &op_table;
             result->body.data            = data;
             MVM_repr_push_o(tc, arr, (MVMObject *)result);
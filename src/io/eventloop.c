@@ -1,18 +1,23 @@
 #include "moar.h"
 
 /* Asynchronous I/O, timers, file system notifications and signal handlers
- * have their callbacks processed by this event loop. Its job is mostly to
+ * have their callbacks processed by an event loop. Its job is mostly to
  * fire off work, receive the callbacks, and put stuff into the concurrent
  * work queue of some scheduler or other. It's backed by a thread that is
  * started in the usual way, but never actually ends up in interpreter;
  * instead, it enters a libuv event loop "forever", until program exit.
  *
- * Work is sent to the event loop by
- */
+ * There may be a number of event loops (MVM_EVENT_LOOP_THREADS), so that
+ * callbacks for many connections can be processed on more than one core.
+ * Work is sent to an event loop by pushing it onto one of its queues and
+ * waking it up. A task goes to the loop it is set to, if any, which is
+ * how tasks on an existing handle are sent to the loop the handle belongs
+ * to; otherwise, tasks queued from an event loop thread stay on that loop,
+ * and all others are handed out round-robin. */
 
 /* Sets up an async task to be done on the loop. */
 static void setup_work(MVMThreadContext *tc) {
-    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)tc->instance->event_loop_todo_queue;
+    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)tc->event_loop->todo_queue;
     MVMObject *task_obj;
 
     MVMROOT(tc, queue, {
@@ -25,7 +30,7 @@ static void setup_work(MVMThreadContext *tc) {
 
 /* Performs an async emit permit grant on the loop. */
 static void permit_work(MVMThreadContext *tc) {
-    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)tc->instance->event_loop_permit_queue;
+    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)tc->event_loop->permit_queue;
     MVMObject *task_arr;
 
     MVMROOT(tc, queue, {
@@ -43,7 +48,7 @@ static void permit_work(MVMThreadContext *tc) {
 
 /* Performs an async cancellation on the loop. */
 static void cancel_work(MVMThreadContext *tc) {
-    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)tc->instance->event_loop_cancel_queue;
+    MVMConcBlockingQueue *queue = (MVMConcBlockingQueue *)tc->event_loop->cancel_queue;
     MVMObject *task_obj;
 
     MVMROOT(tc, queue, {
@@ -67,6 +72,7 @@ static void async_handler(uv_async_t *handle) {
 
 /* Enters the event loop. */
 static void enter_loop(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args) {
+    MVMEventLoop *event_loop = tc->instance->event_loop_starting;
     uv_async_t   *async;
 
     /* Set up async handler so we can be woken up when there's new tasks. */
@@ -74,7 +80,8 @@ static void enter_loop(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister
     if (uv_async_init(tc->loop, async, async_handler) != 0)
         MVM_panic(1, "Unable to initialize async wake-up handle for event loop");
     async->data = tc;
-    tc->instance->event_loop_wakeup = async;
+    tc->event_loop = event_loop;
+    event_loop->wakeup = async;
 
     /* Signal that the event loop is ready for processing. */
     uv_sem_post(&(tc->instance->sem_event_loop_started));
@@ -84,74 +91,100 @@ static void enter_loop(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister
     MVM_panic(1, "Supposedly unending event loop thread ended");
 }
 
-/* Sees if we have an event loop processing thread set up already, and
- * sets it up if not. */
-static uv_loop_t *get_or_vivify_loop(MVMThreadContext *tc) {
+/* Starts the thread for an event loop. Called with the starting mutex held
+ * and the start semaphore initialized. */
+static void start_loop(MVMThreadContext *tc, MVMEventLoop *event_loop) {
     MVMInstance *instance = tc->instance;
+    MVMObject *thread, *loop_runner;
 
-    if (!instance->event_loop_thread) {
+    /* Create various bits of state the async event loop thread needs. */
+    event_loop->todo_queue   = MVM_repr_alloc_init(tc, instance->boot_types.BOOTQueue);
+    event_loop->permit_queue = MVM_repr_alloc_init(tc, instance->boot_types.BOOTQueue);
+    event_loop->cancel_queue = MVM_repr_alloc_init(tc, instance->boot_types.BOOTQueue);
+    event_loop->active       = MVM_repr_alloc_init(tc, instance->boot_types.BOOTArray);
+
+    /* Start the event loop thread, which will call a C function that sits in
+     * the uv loop, never leaving. */
+    instance->event_loop_starting = event_loop;
+    loop_runner = MVM_repr_alloc_init(tc, instance->boot_types.BOOTCCode);
+    ((MVMCFunction *)loop_runner)->body.func = enter_loop;
+    thread = MVM_thread_new(tc, loop_runner, 1);
+    MVMROOT(tc, thread, {
+        MVM_thread_run(tc, thread);
+
+        /* Block until we know it's fully started and initialized. */
+        MVM_gc_mark_thread_blocked(tc);
+        uv_sem_wait(&(instance->sem_event_loop_started));
+        MVM_gc_mark_thread_unblocked(tc);
+
+        event_loop->tc = ((MVMThread *)thread)->body.tc;
+    });
+}
+
+/* Sees if we have the event loop processing threads set up already, and
+ * sets them up if not. */
+static void get_or_vivify_loops(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+
+    if (!MVM_load(&instance->event_loops_started)) {
         /* Grab starting mutex and ensure we didn't lose the race. */
-        MVM_telemetry_timestamp(tc, "hoping to start an event loop thread");
+        MVM_telemetry_timestamp(tc, "hoping to start the event loop threads");
         MVM_gc_mark_thread_blocked(tc);
         uv_mutex_lock(&instance->mutex_event_loop_start);
         MVM_gc_mark_thread_unblocked(tc);
-        if (!instance->event_loop_thread) {
-            MVMObject *thread, *loop_runner;
+        if (!MVM_load(&instance->event_loops_started)) {
+            MVMuint32 i;
             int r;
             unsigned int interval_id;
 
-            interval_id = MVM_telemetry_interval_start(tc, "creating the event loop thread");
-
-            /* Create various bits of state the async event loop thread needs. */
-            instance->event_loop_todo_queue   = MVM_repr_alloc_init(tc,
-                instance->boot_types.BOOTQueue);
-            instance->event_loop_permit_queue = MVM_repr_alloc_init(tc,
-                instance->boot_types.BOOTQueue);
-            instance->event_loop_cancel_queue = MVM_repr_alloc_init(tc,
-                instance->boot_types.BOOTQueue);
-            instance->event_loop_active       = MVM_repr_alloc_init(tc,
-                instance->boot_types.BOOTArray);
+            interval_id = MVM_telemetry_interval_start(tc, "creating the event loop threads");
 
-            /* We need to wait until we know the event loop has started; we'll
-             * use a semaphore for this purpose. */
+            /* We need to wait until we know each event loop has started;
+             * we'll use a semaphore for this purpose. */
             if ((r = uv_sem_init(&(instance->sem_event_loop_started), 0)) < 0) {
                 uv_mutex_unlock(&instance->mutex_event_loop_start);
                 MVM_exception_throw_adhoc(tc, "Failed to initialize event loop start semaphore: %s",
                     uv_strerror(r));
             }
+            for (i = 0; i < instance->num_event_loops; i++)
+                start_loop(tc, &(instance->event_loops[i]));
+            uv_sem_destroy(&(instance->sem_event_loop_started));
 
-            /* Start the event loop thread, which will call a C function that
-             * sits in the uv loop, never leaving. */
-            loop_runner = MVM_repr_alloc_init(tc, instance->boot_types.BOOTCCode);
-            ((MVMCFunction *)loop_runner)->body.func = enter_loop;
-            thread = MVM_thread_new(tc, loop_runner, 1);
-            MVMROOT(tc, thread, {
-                MVM_thread_run(tc, thread);
-
-                /* Block until we know it's fully started and initialized. */
-                MVM_gc_mark_thread_blocked(tc);
-                uv_sem_wait(&(instance->sem_event_loop_started));
-                MVM_gc_mark_thread_unblocked(tc);
-                uv_sem_destroy(&(instance->sem_event_loop_started));
-
-                /* Make the started event loop thread visible to others. */
-                instance->event_loop_thread = ((MVMThread *)thread)->body.tc;
-            });
+            /* Make the started event loops visible to others. */
+            MVM_store(&instance->event_loops_started, 1);
 
-            MVM_telemetry_interval_stop(tc, interval_id, "created the event loop thread");
+            MVM_telemetry_interval_stop(tc, interval_id, "created the event loop threads");
         }
         uv_mutex_unlock(&instance->mutex_event_loop_start);
     }
+}
 
-    return instance->event_loop_thread->loop;
+/* Gets the next event loop in turn to hand work to. */
+MVMEventLoop * MVM_io_eventloop_next(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    return &(instance->event_loops[
+        (MVMuint32)MVM_incr(&instance->event_loop_next) % instance->num_event_loops]);
+}
+
+/* Gets the event loop a task is done on, choosing one if it has none yet, and
+ * makes sure it's running. */
+static MVMEventLoop * loop_for(MVMThreadContext *tc, MVMObject *task_obj) {
+    MVMAsyncTask *task;
+    MVMROOT(tc, task_obj, {
+        get_or_vivify_loops(tc);
+    });
+    task = (MVMAsyncTask *)task_obj;
+    if (!task->body.loop)
+        task->body.loop = tc->event_loop ? tc->event_loop : MVM_io_eventloop_next(tc);
+    return task->body.loop;
 }
 
 /* Adds a work item into the event loop work queue. */
 void MVM_io_eventloop_queue_work(MVMThreadContext *tc, MVMObject *work) {
     MVMROOT(tc, work, {
-        get_or_vivify_loop(tc);
-        MVM_repr_push_o(tc, tc->instance->event_loop_todo_queue, work);
-        uv_async_send(tc->instance->event_loop_wakeup);
+        MVMEventLoop *event_loop = loop_for(tc, work);
+        MVM_repr_push_o(tc, event_loop->todo_queue, work);
+        uv_async_send(event_loop->wakeup);
     });
 }
 
@@ -169,15 +202,16 @@ void MVM_io_eventloop_permit(MVMThreadContext *tc, MVMObject *task_obj,
             MVMROOT(tc, channel_box, {
             MVMROOT(tc, permits_box, {
             MVMROOT(tc, arr, {
+                MVMEventLoop *event_loop;
                 channel_box = MVM_repr_box_int(tc, tc->instance->boot_types.BOOTInt, channel);
                 permits_box = MVM_repr_box_int(tc, tc->instance->boot_types.BOOTInt, permits);
                 arr = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTArray);
                 MVM_repr_push_o(tc, arr, task_obj);
                 MVM_repr_push_o(tc, arr, channel_box);
                 MVM_repr_push_o(tc, arr, permits_box);
-                get_or_vivify_loop(tc);
-                MVM_repr_push_o(tc, tc->instance->event_loop_permit_queue, arr);
-                uv_async_send(tc->instance->event_loop_wakeup);
+                event_loop = loop_for(tc, task_obj);
+                MVM_repr_push_o(tc, event_loop->permit_queue, arr);
+                uv_async_send(event_loop->wakeup);
             });
             });
             });
@@ -200,9 +234,9 @@ void MVM_io_eventloop_cancel_work(MVMThreadContext *tc, MVMObject *task_obj,
                 notify_schedulee);
         }
         MVMROOT(tc, task_obj, {
-            get_or_vivify_loop(tc);
-            MVM_repr_push_o(tc, tc->instance->event_loop_cancel_queue, task_obj);
-            uv_async_send(tc->instance->event_loop_wakeup);
+            MVMEventLoop *event_loop = loop_for(tc, task_obj);
+            MVM_repr_push_o(tc, event_loop->cancel_queue, task_obj);
+            uv_async_send(event_loop->wakeup);
         });
     }
     else {
@@ -210,6 +244,75 @@ void MVM_io_eventloop_cancel_work(MVMThreadContext *tc, MVMObject *task_obj,
     }
 }
 
+/* Wakes up all of the event loops that are running, so they get to a GC
+ * sync point. */
+void MVM_io_eventloop_wake_all(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    MVMuint32 i;
+    for (i = 0; i < instance->num_event_loops; i++)
+        if (instance->event_loops[i].wakeup)
+            uv_async_send(instance->event_loops[i].wakeup);
+}
+
+/* Checks if the thread with the given ID is an event loop thread. */
+MVMint32 MVM_io_eventloop_is_loop_thread(MVMThreadContext *tc, MVMuint32 thread_id) {
+    MVMInstance *instance = tc->instance;
+    MVMuint32 i;
+    for (i = 0; i < instance->num_event_loops; i++)
+        if (instance->event_loops[i].tc && instance->event_loops[i].tc->thread_id == thread_id)
+            return 1;
+    return 0;
+}
+
+/* Gets a buffer for libuv to read into. Reads are done into buffers of a
+ * fixed size, taken from the loop's pool where possible. */
+void MVM_io_eventloop_alloc_read_buffer(MVMThreadContext *tc, size_t suggested_size, uv_buf_t *buf) {
+    MVMEventLoop *event_loop = tc->event_loop;
+    if (suggested_size <= MVM_IO_READ_BUFFER_SIZE) {
+        buf->base = event_loop->num_read_buffers
+            ? event_loop->read_buffers[--event_loop->num_read_buffers]
+            : MVM_malloc(MVM_IO_READ_BUFFER_SIZE);
+        buf->len  = MVM_IO_READ_BUFFER_SIZE;
+    }
+    else {
+        buf->base = MVM_malloc(suggested_size);
+        buf->len  = suggested_size;
+    }
+}
+
+/* Gives back a read buffer that is no longer needed, keeping it in the pool
+ * if there's space. */
+void MVM_io_eventloop_release_read_buffer(MVMThreadContext *tc, const uv_buf_t *buf) {
+    MVMEventLoop *event_loop = tc->event_loop;
+    if (!buf->base)
+        return;
+    if (buf->len == MVM_IO_READ_BUFFER_SIZE && event_loop->num_read_buffers < MVM_IO_READ_BUFFER_POOL)
+        event_loop->read_buffers[event_loop->num_read_buffers++] = buf->base;
+    else
+        MVM_free(buf->base);
+}
+
+/* Gets memory holding the nread bytes that were read into a buffer, for a
+ * buffer object to take ownership of, setting size to its size. If most of
+ * the read buffer was filled, that's handed over as it is; otherwise, the
+ * data is copied into memory of just the right size, and the read buffer
+ * goes back to the pool. Most reads are small, so this saves keeping a mostly
+ * empty buffer alive for each of them. */
+char * MVM_io_eventloop_take_read_buffer(MVMThreadContext *tc, const uv_buf_t *buf,
+                                         size_t nread, MVMuint64 *size) {
+    char *data;
+    if (nread >= buf->len / 2) {
+        *size = buf->len;
+        return buf->base;
+    }
+    data = nread ? MVM_malloc(nread) : NULL;
+    if (nread)
+        memcpy(data, buf->base, nread);
+    MVM_io_eventloop_release_read_buffer(tc, buf);
+    *size = nread;
+    return data;
+}
+
 /* Sends a task cancellation notification if requested for the specified task. */
 void MVM_io_eventloop_send_cancellation_notification(MVMThreadContext *tc, MVMAsyncTask *task) {
     MVMObject *notify_queue = task->body.cancel_notify_queue;
@@ -220,15 +323,15 @@ void MVM_io_eventloop_send_cancellation_notification(MVMThreadContext *tc, MVMAs
 
 /* Adds a work item to the active async task set. */
 int MVM_io_eventloop_add_active_work(MVMThreadContext *tc, MVMObject *async_task) {
-    int work_idx = MVM_repr_elems(tc, tc->instance->event_loop_active);
-    MVM_repr_push_o(tc, tc->instance->event_loop_active, async_task);
+    int work_idx = MVM_repr_elems(tc, tc->event_loop->active);
+    MVM_repr_push_o(tc, tc->event_loop->active, async_task);
     return work_idx;
 }
 
 /* Gets an active work item from the active work eventloop. */
 MVMAsyncTask * MVM_io_eventloop_get_active_work(MVMThreadContext *tc, int work_idx) {
-    if (work_idx >= 0 && work_idx < MVM_repr_elems(tc, tc->instance->event_loop_active)) {
-        MVMObject *task_obj = MVM_repr_at_pos_o(tc, tc->instance->event_loop_active, work_idx);
+    if (work_idx >= 0 && work_idx < MVM_repr_elems(tc, tc->event_loop->active)) {
+        MVMObject *task_obj = MVM_repr_at_pos_o(tc, tc->event_loop->active, work_idx);
         if (REPR(task_obj)->ID != MVM_REPR_ID_MVMAsyncTask)
             MVM_panic(1, "non-AsyncTask fetched from eventloop active work list");
         return (MVMAsyncTask *)task_obj;
@@ -243,9 +346,9 @@ MVMAsyncTask * MVM_io_eventloop_get_active_work(MVMThreadContext *tc, int work_i
  * so that any future use of the task will be a failed lookup. */
 void MVM_io_eventloop_remove_active_work(MVMThreadContext *tc, int *work_idx_to_clear) {
     int work_idx = *work_idx_to_clear;
-    if (work_idx >= 0 && work_idx < MVM_repr_elems(tc, tc->instance->event_loop_active)) {
+    if (work_idx >= 0 && work_idx < MVM_repr_elems(tc, tc->event_loop->active)) {
         *work_idx_to_clear = -1;
-        MVM_repr_bind_pos_o(tc, tc->instance->event_loop_active, work_idx, tc->instance->VMNull);
+        MVM_repr_bind_pos_o(tc, tc->event_loop->active, work_idx, tc->instance->VMNull);
         /* TODO: start to re-use the indices */
     }
     else {
@@ -1,3 +1,34 @@
+/* The size of the buffers reads are done into, and how many free ones each
+ * event loop keeps around for reuse. */
+#define MVM_IO_READ_BUFFER_SIZE     65536
+#define MVM_IO_READ_BUFFER_POOL     16
+
+/* An event loop, run by a thread of its own. There may be a number of them,
+ * with each task set up on one of them; everything that is done for the task
+ * afterwards, including the libuv callbacks for it, happens on that loop. */
+struct MVMEventLoop {
+    /* The thread running the loop, once it's started. */
+    MVMThreadContext *tc;
+
+    /* Concurrent queues of tasks to set up, permits to grant, and tasks to
+     * cancel on the loop. */
+    MVMObject *todo_queue;
+    MVMObject *permit_queue;
+    MVMObject *cancel_queue;
+
+    /* Tasks active on the loop, for the purpose of keeping them GC marked.
+     * Only touched by the loop's thread. */
+    MVMObject *active;
+
+    /* Used to wake the loop up when there's something in the queues. */
+    uv_async_t *wakeup;
+
+    /* Read buffers that are free for reuse. Only touched by the loop's
+     * thread. */
+    char      *read_buffers[MVM_IO_READ_BUFFER_POOL];
+    MVMuint32  num_read_buffers;
+};
+
 /* Operations table for a certain type of asynchronous task that can be run on
  * the event loop. */
 struct MVMAsyncTaskOps {
@@ -19,6 +50,13 @@ struct MVMAsyncTaskOps {
 };
 
 void MVM_io_eventloop_queue_work(MVMThreadContext *tc, MVMObject *work);
+void MVM_io_eventloop_wake_all(MVMThreadContext *tc);
+MVMint32 MVM_io_eventloop_is_loop_thread(MVMThreadContext *tc, MVMuint32 thread_id);
+MVMEventLoop * MVM_io_eventloop_next(MVMThreadContext *tc);
+void MVM_io_eventloop_alloc_read_buffer(MVMThreadContext *tc, size_t suggested_size, uv_buf_t *buf);
+void MVM_io_eventloop_release_read_buffer(MVMThreadContext *tc, const uv_buf_t *buf);
+char * MVM_io_eventloop_take_read_buffer(MVMThreadContext *tc, const uv_buf_t *buf,
+    size_t nread, MVMuint64 *size);
 void MVM_io_eventloop_permit(MVMThreadContext *tc, MVMObject *task_obj,
     MVMint64 channel, MVMint64 permits);
 void MVM_io_eventloop_cancel_work(MVMThreadContext *tc, MVMObject *task_obj,
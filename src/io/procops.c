@@ -307,6 +307,7 @@ static const MVMAsyncTaskOps write_op_table = {
 static MVMAsyncTask * write_bytes(MVMThreadContext *tc, MVMOSHandle *h, MVMObject *queue,
                                   MVMObject *schedulee, MVMObject *buffer, MVMObject *async_type) {
     MVMAsyncTask *task;
+    MVMAsyncTask *spawn_task;
     SpawnWriteInfo    *wi;
 
     /* Validate REPRs. */
@@ -340,6 +341,11 @@ static MVMAsyncTask * write_bytes(MVMThreadContext *tc, MVMOSHandle *h, MVMObjec
     MVM_ASSIGN_REF(tc, &(task->common.header), wi->buf_data, buffer);
     task->body.data = wi;
 
+    /* Write on the event loop the process was spawned on. */
+    spawn_task = (MVMAsyncTask *)((MVMIOAsyncProcessData *)h->body.data)->async_task;
+    if (spawn_task)
+        task->body.loop = spawn_task->body.loop;
+
     /* Hand the task off to the event loop. */
     MVMROOT(tc, task, {
         MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
@@ -394,6 +400,7 @@ static MVMint64 close_stdin(MVMThreadContext *tc, MVMOSHandle *h) {
         });
         task->body.ops  = &deferred_close_op_table;
         task->body.data = si;
+        task->body.loop = ((MVMAsyncTask *)handle_data->async_task)->body.loop;
         MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
         return 0;
     }
@@ -405,6 +412,7 @@ static MVMint64 close_stdin(MVMThreadContext *tc, MVMOSHandle *h) {
         });
         task->body.ops  = &close_op_table;
         task->body.data = si->stdin_handle;
+        task->body.loop = ((MVMAsyncTask *)handle_data->async_task)->body.loop;
         MVM_io_eventloop_queue_work(tc, (MVMObject *)task);
         si->stdin_handle = NULL;
     }
@@ -503,11 +511,9 @@ static void async_spawn_on_exit(uv_process_t *req, MVMint64 exit_status, int ter
         MVM_io_eventloop_remove_active_work(tc, &(si->work_idx));
 }
 
-/* Allocates a buffer of the suggested size. */
+/* Gets a buffer to read into from the event loop's pool. */
 static void on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
-    size_t size = suggested_size > 0 ? suggested_size : 4;
-    buf->base   = MVM_malloc(size);
-    buf->len    = size;
+    MVM_io_eventloop_alloc_read_buffer(((SpawnInfo *)handle->data)->tc, suggested_size, buf);
 }
 
 /* Read functions for stdout/stderr/merged. */
@@ -534,9 +540,9 @@ static void async_read(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf,
                 MVMObject *buf_type    = MVM_repr_at_key_o(tc, si->callbacks,
                                             tc->instance->str_consts.buf_type);
                 MVMArray  *res_buf     = (MVMArray *)MVM_repr_alloc_init(tc, buf_type);
-                res_buf->body.slots.i8 = (MVMint8 *)buf->base;
+                res_buf->body.slots.i8 = (MVMint8 *)MVM_io_eventloop_take_read_buffer(tc,
+                                            buf, nread, &(res_buf->body.ssize));
                 res_buf->body.start    = 0;
-                res_buf->body.ssize    = buf->len;
                 res_buf->body.elems    = nread;
                 MVM_repr_push_o(tc, arr, (MVMObject *)res_buf);
             }
@@ -570,8 +576,7 @@ static void async_read(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf,
             MVM_repr_push_o(tc, arr, tc->instance->boot_types.BOOTStr);
         });
         });
-        if (buf->base)
-            MVM_free(buf->base);
+        MVM_io_eventloop_release_read_buffer(tc, buf);
         uv_close((uv_handle_t *)handle, NULL);
         if (--si->using == 0)
             MVM_io_eventloop_remove_active_work(tc, &(si->work_idx));
@@ -588,8 +593,7 @@ static void async_read(uv_stream_t *handle, ssize_t nread, const uv_buf_t *buf,
             MVM_repr_push_o(tc, arr, msg_box);
         });
         });
-        if (buf->base)
-            MVM_free(buf->base);
+        MVM_io_eventloop_release_read_buffer(tc, buf);
         uv_close((uv_handle_t *)handle, NULL);
         if (--si->using == 0)
             MVM_io_eventloop_remove_active_work(tc, &(si->work_idx));
@@ -0,0 +1,145 @@
+#include "moar.h"
+
+MVMJitBailReport * MVM_jit_bail_report_create(MVMThreadContext *tc, FILE *fh) {
+    MVMJitBailReport *report = MVM_calloc(1, sizeof(MVMJitBailReport));
+    int init_stat;
+    report->fh = fh;
+    if ((init_stat = uv_mutex_init(&report->mutex)) < 0) {
+        fprintf(stderr, "MoarVM: Initialization of JIT bail report mutex failed\n    %s\n",
+            uv_strerror(init_stat));
+        exit(1);
+    }
+    return report;
+}
+
+/* The weight of a specialized frame; see the header. */
+static MVMuint64 frame_weight(MVMThreadContext *tc, MVMStaticFrame *sf) {
+    MVMStaticFrameSpesh *spesh = sf->body.spesh;
+    MVMSpeshStats *ss = spesh ? spesh->body.spesh_stats : NULL;
+    return ss ? (MVMuint64)ss->hits + ss->osr_hits : 0;
+}
+
+/* Records the outcome of trying to JIT-compile a spesh graph; bail_op is the
+ * op that could not be compiled, or NULL if the graph was compiled. */
+void MVM_jit_bail_report_record(MVMThreadContext *tc, MVMSpeshGraph *sg,
+                                const MVMOpInfo *bail_op) {
+    MVMJitBailReport *report = tc->instance->jit_bail_report;
+    MVMuint64 weight = frame_weight(tc, sg->sf);
+    char *frame = NULL;
+    MVMJitBailOp *op = NULL;
+    MVMuint32 i;
+
+    if (bail_op) {
+        char *name  = MVM_string_utf8_encode_C_string(tc, sg->sf->body.name);
+        char *cuuid = MVM_string_utf8_encode_C_string(tc, sg->sf->body.cuuid);
+        frame = MVM_malloc(strlen(name) + strlen(cuuid) + 4);
+        sprintf(frame, "%s (%s)", name, cuuid);
+        MVM_free(name);
+        MVM_free(cuuid);
+    }
+
+    uv_mutex_lock(&report->mutex);
+    if (!bail_op) {
+        report->compiled_frames++;
+        report->compiled_weight += weight;
+        uv_mutex_unlock(&report->mutex);
+        return;
+    }
+    report->bailed_frames++;
+    report->bailed_weight += weight;
+    for (i = 0; i < report->num_ops; i++) {
+        if (report->ops[i].info == bail_op) {
+            op = &(report->ops[i]);
+            break;
+        }
+    }
+    if (!op) {
+        if (report->num_ops == report->alloc_ops) {
+            report->alloc_ops = report->alloc_ops ? report->alloc_ops * 2 : 32;
+            report->ops = MVM_realloc(report->ops,
+                report->alloc_ops * sizeof(MVMJitBailOp));
+        }
+        op = &(report->ops[report->num_ops++]);
+        memset(op, 0, sizeof(MVMJitBailOp));
+        op->info = bail_op;
+    }
+    op->frames++;
+    op->weight += weight;
+    if (!op->top_frame || weight > op->top_weight) {
+        MVM_free(op->top_frame);
+        op->top_frame  = frame;
+        op->top_weight = weight;
+        frame = NULL;
+    }
+    uv_mutex_unlock(&report->mutex);
+    MVM_free(frame);
+}
+
+/* Heaviest first, then by the number of frames. */
+static int compare_ops(const void *a, const void *b) {
+    const MVMJitBailOp *op_a = (const MVMJitBailOp *)a;
+    const MVMJitBailOp *op_b = (const MVMJitBailOp *)b;
+    if (op_a->weight != op_b->weight)
+        return op_a->weight < op_b->weight ? 1 : -1;
+    if (op_a->frames != op_b->frames)
+        return op_a->frames < op_b->frames ? 1 : -1;
+    return strcmp(op_a->info->name, op_b->info->name);
+}
+
+static double percentage(MVMuint64 part, MVMuint64 total) {
+    return total ? 100.0 * part / total : 0.0;
+}
+
+/* Writes out the report and closes the file; later calls do nothing. */
+void MVM_jit_bail_report_write(MVMThreadContext *tc) {
+    MVMJitBailReport *report = tc->instance->jit_bail_report;
+    MVMuint32 total_frames;
+    MVMuint64 total_weight;
+    MVMuint32 i;
+    FILE *fh;
+
+    uv_mutex_lock(&report->mutex);
+    fh = report->fh;
+    report->fh = NULL;
+    if (!fh) {
+        uv_mutex_unlock(&report->mutex);
+        return;
+    }
+
+    total_frames = report->compiled_frames + report->bailed_frames;
+    total_weight = report->compiled_weight + report->bailed_weight;
+    fprintf(fh, "JIT bail report\n\n");
+    fprintf(fh, "Specialized frames:  %u (weight %"PRIu64")\n",
+        total_frames, total_weight);
+    fprintf(fh, "Compiled:            %u (%.1f%% of frames, %.1f%% of weight)\n",
+        report->compiled_frames,
+        percentage(report->compiled_frames, total_frames),
+        percentage(report->compiled_weight, total_weight));
+    fprintf(fh, "Bailed:              %u (%.1f%% of frames, %.1f%% of weight)\n\n",
+        report->bailed_frames,
+        percentage(report->bailed_frames, total_frames),
+        percentage(report->bailed_weight, total_weight));
+
+    qsort(report->ops, report->num_ops, sizeof(MVMJitBailOp), compare_ops);
+    fprintf(fh, "%12s %7s %8s  %-24s %s\n", "Weight", "Frames", "% weight",
+        "Op", "Heaviest frame");
+    for (i = 0; i < report->num_ops; i++) {
+        MVMJitBailOp *op = &(report->ops[i]);
+        fprintf(fh, "%12"PRIu64" %7u %7.1f%%  %-24s %s\n", op->weight,
+            op->frames, percentage(op->weight, total_weight), op->info->name,
+            op->top_frame);
+    }
+    fclose(fh);
+    uv_mutex_unlock(&report->mutex);
+}
+
+void MVM_jit_bail_report_destroy(MVMThreadContext *tc, MVMJitBailReport *report) {
+    MVMuint32 i;
+    if (report->fh)
+        fclose(report->fh);
+    for (i = 0; i < report->num_ops; i++)
+        MVM_free(report->ops[i].top_frame);
+    MVM_free(report->ops);
+    uv_mutex_destroy(&report->mutex);
+    MVM_free(report);
+}
@@ -0,0 +1,42 @@
+/* The JIT bail report shows how much of the specialized code ends up being
+ * compiled to machine code, and which ops are to blame for what doesn't. It
+ * is enabled by setting MVM_JIT_BAIL_REPORT to the name of a file, which is
+ * written at exit. Frames are weighted by the number of calls (and OSR
+ * entries) that had been recorded in their statistics at the point they were
+ * specialized, as an estimate of how hot they are. */
+
+/* Totals for frames that bailed on a particular op. */
+struct MVMJitBailOp {
+    const MVMOpInfo *info;
+    MVMuint32        frames;
+    MVMuint64        weight;
+
+    /* Name and cuuid of the heaviest frame that bailed on the op, and its
+     * weight. */
+    char      *top_frame;
+    MVMuint64  top_weight;
+};
+
+struct MVMJitBailReport {
+    /* The file to write the report to. */
+    FILE *fh;
+
+    /* Frames that were compiled, and those that bailed. */
+    MVMuint32 compiled_frames;
+    MVMuint64 compiled_weight;
+    MVMuint32 bailed_frames;
+    MVMuint64 bailed_weight;
+
+    /* Totals by op for the frames that bailed. */
+    MVMJitBailOp *ops;
+    MVMuint32     num_ops;
+    MVMuint32     alloc_ops;
+
+    /* Specialization workers may compile concurrently. */
+    uv_mutex_t mutex;
+};
+
+MVMJitBailReport * MVM_jit_bail_report_create(MVMThreadContext *tc, FILE *fh);
+void MVM_jit_bail_report_record(MVMThreadContext *tc, MVMSpeshGraph *sg, const MVMOpInfo *bail_op);
+void MVM_jit_bail_report_write(MVMThreadContext *tc);
+void MVM_jit_bail_report_destroy(MVMThreadContext *tc, MVMJitBailReport *report);
@@ -58,6 +58,9 @@ MVMJitCode * MVM_jit_compile_graph(MVMThreadContext *tc, MVMJitGraph *jg) {
         case MVM_JIT_NODE_DATA:
             MVM_jit_emit_data(tc, jg, &node->u.data, &state);
             break;
+        case MVM_JIT_NODE_EXPR:
+            MVM_jit_emit_expr(tc, jg, &node->u.expr, &state);
+            break;
         }
         node = node->next;
     }
@@ -0,0 +1,420 @@
+#include "moar.h"
+
+/* The machine registers values may be allocated to: rax, rcx, rdx, and r8
+ * to r11. These are all caller-saved, and templates treat them as scratch,
+ * so they are free for use within a tree. (Numbered as x64 encodes them.) */
+static const MVMint8 available_regs[] = { 0, 1, 2, 8, 9, 10, 11 };
+#define NUM_AVAILABLE_REGS ((MVMint32)(sizeof(available_regs) / sizeof(MVMint8)))
+
+/* The most nodes an instruction can add: two loads, a constant, and the
+ * operation itself. */
+#define MAX_NODES_PER_INS 4
+
+/* The value of a WORK register, as far as the tree has got. */
+typedef struct {
+    MVMint16 reg;
+    MVMint32 node;
+    MVMint32 written;
+
+    /* The node loading the original value, if it was read; -1 if not. */
+    MVMint32 load_node;
+
+    /* If written, the node after which the final value is stored. */
+    MVMint32 store_after;
+} RegValue;
+
+typedef struct {
+    MVMJitExprNode *nodes;
+    MVMint32        num_nodes;
+    RegValue       *values;
+    MVMint32        num_values;
+} ExprBuilder;
+
+/* Is this an instruction we can turn into part of a tree? */
+MVMint32 MVM_jit_expr_ins_ok(MVMThreadContext *tc, MVMSpeshIns *ins) {
+    switch (ins->info->opcode) {
+    case MVM_OP_const_i64:
+    case MVM_OP_const_i64_16:
+    case MVM_OP_const_i64_32:
+    case MVM_OP_set:
+    case MVM_OP_add_i:
+    case MVM_OP_sub_i:
+    case MVM_OP_mul_i:
+    case MVM_OP_band_i:
+    case MVM_OP_bor_i:
+    case MVM_OP_bxor_i:
+    case MVM_OP_neg_i:
+    case MVM_OP_bnot_i:
+    case MVM_OP_inc_i:
+    case MVM_OP_dec_i:
+    case MVM_OP_eq_i:
+    case MVM_OP_ne_i:
+    case MVM_OP_lt_i:
+    case MVM_OP_le_i:
+    case MVM_OP_gt_i:
+    case MVM_OP_ge_i:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static MVMint32 fits_in_32_bit(MVMint64 number) {
+    return number >= INT32_MIN && number <= INT32_MAX;
+}
+
+static MVMint32 is_commutative(MVMJitExprOp op) {
+    switch (op) {
+    case MVM_JIT_EXPR_ADD:
+    case MVM_JIT_EXPR_MUL:
+    case MVM_JIT_EXPR_AND:
+    case MVM_JIT_EXPR_OR:
+    case MVM_JIT_EXPR_XOR:
+    case MVM_JIT_EXPR_EQ:
+    case MVM_JIT_EXPR_NE:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* The comparison that gives the same result with the operands swapped. */
+static MVMJitExprOp mirror_comparison(MVMJitExprOp op) {
+    switch (op) {
+    case MVM_JIT_EXPR_LT: return MVM_JIT_EXPR_GT;
+    case MVM_JIT_EXPR_LE: return MVM_JIT_EXPR_GE;
+    case MVM_JIT_EXPR_GT: return MVM_JIT_EXPR_LT;
+    case MVM_JIT_EXPR_GE: return MVM_JIT_EXPR_LE;
+    default:              return op;
+    }
+}
+
+/* Computes an operation on constants, with the same wrap-around on
+ * overflow as the machine code would have. */
+static MVMint64 fold(MVMJitExprOp op, MVMint64 a, MVMint64 b) {
+    switch (op) {
+    case MVM_JIT_EXPR_ADD: return (MVMint64)((MVMuint64)a + (MVMuint64)b);
+    case MVM_JIT_EXPR_SUB: return (MVMint64)((MVMuint64)a - (MVMuint64)b);
+    case MVM_JIT_EXPR_MUL: return (MVMint64)((MVMuint64)a * (MVMuint64)b);
+    case MVM_JIT_EXPR_AND: return a & b;
+    case MVM_JIT_EXPR_OR:  return a | b;
+    case MVM_JIT_EXPR_XOR: return a ^ b;
+    case MVM_JIT_EXPR_NEG: return (MVMint64)(0 - (MVMuint64)a);
+    case MVM_JIT_EXPR_NOT: return ~a;
+    case MVM_JIT_EXPR_EQ:  return a == b;
+    case MVM_JIT_EXPR_NE:  return a != b;
+    case MVM_JIT_EXPR_LT:  return a < b;
+    case MVM_JIT_EXPR_LE:  return a <= b;
+    case MVM_JIT_EXPR_GT:  return a > b;
+    case MVM_JIT_EXPR_GE:  return a >= b;
+    default:               return 0;
+    }
+}
+
+static MVMint32 new_node(ExprBuilder *eb, MVMJitExprOp op, MVMint32 left,
+                         MVMint32 right, MVMint64 value) {
+    MVMJitExprNode *node = &(eb->nodes[eb->num_nodes]);
+    node->op       = op;
+    node->left     = left;
+    node->right    = right;
+    node->value    = value;
+    node->last_use = -1;
+    node->reg      = -1;
+    return eb->num_nodes++;
+}
+
+static MVMint32 add_const(ExprBuilder *eb, MVMint64 value) {
+    MVMint32 i;
+    for (i = 0; i < eb->num_nodes; i++)
+        if (eb->nodes[i].op == MVM_JIT_EXPR_CONST && eb->nodes[i].value == value)
+            return i;
+    return new_node(eb, MVM_JIT_EXPR_CONST, -1, -1, value);
+}
+
+/* Adds an operation, unless it can be folded or an equal one exists. */
+static MVMint32 add_op(ExprBuilder *eb, MVMJitExprOp op, MVMint32 left, MVMint32 right) {
+    MVMJitExprNode *nodes = eb->nodes;
+    MVMint32 i;
+
+    if (right < 0) {
+        if (nodes[left].op == MVM_JIT_EXPR_CONST)
+            return add_const(eb, fold(op, nodes[left].value, 0));
+    }
+    else {
+        if (nodes[left].op == MVM_JIT_EXPR_CONST && nodes[right].op == MVM_JIT_EXPR_CONST)
+            return add_const(eb, fold(op, nodes[left].value, nodes[right].value));
+
+        /* Keep constants on the right, where they can be immediates, and
+         * otherwise order the operands of commutative operations, so equal
+         * expressions are found. */
+        if (nodes[left].op == MVM_JIT_EXPR_CONST
+                ? is_commutative(op) || mirror_comparison(op) != op
+                : nodes[right].op != MVM_JIT_EXPR_CONST && right < left && is_commutative(op)) {
+            MVMint32 tmp = left;
+            left  = right;
+            right = tmp;
+            op    = mirror_comparison(op);
+        }
+    }
+
+    for (i = 0; i < eb->num_nodes; i++)
+        if (nodes[i].op == op && nodes[i].left == left && nodes[i].right == right)
+            return i;
+    return new_node(eb, op, left, right, 0);
+}
+
+static RegValue * find_value(ExprBuilder *eb, MVMint16 reg) {
+    MVMint32 i;
+    for (i = 0; i < eb->num_values; i++)
+        if (eb->values[i].reg == reg)
+            return &(eb->values[i]);
+    return NULL;
+}
+
+/* Gets the node for the current value of a WORK register, loading it if
+ * the tree hasn't seen it yet. */
+static MVMint32 get_value(ExprBuilder *eb, MVMSpeshOperand operand) {
+    MVMint16  reg = operand.reg.orig;
+    RegValue *rv  = find_value(eb, reg);
+    if (!rv) {
+        rv = &(eb->values[eb->num_values++]);
+        rv->reg       = reg;
+        rv->node      = new_node(eb, MVM_JIT_EXPR_LOAD, -1, -1, reg);
+        rv->written   = 0;
+        rv->load_node = rv->node;
+    }
+    return rv->node;
+}
+
+static void set_value(ExprBuilder *eb, MVMSpeshOperand operand, MVMint32 node) {
+    MVMint16  reg = operand.reg.orig;
+    RegValue *rv  = find_value(eb, reg);
+    if (!rv) {
+        rv = &(eb->values[eb->num_values++]);
+        rv->load_node = -1;
+    }
+    rv->reg     = reg;
+    rv->node    = node;
+    rv->written = 1;
+}
+
+static MVMJitExprOp binary_op(MVMuint16 opcode) {
+    switch (opcode) {
+    case MVM_OP_add_i:  return MVM_JIT_EXPR_ADD;
+    case MVM_OP_sub_i:  return MVM_JIT_EXPR_SUB;
+    case MVM_OP_mul_i:  return MVM_JIT_EXPR_MUL;
+    case MVM_OP_band_i: return MVM_JIT_EXPR_AND;
+    case MVM_OP_bor_i:  return MVM_JIT_EXPR_OR;
+    case MVM_OP_bxor_i: return MVM_JIT_EXPR_XOR;
+    case MVM_OP_eq_i:   return MVM_JIT_EXPR_EQ;
+    case MVM_OP_ne_i:   return MVM_JIT_EXPR_NE;
+    case MVM_OP_lt_i:   return MVM_JIT_EXPR_LT;
+    case MVM_OP_le_i:   return MVM_JIT_EXPR_LE;
+    case MVM_OP_gt_i:   return MVM_JIT_EXPR_GT;
+    default:            return MVM_JIT_EXPR_GE;
+    }
+}
+
+/* Adds the nodes for an instruction. */
+static void add_ins(ExprBuilder *eb, MVMSpeshIns *ins) {
+    MVMSpeshOperand *operands = ins->operands;
+    MVMint32 left, right;
+    switch (ins->info->opcode) {
+    case MVM_OP_const_i64:
+        set_value(eb, operands[0], add_const(eb, operands[1].lit_i64));
+        break;
+    case MVM_OP_const_i64_16:
+        set_value(eb, operands[0], add_const(eb, operands[1].lit_i16));
+        break;
+    case MVM_OP_const_i64_32:
+        set_value(eb, operands[0], add_const(eb, operands[1].lit_i32));
+        break;
+    case MVM_OP_set:
+        set_value(eb, operands[0], get_value(eb, operands[1]));
+        break;
+    case MVM_OP_inc_i:
+    case MVM_OP_dec_i:
+        left  = get_value(eb, operands[0]);
+        right = add_const(eb, 1);
+        set_value(eb, operands[0], add_op(eb,
+            ins->info->opcode == MVM_OP_inc_i ? MVM_JIT_EXPR_ADD : MVM_JIT_EXPR_SUB,
+            left, right));
+        break;
+    case MVM_OP_neg_i:
+    case MVM_OP_bnot_i:
+        left = get_value(eb, operands[1]);
+        set_value(eb, operands[0], add_op(eb,
+            ins->info->opcode == MVM_OP_neg_i ? MVM_JIT_EXPR_NEG : MVM_JIT_EXPR_NOT,
+            left, -1));
+        break;
+    default:
+        left  = get_value(eb, operands[1]);
+        right = get_value(eb, operands[2]);
+        set_value(eb, operands[0], add_op(eb, binary_op(ins->info->opcode), left, right));
+        break;
+    }
+}
+
+static void use(MVMJitExprNode *nodes, MVMint32 node, MVMint32 at) {
+    if (node >= 0 && nodes[node].last_use < at)
+        nodes[node].last_use = at;
+}
+
+/* Can a constant be used as an immediate everywhere it is needed? */
+static MVMint32 needs_reg(MVMJitExprNode *nodes, MVMint32 num_nodes, MVMint32 i) {
+    MVMint32 j;
+    if (nodes[i].op != MVM_JIT_EXPR_CONST)
+        return 1;
+    if (!fits_in_32_bit(nodes[i].value))
+        return 1;
+    for (j = i + 1; j <= nodes[i].last_use && j < num_nodes; j++) {
+        if (nodes[j].last_use < 0)
+            continue;
+        if (nodes[j].left == i)
+            return 1;
+        if (nodes[j].right == i && nodes[j].op == MVM_JIT_EXPR_MUL)
+            return 1;
+    }
+    return 0;
+}
+
+/* Assigns machine registers to values by a linear scan. Returns the node at
+ * which we ran out of registers, or -1 if all values got one. */
+static MVMint32 allocate_registers(MVMJitExprNode *nodes, MVMint32 num_nodes) {
+    MVMint32 owner[NUM_AVAILABLE_REGS];
+    MVMint32 i, r;
+    for (r = 0; r < NUM_AVAILABLE_REGS; r++)
+        owner[r] = -1;
+    for (i = 0; i < num_nodes; i++) {
+        MVMJitExprNode *node = &(nodes[i]);
+        MVMint32 chosen = -1;
+        if (node->last_use < 0 || !needs_reg(nodes, num_nodes, i))
+            continue;
+
+        /* Free registers holding values that are no longer needed. */
+        for (r = 0; r < NUM_AVAILABLE_REGS; r++)
+            if (owner[r] >= 0 && nodes[owner[r]].last_use < i)
+                owner[r] = -1;
+
+        /* If this is the last use of the left operand, compute the result
+         * in place, which is how x64 likes it. The right operand is still
+         * needed while computing, so is never reused. */
+        if (node->left >= 0 && nodes[node->left].last_use == i && nodes[node->left].reg >= 0
+                && node->left != node->right) {
+            for (r = 0; r < NUM_AVAILABLE_REGS; r++)
+                if (owner[r] == node->left)
+                    chosen = r;
+        }
+        if (chosen < 0)
+            for (r = 0; r < NUM_AVAILABLE_REGS && chosen < 0; r++)
+                if (owner[r] < 0)
+                    chosen = r;
+        if (chosen < 0)
+            return i;
+        owner[chosen] = i;
+        node->reg = available_regs[chosen];
+    }
+    return -1;
+}
+
+/* Builds a tree for the run of instructions starting at first_ins, which
+ * should all be accepted by MVM_jit_expr_ins_ok. If there are too many live
+ * values to keep in registers, the tree covers a shorter run; check its
+ * num_ins. Returns NULL if fewer than two instructions could be covered,
+ * since then there's nothing gained over the templates. */
+MVMJitExprTree * MVM_jit_expr_build(MVMThreadContext *tc, MVMSpeshGraph *sg,
+                                    MVMSpeshIns *first_ins, MVMint32 num_ins) {
+    ExprBuilder      eb;
+    MVMJitExprTree  *tree = NULL;
+    MVMint32        *ins_first_node;
+
+    if (num_ins > MVM_JIT_EXPR_MAX_INS)
+        num_ins = MVM_JIT_EXPR_MAX_INS;
+    eb.nodes       = MVM_malloc(num_ins * MAX_NODES_PER_INS * sizeof(MVMJitExprNode));
+    eb.values      = MVM_malloc(num_ins * 3 * sizeof(RegValue));
+    ins_first_node = MVM_malloc(num_ins * sizeof(MVMint32));
+
+    while (num_ins >= 2) {
+        MVMSpeshIns *ins = first_ins;
+        MVMint32 i, k, failed_at, num_stores;
+
+        /* Translate the instructions. */
+        eb.num_nodes  = 0;
+        eb.num_values = 0;
+        for (k = 0; k < num_ins; k++) {
+            ins_first_node[k] = eb.num_nodes;
+            add_ins(&eb, ins);
+            ins = ins->next;
+        }
+
+        /* Work out where the final value of each WORK register can be
+         * stored: once it is computed, and once the original value has been
+         * loaded, if it is needed. The stored value is kept until the node
+         * after that, so it isn't overwritten by computing in place. Then,
+         * going backwards, work out where the values of the nodes that are
+         * used at all are last needed. */
+        num_stores = 0;
+        for (i = 0; i < eb.num_values; i++) {
+            RegValue *rv = &(eb.values[i]);
+            if (!rv->written || rv->node == rv->load_node) {
+                rv->written = 0;
+                continue;
+            }
+            rv->store_after = rv->node > rv->load_node ? rv->node : rv->load_node;
+            use(eb.nodes, rv->node, rv->store_after + 1);
+            num_stores++;
+        }
+        for (i = eb.num_nodes - 1; i >= 0; i--) {
+            if (eb.nodes[i].last_use >= 0) {
+                use(eb.nodes, eb.nodes[i].left, i);
+                use(eb.nodes, eb.nodes[i].right, i);
+            }
+        }
+
+        failed_at = allocate_registers(eb.nodes, eb.num_nodes);
+        if (failed_at >= 0) {
+            /* Cut the run before the instruction that needed one register
+             * too many, and try again. */
+            for (k = num_ins - 1; k > 0 && ins_first_node[k] > failed_at; k--)
+                ;
+            MVM_jit_log(tc, "expression tree ran out of registers at instruction %d of %d\n",
+                        k, num_ins);
+            num_ins = k;
+            continue;
+        }
+
+        /* Success; copy it into the spesh graph's memory. */
+        tree = MVM_spesh_alloc(tc, sg, sizeof(MVMJitExprTree));
+        tree->first_ins  = first_ins;
+        tree->num_ins    = num_ins;
+        tree->num_nodes  = eb.num_nodes;
+        tree->nodes      = MVM_spesh_alloc(tc, sg, eb.num_nodes * sizeof(MVMJitExprNode));
+        memcpy(tree->nodes, eb.nodes, eb.num_nodes * sizeof(MVMJitExprNode));
+        tree->num_stores = 0;
+        tree->stores     = num_stores
+            ? MVM_spesh_alloc(tc, sg, num_stores * sizeof(MVMJitExprStore))
+            : NULL;
+        for (i = 0; i < eb.num_values; i++) {
+            RegValue *rv = &(eb.values[i]);
+            MVMint32  j;
+            if (!rv->written)
+                continue;
+            j = tree->num_stores++;
+            while (j > 0 && tree->stores[j - 1].after > rv->store_after) {
+                tree->stores[j] = tree->stores[j - 1];
+                j--;
+            }
+            tree->stores[j].node  = rv->node;
+            tree->stores[j].reg   = rv->reg;
+            tree->stores[j].after = rv->store_after;
+        }
+        MVM_jit_log(tc, "expression tree for %d instructions: %d nodes, %d stores\n",
+                    num_ins, tree->num_nodes, tree->num_stores);
+        break;
+    }
+
+    MVM_free(eb.nodes);
+    MVM_free(eb.values);
+    MVM_free(ins_first_node);
+    return tree;
+}
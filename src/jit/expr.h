@@ -0,0 +1,80 @@
+/* The expression JIT. Rather than emitting a fixed template for each
+ * instruction, which loads its operands from the WORK area and stores its
+ * result back, runs of pure integer instructions within a basic block are
+ * translated into a tree of values (really a DAG, as common subexpressions
+ * are shared and constants are folded). Machine registers are then assigned
+ * to the values by a linear scan, so each WORK register is loaded at most
+ * once in a run, and only the final value of each WORK register written is
+ * stored back. */
+
+/* The most instructions we consider for a single tree. */
+#define MVM_JIT_EXPR_MAX_INS 64
+
+/* Operators of the tree. */
+typedef enum {
+    /* The value of a WORK register at the start of the tree. */
+    MVM_JIT_EXPR_LOAD,
+    MVM_JIT_EXPR_CONST,
+    MVM_JIT_EXPR_ADD,
+    MVM_JIT_EXPR_SUB,
+    MVM_JIT_EXPR_MUL,
+    MVM_JIT_EXPR_AND,
+    MVM_JIT_EXPR_OR,
+    MVM_JIT_EXPR_XOR,
+    MVM_JIT_EXPR_NEG,
+    MVM_JIT_EXPR_NOT,
+    MVM_JIT_EXPR_EQ,
+    MVM_JIT_EXPR_NE,
+    MVM_JIT_EXPR_LT,
+    MVM_JIT_EXPR_LE,
+    MVM_JIT_EXPR_GT,
+    MVM_JIT_EXPR_GE
+} MVMJitExprOp;
+
+/* A value in the tree. Nodes only ever refer to earlier nodes, so the node
+ * order is also the evaluation order. */
+struct MVMJitExprNode {
+    MVMJitExprOp op;
+
+    /* Operand nodes; -1 if not used by the operator. */
+    MVMint32 left;
+    MVMint32 right;
+
+    /* The constant value, or the WORK register to load. */
+    MVMint64 value;
+
+    /* The last node that needs this value (a store counts as a use by the
+     * node following the one it is emitted after); -1 if the value is
+     * dead. */
+    MVMint32 last_use;
+
+    /* The machine register holding the value, or -1 if it has none (it is
+     * dead, or a constant used as an immediate). */
+    MVMint8 reg;
+};
+
+/* A store of a final value to a WORK register. */
+struct MVMJitExprStore {
+    /* The value to store, the WORK register, and the node after which the
+     * store is emitted. */
+    MVMint32 node;
+    MVMint16 reg;
+    MVMint32 after;
+};
+
+struct MVMJitExprTree {
+    MVMJitExprNode  *nodes;
+    MVMint32         num_nodes;
+
+    /* Stores, ordered by the node they follow. */
+    MVMJitExprStore *stores;
+    MVMint32         num_stores;
+
+    /* The instructions the tree replaces. */
+    MVMSpeshIns     *first_ins;
+    MVMint32         num_ins;
+};
+
+MVMint32 MVM_jit_expr_ins_ok(MVMThreadContext *tc, MVMSpeshIns *ins);
+MVMJitExprTree * MVM_jit_expr_build(MVMThreadContext *tc, MVMSpeshGraph *sg,
+                                    MVMSpeshIns *first_ins, MVMint32 num_ins);
@@ -24,6 +24,9 @@ typedef struct {
 
     MVMint32       num_inlines;
     MVMJitInline  *inlines;
+
+    /* The op we could not compile, if we had to bail. */
+    const MVMOpInfo *bail_op;
 } JitGraphBuilder;
 
 
@@ -137,6 +140,26 @@ static void add_deopt_idx(MVMThreadContext *tc, JitGraphBuilder *jgb, MVMint32 l
 }
 
 
+static MVMint32 is_optional_param(MVMuint16 op) {
+    switch (op) {
+    case MVM_OP_param_op_i:
+    case MVM_OP_param_op_n:
+    case MVM_OP_param_op_s:
+    case MVM_OP_param_op_o:
+    case MVM_OP_param_on_i:
+    case MVM_OP_param_on_n:
+    case MVM_OP_param_on_s:
+    case MVM_OP_param_on_o:
+    case MVM_OP_param_on2_i:
+    case MVM_OP_param_on2_n:
+    case MVM_OP_param_on2_s:
+    case MVM_OP_param_on2_o:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
 static void jgb_append_branch(MVMThreadContext *tc, JitGraphBuilder *jgb,
                               MVMint32 name, MVMSpeshIns *ins) {
     MVMJitNode * node = MVM_spesh_alloc(tc, jgb->sg, sizeof(MVMJitNode));
@@ -155,6 +178,10 @@ static void jgb_append_branch(MVMThreadContext *tc, JitGraphBuilder *jgb,
                  ins->info->opcode == MVM_OP_indexnat) {
             bb = ins->operands[3].ins_bb;
         }
+        else if (is_optional_param(ins->info->opcode)) {
+            /* The label to go to if the argument was passed is last. */
+            bb = ins->operands[ins->info->num_operands - 1].ins_bb;
+        }
         else {
             bb = ins->operands[1].ins_bb;
         }
@@ -210,6 +237,12 @@ static void * op_to_func(MVMThreadContext *tc, MVMint16 opcode) {
     case MVM_OP_throwcatdyn:
     case MVM_OP_throwcatlex:
     case MVM_OP_throwcatlexotic: return MVM_exception_throwcat;
+    case MVM_OP_throwpayloadlex:
+    case MVM_OP_throwpayloadlexcaller: return MVM_exception_throwpayload;
+    case MVM_OP_getexmessage: return MVM_exception_get_message;
+    case MVM_OP_getexpayload: return MVM_exception_get_payload;
+    case MVM_OP_getexcategory: return MVM_exception_get_category;
+    case MVM_OP_bindexcategory: return MVM_exception_bind_category;
     case MVM_OP_resume: return MVM_exception_resume;
     case MVM_OP_continuationreset: return MVM_continuation_reset;
     case MVM_OP_continuationcontrol: return MVM_continuation_control;
@@ -320,11 +353,15 @@ static void * op_to_func(MVMThreadContext *tc, MVMint16 opcode) {
     case MVM_OP_fc: return MVM_string_fc;
     case MVM_OP_eq_s: return MVM_string_equal;
     case MVM_OP_eqat_s: return MVM_string_equal_at;
+    case MVM_OP_eqatic_s: return MVM_string_equal_at_ignore_case;
+    case MVM_OP_haveat_s: return MVM_string_have_at;
+    case MVM_OP_ordbaseat: return MVM_string_ord_basechar_at;
     case MVM_OP_chars: case MVM_OP_graphs_s: return MVM_string_graphs;
     case MVM_OP_chr: return MVM_string_chr;
     case MVM_OP_codes_s: return MVM_string_codes;
     case MVM_OP_getcp_s: return MVM_string_get_grapheme_at;
     case MVM_OP_index_s: return MVM_string_index;
+    case MVM_OP_indexic_s: return MVM_string_index_ignore_case;
     case MVM_OP_substr_s: return MVM_string_substring;
     case MVM_OP_join: return MVM_string_join;
     case MVM_OP_replace: return MVM_string_replace;
@@ -544,6 +581,7 @@ static MVMint32 jgb_consume_invoke(MVMThreadContext *tc, JitGraphBuilder *jgb,
         default:
             MVM_jit_log(tc, "Unexpected opcode in invoke sequence: <%s>\n",
                         ins->info->name);
+            jgb->bail_op = ins->info;
             return 0;
         }
     }
@@ -552,6 +590,8 @@ static MVMint32 jgb_consume_invoke(MVMThreadContext *tc, JitGraphBuilder *jgb,
         MVM_jit_log(tc, "Could not find invoke opcode or enough arguments\n"
                     "BAIL: op <%s>, expected args: %d, num of args: %d\n",
                     ins? ins->info->name : "NULL", i, cs->arg_count);
+        if (ins)
+            jgb->bail_op = ins->info;
         return 0;
     }
     MVM_jit_log(tc, "Invoke instruction: <%s>\n", ins->info->name);
@@ -1645,6 +1685,8 @@ static MVMint32 jgb_consume_ins(MVMThreadContext *tc, JitGraphBuilder *jgb,
     case MVM_OP_getstdin:
     case MVM_OP_ordat:
     case MVM_OP_ordfirst:
+    case MVM_OP_istrue_s:
+    case MVM_OP_isfalse_s:
     case MVM_OP_setcodeobj:
         /* Profiling */
     case MVM_OP_prof_enterspesh:
@@ -1683,6 +1725,49 @@ static MVMint32 jgb_consume_ins(MVMThreadContext *tc, JitGraphBuilder *jgb,
                                  { MVM_JIT_LITERAL, { arg_idx } } };
         jgb_append_call_c(tc, jgb, MVM_args_get_required_pos_obj, 3, args, MVM_JIT_RV_PTR, dst);
         break;
+    }
+    case MVM_OP_param_rp_s:
+    case MVM_OP_param_op_i:
+    case MVM_OP_param_op_n:
+    case MVM_OP_param_op_s:
+    case MVM_OP_param_op_o:
+    case MVM_OP_param_rn_i:
+    case MVM_OP_param_rn_n:
+    case MVM_OP_param_rn_s:
+    case MVM_OP_param_rn_o:
+    case MVM_OP_param_on_i:
+    case MVM_OP_param_on_n:
+    case MVM_OP_param_on_s:
+    case MVM_OP_param_on_o:
+    case MVM_OP_param_rn2_i:
+    case MVM_OP_param_rn2_n:
+    case MVM_OP_param_rn2_s:
+    case MVM_OP_param_rn2_o:
+    case MVM_OP_param_on2_i:
+    case MVM_OP_param_on2_n:
+    case MVM_OP_param_on2_s:
+    case MVM_OP_param_on2_o: {
+        /* See MVM_args_param_for_jit for the operand encoding. */
+        MVMint16  dst = ins->operands[0].reg.orig;
+        MVMuint64 operand;
+        if (ins->info->operands[1] == MVM_operand_int16)
+            operand = ins->operands[1].lit_ui16;
+        else
+            operand = ins->operands[1].lit_str_idx;
+        if (ins->info->num_operands > 2 && ins->info->operands[2] == MVM_operand_str)
+            operand |= (MVMuint64)ins->operands[2].lit_str_idx << 32;
+        {
+            MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                     { MVM_JIT_LITERAL, { op } },
+                                     { MVM_JIT_LITERAL_64, { operand } },
+                                     { MVM_JIT_REG_ADDR, { dst } } };
+            jgb_append_call_c(tc, jgb, MVM_args_param_for_jit, 4, args, MVM_JIT_RV_VOID, -1);
+        }
+        /* For optional parameters, the branch tests the result of the call
+         * we just made. */
+        if (is_optional_param(op))
+            jgb_append_branch(tc, jgb, 0, ins);
+        break;
     }
         /* branches */
     case MVM_OP_goto:
@@ -1853,6 +1938,43 @@ static MVMint32 jgb_consume_ins(MVMThreadContext *tc, JitGraphBuilder *jgb,
                           4, args, MVM_JIT_RV_VOID, -1);
         break;
     }
+    case MVM_OP_throwpayloadlex:
+    case MVM_OP_throwpayloadlexcaller: {
+        MVMint16 regi     = ins->operands[0].reg.orig;
+        MVMint32 category = (MVMuint32)ins->operands[1].lit_i64;
+        MVMint16 payload  = ins->operands[2].reg.orig;
+        MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                 { MVM_JIT_LITERAL, {
+                                   op == MVM_OP_throwpayloadlex ? MVM_EX_THROW_LEX :
+                                                                  MVM_EX_THROW_LEX_CALLER
+                                   } },
+                                 { MVM_JIT_LITERAL, { category } },
+                                 { MVM_JIT_REG_VAL, { payload } },
+                                 { MVM_JIT_REG_ADDR, { regi } }};
+        jgb_append_call_c(tc, jgb, op_to_func(tc, op),
+                          5, args, MVM_JIT_RV_VOID, -1);
+        break;
+    }
+    case MVM_OP_getexmessage:
+    case MVM_OP_getexpayload:
+    case MVM_OP_getexcategory: {
+        MVMint16 dst = ins->operands[0].reg.orig;
+        MVMint16 ex  = ins->operands[1].reg.orig;
+        MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                 { MVM_JIT_REG_VAL, { ex } } };
+        jgb_append_call_c(tc, jgb, op_to_func(tc, op), 2, args,
+                          op == MVM_OP_getexcategory ? MVM_JIT_RV_INT : MVM_JIT_RV_PTR, dst);
+        break;
+    }
+    case MVM_OP_bindexcategory: {
+        MVMint16 ex       = ins->operands[0].reg.orig;
+        MVMint16 category = ins->operands[1].reg.orig;
+        MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                 { MVM_JIT_REG_VAL, { ex } },
+                                 { MVM_JIT_REG_VAL, { category } } };
+        jgb_append_call_c(tc, jgb, op_to_func(tc, op), 3, args, MVM_JIT_RV_VOID, -1);
+        break;
+    }
     case MVM_OP_resume: {
         MVMint16 exc = ins->operands[0].reg.orig;
         MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
@@ -2121,6 +2243,7 @@ static MVMint32 jgb_consume_ins(MVMThreadContext *tc, JitGraphBuilder *jgb,
     case MVM_OP_elems:
         if (!jgb_consume_reprop(tc, jgb, bb, ins)) {
             MVM_jit_log(tc, "BAIL: op <%s> (devirt attempted)\n", ins->info->name);
+            jgb->bail_op = ins->info;
             return 0;
         }
         break;
@@ -2390,7 +2513,8 @@ static MVMint32 jgb_consume_ins(MVMThreadContext *tc, JitGraphBuilder *jgb,
         }
         break;
     }
-    case MVM_OP_eqat_s: {
+    case MVM_OP_eqat_s:
+    case MVM_OP_eqatic_s: {
         MVMint16 dst    = ins->operands[0].reg.orig;
         MVMint16 src_a  = ins->operands[1].reg.orig;
         MVMint16 src_b  = ins->operands[2].reg.orig;
@@ -2403,6 +2527,32 @@ static MVMint32 jgb_consume_ins(MVMThreadContext *tc, JitGraphBuilder *jgb,
                           MVM_JIT_RV_INT, dst);
         break;
     }
+    case MVM_OP_ordbaseat: {
+        MVMint16 dst = ins->operands[0].reg.orig;
+        MVMint16 str = ins->operands[1].reg.orig;
+        MVMint16 idx = ins->operands[2].reg.orig;
+        MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                 { MVM_JIT_REG_VAL, { str } },
+                                 { MVM_JIT_REG_VAL, { idx } } };
+        jgb_append_call_c(tc, jgb, op_to_func(tc, op), 3, args, MVM_JIT_RV_INT, dst);
+        break;
+    }
+    case MVM_OP_haveat_s: {
+        MVMint16 dst        = ins->operands[0].reg.orig;
+        MVMint16 src_a      = ins->operands[1].reg.orig;
+        MVMint16 start_a    = ins->operands[2].reg.orig;
+        MVMint16 length     = ins->operands[3].reg.orig;
+        MVMint16 src_b      = ins->operands[4].reg.orig;
+        MVMint16 start_b    = ins->operands[5].reg.orig;
+        MVMJitCallArg args[] = { { MVM_JIT_INTERP_VAR, { MVM_JIT_INTERP_TC } },
+                                 { MVM_JIT_REG_VAL, { src_a } },
+                                 { MVM_JIT_REG_VAL, { start_a } },
+                                 { MVM_JIT_REG_VAL, { length } },
+                                 { MVM_JIT_REG_VAL, { src_b } },
+                                 { MVM_JIT_REG_VAL, { start_b } } };
+        jgb_append_call_c(tc, jgb, op_to_func(tc, op), 6, args, MVM_JIT_RV_INT, dst);
+        break;
+    }
     case MVM_OP_chars:
     case MVM_OP_graphs_s:
     case MVM_OP_codes_s:
@@ -2469,7 +2619,8 @@ static MVMint32 jgb_consume_ins(MVMThreadContext *tc, JitGraphBuilder *jgb,
         jgb_append_call_c(tc, jgb, op_to_func(tc, op), 4, args, MVM_JIT_RV_PTR, dst);
         break;
     }
-    case MVM_OP_index_s: {
+    case MVM_OP_index_s:
+    case MVM_OP_indexic_s: {
         MVMint16 dst = ins->operands[0].reg.orig;
         MVMint16 haystack = ins->operands[1].reg.orig;
         MVMint16 needle = ins->operands[2].reg.orig;
@@ -3028,6 +3179,7 @@ static MVMint32 jgb_consume_ins(MVMThreadContext *tc, JitGraphBuilder *jgb,
         }
         if (!emitted_extop) {
             MVM_jit_log(tc, "BAIL: op <%s>\n", ins->info->name);
+            jgb->bail_op = ins->info;
             return 0;
         }
     }
@@ -3035,6 +3187,76 @@ static MVMint32 jgb_consume_ins(MVMThreadContext *tc, JitGraphBuilder *jgb,
     return 1;
 }
 
+/* Annotations that need a label before an instruction, so that it can't be
+ * part of an expression tree unless it starts it. */
+static MVMint32 has_before_label(MVMSpeshIns *ins) {
+    MVMSpeshAnn *ann = ins->annotations;
+    while (ann) {
+        switch (ann->type) {
+        case MVM_SPESH_ANN_DEOPT_OSR:
+        case MVM_SPESH_ANN_FH_START:
+        case MVM_SPESH_ANN_FH_END:
+        case MVM_SPESH_ANN_FH_GOTO:
+        case MVM_SPESH_ANN_INLINE_START:
+            return 1;
+        }
+        ann = ann->next;
+    }
+    return 0;
+}
+
+/* Annotations that need a label after an instruction, so that it has to end
+ * an expression tree. */
+static MVMint32 has_after_label(MVMSpeshIns *ins) {
+    MVMSpeshAnn *ann = ins->annotations;
+    while (ann) {
+        if (ann->type == MVM_SPESH_ANN_INLINE_END ||
+            ann->type == MVM_SPESH_ANN_DEOPT_ALL_INS)
+            return 1;
+        ann = ann->next;
+    }
+    return 0;
+}
+
+/* Tries to compile a run of pure integer instructions, starting with ins,
+ * as an expression tree. On success, the current instruction is left at the
+ * last one in the tree, and after_ins processing has been done for it. */
+static MVMint32 jgb_consume_expr(MVMThreadContext *tc, JitGraphBuilder *jgb,
+                                 MVMSpeshBB *bb, MVMSpeshIns *ins) {
+    MVMSpeshIns    *last_ins = ins;
+    MVMint32        num_ins  = 1;
+    MVMJitExprTree *tree;
+    MVMJitNode     *node;
+    MVMint32        i;
+
+    if (!tc->instance->jit_expr_enabled || !MVM_jit_expr_ins_ok(tc, ins))
+        return 0;
+    while (num_ins < MVM_JIT_EXPR_MAX_INS && !has_after_label(last_ins) &&
+           last_ins->next && MVM_jit_expr_ins_ok(tc, last_ins->next) &&
+           !has_before_label(last_ins->next)) {
+        last_ins = last_ins->next;
+        num_ins++;
+    }
+    if (num_ins < 2)
+        return 0;
+
+    tree = MVM_jit_expr_build(tc, jgb->sg, ins, num_ins);
+    if (!tree)
+        return 0;
+
+    node = MVM_spesh_alloc(tc, jgb->sg, sizeof(MVMJitNode));
+    node->type   = MVM_JIT_NODE_EXPR;
+    node->u.expr = *tree;
+    jgb_append_node(jgb, node);
+
+    /* The tree may cover fewer instructions than we offered it. */
+    for (i = 1; i < tree->num_ins; i++)
+        ins = ins->next;
+    jgb_after_ins(tc, jgb, bb, ins);
+    jgb->cur_ins = ins;
+    return 1;
+}
+
 static MVMint32 jgb_consume_bb(MVMThreadContext *tc, JitGraphBuilder *jgb,
                                MVMSpeshBB *bb) {
     MVMint32 label = get_label_for_bb(tc, jgb, bb);
@@ -3050,9 +3272,11 @@ static MVMint32 jgb_consume_bb(MVMThreadContext *tc, JitGraphBuilder *jgb,
     jgb->cur_ins = bb->first_ins;
     while (jgb->cur_ins) {
         jgb_before_ins(tc, jgb, jgb->cur_bb, jgb->cur_ins);
-        if(!jgb_consume_ins(tc, jgb, jgb->cur_bb, jgb->cur_ins))
-            return 0;
-        jgb_after_ins(tc, jgb, jgb->cur_bb, jgb->cur_ins);
+        if (!jgb_consume_expr(tc, jgb, jgb->cur_bb, jgb->cur_ins)) {
+            if(!jgb_consume_ins(tc, jgb, jgb->cur_bb, jgb->cur_ins))
+                return 0;
+            jgb_after_ins(tc, jgb, jgb->cur_bb, jgb->cur_ins);
+        }
         jgb->cur_ins = jgb->cur_ins->next;
     }
     return 1;
@@ -3118,15 +3342,24 @@ MVMJitGraph * MVM_jit_try_make_graph(MVMThreadContext *tc, MVMSpeshGraph *sg) {
     /* guess what inlines are indexed by */
     jgb.num_inlines  = sg->num_inlines;
     jgb.inlines      = sg->num_inlines ? MVM_spesh_alloc(tc, sg, sizeof(MVMJitInline) * sg->num_inlines) : NULL;
+    jgb.bail_op      = NULL;
     /* loop over basic blocks, adding one after the other */
     while (jgb.cur_bb) {
-        if (!jgb_consume_bb(tc, &jgb, jgb.cur_bb))
+        if (!jgb_consume_bb(tc, &jgb, jgb.cur_bb)) {
+            /* Not every way to fail says which op was to blame; if not, it
+             * was the one we were at. */
+            if (tc->instance->jit_bail_report)
+                MVM_jit_bail_report_record(tc, sg,
+                    jgb.bail_op ? jgb.bail_op : jgb.cur_ins->info);
             return NULL;
+        }
         jgb.cur_bb = jgb.cur_bb->linear_next;
     }
     /* Check if we've added a instruction at all */
     if (!jgb.first_node)
         return NULL;
+    if (tc->instance->jit_bail_report)
+        MVM_jit_bail_report_record(tc, sg, NULL);
     /* append the end-of-graph label */
     jgb_append_label(tc, &jgb, get_label_for_graph(tc, &jgb, sg));
     return jgb_build(tc, &jgb);
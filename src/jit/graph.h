@@ -178,6 +178,7 @@ typedef enum {
     MVM_JIT_NODE_JUMPLIST,
     MVM_JIT_NODE_CONTROL,
     MVM_JIT_NODE_DATA,
+    MVM_JIT_NODE_EXPR,
 } MVMJitNodeType;
 
 struct MVMJitNode {
@@ -193,6 +194,7 @@ struct MVMJitNode {
         MVMJitJumpList  jumplist;
         MVMJitControl   control;
         MVMJitData      data;
+        MVMJitExprTree  expr;
     } u;
 };
 
@@ -38,3 +38,4 @@ void MVM_jit_emit_jumplist(MVMThreadContext *tc, MVMJitGraph *jg,
 void MVM_jit_emit_control(MVMThreadContext *tc, MVMJitGraph *jg,
                           MVMJitControl *ctrl, dasm_State **Dst) {}
 void MVM_jit_emit_data(MVMThreadContext *tc, MVMJitGraph *jg, MVMJitData *data, dasm_State **Dst) {}
+void MVM_jit_emit_expr(MVMThreadContext *tc, MVMJitGraph *jg, MVMJitExprTree *tree, dasm_State **Dst) {}
@@ -19,30 +19,20 @@ MVM_STATIC_INLINE void adjust_nursery(MVMThreadContext *tc, MVMP6bigintBody *bod
     }
 }
 
-/* Taken from mp_set_long, but portably accepts a 64-bit number. */
+/* Sets a bigint to an unsigned 64-bit number, filling in the digits directly
+ * rather than shifting the number in a few bits at a time. */
 int MVM_bigint_mp_set_uint64(mp_int * a, MVMuint64 b) {
-  int     x, res;
+    int res, x = 0;
 
-  mp_zero (a);
-
-  /* set four bits at a time */
-  for (x = 0; x < sizeof(MVMuint64) * 2; x++) {
-    /* shift the number up four bits */
-    if ((res = mp_mul_2d (a, 4, a)) != MP_OKAY) {
-      return res;
+    mp_zero(a);
+    if ((res = mp_grow(a, (64 + DIGIT_BIT - 1) / DIGIT_BIT)) != MP_OKAY)
+        return res;
+    while (b) {
+        DIGIT(a, x++) = (mp_digit)(b & MP_MASK);
+        b >>= DIGIT_BIT;
     }
-
-    /* OR in the top four bits of the source */
-    a->dp[0] |= (b >> ((sizeof(MVMuint64)) * 8 - 4)) & 15;
-
-    /* shift the source up to the next four bits */
-    b <<= 4;
-
-    /* ensure that digits are not clamped off */
-    a->used += 1;
-  }
-  mp_clamp(a);
-  return MP_OKAY;
+    USED(a) = x;
+    return MP_OKAY;
 }
 
 static MVMnum64 mp_get_double(mp_int *a) {
@@ -186,7 +176,7 @@ static void store_int64_result(MVMP6bigintBody *body, MVMint64 result) {
             MVM_bigint_mp_set_uint64(i, (MVMuint64)result);
         }
         else {
-            MVM_bigint_mp_set_uint64(i, (MVMuint64)-result);
+            MVM_bigint_mp_set_uint64(i, -(MVMuint64)result);
             mp_neg(i, i);
         }
         body->u.bigint = i;
@@ -208,6 +198,153 @@ static void store_bigint_result(MVMP6bigintBody *body, mp_int *i) {
     }
 }
 
+/* Gets the value of a bigint body as a 64-bit integer, if it fits. This is
+ * always the case for a smallint, and for a bigint of up to 63 bits of
+ * magnitude, so values that got just past the smallint range can still be
+ * worked on without involving the big integer library. */
+static int get_int64(const MVMP6bigintBody *body, MVMint64 *value) {
+    if (MVM_BIGINT_IS_BIG(body)) {
+        const mp_int *i = body->u.bigint;
+        MVMuint64 magnitude = 0;
+        int d;
+        if (USED(i) > (63 + DIGIT_BIT - 1) / DIGIT_BIT)
+            return 0;
+        for (d = USED(i) - 1; d >= 0; d--) {
+            if (magnitude >> (63 - DIGIT_BIT))
+                return 0;
+            magnitude = (magnitude << DIGIT_BIT) | (MVMuint64)DIGIT(i, d);
+        }
+        *value = SIGN(i) == MP_NEG ? -(MVMint64)magnitude : (MVMint64)magnitude;
+        return 1;
+    }
+    else {
+        *value = body->u.smallint.value;
+        return 1;
+    }
+}
+
+/* Overflow checked 64-bit arithmetic; these return zero if the result does
+ * not fit, in which case the big integer library has to be used. Operands
+ * are never INT64_MIN, since get_int64 does not produce it. */
+MVM_STATIC_INLINE int add_int64(MVMint64 a, MVMint64 b, MVMint64 *result) {
+    MVMint64 r = (MVMint64)((MVMuint64)a + (MVMuint64)b);
+    if (((a ^ r) & (b ^ r)) < 0 || r == INT64_MIN)
+        return 0;
+    *result = r;
+    return 1;
+}
+MVM_STATIC_INLINE int sub_int64(MVMint64 a, MVMint64 b, MVMint64 *result) {
+    MVMint64 r = (MVMint64)((MVMuint64)a - (MVMuint64)b);
+    if (((a ^ b) & (a ^ r)) < 0 || r == INT64_MIN)
+        return 0;
+    *result = r;
+    return 1;
+}
+MVM_STATIC_INLINE int mul_int64(MVMint64 a, MVMint64 b, MVMint64 *result) {
+    /* Products of values in 32-bit range, such as smallints, always fit. */
+    if (!(MVM_IS_32BIT_INT(a) && MVM_IS_32BIT_INT(b))) {
+        MVMuint64 ua = a < 0 ? -(MVMuint64)a : (MVMuint64)a;
+        MVMuint64 ub = b < 0 ? -(MVMuint64)b : (MVMuint64)b;
+        if (ua && ub > (MVMuint64)INT64_MAX / ua)
+            return 0;
+    }
+    *result = a * b;
+    return 1;
+}
+
+/* Shifts a 64-bit value left by count bits, or right (with sign extension)
+ * if count is negative, returning zero if the result would not fit. */
+static int shl_int64(MVMint64 value, MVMint64 count, MVMint64 *result) {
+    if (count >= 0) {
+        MVMuint64 magnitude = value < 0 ? -(MVMuint64)value : (MVMuint64)value;
+        if (magnitude == 0) {
+            *result = 0;
+            return 1;
+        }
+        if (count >= 63 || magnitude >> (63 - count))
+            return 0;
+        *result = value < 0 ? -(MVMint64)(magnitude << count) : (MVMint64)(magnitude << count);
+    }
+    else if (count <= -63) {
+        *result = value < 0 ? -1 : 0;
+    }
+    else {
+        *result = value < 0 ? ~(~value >> -count) : value >> -count;
+    }
+    return 1;
+}
+
+/* The greatest common divisor of two 64-bit values, which is never negative. */
+static MVMint64 gcd_int64(MVMint64 a, MVMint64 b) {
+    MVMint64 t;
+    a = a < 0 ? -a : a;
+    b = b < 0 ? -b : b;
+    while (b != 0) {
+        t = b;
+        b = a % b;
+        a = t;
+    }
+    return a;
+}
+
+/* The least common multiple of two 64-bit values, which like with mp_lcm is
+ * never negative; returns zero if it does not fit. */
+static int lcm_int64(MVMint64 a, MVMint64 b, MVMint64 *result) {
+    if (a == 0 || b == 0) {
+        *result = 0;
+        return 1;
+    }
+    if (!mul_int64(a / gcd_int64(a, b), b, result))
+        return 0;
+    if (*result < 0)
+        *result = -*result;
+    return 1;
+}
+
+/* Raises a 64-bit value to a power that is not negative; returns zero if the
+ * result does not fit. */
+static int pow_int64(MVMint64 base, MVMint64 exponent, MVMint64 *result) {
+    MVMint64 r = 1;
+    if (exponent == 0 || base == 1 || base == 0) {
+        *result = exponent == 0 ? 1 : base;
+        return 1;
+    }
+    if (base == -1) {
+        *result = exponent & 1 ? -1 : 1;
+        return 1;
+    }
+    if (exponent >= 63)
+        return 0;
+    /* Square and multiply; the squared base is always multiplied in at some
+     * point, so if squaring overflows, so would the result. */
+    while (1) {
+        if ((exponent & 1) && !mul_int64(r, base, &r))
+            return 0;
+        exponent >>= 1;
+        if (!exponent)
+            break;
+        if (!mul_int64(base, base, &base))
+            return 0;
+    }
+    *result = r;
+    return 1;
+}
+
+/* Floored division and modulus, as opposed to the truncating ones that C
+ * gives us. The divisor must not be zero. */
+MVM_STATIC_INLINE MVMint64 div_int64(MVMint64 a, MVMint64 b) {
+    MVMint64 q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0)))
+        q--;
+    return q;
+}
+MVM_STATIC_INLINE MVMint64 mod_int64(MVMint64 a, MVMint64 b) {
+    MVMint64 r = a % b;
+    if (r != 0 && ((r < 0) != (b < 0)))
+        r += b;
+    return r;
+}
+
 /* Bitops on libtomath (no two's complement API) are horrendously inefficient and
  * really should be hand-coded to work DIGIT-by-DIGIT with in-loop carry
  * handling.  For now we have these fixups.
@@ -285,6 +422,8 @@ static void two_complement_bitop(mp_int *a, mp_int *b, mp_int *c,
 }
 
 static void two_complement_shl(mp_int *result, mp_int *value, MVMint64 count) {
+    if (count == INT64_MIN)
+        count = -INT64_MAX;
     if (count >= 0) {
         mp_mul_2d(value, count, result);
     }
@@ -309,7 +448,13 @@ void MVM_bigint_##opname(MVMThreadContext *tc, MVMObject *result, MVMObject *sou
     } \
     else { \
         MVMP6bigintBody *ba = get_bigint_body(tc, source); \
-        if (MVM_BIGINT_IS_BIG(ba)) { \
+        MVMint64 sa, sb; \
+        if (get_int64(ba, &sa)) { \
+            SMALLINT_OP; \
+            store_int64_result(bb, sb); \
+            adjust_nursery(tc, bb); \
+        } \
+        else { \
             mp_int *ia = ba->u.bigint; \
             mp_int *ib = MVM_malloc(sizeof(mp_int)); \
             mp_init(ib); \
@@ -317,47 +462,26 @@ void MVM_bigint_##opname(MVMThreadContext *tc, MVMObject *result, MVMObject *sou
             store_bigint_result(bb, ib); \
             adjust_nursery(tc, bb); \
         } \
-        else { \
-            MVMint64 sb; \
-            MVMint64 sa = ba->u.smallint.value; \
-            SMALLINT_OP; \
-            store_int64_result(bb, sb); \
-        } \
     } \
 }
 
-#define MVM_BIGINT_BINARY_OP(opname) \
-MVMObject * MVM_bigint_##opname(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMObject *b) { \
-    MVMP6bigintBody *ba, *bb, *bc; \
-    MVMObject *result; \
-    mp_int *tmp[2] = { NULL, NULL }; \
-    mp_int *ia, *ib, *ic; \
-    MVMROOT(tc, a, { \
-    MVMROOT(tc, b, { \
-        result = MVM_repr_alloc_init(tc, result_type);\
-    }); \
-    }); \
-    ba = get_bigint_body(tc, a); \
-    bb = get_bigint_body(tc, b); \
-    bc = get_bigint_body(tc, result); \
-    ia = force_bigint(ba, tmp); \
-    ib = force_bigint(bb, tmp); \
-    ic = MVM_malloc(sizeof(mp_int)); \
-    mp_init(ic); \
-    mp_##opname(ia, ib, ic); \
-    store_bigint_result(bc, ic); \
-    clear_temp_bigints(tmp, 2); \
-    adjust_nursery(tc, bc); \
-    return result; \
-}
-
-#define MVM_BIGINT_BINARY_OP_SIMPLE(opname, SMALLINT_OP) \
+#define MVM_BIGINT_BINARY_OP_SIMPLE(opname) \
 MVMObject * MVM_bigint_##opname(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMObject *b) { \
     MVMP6bigintBody *ba, *bb, *bc; \
     MVMObject *result; \
+    MVMint64 sa, sb, sc; \
     ba = get_bigint_body(tc, a); \
     bb = get_bigint_body(tc, b); \
-    if (MVM_BIGINT_IS_BIG(ba) || MVM_BIGINT_IS_BIG(bb)) { \
+    if (get_int64(ba, &sa) && get_int64(bb, &sb) && opname##_int64(sa, sb, &sc)) { \
+        result = MVM_intcache_get(tc, result_type, sc); \
+        if (result) \
+            return result; \
+        result = MVM_repr_alloc_init(tc, result_type);\
+        bc = get_bigint_body(tc, result); \
+        store_int64_result(bc, sc); \
+        adjust_nursery(tc, bc); \
+    } \
+    else { \
         mp_int *tmp[2] = { NULL, NULL }; \
         mp_int *ia, *ib, *ic; \
         MVMROOT(tc, a, { \
@@ -377,34 +501,28 @@ MVMObject * MVM_bigint_##opname(MVMThreadContext *tc, MVMObject *result_type, MV
         clear_temp_bigints(tmp, 2); \
         adjust_nursery(tc, bc); \
     } \
-    else { \
-        MVMint64 sc; \
-        MVMint64 sa = ba->u.smallint.value; \
-        MVMint64 sb = bb->u.smallint.value; \
-        SMALLINT_OP; \
-        result = MVM_intcache_get(tc, result_type, sc); \
-        if (result) \
-            return result; \
-        result = MVM_repr_alloc_init(tc, result_type);\
-        bc = get_bigint_body(tc, result); \
-        store_int64_result(bc, sc); \
-    } \
     return result; \
 }
 
 #define MVM_BIGINT_BINARY_OP_2(opname, SMALLINT_OP) \
 MVMObject * MVM_bigint_##opname(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMObject *b) { \
-    MVMP6bigintBody *ba = get_bigint_body(tc, a); \
-    MVMP6bigintBody *bb = get_bigint_body(tc, b); \
-    MVMP6bigintBody *bc; \
+    MVMP6bigintBody *ba, *bb, *bc; \
     MVMObject *result; \
+    MVMint64 sa, sb, sc; \
     MVMROOT(tc, a, { \
     MVMROOT(tc, b, { \
         result = MVM_repr_alloc_init(tc, result_type);\
     }); \
     }); \
+    ba = get_bigint_body(tc, a); \
+    bb = get_bigint_body(tc, b); \
     bc = get_bigint_body(tc, result); \
-    if (MVM_BIGINT_IS_BIG(ba) || MVM_BIGINT_IS_BIG(bb)) { \
+    if (get_int64(ba, &sa) && get_int64(bb, &sb)) { \
+        SMALLINT_OP; \
+        store_int64_result(bc, sc); \
+        adjust_nursery(tc, bc); \
+    } \
+    else { \
         mp_int *tmp[2] = { NULL, NULL }; \
         mp_int *ia = force_bigint(ba, tmp); \
         mp_int *ib = force_bigint(bb, tmp); \
@@ -415,32 +533,57 @@ MVMObject * MVM_bigint_##opname(MVMThreadContext *tc, MVMObject *result_type, MV
         clear_temp_bigints(tmp, 2); \
         adjust_nursery(tc, bc); \
     } \
-    else { \
-        MVMint64 sc; \
-        MVMint64 sa = ba->u.smallint.value; \
-        MVMint64 sb = bb->u.smallint.value; \
-        SMALLINT_OP; \
-        store_int64_result(bc, sc); \
-    } \
     return result; \
 }
 
-MVM_BIGINT_UNARY_OP(abs, { sb = labs(sa); })
+MVM_BIGINT_UNARY_OP(abs, { sb = sa < 0 ? -sa : sa; })
 MVM_BIGINT_UNARY_OP(neg, { sb = -sa; })
 
 /* unused */
 /* MVM_BIGINT_UNARY_OP(sqrt) */
 
-MVM_BIGINT_BINARY_OP_SIMPLE(add, { sc = sa + sb; })
-MVM_BIGINT_BINARY_OP_SIMPLE(sub, { sc = sa - sb; })
-MVM_BIGINT_BINARY_OP_SIMPLE(mul, { sc = sa * sb; })
-MVM_BIGINT_BINARY_OP(lcm)
+MVM_BIGINT_BINARY_OP_SIMPLE(add)
+MVM_BIGINT_BINARY_OP_SIMPLE(sub)
+MVM_BIGINT_BINARY_OP_SIMPLE(mul)
+
+MVMObject *MVM_bigint_lcm(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMObject *b) {
+    MVMP6bigintBody *ba, *bb, *bc;
+    MVMObject       *result;
+    MVMint64         sa, sb, sc;
+
+    MVMROOT(tc, a, {
+    MVMROOT(tc, b, {
+        result = MVM_repr_alloc_init(tc, result_type);
+    });
+    });
+
+    ba = get_bigint_body(tc, a);
+    bb = get_bigint_body(tc, b);
+    bc = get_bigint_body(tc, result);
+
+    if (get_int64(ba, &sa) && get_int64(bb, &sb) && lcm_int64(sa, sb, &sc)) {
+        store_int64_result(bc, sc);
+        adjust_nursery(tc, bc);
+    }
+    else {
+        mp_int *tmp[2] = { NULL, NULL };
+        mp_int *ia = force_bigint(ba, tmp);
+        mp_int *ib = force_bigint(bb, tmp);
+        mp_int *ic = MVM_malloc(sizeof(mp_int));
+        mp_init(ic);
+        mp_lcm(ia, ib, ic);
+        store_bigint_result(bc, ic);
+        clear_temp_bigints(tmp, 2);
+        adjust_nursery(tc, bc);
+    }
+
+    return result;
+}
 
 MVMObject *MVM_bigint_gcd(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMObject *b) {
-    MVMP6bigintBody *ba = get_bigint_body(tc, a);
-    MVMP6bigintBody *bb = get_bigint_body(tc, b);
-    MVMP6bigintBody *bc;
+    MVMP6bigintBody *ba, *bb, *bc;
     MVMObject       *result;
+    MVMint64         sa, sb;
 
     MVMROOT(tc, a, {
     MVMROOT(tc, b, {
@@ -448,9 +591,15 @@ MVMObject *MVM_bigint_gcd(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
     });
     });
 
+    ba = get_bigint_body(tc, a);
+    bb = get_bigint_body(tc, b);
     bc = get_bigint_body(tc, result);
 
-    if (MVM_BIGINT_IS_BIG(ba) || MVM_BIGINT_IS_BIG(bb)) {
+    if (get_int64(ba, &sa) && get_int64(bb, &sb)) {
+        store_int64_result(bc, gcd_int64(sa, sb));
+        adjust_nursery(tc, bc);
+    }
+    else {
         mp_int *tmp[2] = { NULL, NULL };
         mp_int *ia = force_bigint(ba, tmp);
         mp_int *ib = force_bigint(bb, tmp);
@@ -460,18 +609,6 @@ MVMObject *MVM_bigint_gcd(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
         store_bigint_result(bc, ic);
         clear_temp_bigints(tmp, 2);
         adjust_nursery(tc, bc);
-    } else {
-        MVMint32 sa = ba->u.smallint.value;
-        MVMint32 sb = bb->u.smallint.value;
-        MVMint32 t;
-        sa = abs(sa);
-        sb = abs(sb);
-        while (sb != 0) {
-            t  = sb;
-            sb = sa % sb;
-            sa = t;
-        }
-        store_int64_result(bc, sa);
     }
 
     return result;
@@ -484,27 +621,29 @@ MVM_BIGINT_BINARY_OP_2(and, { sc = sa & sb; })
 MVMint64 MVM_bigint_cmp(MVMThreadContext *tc, MVMObject *a, MVMObject *b) {
     MVMP6bigintBody *ba = get_bigint_body(tc, a);
     MVMP6bigintBody *bb = get_bigint_body(tc, b);
-    if (MVM_BIGINT_IS_BIG(ba) || MVM_BIGINT_IS_BIG(bb)) {
-        mp_int *tmp[2] = { NULL, NULL };
-        mp_int *ia = force_bigint(ba, tmp);
-        mp_int *ib = force_bigint(bb, tmp);
-        MVMint64 r = (MVMint64)mp_cmp(ia, ib);
-        clear_temp_bigints(tmp, 2);
-        return r;
+    MVMint64 sa, sb;
+    int a_fits = get_int64(ba, &sa);
+    int b_fits = get_int64(bb, &sb);
+    if (a_fits && b_fits) {
+        return sa == sb ? 0 : sa <  sb ? -1 : 1;
+    }
+    else if (a_fits) {
+        /* b is further from zero than any 64-bit value. */
+        return SIGN(bb->u.bigint) == MP_NEG ? 1 : -1;
+    }
+    else if (b_fits) {
+        return SIGN(ba->u.bigint) == MP_NEG ? -1 : 1;
     }
     else {
-        MVMint64 sa = ba->u.smallint.value;
-        MVMint64 sb = bb->u.smallint.value;
-        return sa == sb ? 0 : sa <  sb ? -1 : 1;
+        /* Only bigints can be out of 64-bit range, so no temporaries. */
+        return (MVMint64)mp_cmp(ba->u.bigint, bb->u.bigint);
     }
 }
 
 MVMObject * MVM_bigint_mod(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMObject *b) {
-    MVMP6bigintBody *ba = get_bigint_body(tc, a);
-    MVMP6bigintBody *bb = get_bigint_body(tc, b);
-    MVMP6bigintBody *bc;
-
-    MVMObject *result;
+    MVMP6bigintBody *ba, *bb, *bc;
+    MVMObject       *result;
+    MVMint64         sa, sb;
 
     MVMROOT(tc, a, {
     MVMROOT(tc, b, {
@@ -512,12 +651,18 @@ MVMObject * MVM_bigint_mod(MVMThreadContext *tc, MVMObject *result_type, MVMObje
     });
     });
 
+    ba = get_bigint_body(tc, a);
+    bb = get_bigint_body(tc, b);
     bc = get_bigint_body(tc, result);
 
-    /* XXX the behavior of C's mod operator is not correct
-     * for our purposes. So we rely on mp_mod for all our modulus
-     * calculations for now. */
-    if (1 || MVM_BIGINT_IS_BIG(ba) || MVM_BIGINT_IS_BIG(bb)) {
+    /* The result takes the sign of the divisor, as with mp_mod. */
+    if (get_int64(ba, &sa) && get_int64(bb, &sb)) {
+        if (sb == 0)
+            MVM_exception_throw_adhoc(tc, "Division by zero");
+        store_int64_result(bc, mod_int64(sa, sb));
+        adjust_nursery(tc, bc);
+    }
+    else {
         mp_int *tmp[2] = { NULL, NULL };
         mp_int *ia = force_bigint(ba, tmp);
         mp_int *ib = force_bigint(bb, tmp);
@@ -534,23 +679,20 @@ MVMObject * MVM_bigint_mod(MVMThreadContext *tc, MVMObject *result_type, MVMObje
         }
         store_bigint_result(bc, ic);
         adjust_nursery(tc, bc);
-    } else {
-        store_int64_result(bc, ba->u.smallint.value % bb->u.smallint.value);
     }
 
     return result;
 }
 
 MVMObject *MVM_bigint_div(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMObject *b) {
-    MVMP6bigintBody *ba = get_bigint_body(tc, a);
-    MVMP6bigintBody *bb = get_bigint_body(tc, b);
-    MVMP6bigintBody *bc;
+    MVMP6bigintBody *ba, *bb, *bc;
     mp_int *ia, *ib, *ic;
     int cmp_a;
     int cmp_b;
     mp_int remainder;
     mp_int intermediate;
     MVMObject *result;
+    MVMint64 sa, sb;
 
     int mp_result;
 
@@ -560,22 +702,33 @@ MVMObject *MVM_bigint_div(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
     });
     });
 
+    ba = get_bigint_body(tc, a);
+    bb = get_bigint_body(tc, b);
     bc = get_bigint_body(tc, result);
 
-    /* we only care about MP_LT or !MP_LT, so we give MP_GT even for 0. */
-    if (MVM_BIGINT_IS_BIG(ba)) {
-        cmp_a = !mp_iszero(ba->u.bigint) && SIGN(ba->u.bigint) == MP_NEG ? MP_LT : MP_GT;
-    } else {
-        cmp_a = ba->u.smallint.value < 0 ? MP_LT : MP_GT;
-    }
-    if (MVM_BIGINT_IS_BIG(bb)) {
-        cmp_b = !mp_iszero(bb->u.bigint) && SIGN(bb->u.bigint) == MP_NEG ? MP_LT : MP_GT;
-    } else {
-        cmp_b = bb->u.smallint.value < 0 ? MP_LT : MP_GT;
+    /* The quotient is floored rather than rounded towards zero. Since the
+     * operands are never INT64_MIN, it always fits. */
+    if (get_int64(ba, &sa) && get_int64(bb, &sb)) {
+        if (sb == 0)
+            MVM_exception_throw_adhoc(tc, "Division by zero");
+        store_int64_result(bc, div_int64(sa, sb));
+        adjust_nursery(tc, bc);
     }
-
-    if (MVM_BIGINT_IS_BIG(ba) || MVM_BIGINT_IS_BIG(bb)) {
+    else {
         mp_int *tmp[2] = { NULL, NULL };
+
+        /* we only care about MP_LT or !MP_LT, so we give MP_GT even for 0. */
+        if (MVM_BIGINT_IS_BIG(ba)) {
+            cmp_a = !mp_iszero(ba->u.bigint) && SIGN(ba->u.bigint) == MP_NEG ? MP_LT : MP_GT;
+        } else {
+            cmp_a = ba->u.smallint.value < 0 ? MP_LT : MP_GT;
+        }
+        if (MVM_BIGINT_IS_BIG(bb)) {
+            cmp_b = !mp_iszero(bb->u.bigint) && SIGN(bb->u.bigint) == MP_NEG ? MP_LT : MP_GT;
+        } else {
+            cmp_b = bb->u.smallint.value < 0 ? MP_LT : MP_GT;
+        }
+
         ia = force_bigint(ba, tmp);
         ib = force_bigint(bb, tmp);
 
@@ -612,23 +765,6 @@ MVMObject *MVM_bigint_div(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
         store_bigint_result(bc, ic);
         clear_temp_bigints(tmp, 2);
         adjust_nursery(tc, bc);
-    } else {
-        MVMint32 num   = ba->u.smallint.value;
-        MVMint32 denom = bb->u.smallint.value;
-        MVMint32 value;
-        if ((cmp_a == MP_LT) ^ (cmp_b == MP_LT)) {
-            if (denom == 0) {
-                MVM_exception_throw_adhoc(tc, "Division by zero");
-            }
-            if ((num % denom) != 0) {
-                value = num / denom - 1;
-            } else {
-                value = num / denom;
-            }
-        } else {
-            value = num / denom;
-        }
-        store_int64_result(bc, value);
     }
 
     return result;
@@ -639,12 +775,22 @@ MVMObject * MVM_bigint_pow(MVMThreadContext *tc, MVMObject *a, MVMObject *b,
     MVMP6bigintBody *ba = get_bigint_body(tc, a);
     MVMP6bigintBody *bb = get_bigint_body(tc, b);
     MVMObject       *r  = NULL;
+    MVMint64         sa, sb, value;
 
     mp_int *tmp[2] = { NULL, NULL };
-    mp_int *base        = force_bigint(ba, tmp);
-    mp_int *exponent    = force_bigint(bb, tmp);
+    mp_int *base;
+    mp_int *exponent;
     mp_digit exponent_d = 0;
 
+    if (get_int64(ba, &sa) && get_int64(bb, &sb)) {
+        if (sb < 0 && sa != 1)
+            return MVM_repr_box_num(tc, num_type, pow((MVMnum64)sa, (MVMnum64)sb));
+        if (pow_int64(sa, sb, &value))
+            return MVM_repr_box_int(tc, int_type, value);
+    }
+
+    base     = force_bigint(ba, tmp);
+    exponent = force_bigint(bb, tmp);
     if (mp_iszero(exponent) || (MP_EQ == mp_cmp_d(base, 1))) {
         r = MVM_repr_box_int(tc, int_type, 1);
     }
@@ -689,17 +835,21 @@ MVMObject * MVM_bigint_pow(MVMThreadContext *tc, MVMObject *a, MVMObject *b,
 }
 
 MVMObject *MVM_bigint_shl(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMint64 n) {
-    MVMP6bigintBody *ba = get_bigint_body(tc, a);
-    MVMP6bigintBody *bb;
+    MVMP6bigintBody *ba, *bb;
     MVMObject       *result;
+    MVMint64         value;
 
     MVMROOT(tc, a, {
         result = MVM_repr_alloc_init(tc, result_type);
     });
 
+    ba = get_bigint_body(tc, a);
     bb = get_bigint_body(tc, result);
 
-    if (MVM_BIGINT_IS_BIG(ba) || n >= 31) {
+    if (get_int64(ba, &value) && shl_int64(value, n, &value)) {
+        store_int64_result(bb, value);
+        adjust_nursery(tc, bb);
+    } else {
         mp_int *tmp[1] = { NULL };
         mp_int *ia = force_bigint(ba, tmp);
         mp_int *ib = MVM_malloc(sizeof(mp_int));
@@ -708,13 +858,6 @@ MVMObject *MVM_bigint_shl(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
         store_bigint_result(bb, ib);
         clear_temp_bigints(tmp, 1);
         adjust_nursery(tc, bb);
-    } else {
-        MVMint64 value;
-        if (n < 0)
-            value = ((MVMint64)ba->u.smallint.value) >> -n;
-        else
-            value = ((MVMint64)ba->u.smallint.value) << n;
-        store_int64_result(bb, value);
     }
 
     return result;
@@ -731,17 +874,26 @@ int BIGINT_IS_NEGATIVE (MVMP6bigintBody *ba) {
     }
 }
 MVMObject *MVM_bigint_shr(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a, MVMint64 n) {
-    MVMP6bigintBody *ba = get_bigint_body(tc, a);
-    MVMP6bigintBody *bb;
+    MVMP6bigintBody *ba, *bb;
     MVMObject       *result;
+    MVMint64         value;
 
     MVMROOT(tc, a, {
         result = MVM_repr_alloc_init(tc, result_type);
     });
 
+    ba = get_bigint_body(tc, a);
     bb = get_bigint_body(tc, result);
 
-    if (MVM_BIGINT_IS_BIG(ba) || n < 0) {
+    /* A right shift is a left shift by -n, which we can't negate for the
+     * most negative n; shifting by one bit less makes no difference. */
+    if (n == INT64_MIN)
+        n = -INT64_MAX;
+
+    if (get_int64(ba, &value) && shl_int64(value, -n, &value)) {
+        store_int64_result(bb, value);
+        adjust_nursery(tc, bb);
+    } else {
         mp_int *tmp[1] = { NULL };
         mp_int *ia = force_bigint(ba, tmp);
         mp_int *ib = MVM_malloc(sizeof(mp_int));
@@ -750,29 +902,27 @@ MVMObject *MVM_bigint_shr(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
         store_bigint_result(bb, ib);
         clear_temp_bigints(tmp, 1);
         adjust_nursery(tc, bb);
-    } else if (n >= 32) {
-        store_int64_result(bb, BIGINT_IS_NEGATIVE(ba) ? -1 : 0);
-    } else {
-        MVMint32 value = ba->u.smallint.value;
-        value = value >> n;
-        store_int64_result(bb, value);
     }
 
     return result;
 }
 
 MVMObject *MVM_bigint_not(MVMThreadContext *tc, MVMObject *result_type, MVMObject *a) {
-    MVMP6bigintBody *ba = get_bigint_body(tc, a);
-    MVMP6bigintBody *bb;
+    MVMP6bigintBody *ba, *bb;
     MVMObject       *result;
+    MVMint64         value;
 
     MVMROOT(tc, a, {
         result = MVM_repr_alloc_init(tc, result_type);
     });
 
+    ba = get_bigint_body(tc, a);
     bb = get_bigint_body(tc, result);
 
-    if (MVM_BIGINT_IS_BIG(ba)) {
+    if (get_int64(ba, &value)) {
+        store_int64_result(bb, ~value);
+        adjust_nursery(tc, bb);
+    } else {
         mp_int *ia = ba->u.bigint;
         mp_int *ib = MVM_malloc(sizeof(mp_int));
         mp_init(ib);
@@ -781,10 +931,6 @@ MVMObject *MVM_bigint_not(MVMThreadContext *tc, MVMObject *result_type, MVMObjec
         mp_neg(ib, ib);
         store_bigint_result(bb, ib);
         adjust_nursery(tc, bb);
-    } else {
-        MVMint32 value = ba->u.smallint.value;
-        value = ~value;
-        store_int64_result(bb, value);
     }
 
     return result;
@@ -795,13 +941,33 @@ void MVM_bigint_expmod(MVMThreadContext *tc, MVMObject *result, MVMObject *a, MV
     MVMP6bigintBody *bb = get_bigint_body(tc, b);
     MVMP6bigintBody *bc = get_bigint_body(tc, c);
     MVMP6bigintBody *bd = get_bigint_body(tc, result);
+    MVMint64 sa, sb, sc;
 
     mp_int *tmp[3] = { NULL, NULL, NULL };
+    mp_int *ia, *ib, *ic, *id;
+
+    /* With a modulus below 2**32, products of residues fit in 64 bits. A
+     * negative exponent needs a modular inverse, so is left to mp_exptmod. */
+    if (get_int64(ba, &sa) && get_int64(bb, &sb) && get_int64(bc, &sc)
+            && sb >= 0 && sc > 0 && sc <= 0xFFFFFFFFLL) {
+        MVMuint64 modulus = (MVMuint64)sc;
+        MVMuint64 base    = (MVMuint64)mod_int64(sa, sc);
+        MVMuint64 value   = 1 % modulus;
+        while (sb) {
+            if (sb & 1)
+                value = value * base % modulus;
+            base = base * base % modulus;
+            sb >>= 1;
+        }
+        store_int64_result(bd, (MVMint64)value);
+        adjust_nursery(tc, bd);
+        return;
+    }
 
-    mp_int *ia = force_bigint(ba, tmp);
-    mp_int *ib = force_bigint(bb, tmp);
-    mp_int *ic = force_bigint(bc, tmp);
-    mp_int *id = MVM_malloc(sizeof(mp_int));
+    ia = force_bigint(ba, tmp);
+    ib = force_bigint(bb, tmp);
+    ic = force_bigint(bc, tmp);
+    id = MVM_malloc(sizeof(mp_int));
     mp_init(id);
 
     mp_exptmod(ia, ib, ic, id);
@@ -845,6 +1011,22 @@ MVMString * MVM_bigint_to_str(MVMThreadContext *tc, MVMObject *a, int base) {
         if (base == 10) {
             return MVM_coerce_i_s(tc, body->u.smallint.value);
         }
+        else if (base >= 2 && base <= 36) {
+            /* Write the digits from the end of the buffer backwards, using
+             * the same (upper case) digits as mp_toradix. */
+            char buf[34];
+            char *pos = buf + sizeof(buf);
+            MVMint64 value = body->u.smallint.value;
+            MVMuint64 magnitude = value < 0 ? -(MVMuint64)value : (MVMuint64)value;
+            do {
+                *--pos = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"[magnitude % base];
+                magnitude /= base;
+            } while (magnitude);
+            if (value < 0)
+                *--pos = '-';
+            return MVM_string_ascii_decode(tc, tc->instance->VMString, pos,
+                buf + sizeof(buf) - pos);
+        }
         else {
             /* It's small, but shove it through bigint lib, as it knows how to
              * get other bases right. */
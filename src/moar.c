@@ -74,14 +74,33 @@ static FILE *fopen_perhaps_with_pid(char *path, const char *mode) {
 MVMInstance * MVM_vm_create_instance(void) {
     MVMInstance *instance;
     char *spesh_log, *spesh_nodelay, *spesh_disable, *spesh_inline_disable,
-         *spesh_osr_disable, *spesh_limit, *spesh_blocking;
-    char *jit_log, *jit_disable, *jit_bytecode_dir;
+         *spesh_osr_disable, *spesh_limit, *spesh_blocking, *spesh_workers,
+         *spesh_plan_cache;
+    char *jit_log, *jit_disable, *jit_expr_disable, *jit_bytecode_dir, *jit_bail_report;
     char *dynvar_log;
+    char *gc_parallel, *gc_pause_target, *nursery_min_size, *nursery_max_size;
+    char *sampling_profile;
+    char *event_loop_threads;
+    char *fsa_stats;
+    char *deserialize_stats;
+    char *cu_image_dir;
     int init_stat;
 
     /* Set up instance data structure. */
     instance = MVM_calloc(1, sizeof(MVMInstance));
 
+    /* Bounds for the nursery sizes; needed before creating any thread. */
+    instance->nursery_min_size = MVM_NURSERY_MIN_SIZE;
+    instance->nursery_max_size = MVM_NURSERY_MAX_SIZE;
+    nursery_min_size = getenv("MVM_NURSERY_MIN_SIZE");
+    if (nursery_min_size && nursery_min_size[0] && atoi(nursery_min_size) > 0)
+        instance->nursery_min_size = atoi(nursery_min_size);
+    nursery_max_size = getenv("MVM_NURSERY_MAX_SIZE");
+    if (nursery_max_size && nursery_max_size[0] && atoi(nursery_max_size) > 0)
+        instance->nursery_max_size = atoi(nursery_max_size);
+    if (instance->nursery_min_size > instance->nursery_max_size)
+        instance->nursery_min_size = instance->nursery_max_size;
+
     /* Create the main thread's ThreadContext and stash it. */
     instance->main_thread = MVM_tc_create(NULL, instance);
     instance->main_thread->thread_id = 1;
@@ -102,8 +121,18 @@ MVMInstance * MVM_vm_create_instance(void) {
     init_cond(instance->cond_gc_finish, "GC finish");
     init_cond(instance->cond_gc_intrays_clearing, "GC intrays clearing");
 
-    /* Create fixed size allocator. */
+    /* Create fixed size allocator, and see if we should write statistics
+     * about how much memory each thread has in it at exit. */
     instance->fsa = MVM_fixed_size_create(instance->main_thread);
+    fsa_stats = getenv("MVM_FSA_STATS");
+    if (fsa_stats && fsa_stats[0])
+        instance->fsa->stats_fh = fopen_perhaps_with_pid(fsa_stats, "w");
+
+    /* See if we should write how much of each serialization context was
+     * deserialized at exit. */
+    deserialize_stats = getenv("MVM_DESERIALIZE_STATS");
+    if (deserialize_stats && deserialize_stats[0])
+        instance->deserialize_stats_fh = fopen_perhaps_with_pid(deserialize_stats, "w");
 
     /* Set up REPR registry mutex. */
     init_mutex(instance->mutex_repr_registry, "REPR registry");
@@ -126,6 +155,12 @@ MVMInstance * MVM_vm_create_instance(void) {
     /* Set up loaded compunits hash mutex. */
     init_mutex(instance->mutex_loaded_compunits, "loaded compunits");
 
+    /* Should we keep images of the compilation units we load from files, to
+     * load them faster next time? */
+    cu_image_dir = getenv("MVM_CU_IMAGE_DIR");
+    if (cu_image_dir && cu_image_dir[0])
+        instance->cu_image_dir = cu_image_dir;
+
     /* Set up container registry mutex. */
     init_mutex(instance->mutex_container_registry, "container registry");
 
@@ -152,8 +187,14 @@ MVMInstance * MVM_vm_create_instance(void) {
     /* Set up main thread's last_payload. */
     instance->main_thread->last_payload = instance->VMNull;
 
-    /* Initialize event loop thread starting mutex. */
+    /* Initialize event loop thread starting mutex, and see how many event
+     * loop threads we should run. */
     init_mutex(instance->mutex_event_loop_start, "event loop thread start");
+    event_loop_threads = getenv("MVM_EVENT_LOOP_THREADS");
+    instance->num_event_loops = event_loop_threads && atoi(event_loop_threads) > 0
+        ? (MVMuint32)atoi(event_loop_threads)
+        : 1;
+    instance->event_loops = MVM_calloc(instance->num_event_loops, sizeof(MVMEventLoop));
 
     /* Create main thread object, and also make it the start of the all threads
      * linked list. Set up the mutex to protect it. */
@@ -230,13 +271,35 @@ MVMInstance * MVM_vm_create_instance(void) {
     if (spesh_blocking && spesh_blocking[0])
         instance->spesh_blocking = 1;
 
+    /* How many specialization worker threads should we run? */
+    instance->spesh_num_workers = 1;
+    spesh_workers = getenv("MVM_SPESH_WORKERS");
+    if (spesh_workers && spesh_workers[0] && atoi(spesh_workers) > 1)
+        instance->spesh_num_workers = atoi(spesh_workers);
+
+    /* Should we keep a file of the specializations produced, so the next run
+     * can produce them again without waiting for statistics? */
+    spesh_plan_cache = getenv("MVM_SPESH_PLAN_CACHE");
+    if (instance->spesh_enabled && spesh_plan_cache && spesh_plan_cache[0])
+        instance->spesh_plan_cache = MVM_spesh_plan_cache_load(instance->main_thread,
+            spesh_plan_cache);
+
     /* JIT environment/logging setup. */
     jit_disable = getenv("MVM_JIT_DISABLE");
     if (!jit_disable || !jit_disable[0])
         instance->jit_enabled = 1;
+    jit_expr_disable = getenv("MVM_JIT_EXPR_DISABLE");
+    if (!jit_expr_disable || !jit_expr_disable[0])
+        instance->jit_expr_enabled = 1;
     jit_log = getenv("MVM_JIT_LOG");
     if (jit_log && jit_log[0])
         instance->jit_log_fh = fopen_perhaps_with_pid(jit_log, "w");
+    jit_bail_report = getenv("MVM_JIT_BAIL_REPORT");
+    if (instance->jit_enabled && jit_bail_report && jit_bail_report[0]) {
+        FILE *fh = fopen_perhaps_with_pid(jit_bail_report, "w");
+        if (fh)
+            instance->jit_bail_report = MVM_jit_bail_report_create(instance->main_thread, fh);
+    }
     jit_bytecode_dir = getenv("MVM_JIT_BYTECODE_DIR");
     if (jit_bytecode_dir && jit_bytecode_dir[0]) {
         char *bytecode_map_name = MVM_malloc(strlen(jit_bytecode_dir) + strlen("/jit-map.txt") + 1);
@@ -247,9 +310,23 @@ MVMInstance * MVM_vm_create_instance(void) {
     }
     instance->jit_seq_nr = 0;
 
+    /* Should nursery collections be done in parallel? */
+    gc_parallel = getenv("MVM_GC_PARALLEL");
+    if (gc_parallel && gc_parallel[0])
+        instance->gc_parallel = 1;
+
+    /* Should full collections be done incrementally, and if so with what
+     * target for the length of each pause? */
+    gc_pause_target = getenv("MVM_GC_PAUSE_TARGET_MS");
+    if (gc_pause_target && gc_pause_target[0] && atoi(gc_pause_target) > 0)
+        instance->gc_pause_target = (MVMuint64)atoi(gc_pause_target) * 1000000;
+
     /* Spesh thread syncing. */
     init_mutex(instance->mutex_spesh_sync, "spesh sync");
     init_cond(instance->cond_spesh_sync, "spesh sync");
+    init_mutex(instance->mutex_spesh_workers, "spesh workers");
+    init_cond(instance->cond_spesh_workers, "spesh workers");
+    init_mutex(instance->mutex_spesh_dequeue, "spesh log dequeue");
 
     /* Various kinds of debugging that can be enabled. */
     dynvar_log = getenv("MVM_DYNVAR_LOG");
@@ -294,6 +371,19 @@ MVMInstance * MVM_vm_create_instance(void) {
         instance->coverage_logging = 0;
     }
 
+    /* Should we sample call stacks? This goes before any other threads are
+     * started, so they are all sampled. */
+    sampling_profile = getenv("MVM_SAMPLING_PROFILE");
+    if (sampling_profile && sampling_profile[0]) {
+        FILE *fh = fopen_perhaps_with_pid(sampling_profile, "w");
+        if (fh) {
+            char *hz = getenv("MVM_SAMPLING_PROFILE_HZ");
+            instance->sampling_profiler = MVM_profile_sampling_create(
+                instance->main_thread, fh,
+                hz && atoi(hz) > 0 ? (MVMuint64)atoi(hz) : 100);
+        }
+    }
+
     /* Create std[in/out/err]. */
     setup_std_handles(instance->main_thread);
 
@@ -340,6 +430,8 @@ void MVM_vm_run_file(MVMInstance *instance, const char *filename) {
            location cu->body.filename */
         MVMString *const str = MVM_string_utf8_c8_decode(tc, instance->VMString, filename, strlen(filename));
         cu->body.filename = str;
+        if (instance->spesh_plan_cache)
+            MVM_spesh_plan_cache_cu_loaded(tc, cu);
 
         /* Run deserialization frame, if there is one. Disable specialization
          * during this time, so we don't waste time logging one-shot setup
@@ -389,6 +481,26 @@ void MVM_vm_exit(MVMInstance *instance) {
     /* Join any foreground threads. */
     MVM_thread_join_foreground(instance->main_thread);
 
+    /* Write out the specialization plan cache. */
+    if (instance->spesh_plan_cache)
+        MVM_spesh_plan_cache_save(instance->main_thread);
+
+    /* Write the JIT bail report. */
+    if (instance->jit_bail_report)
+        MVM_jit_bail_report_write(instance->main_thread);
+
+    /* Write the sampled call stacks. */
+    if (instance->sampling_profiler)
+        MVM_profile_sampling_write(instance->main_thread);
+
+    /* Write the fixed size allocator statistics. */
+    if (instance->fsa->stats_fh)
+        MVM_fixed_size_write_stats(instance->main_thread, instance->fsa);
+
+    /* Write how much of each serialization context was deserialized. */
+    if (instance->deserialize_stats_fh)
+        MVM_serialization_write_stats(instance->main_thread);
+
     /* Close any spesh or jit log. */
     if (instance->spesh_log_fh)
         fclose(instance->spesh_log_fh);
@@ -438,6 +550,27 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
     /* Join any foreground threads. */
     MVM_thread_join_foreground(instance->main_thread);
 
+    /* Write out the specialization plan cache while the objects it refers to
+     * are still around. */
+    if (instance->spesh_plan_cache)
+        MVM_spesh_plan_cache_save(instance->main_thread);
+
+    /* Write the JIT bail report. */
+    if (instance->jit_bail_report)
+        MVM_jit_bail_report_write(instance->main_thread);
+
+    /* Write the sampled call stacks. */
+    if (instance->sampling_profiler)
+        MVM_profile_sampling_write(instance->main_thread);
+
+    /* Write the fixed size allocator statistics. */
+    if (instance->fsa->stats_fh)
+        MVM_fixed_size_write_stats(instance->main_thread, instance->fsa);
+
+    /* Write how much of each serialization context was deserialized. */
+    if (instance->deserialize_stats_fh)
+        MVM_serialization_write_stats(instance->main_thread);
+
     /* Run the GC global destruction phase. After this,
      * no 6model object pointers should be accessed. */
     MVM_gc_global_destruction(instance->main_thread);
@@ -451,6 +584,8 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
     uv_mutex_destroy(&instance->mutex_permroots);
     MVM_free(instance->permroots);
     MVM_free(instance->permroot_descriptions);
+    MVM_free(instance->gc_parallel_workers);
+    MVM_free(instance->gc_mark_stack);
     uv_cond_destroy(&instance->cond_gc_start);
     uv_cond_destroy(&instance->cond_gc_finish);
     uv_cond_destroy(&instance->cond_gc_intrays_clearing);
@@ -505,11 +640,20 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
     /* Clean up spesh mutexes and close any log. */
     uv_mutex_destroy(&instance->mutex_spesh_install);
     uv_cond_destroy(&instance->cond_spesh_sync);
+    uv_cond_destroy(&instance->cond_spesh_workers);
     uv_mutex_destroy(&instance->mutex_spesh_sync);
+    uv_mutex_destroy(&instance->mutex_spesh_workers);
+    uv_mutex_destroy(&instance->mutex_spesh_dequeue);
+    if (instance->spesh_plan_cache)
+        MVM_spesh_plan_cache_destroy(instance->main_thread, instance->spesh_plan_cache);
     if (instance->spesh_log_fh)
         fclose(instance->spesh_log_fh);
     if (instance->jit_log_fh)
         fclose(instance->jit_log_fh);
+    if (instance->jit_bail_report)
+        MVM_jit_bail_report_destroy(instance->main_thread, instance->jit_bail_report);
+    if (instance->sampling_profiler)
+        MVM_profile_sampling_destroy(instance->main_thread, instance->sampling_profiler);
     if (instance->dynvar_log_fh)
         fclose(instance->dynvar_log_fh);
 
@@ -528,8 +672,9 @@ void MVM_vm_destroy_instance(MVMInstance *instance) {
     MVM_free(instance->int_const_cache);
     MVM_free(instance->int_to_str_cache);
 
-    /* Clean up event loop starting mutex. */
+    /* Clean up event loop starting mutex and the event loops. */
     uv_mutex_destroy(&instance->mutex_event_loop_start);
+    MVM_free(instance->event_loops);
 
     /* Destroy main thread contexts and thread list mutex. */
     MVM_tc_destroy(instance->main_thread);
@@ -93,9 +93,9 @@ MVM_PUBLIC const MVMint32 MVM_jit_support(void);
 #include "6model/6model.h"
 #include "gc/collect.h"
 #include "gc/debug.h"
-#include "gc/wb.h"
 #include "core/threadcontext.h"
 #include "core/instance.h"
+#include "gc/wb.h"
 #include "core/interp.h"
 #include "core/callsite.h"
 #include "core/args.h"
@@ -121,6 +121,7 @@ MVM_PUBLIC const MVMint32 MVM_jit_support(void);
 #include "core/nativecall.h"
 #include "core/dll.h"
 #include "core/continuation.h"
+#include "core/str_hash_table.h"
 #include "6model/reprs.h"
 #include "6model/reprconv.h"
 #include "6model/bootstrap.h"
@@ -136,6 +137,7 @@ MVM_PUBLIC const MVMint32 MVM_jit_support(void);
 #include "gc/roots.h"
 #include "gc/objectid.h"
 #include "gc/finalize.h"
+#include "gc/incremental.h"
 #include "core/regionalloc.h"
 #include "spesh/dump.h"
 #include "spesh/graph.h"
@@ -155,7 +157,11 @@ MVM_PUBLIC const MVMint32 MVM_jit_support(void);
 #include "spesh/worker.h"
 #include "spesh/stats.h"
 #include "spesh/plan.h"
+#include "spesh/plan_cache.h"
 #include "spesh/arg_guard.h"
+#include "spesh/escape.h"
+#include "spesh/licm.h"
+#include "spesh/gvn.h"
 #include "strings/nfg.h"
 #include "strings/normalize.h"
 #include "strings/decode_stream.h"
@@ -186,14 +192,17 @@ MVM_PUBLIC const MVMint32 MVM_jit_support(void);
 #include "mast/driver.h"
 #include "core/intcache.h"
 #include "core/fixedsizealloc.h"
+#include "jit/expr.h"
 #include "jit/graph.h"
 #include "jit/compile.h"
 #include "jit/log.h"
+#include "jit/bail.h"
 #include "profiler/instrument.h"
 #include "profiler/log.h"
 #include "profiler/profile.h"
 #include "profiler/heapsnapshot.h"
 #include "profiler/telemeh.h"
+#include "profiler/sampling.h"
 #include "instrument/crossthreadwrite.h"
 #include "instrument/line_coverage.h"
 
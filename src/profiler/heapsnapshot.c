@@ -5,9 +5,32 @@ MVMint32 MVM_profile_heap_profiling(MVMThreadContext *tc) {
     return tc->instance->heap_snapshots != NULL;
 }
 
-/* Start heap profiling. */
+static void write_file_header(MVMThreadContext *tc, MVMHeapSnapshotCollection *col);
+
+/* Start heap profiling. If a path is configured, snapshots are written to it
+ * as they are taken. */
 void MVM_profile_heap_start(MVMThreadContext *tc, MVMObject *config) {
-    tc->instance->heap_snapshots = MVM_calloc(1, sizeof(MVMHeapSnapshotCollection));
+    MVMHeapSnapshotCollection *col;
+    FILE *fh   = NULL;
+    char *path = NULL;
+
+    if (MVM_repr_exists_key(tc, config, tc->instance->str_consts.path)) {
+        path = MVM_string_utf8_encode_C_string(tc, MVM_repr_get_str(tc,
+            MVM_repr_at_key_o(tc, config, tc->instance->str_consts.path)));
+        fh = fopen(path, "wb");
+        if (!fh) {
+            char *waste[] = { path, NULL };
+            MVM_exception_throw_adhoc_free(tc, waste,
+                "Could not open heap snapshot file %s: %s", path, strerror(errno));
+        }
+    }
+
+    col = MVM_calloc(1, sizeof(MVMHeapSnapshotCollection));
+    col->fh   = fh;
+    col->path = path;
+    if (fh)
+        write_file_header(tc, col);
+    tc->instance->heap_snapshots = col;
 }
 
 /* Grows storage if it's full, zeroing the extension. Assumes it's only being
@@ -375,6 +398,8 @@ static void process_workitems(MVMThreadContext *tc, MVMHeapSnapshotState *ss) {
                     (MVMCollectable *)st->HOW, "HOW");
                 MVM_profile_heap_add_collectable_rel_const_cstr(tc, ss,
                     (MVMCollectable *)st->HOW_sc, "HOW serialization context");
+                MVM_profile_heap_add_collectable_rel_const_cstr(tc, ss,
+                    (MVMCollectable *)st->WHO_sc, "WHO serialization context");
                 MVM_profile_heap_add_collectable_rel_const_cstr(tc, ss,
                     (MVMCollectable *)st->method_cache_sc,
                     "Method cache serialization context");
@@ -601,14 +626,181 @@ static void record_snapshot(MVMThreadContext *tc, MVMHeapSnapshotCollection *col
     MVM_gc_worklist_destroy(tc, ss.gcwl);
 }
 
+/* A buffer a chunk of the heap snapshot file is encoded into. */
+typedef struct {
+    unsigned char *data;
+    size_t         pos;
+    size_t         alloc;
+} ChunkBuffer;
+
+static void ensure_space(ChunkBuffer *buf, size_t needed) {
+    if (buf->pos + needed > buf->alloc) {
+        buf->alloc = buf->alloc ? buf->alloc * 2 : 4096;
+        if (buf->pos + needed > buf->alloc)
+            buf->alloc = buf->pos + needed;
+        buf->data = MVM_realloc(buf->data, buf->alloc);
+    }
+}
+
+static void put_varint(ChunkBuffer *buf, MVMuint64 value) {
+    ensure_space(buf, 10);
+    while (value >= 0x80) {
+        buf->data[buf->pos++] = (unsigned char)(value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buf->data[buf->pos++] = (unsigned char)value;
+}
+
+static void put_fixed(ChunkBuffer *buf, MVMuint64 value, size_t bytes) {
+    size_t i;
+    ensure_space(buf, bytes);
+    for (i = 0; i < bytes; i++)
+        buf->data[buf->pos++] = (unsigned char)(value >> (8 * i));
+}
+
+static void put_bytes(ChunkBuffer *buf, const char *bytes, size_t length) {
+    ensure_space(buf, length);
+    memcpy(buf->data + buf->pos, bytes, length);
+    buf->pos += length;
+}
+
+/* Writes raw bytes to the snapshot file, keeping track of the position. */
+static void write_bytes(MVMThreadContext *tc, MVMHeapSnapshotCollection *col,
+                        const void *bytes, size_t length) {
+    if (length && fwrite(bytes, 1, length, col->fh) != length)
+        MVM_panic(1, "Failed to write heap snapshot file %s: %s", col->path,
+            strerror(errno));
+    col->file_pos += length;
+}
+
+/* Writes a chunk with the buffer contents as its payload, and empties the
+ * buffer. */
+static void write_chunk(MVMThreadContext *tc, MVMHeapSnapshotCollection *col,
+                        const char *tag, ChunkBuffer *buf) {
+    ChunkBuffer header = { NULL, 0, 0 };
+    put_bytes(&header, tag, 4);
+    put_fixed(&header, buf->pos, 8);
+    write_bytes(tc, col, header.data, header.pos);
+    write_bytes(tc, col, buf->data, buf->pos);
+    MVM_free(header.data);
+    buf->pos = 0;
+}
+
+static void write_file_header(MVMThreadContext *tc, MVMHeapSnapshotCollection *col) {
+    ChunkBuffer buf = { NULL, 0, 0 };
+    put_bytes(&buf, "MOARHEAP", 8);
+    put_fixed(&buf, MVM_HEAPSNAPSHOT_FORMAT_VERSION, 4);
+    write_bytes(tc, col, buf.data, buf.pos);
+    MVM_free(buf.data);
+}
+
+/* Zigzag encodes a difference, so small negative ones stay small. */
+static MVMuint64 zigzag(MVMint64 value) {
+    return ((MVMuint64)value << 1) ^ (MVMuint64)(value >> 63);
+}
+
+/* Writes a snapshot that was just taken, along with the strings, types and
+ * static frames it added to the collection; see the header for the format. */
+static void write_snapshot(MVMThreadContext *tc, MVMHeapSnapshotCollection *col,
+                           MVMHeapSnapshot *hs) {
+    ChunkBuffer buf = { NULL, 0, 0 };
+    MVMuint64 i, j;
+
+    grow_storage(&(col->offsets), &(col->num_snapshots), &(col->alloc_offsets),
+        sizeof(MVMuint64));
+    col->offsets[col->num_snapshots] = col->file_pos;
+
+    put_varint(&buf, col->num_strings - col->strings_written);
+    for (i = col->strings_written; i < col->num_strings; i++) {
+        size_t length = strlen(col->strings[i]);
+        put_varint(&buf, length);
+        put_bytes(&buf, col->strings[i], length);
+    }
+    col->strings_written = col->num_strings;
+    write_chunk(tc, col, "strs", &buf);
+
+    put_varint(&buf, col->num_types - col->types_written);
+    for (i = col->types_written; i < col->num_types; i++) {
+        put_varint(&buf, col->types[i].repr_name);
+        put_varint(&buf, col->types[i].type_name);
+    }
+    col->types_written = col->num_types;
+    write_chunk(tc, col, "type", &buf);
+
+    put_varint(&buf, col->num_static_frames - col->static_frames_written);
+    for (i = col->static_frames_written; i < col->num_static_frames; i++) {
+        put_varint(&buf, col->static_frames[i].name);
+        put_varint(&buf, col->static_frames[i].cuid);
+        put_varint(&buf, col->static_frames[i].line);
+        put_varint(&buf, col->static_frames[i].file);
+    }
+    col->static_frames_written = col->num_static_frames;
+    write_chunk(tc, col, "sfrm", &buf);
+
+    put_varint(&buf, hs->num_collectables);
+    for (i = 0; i < hs->num_collectables; i++) {
+        MVMHeapSnapshotCollectable *c = &(hs->collectables[i]);
+        put_varint(&buf, c->kind);
+        put_varint(&buf, c->type_or_frame_index);
+        put_varint(&buf, c->collectable_size);
+        put_varint(&buf, c->unmanaged_size);
+        put_varint(&buf, c->num_refs);
+    }
+    write_chunk(tc, col, "coll", &buf);
+
+    /* The references were added in the order the collectables were worked
+     * through, so put them in collectable order. */
+    put_varint(&buf, hs->num_references);
+    for (i = 0; i < hs->num_collectables; i++) {
+        MVMHeapSnapshotCollectable *c = &(hs->collectables[i]);
+        for (j = c->refs_start; j < c->refs_start + c->num_refs; j++) {
+            MVMHeapSnapshotReference *ref = &(hs->references[j]);
+            put_varint(&buf, ref->description);
+            put_varint(&buf, zigzag((MVMint64)(ref->collectable_index - i)));
+        }
+    }
+    write_chunk(tc, col, "refs", &buf);
+
+    MVM_free(buf.data);
+    fflush(col->fh);
+}
+
+/* Writes the index of snapshots and its offset, and closes the file. */
+static void finish_file(MVMThreadContext *tc, MVMHeapSnapshotCollection *col) {
+    ChunkBuffer buf = { NULL, 0, 0 };
+    MVMuint64 index_pos = col->file_pos;
+    MVMuint64 i;
+
+    put_varint(&buf, col->num_snapshots);
+    for (i = 0; i < col->num_snapshots; i++)
+        put_fixed(&buf, col->offsets[i], 8);
+    write_chunk(tc, col, "indx", &buf);
+    put_fixed(&buf, index_pos, 8);
+    write_bytes(tc, col, buf.data, buf.pos);
+    MVM_free(buf.data);
+
+    fclose(col->fh);
+    col->fh = NULL;
+}
+
 /* Takes a snapshot of the heap, adding it to the current heap snapshot
- * collection. */
+ * collection, or writing it out if we're writing to a file. */
 void MVM_profile_heap_take_snapshot(MVMThreadContext *tc) {
     if (MVM_profile_heap_profiling(tc)) {
         MVMHeapSnapshotCollection *col = tc->instance->heap_snapshots;
-        grow_storage(&(col->snapshots), &(col->num_snapshots), &(col->alloc_snapshots),
-            sizeof(MVMHeapSnapshot));
-        record_snapshot(tc, col, &(col->snapshots[col->num_snapshots]));
+        if (col->fh) {
+            MVMHeapSnapshot hs;
+            memset(&hs, 0, sizeof(MVMHeapSnapshot));
+            record_snapshot(tc, col, &hs);
+            write_snapshot(tc, col, &hs);
+            MVM_free(hs.collectables);
+            MVM_free(hs.references);
+        }
+        else {
+            grow_storage(&(col->snapshots), &(col->num_snapshots), &(col->alloc_snapshots),
+                sizeof(MVMHeapSnapshot));
+            record_snapshot(tc, col, &(col->snapshots[col->num_snapshots]));
+        }
         col->num_snapshots++;
     }
 }
@@ -618,12 +810,15 @@ static void destroy_heap_snapshot_collection(MVMThreadContext *tc) {
     MVMHeapSnapshotCollection *col = tc->instance->heap_snapshots;
     MVMuint64 i;
 
-    for (i = 0; i < col->num_snapshots; i++) {
-        MVMHeapSnapshot *hs = &(col->snapshots[i]);
-        MVM_free(hs->collectables);
-        MVM_free(hs->references);
+    /* Snapshots are only kept if they're not written to a file. */
+    if (col->snapshots) {
+        for (i = 0; i < col->num_snapshots; i++) {
+            MVMHeapSnapshot *hs = &(col->snapshots[i]);
+            MVM_free(hs->collectables);
+            MVM_free(hs->references);
+        }
+        MVM_free(col->snapshots);
     }
-    MVM_free(col->snapshots);
 
     for (i = 0; i < col->num_strings; i++)
         if (col->strings_free[i])
@@ -634,6 +829,11 @@ static void destroy_heap_snapshot_collection(MVMThreadContext *tc) {
     MVM_free(col->types);
     MVM_free(col->static_frames);
 
+    if (col->fh)
+        fclose(col->fh);
+    MVM_free(col->path);
+    MVM_free(col->offsets);
+
     MVM_free(col);
     tc->instance->heap_snapshots = NULL;
 }
@@ -829,15 +1029,34 @@ MVMObject * collection_to_mvm_objects(MVMThreadContext *tc, MVMHeapSnapshotColle
     return results;
 }
 
+/* When the snapshots were written to a file, the results just say where. */
+MVMObject * file_to_mvm_objects(MVMThreadContext *tc, MVMHeapSnapshotCollection *col) {
+    MVMObject *results;
+    MVM_gc_allocate_gen2_default_set(tc);
+    results = MVM_repr_alloc_init(tc, MVM_hll_current(tc)->slurpy_hash_type);
+    MVM_repr_bind_key_o(tc, results, vmstr(tc, "path"),
+        box_s(tc, vmstr(tc, col->path)));
+    MVM_gc_allocate_gen2_default_clear(tc);
+    return results;
+}
+
 /* Finishes heap profiling, getting the data. */
 MVMObject * MVM_profile_heap_end(MVMThreadContext *tc) {
+    MVMHeapSnapshotCollection *col;
     MVMObject *dataset;
 
     /* Trigger a GC run, to ensure we get at least one heap snapshot. */
     MVM_gc_enter_from_allocator(tc);
 
     /* Process and return the data. */
-    dataset = collection_to_mvm_objects(tc, tc->instance->heap_snapshots);
+    col = tc->instance->heap_snapshots;
+    if (col->fh) {
+        finish_file(tc, col);
+        dataset = file_to_mvm_objects(tc, col);
+    }
+    else {
+        dataset = collection_to_mvm_objects(tc, col);
+    }
     destroy_heap_snapshot_collection(tc);
     return dataset;
 }
@@ -1,7 +1,38 @@
 /* A collection of heap snapshots, with common type and static frame names.
  * Note that we take care to never refer to heap objects themselves in here,
  * including for types and frames, since to do so would extend their lifetime
- * for the whole program, which would render the results pretty bogus. */
+ * for the whole program, which would render the results pretty bogus.
+ *
+ * If a path is given in the profiler configuration, each snapshot is written
+ * to that file as soon as it has been taken, and then thrown away, so only
+ * one snapshot is held in memory at a time. The file format is:
+ *
+ *   "MOARHEAP"      magic
+ *   uint32          format version
+ *   chunk*          5 chunks per snapshot, then an index chunk
+ *   uint64          file offset of the index chunk
+ *
+ * Each chunk is a 4 byte tag, a uint64 payload length and the payload, so
+ * that a reader can skip the ones it is not interested in. Fixed size
+ * integers are little endian; all others are unsigned LEB128 varints. For
+ * each snapshot, the chunks are:
+ *
+ *   "strs"  count, then (length, UTF-8 bytes) for each string
+ *   "type"  count, then (repr name, type name) string indexes for each type
+ *   "sfrm"  count, then (name, cuid, line, file) for each static frame
+ *   "coll"  count, then (kind, type or frame index, size, unmanaged size,
+ *           number of references) for each collectable
+ *   "refs"  count, then (description, target) for each reference
+ *
+ * The string, type and static frame chunks only hold the entries that were
+ * new in that snapshot; the indexes used by later snapshots refer to all of
+ * them added up so far. References are ordered by the collectable they are
+ * from, and the target is stored as the zigzag encoded difference from the
+ * index of that collectable, which is usually small. The "indx" chunk has a
+ * count, then the uint64 offset of the first chunk of each snapshot; to read
+ * a snapshot, read the table chunks of it and all of those before it. If the
+ * process exits before profiling ends, there is no index or final offset,
+ * but the chunks can still be read one after the other. */
 struct MVMHeapSnapshotCollection {
     /* List of taken snapshots. */
     MVMHeapSnapshot *snapshots;
@@ -27,8 +58,25 @@ struct MVMHeapSnapshotCollection {
     char *strings_free;
     MVMuint64 num_strings_free;
     MVMuint64 alloc_strings_free;
+
+    /* If snapshots are being written out as they are taken, the file and its
+     * name, the number of bytes written so far, and how many of the strings,
+     * types and static frames have been written. */
+    FILE *fh;
+    char *path;
+    MVMuint64 file_pos;
+    MVMuint64 strings_written;
+    MVMuint64 types_written;
+    MVMuint64 static_frames_written;
+
+    /* The file offset of each snapshot written. */
+    MVMuint64 *offsets;
+    MVMuint64 alloc_offsets;
 };
 
+/* Version of the heap snapshot file format. */
+#define MVM_HEAPSNAPSHOT_FORMAT_VERSION 1
+
 /* An individual heap snapshot. */
 struct MVMHeapSnapshot {
     /* Array of data about collectables on the heap. */
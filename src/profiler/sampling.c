@@ -0,0 +1,305 @@
+#include "moar.h"
+
+/* The thread asking for samples. Each time the interval passes, it flags all
+ * of the threads being sampled; they take the sample themselves, so their
+ * stacks are never looked at while they are changing. */
+static void sampler_thread(void *arg) {
+    MVMProfileSampler *sampler = (MVMProfileSampler *)arg;
+    uv_mutex_lock(&sampler->mutex);
+    while (!sampler->stop) {
+        if (uv_cond_timedwait(&sampler->cond, &sampler->mutex, sampler->interval) == UV_ETIMEDOUT) {
+            MVMuint32 i;
+            for (i = 0; i < sampler->num_threads; i++) {
+                MVMThreadContext *tc = sampler->threads[i]->tc;
+                if (tc)
+                    MVM_store(&tc->prof_sample_requested, 1);
+            }
+        }
+    }
+    uv_mutex_unlock(&sampler->mutex);
+}
+
+static void add_thread(MVMProfileSampler *sampler, MVMThreadContext *tc) {
+    MVMProfileSampleThread *pst = MVM_calloc(1, sizeof(MVMProfileSampleThread));
+    pst->tc        = tc;
+    pst->thread_id = tc->thread_id;
+    pst->root      = MVM_calloc(1, sizeof(MVMProfileSampleNode));
+
+    uv_mutex_lock(&sampler->mutex);
+    if (sampler->num_threads == sampler->alloc_threads) {
+        sampler->alloc_threads = sampler->alloc_threads ? sampler->alloc_threads * 2 : 8;
+        sampler->threads = MVM_realloc(sampler->threads,
+            sampler->alloc_threads * sizeof(MVMProfileSampleThread *));
+    }
+    sampler->threads[sampler->num_threads++] = pst;
+    uv_mutex_unlock(&sampler->mutex);
+
+    tc->prof_samples = pst;
+}
+
+/* Sets up the sampling profiler, starting with the given (main) thread, and
+ * starts the thread that asks for samples. */
+MVMProfileSampler * MVM_profile_sampling_create(MVMThreadContext *tc, FILE *fh, MVMuint64 hz) {
+    MVMProfileSampler *sampler = MVM_calloc(1, sizeof(MVMProfileSampler));
+    int init_stat;
+    sampler->fh       = fh;
+    sampler->interval = 1000000000 / (hz ? hz : 100);
+    if ((init_stat = uv_mutex_init(&sampler->mutex)) < 0) {
+        fprintf(stderr, "MoarVM: Initialization of sampling profiler mutex failed\n    %s\n",
+            uv_strerror(init_stat));
+        exit(1);
+    }
+    if ((init_stat = uv_cond_init(&sampler->cond)) < 0) {
+        fprintf(stderr, "MoarVM: Initialization of sampling profiler condition variable failed\n    %s\n",
+            uv_strerror(init_stat));
+        exit(1);
+    }
+    add_thread(sampler, tc);
+    if ((init_stat = uv_thread_create(&sampler->thread, sampler_thread, sampler)) < 0) {
+        fprintf(stderr, "MoarVM: Could not start sampling profiler thread\n    %s\n",
+            uv_strerror(init_stat));
+        exit(1);
+    }
+    sampler->running = 1;
+    return sampler;
+}
+
+/* Starts sampling a newly created thread. */
+void MVM_profile_sampling_register_thread(MVMThreadContext *tc) {
+    add_thread(tc->instance->sampling_profiler, tc);
+}
+
+/* Stops sampling a thread that is going away; its samples are kept. */
+void MVM_profile_sampling_unregister_thread(MVMThreadContext *tc) {
+    MVMProfileSampler *sampler = tc->instance->sampling_profiler;
+    uv_mutex_lock(&sampler->mutex);
+    tc->prof_samples->tc = NULL;
+    uv_mutex_unlock(&sampler->mutex);
+    tc->prof_samples = NULL;
+}
+
+/* Finds or adds the child of a node for a frame. */
+static MVMProfileSampleNode * get_child(MVMProfileSampleNode *node, MVMProfileSampleFrame *frame) {
+    MVMProfileSampleNode *child;
+    MVMuint32 i;
+    for (i = 0; i < node->num_children; i++) {
+        child = node->children[i];
+        if (child->sf == frame->sf && child->kind == frame->kind && child->offset == frame->offset)
+            return child;
+    }
+    if (node->num_children == node->alloc_children) {
+        node->alloc_children = node->alloc_children ? node->alloc_children * 2 : 4;
+        node->children = MVM_realloc(node->children,
+            node->alloc_children * sizeof(MVMProfileSampleNode *));
+    }
+    child = MVM_calloc(1, sizeof(MVMProfileSampleNode));
+    child->sf   = frame->sf;
+    child->kind   = frame->kind;
+    child->offset = frame->offset;
+    node->children[node->num_children++] = child;
+    return child;
+}
+
+/* Takes a sample of the current thread's call stack; called from a GC sync
+ * point in the interpreter or JIT-compiled code when one was asked for. */
+void MVM_profile_sampling_take(MVMThreadContext *tc) {
+    MVMProfileSampler      *sampler = tc->instance->sampling_profiler;
+    MVMProfileSampleThread *pst     = tc->prof_samples;
+    MVMProfileSampleNode   *node;
+    MVMFrame               *frame;
+    MVMuint32               depth   = 0;
+
+    MVM_store(&tc->prof_sample_requested, 0);
+    if (!pst)
+        return;
+
+    /* Collect the stack, innermost frame first. Frames that were inlined are
+     * not seen, and show up as part of the frame they were inlined into. */
+    for (frame = tc->cur_frame; frame; frame = frame->caller) {
+        if (depth == pst->alloc_stack) {
+            pst->alloc_stack = pst->alloc_stack ? pst->alloc_stack * 2 : 64;
+            pst->stack = MVM_realloc(pst->stack,
+                pst->alloc_stack * sizeof(MVMProfileSampleFrame));
+        }
+        pst->stack[depth].sf     = frame->static_info;
+        pst->stack[depth].offset = 0;
+        if (!frame->spesh_cand) {
+            /* Like backtraces, point at the instruction before the current
+             * position, which for callers is the invoke. */
+            MVMuint8 *cur_op = frame == tc->cur_frame
+                ? *(tc->interp_cur_op)
+                : frame->return_address;
+            MVMuint8 *start  = frame->static_info->body.bytecode;
+            if (cur_op > start && cur_op <= start + frame->static_info->body.bytecode_size)
+                pst->stack[depth].offset = (MVMuint32)(cur_op - start - 1);
+            pst->stack[depth].kind = MVM_PROFILE_SAMPLE_INTERP;
+        }
+        else {
+            pst->stack[depth].kind = frame->spesh_cand->jitcode
+                ? MVM_PROFILE_SAMPLE_JIT
+                : MVM_PROFILE_SAMPLE_SPESH;
+        }
+        depth++;
+    }
+    if (!depth)
+        return;
+
+    /* Add it to the call tree, unless the profile was already written. */
+    uv_mutex_lock(&sampler->mutex);
+    if (sampler->fh) {
+        node = pst->root;
+        while (depth--)
+            node = get_child(node, &(pst->stack[depth]));
+        node->self_samples++;
+        pst->thread_id = tc->thread_id;
+        pst->samples++;
+    }
+    uv_mutex_unlock(&sampler->mutex);
+}
+
+/* Stops the thread asking for samples, if it's still running. */
+static void stop_sampling(MVMProfileSampler *sampler) {
+    if (!sampler->running)
+        return;
+    uv_mutex_lock(&sampler->mutex);
+    sampler->stop = 1;
+    uv_cond_signal(&sampler->cond);
+    uv_mutex_unlock(&sampler->mutex);
+    uv_thread_join(&sampler->thread);
+    sampler->running = 0;
+}
+
+/* Makes a frame name for a folded stack, of the form "name file:line". JIT
+ * compiled and specialized frames are marked with a _[j] and _[s] suffix,
+ * the first of which flame graph tools know to color differently; their
+ * line is that of the start of the frame. */
+static char * frame_label(MVMThreadContext *tc, MVMProfileSampleNode *node) {
+    MVMBytecodeAnnotation *annot = MVM_bytecode_resolve_annotation(tc,
+        &(node->sf->body), node->offset);
+    MVMint32 fshi = annot ? (MVMint32)annot->filename_string_heap_index : -1;
+    MVMint32 line = annot ? (MVMint32)annot->line_number : -1;
+    char *name    = MVM_string_utf8_encode_C_string(tc, node->sf->body.name);
+    char *file    = NULL;
+    char *label, *c;
+    MVM_free(annot);
+
+    if (fshi >= 0 && fshi < node->sf->body.cu->body.num_strings)
+        file = MVM_string_utf8_encode_C_string(tc,
+            MVM_cu_string(tc, node->sf->body.cu, fshi));
+    else if (node->sf->body.cu->body.filename)
+        file = MVM_string_utf8_encode_C_string(tc, node->sf->body.cu->body.filename);
+
+    label = MVM_malloc(strlen(name) + (file ? strlen(file) : 0) + 32);
+    sprintf(label, "%s %s:%d%s",
+        name[0] ? name : "<anon>",
+        file ? file : "<unknown>",
+        line,
+        node->kind == MVM_PROFILE_SAMPLE_JIT   ? "_[j]" :
+        node->kind == MVM_PROFILE_SAMPLE_SPESH ? "_[s]" : "");
+    MVM_free(name);
+    MVM_free(file);
+
+    /* Semicolons separate frames and newlines separate stacks. */
+    for (c = label; *c; c++)
+        if (*c == ';' || *c == '\n' || *c == '\r')
+            *c = '_';
+    return label;
+}
+
+/* The labels of the nodes from the root to the one being written. */
+typedef struct {
+    char      **labels;
+    MVMuint32   num;
+    MVMuint32   alloc;
+} FoldedPath;
+
+static void write_node(MVMThreadContext *tc, FILE *fh, MVMuint32 thread_id,
+                       MVMProfileSampleNode *node, FoldedPath *path) {
+    MVMuint32 i;
+    if (node->self_samples) {
+        fprintf(fh, "thread %u", thread_id);
+        for (i = 0; i < path->num; i++)
+            fprintf(fh, ";%s", path->labels[i]);
+        fprintf(fh, " %"PRIu64"\n", node->self_samples);
+    }
+    for (i = 0; i < node->num_children; i++) {
+        if (path->num == path->alloc) {
+            path->alloc = path->alloc ? path->alloc * 2 : 64;
+            path->labels = MVM_realloc(path->labels, path->alloc * sizeof(char *));
+        }
+        path->labels[path->num++] = frame_label(tc, node->children[i]);
+        write_node(tc, fh, thread_id, node->children[i], path);
+        MVM_free(path->labels[--path->num]);
+    }
+}
+
+/* Writes out the folded stacks and closes the file; later calls do nothing.
+ * Threads that are still running stop adding samples from here on, so the
+ * trees can be walked without holding the mutex (which we may not do, since
+ * getting at file names can allocate). */
+void MVM_profile_sampling_write(MVMThreadContext *tc) {
+    MVMProfileSampler *sampler = tc->instance->sampling_profiler;
+    FoldedPath path = { NULL, 0, 0 };
+    MVMuint32 i;
+    FILE *fh;
+
+    stop_sampling(sampler);
+    uv_mutex_lock(&sampler->mutex);
+    fh = sampler->fh;
+    sampler->fh = NULL;
+    uv_mutex_unlock(&sampler->mutex);
+    if (!fh)
+        return;
+
+    for (i = 0; i < sampler->num_threads; i++) {
+        MVMProfileSampleThread *pst = sampler->threads[i];
+        write_node(tc, fh, pst->thread_id, pst->root, &path);
+    }
+    MVM_free(path.labels);
+    fclose(fh);
+}
+
+static void mark_node(MVMThreadContext *tc, MVMProfileSampleNode *node, MVMGCWorklist *worklist) {
+    MVMuint32 i;
+    MVM_gc_worklist_add(tc, worklist, &(node->sf));
+    for (i = 0; i < node->num_children; i++)
+        mark_node(tc, node->children[i], worklist);
+}
+
+/* Marks the static frames in the call trees. */
+void MVM_profile_sampling_gc_mark(MVMThreadContext *tc, MVMProfileSampler *sampler, MVMGCWorklist *worklist) {
+    MVMuint32 i;
+    if (!sampler)
+        return;
+    uv_mutex_lock(&sampler->mutex);
+    for (i = 0; i < sampler->num_threads; i++)
+        mark_node(tc, sampler->threads[i]->root, worklist);
+    uv_mutex_unlock(&sampler->mutex);
+}
+
+static void destroy_node(MVMProfileSampleNode *node) {
+    MVMuint32 i;
+    for (i = 0; i < node->num_children; i++)
+        destroy_node(node->children[i]);
+    MVM_free(node->children);
+    MVM_free(node);
+}
+
+void MVM_profile_sampling_destroy(MVMThreadContext *tc, MVMProfileSampler *sampler) {
+    MVMuint32 i;
+    stop_sampling(sampler);
+    if (sampler->fh)
+        fclose(sampler->fh);
+    for (i = 0; i < sampler->num_threads; i++) {
+        MVMProfileSampleThread *pst = sampler->threads[i];
+        if (pst->tc)
+            pst->tc->prof_samples = NULL;
+        destroy_node(pst->root);
+        MVM_free(pst->stack);
+        MVM_free(pst);
+    }
+    MVM_free(sampler->threads);
+    uv_cond_destroy(&sampler->cond);
+    uv_mutex_destroy(&sampler->mutex);
+    MVM_free(sampler);
+}
@@ -0,0 +1,90 @@
+/* The sampling profiler builds a call tree for each thread from periodic
+ * samples of its call stack, which is cheap enough to leave on for a whole
+ * run, unlike the instrumented profiler. It is enabled by setting
+ * MVM_SAMPLING_PROFILE to the name of a file, and the rate (in samples per
+ * second, 100 by default) can be set with MVM_SAMPLING_PROFILE_HZ. A thread
+ * of its own wakes up at that rate and asks each thread for a sample, which
+ * the thread takes at its next GC sync point. At exit, the trees are written
+ * out as folded stacks, one line per distinct stack with a sample count, as
+ * consumed by flame graph tools. */
+
+/* How a frame was being run when it was sampled. */
+#define MVM_PROFILE_SAMPLE_INTERP   0
+#define MVM_PROFILE_SAMPLE_SPESH    1
+#define MVM_PROFILE_SAMPLE_JIT      2
+
+/* A node in a per-thread call tree of samples. */
+struct MVMProfileSampleNode {
+    /* The static frame and how it was run; NULL for the root. */
+    MVMStaticFrame *sf;
+    MVMuint8        kind;
+
+    /* The bytecode offset within the frame; see MVMProfileSampleFrame. */
+    MVMuint32 offset;
+
+    /* Samples taken with this node at the top of the stack. */
+    MVMuint64 self_samples;
+
+    /* Callees. */
+    MVMProfileSampleNode **children;
+    MVMuint32              num_children;
+    MVMuint32              alloc_children;
+};
+
+/* A frame of a stack being sampled. The offset is that of the instruction
+ * being run (or of the call, for frames further down the stack) in the
+ * frame's original bytecode. Specialized and JIT-compiled code doesn't map
+ * back to that, so the offset is always 0 for those. */
+struct MVMProfileSampleFrame {
+    MVMStaticFrame *sf;
+    MVMuint8        kind;
+    MVMuint32       offset;
+};
+
+/* Samples for a thread. */
+struct MVMProfileSampleThread {
+    /* The thread context; NULL once the thread is gone. */
+    MVMThreadContext *tc;
+    MVMuint32         thread_id;
+
+    /* Root of the call tree, and the number of samples taken. */
+    MVMProfileSampleNode *root;
+    MVMuint64             samples;
+
+    /* Scratch space for the stack being sampled; only touched by the
+     * thread itself. */
+    MVMProfileSampleFrame *stack;
+    MVMuint32              alloc_stack;
+};
+
+struct MVMProfileSampler {
+    /* The file to write the folded stacks to. */
+    FILE *fh;
+
+    /* Time between samples, in nanoseconds. */
+    MVMuint64 interval;
+
+    /* The thread asking for samples, and whether it's running and should
+     * stop. */
+    uv_thread_t thread;
+    MVMuint8    running;
+    MVMuint8    stop;
+
+    /* Threads being sampled. */
+    MVMProfileSampleThread **threads;
+    MVMuint32                num_threads;
+    MVMuint32                alloc_threads;
+
+    /* Protects all of the above but the scratch stacks, and is waited on
+     * between samples. Never held while doing anything that might GC. */
+    uv_mutex_t mutex;
+    uv_cond_t  cond;
+};
+
+MVMProfileSampler * MVM_profile_sampling_create(MVMThreadContext *tc, FILE *fh, MVMuint64 hz);
+void MVM_profile_sampling_register_thread(MVMThreadContext *tc);
+void MVM_profile_sampling_unregister_thread(MVMThreadContext *tc);
+void MVM_profile_sampling_take(MVMThreadContext *tc);
+void MVM_profile_sampling_write(MVMThreadContext *tc);
+void MVM_profile_sampling_gc_mark(MVMThreadContext *tc, MVMProfileSampler *sampler, MVMGCWorklist *worklist);
+void MVM_profile_sampling_destroy(MVMThreadContext *tc, MVMProfileSampler *sampler);
@@ -30,9 +30,14 @@ void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
     MVMuint64 start_time;
 
     /* If we've reached our specialization limit, don't continue. */
-    if (tc->instance->spesh_limit)
-        if (++tc->instance->spesh_produced > tc->instance->spesh_limit)
+    if (tc->instance->spesh_limit) {
+        MVMint32 produced;
+        uv_mutex_lock(&tc->instance->mutex_spesh_install);
+        produced = ++tc->instance->spesh_produced;
+        uv_mutex_unlock(&tc->instance->mutex_spesh_install);
+        if (produced > tc->instance->spesh_limit)
             return;
+    }
 
     /* Produce the specialization graph and, if we're logging, dump it out
      * pre-transformation. */
@@ -79,6 +84,7 @@ void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
     candidate->num_deopts    = sg->num_deopt_addrs;
     candidate->deopts        = sg->deopt_addrs;
     candidate->deopt_named_used_bit_field = sg->deopt_named_used_bit_field;
+    candidate->materializations = MVM_spesh_escape_materializations_for_cand(tc, sg);
     candidate->num_locals    = sg->num_locals;
     candidate->num_lexicals  = sg->num_lexicals;
     candidate->num_inlines   = sg->num_inlines;
@@ -111,9 +117,23 @@ void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
     }
     MVM_spesh_graph_destroy(tc, sg);
 
+    /* Another specialization worker may be installing a candidate for the
+     * same frame, or may even have produced this very one from a plan of its
+     * own, so installation is done under a lock. */
+    spesh = p->sf->body.spesh;
+    uv_mutex_lock(&tc->instance->mutex_spesh_install);
+    if (MVM_spesh_arg_guard_exists(tc, spesh->body.spesh_arg_guard, p->cs_stats->cs, p->type_tuple)) {
+        uv_mutex_unlock(&tc->instance->mutex_spesh_install);
+        MVM_spesh_candidate_destroy(tc, candidate);
+        MVM_free(candidate);
+#if MVM_GC_DEBUG
+        tc->in_spesh = 0;
+#endif
+        return;
+    }
+
     /* Create a new candidate list and copy any existing ones. Free memory
      * using the FSA safepoint mechanism. */
-    spesh = p->sf->body.spesh;
     new_candidate_list = MVM_fixed_size_alloc(tc, tc->instance->fsa,
         (spesh->body.num_spesh_candidates + 1) * sizeof(MVMSpeshCandidate *));
     if (spesh->body.num_spesh_candidates) {
@@ -141,6 +161,9 @@ void MVM_spesh_candidate_add(MVMThreadContext *tc, MVMSpeshPlanned *p) {
         p->cs_stats->cs, p->type_tuple, spesh->body.num_spesh_candidates);
     MVM_barrier();
     spesh->body.num_spesh_candidates++;
+    if (tc->instance->spesh_plan_cache)
+        MVM_spesh_plan_cache_record(tc, p);
+    uv_mutex_unlock(&tc->instance->mutex_spesh_install);
 
     /* If we're logging, dump the updated arg guards also. */
     if (tc->instance->spesh_log_fh) {
@@ -161,6 +184,7 @@ void MVM_spesh_candidate_destroy(MVMThreadContext *tc, MVMSpeshCandidate *candid
     MVM_free(candidate->handlers);
     MVM_free(candidate->spesh_slots);
     MVM_free(candidate->deopts);
+    MVM_spesh_escape_destroy_materializations(tc, candidate->materializations);
     MVM_free(candidate->inlines);
     MVM_free(candidate->local_types);
     MVM_free(candidate->lexical_types);
@@ -28,6 +28,9 @@ struct MVMSpeshCandidate {
      * typically don't update the array in specialized code. */
     MVMuint64 deopt_named_used_bit_field;
 
+    /* Objects to materialize on deopt; see escape.h. */
+    MVMSpeshMaterializations *materializations;
+
     /* Number of inlines and inlines table; see graph.h for description of
      * the table format. */
     MVMint32 num_inlines;
@@ -157,6 +157,93 @@ static void uninline(MVMThreadContext *tc, MVMFrame *f, MVMSpeshCandidate *cand,
     }
 }
 
+/* Escape analysis may have replaced objects with registers holding their
+ * attributes; if any of them are live at the deopt point, then allocate them
+ * and put them in the registers the original code expects them in. Returns
+ * the frame, which is moved to the heap if we materialize anything. */
+static MVMFrame * materialize_replaced_objects(MVMThreadContext *tc, MVMFrame *f,
+                                               MVMint32 deopt_offset, MVMint32 deopt_target) {
+    MVMSpeshCandidate        *cand      = f->spesh_cand;
+    MVMSpeshMaterializations *m         = cand->materializations;
+    MVMint32                  deopt_idx = -1;
+    MVMuint32                 i, j;
+    if (!m)
+        return f;
+
+    /* More than one deopt index may map to the same place; they will all
+     * have the same objects, so we just take the first we find. */
+    for (i = 0; i < m->num_objects; i++) {
+        MVMint32 idx = m->objects[i].deopt_idx;
+        if (cand->deopts[2 * idx] == deopt_target && cand->deopts[2 * idx + 1] == deopt_offset) {
+            deopt_idx = idx;
+            break;
+        }
+    }
+    if (deopt_idx < 0)
+        return f;
+
+    f = MVM_frame_force_to_heap(tc, f);
+    MVMROOT(tc, f, {
+        for (i = 0; i < m->num_objects; i++) {
+            MVMSpeshMaterialization *mat = &(m->objects[i]);
+            MVMObject               *obj;
+            if (mat->deopt_idx != deopt_idx)
+                continue;
+            if (mat->is_box) {
+                MVMObject                 *type  = (MVMObject *)cand->spesh_slots[mat->type_slot];
+                MVMSpeshMaterializedField *field = &(m->fields[mat->first_field]);
+                switch (field->kind) {
+                    case MVM_reg_int64:
+                        obj = MVM_repr_box_int(tc, type, f->work[field->reg].i64);
+                        break;
+                    case MVM_reg_num64:
+                        obj = MVM_repr_box_num(tc, type, f->work[field->reg].n64);
+                        break;
+                    default:
+                        obj = MVM_repr_box_str(tc, type, f->work[field->reg].s);
+                        break;
+                }
+            }
+            else {
+                /* Allocate just as sp_fastcreate does, then bind the fields. */
+                MVMSTable *st = (MVMSTable *)cand->spesh_slots[mat->type_slot];
+                char      *data;
+                obj               = MVM_gc_allocate_zeroed(tc, st->size);
+                obj->st           = st;
+                obj->header.size  = st->size;
+                obj->header.owner = tc->thread_id;
+                data = MVM_p6opaque_real_data(tc, OBJECT_BODY(obj));
+                for (j = 0; j < mat->num_fields; j++) {
+                    MVMSpeshMaterializedField *field = &(m->fields[mat->first_field + j]);
+                    MVMRegister               *value = &(f->work[field->reg]);
+                    switch (field->kind) {
+                        case MVM_reg_obj:
+                            MVM_ASSIGN_REF(tc, &(obj->header),
+                                *((MVMObject **)(data + field->offset)), value->o);
+                            break;
+                        case MVM_reg_str:
+                            MVM_ASSIGN_REF(tc, &(obj->header),
+                                *((MVMString **)(data + field->offset)), value->s);
+                            break;
+                        case MVM_reg_int64:
+                            *((MVMint64 *)(data + field->offset)) = value->i64;
+                            break;
+                        case MVM_reg_num64:
+                            *((MVMnum64 *)(data + field->offset)) = value->n64;
+                            break;
+                    }
+                }
+            }
+            for (j = 0; j < mat->num_targets; j++)
+                MVM_ASSIGN_REF(tc, &(f->header), f->work[m->targets[mat->first_target + j]].o, obj);
+        }
+    });
+#if MVM_LOG_DEOPTS
+    fprintf(stderr, "Materialized replaced objects for deopt index %d\n", deopt_idx);
+#endif
+    return f;
+}
+
 static void deopt_named_args_used(MVMThreadContext *tc, MVMFrame *f) {
     if (f->spesh_cand->deopt_named_used_bit_field)
         f->params.named_used.bit_field = f->spesh_cand->deopt_named_used_bit_field;
@@ -165,6 +252,7 @@ static void deopt_named_args_used(MVMThreadContext *tc, MVMFrame *f) {
 static void deopt_frame(MVMThreadContext *tc, MVMFrame *f, MVMint32 deopt_offset, MVMint32 deopt_target) {
     /* Found it; are we in an inline? */
     MVMSpeshInline *inlines = f->spesh_cand->inlines;
+    f = materialize_replaced_objects(tc, f, deopt_offset, deopt_target);
     deopt_named_args_used(tc, f);
     if (inlines) {
         /* Yes, going to have to re-create the frames; uninline
@@ -276,6 +364,11 @@ void MVM_spesh_deopt_all(MVMThreadContext *tc) {
                                 deopts[i].label, deopts[i].idx);
 #endif
 
+                        /* Put back any objects escape analysis replaced. */
+                        MVMROOT(tc, l, {
+                            f = materialize_replaced_objects(tc, f, deopt_offset, deopt_target);
+                        });
+
                         /* Re-create any frames needed if we're in an inline; if not,
                         * just update return address. */
                         if (f->spesh_cand->inlines) {
@@ -311,6 +404,12 @@ void MVM_spesh_deopt_all(MVMThreadContext *tc) {
                 MVMint32 i;
                 for (i = 0; i < n; i += 2) {
                     if (f->spesh_cand->deopts[i + 1] == ret_offset) {
+                        /* Put back any objects escape analysis replaced. */
+                        MVMROOT(tc, l, {
+                            f = materialize_replaced_objects(tc, f, ret_offset,
+                                f->spesh_cand->deopts[i]);
+                        });
+
                         /* Re-create any frames needed if we're in an inline; if not,
                         * just update return address. */
                         if (f->spesh_cand->inlines) {
@@ -510,6 +510,23 @@ char * MVM_spesh_dump(MVMThreadContext *tc, MVMSpeshGraph *g) {
         }
     }
 
+    /* Dump loops. */
+    if (g->num_loops) {
+        MVMuint32 i;
+        append(&ds, "\nLoops:\n");
+        for (i = 0; i < g->num_loops; i++) {
+            MVMSpeshLoop *loop = &(g->loops[i]);
+            appendf(&ds, "    Header %d ", loop->header->idx);
+            if (loop->preheader)
+                appendf(&ds, "(preheader %d)", loop->preheader->idx);
+            else
+                append(&ds, "(no preheader)");
+            appendf(&ds, ": %u blocks, %u back edges, hoisted %u instructions (%u guards)%s\n",
+                loop->num_bbs, loop->num_back_edges, loop->hoisted, loop->hoisted_guards,
+                loop->side_effects ? ", has side effects" : "");
+        }
+    }
+
     append(&ds, "\n");
     append_null(&ds);
     return ds.buffer;
@@ -0,0 +1,640 @@
+#include "moar.h"
+
+/* Escape analysis and scalar replacement. An object that is allocated by a
+ * sp_fastcreate of a P6opaque type, or by boxing a native value, and that is
+ * then only copied around with set, read with sp_p6oget_* or unbox_*, and
+ * written with sp_p6obind_*, is never seen outside of the frame, so there is
+ * no need to allocate it at all: each of its attributes can live in a
+ * register of its own instead. The analysis is deliberately simple. We only
+ * follow the object along a run of basic blocks with no branches or merges,
+ * and give up unless every register holding it has been overwritten by the
+ * end of that run, so nothing else can ever see it.
+ *
+ * While the object is still live, a deopt may happen, after which the
+ * interpreter will expect to find it in those registers. So, for each deopt
+ * point in that range, we record what's needed to materialize it: the type,
+ * the registers holding its attributes at that point, and the registers it
+ * should be put into. */
+
+/* Limits on the objects we'll consider; anything bigger is left alone. */
+#define MAX_FIELDS      16
+#define MAX_ALIASES     16
+#define MAX_USES        64
+#define MAX_SNAPSHOTS   32
+#define MAX_DEOPTS_INS  4
+
+/* The kinds of use of the object that we can replace. */
+#define USE_SET     0
+#define USE_GET     1
+#define USE_BIND    2
+#define USE_UNBOX   3
+
+/* A use of the object. */
+typedef struct {
+    MVMSpeshIns *ins;
+    MVMSpeshBB  *bb;
+    MVMuint16    type;
+    MVMuint16    field;
+} Use;
+
+/* A deopt point passed while the object was live, with the number of uses
+ * done by then and the registers holding it (as a bit field of aliases). */
+typedef struct {
+    MVMint32  deopt_idx;
+    MVMuint32 num_uses;
+    MVMuint32 live;
+} Snapshot;
+
+/* An allocation being considered for replacement. */
+typedef struct {
+    MVMSpeshIns *alloc;
+    MVMSpeshBB  *alloc_bb;
+    MVMuint16    is_box;
+    MVMuint16    type_slot;
+    MVMObject   *box_type;
+
+    /* The fields used; for a box, just the boxed value. */
+    MVMuint16 field_offsets[MAX_FIELDS];
+    MVMuint16 field_kinds[MAX_FIELDS];
+    MVMuint32 num_fields;
+
+    /* The registers the object has been put in, and which of them still
+     * hold it. */
+    MVMSpeshOperand aliases[MAX_ALIASES];
+    MVMuint32       num_aliases;
+    MVMuint32       live;
+
+    Use       uses[MAX_USES];
+    MVMuint32 num_uses;
+
+    Snapshot  snapshots[MAX_SNAPSHOTS];
+    MVMuint32 num_snapshots;
+} Candidate;
+
+/* Gets the register kind an unbox or attribute access works with. */
+static MVMuint16 access_kind(MVMuint16 opcode) {
+    switch (opcode) {
+        case MVM_OP_box_i:
+        case MVM_OP_unbox_i:
+        case MVM_OP_sp_p6oget_i:
+        case MVM_OP_sp_p6obind_i:
+            return MVM_reg_int64;
+        case MVM_OP_box_n:
+        case MVM_OP_unbox_n:
+        case MVM_OP_sp_p6oget_n:
+        case MVM_OP_sp_p6obind_n:
+            return MVM_reg_num64;
+        case MVM_OP_box_s:
+        case MVM_OP_unbox_s:
+        case MVM_OP_sp_p6oget_s:
+        case MVM_OP_sp_p6obind_s:
+            return MVM_reg_str;
+        default:
+            return MVM_reg_obj;
+    }
+}
+
+static MVMint32 has_deopt_ann(MVMSpeshIns *ins) {
+    MVMSpeshAnn *ann = ins->annotations;
+    while (ann) {
+        switch (ann->type) {
+            case MVM_SPESH_ANN_DEOPT_ONE_INS:
+            case MVM_SPESH_ANN_DEOPT_ALL_INS:
+            case MVM_SPESH_ANN_DEOPT_INLINE:
+            case MVM_SPESH_ANN_DEOPT_OSR:
+                return 1;
+        }
+        ann = ann->next;
+    }
+    return 0;
+}
+
+/* Sees if an instruction is an allocation we can consider, and sets up the
+ * candidate if so. */
+static MVMint32 init_candidate(MVMThreadContext *tc, MVMSpeshGraph *g, Candidate *c,
+                               MVMSpeshBB *bb, MVMSpeshIns *ins) {
+    MVMuint16 opcode = ins->info->opcode;
+    switch (opcode) {
+        case MVM_OP_sp_fastcreate: {
+            MVMSTable *st = (MVMSTable *)g->spesh_slots[ins->operands[2].lit_i16];
+            if (st->REPR->ID != MVM_REPR_ID_P6opaque)
+                return 0;
+            c->is_box     = 0;
+            c->type_slot  = ins->operands[2].lit_i16;
+            c->num_fields = 0;
+            break;
+        }
+        case MVM_OP_box_i:
+        case MVM_OP_box_n:
+        case MVM_OP_box_s: {
+            /* We need to know the type to box with should we deopt, and it
+             * must not depend on a log guard, since those may be gone. */
+            MVMSpeshFacts *type_facts = MVM_spesh_get_facts(tc, g, ins->operands[2]);
+            if (!(type_facts->flags & MVM_SPESH_FACT_KNOWN_TYPE) || !type_facts->type)
+                return 0;
+            if (type_facts->flags & (MVM_SPESH_FACT_FROM_LOG_GUARD | MVM_SPESH_FACT_MERGED_WITH_LOG_GUARD))
+                return 0;
+            switch (REPR(type_facts->type)->ID) {
+                case MVM_REPR_ID_P6opaque:
+                case MVM_REPR_ID_P6int:
+                case MVM_REPR_ID_P6num:
+                case MVM_REPR_ID_P6str:
+                case MVM_REPR_ID_P6bigint:
+                    break;
+                default:
+                    return 0;
+            }
+            c->is_box           = 1;
+            c->box_type         = type_facts->type;
+            c->field_offsets[0] = 0;
+            c->field_kinds[0]   = access_kind(opcode);
+            c->num_fields       = 1;
+            break;
+        }
+        default:
+            return 0;
+    }
+    if (has_deopt_ann(ins))
+        return 0;
+    c->alloc         = ins;
+    c->alloc_bb      = bb;
+    c->aliases[0]    = ins->operands[0];
+    c->num_aliases   = 1;
+    c->live          = 1;
+    c->num_uses      = 0;
+    c->num_snapshots = 0;
+    return 1;
+}
+
+/* Finds the live alias a register operand is, if any. */
+static MVMint32 find_alias(Candidate *c, MVMSpeshOperand o) {
+    MVMuint32 i;
+    for (i = 0; i < c->num_aliases; i++)
+        if ((c->live & (1 << i)) && c->aliases[i].reg.orig == o.reg.orig &&
+                c->aliases[i].reg.i == o.reg.i)
+            return i;
+    return -1;
+}
+
+/* Finds or adds a field; fails if it was accessed as another kind. */
+static MVMint32 find_field(Candidate *c, MVMuint16 offset, MVMuint16 kind) {
+    MVMuint32 i;
+    for (i = 0; i < c->num_fields; i++)
+        if (c->field_offsets[i] == offset)
+            return c->field_kinds[i] == kind ? (MVMint32)i : -1;
+    if (c->num_fields == MAX_FIELDS)
+        return -1;
+    c->field_offsets[c->num_fields] = offset;
+    c->field_kinds[c->num_fields]   = kind;
+    return c->num_fields++;
+}
+
+/* Works out what kind of use reading the object as operand i is, or -1 if
+ * it's a use we can't replace, meaning the object escapes. */
+static MVMint32 classify_use(Candidate *c, MVMSpeshIns *ins, MVMuint32 i, MVMint32 *field) {
+    MVMuint16 opcode = ins->info->opcode;
+    switch (opcode) {
+        case MVM_OP_set:
+            return USE_SET;
+        case MVM_OP_unbox_i:
+        case MVM_OP_unbox_n:
+        case MVM_OP_unbox_s:
+            if (!c->is_box || c->field_kinds[0] != access_kind(opcode))
+                return -1;
+            *field = 0;
+            return USE_UNBOX;
+        case MVM_OP_sp_p6oget_o:
+        case MVM_OP_sp_p6oget_i:
+        case MVM_OP_sp_p6oget_n:
+        case MVM_OP_sp_p6oget_s:
+            if (c->is_box)
+                return -1;
+            *field = find_field(c, ins->operands[2].lit_i16, access_kind(opcode));
+            return *field >= 0 ? USE_GET : -1;
+        case MVM_OP_sp_p6obind_o:
+        case MVM_OP_sp_p6obind_i:
+        case MVM_OP_sp_p6obind_n:
+        case MVM_OP_sp_p6obind_s:
+            /* Only binding into the object; binding it somewhere escapes. */
+            if (c->is_box || i != 0)
+                return -1;
+            *field = find_field(c, ins->operands[1].lit_i16, access_kind(opcode));
+            return *field >= 0 ? USE_BIND : -1;
+        default:
+            return -1;
+    }
+}
+
+static MVMint32 add_snapshot(Candidate *c, MVMint32 deopt_idx) {
+    if (c->num_snapshots == MAX_SNAPSHOTS)
+        return 0;
+    c->snapshots[c->num_snapshots].deopt_idx = deopt_idx;
+    c->snapshots[c->num_snapshots].num_uses  = c->num_uses;
+    c->snapshots[c->num_snapshots].live      = c->live;
+    c->num_snapshots++;
+    return 1;
+}
+
+/* Analyzes an instruction met while the object is live. Returns zero if the
+ * object escapes, or if we can't otherwise handle what we find. */
+static MVMint32 analyze_ins(MVMThreadContext *tc, Candidate *c, MVMSpeshBB *bb, MVMSpeshIns *ins) {
+    MVMSpeshAnn *ann;
+    MVMint32     deopt_before[MAX_DEOPTS_INS], deopt_after[MAX_DEOPTS_INS];
+    MVMuint32    num_before = 0, num_after = 0;
+    MVMint32     use_type = -1, field = 0, new_alias = -1;
+    MVMuint32    is_phi = ins->info->opcode == MVM_SSA_PHI;
+    MVMuint32    i, a;
+
+    /* We can't tell OSR about objects to materialize. */
+    if (ins->info->opcode == MVM_OP_osrpoint)
+        return 0;
+
+    /* Collect deopt points. A deopt_one happens before the instruction does
+     * its work; deopt_all and inline ones are after it returns. */
+    for (ann = ins->annotations; ann; ann = ann->next) {
+        switch (ann->type) {
+            case MVM_SPESH_ANN_DEOPT_OSR:
+                return 0;
+            case MVM_SPESH_ANN_DEOPT_ONE_INS:
+                if (num_before == MAX_DEOPTS_INS)
+                    return 0;
+                deopt_before[num_before++] = ann->data.deopt_idx;
+                break;
+            case MVM_SPESH_ANN_DEOPT_ALL_INS:
+            case MVM_SPESH_ANN_DEOPT_INLINE:
+                if (num_after == MAX_DEOPTS_INS)
+                    return 0;
+                deopt_after[num_after++] = ann->data.deopt_idx;
+                break;
+        }
+    }
+
+    /* Look for reads of the object. */
+    for (i = is_phi ? 1 : 0; i < ins->info->num_operands; i++) {
+        if (!is_phi && (ins->info->operands[i] & MVM_operand_rw_mask) != MVM_operand_read_reg)
+            continue;
+        if (find_alias(c, ins->operands[i]) < 0)
+            continue;
+        if (is_phi || use_type >= 0)
+            return 0;
+        use_type = classify_use(c, ins, i, &field);
+        if (use_type < 0)
+            return 0;
+    }
+
+    /* A deopt_one on a use would need the object before we replaced the use,
+     * and an alias set will be deleted, taking any deopt point with it. */
+    if (use_type >= 0 && num_before)
+        return 0;
+    if (use_type == USE_SET && num_after)
+        return 0;
+
+    for (i = 0; i < num_before; i++)
+        if (!add_snapshot(c, deopt_before[i]))
+            return 0;
+
+    if (use_type >= 0) {
+        if (c->num_uses == MAX_USES)
+            return 0;
+        c->uses[c->num_uses].ins   = ins;
+        c->uses[c->num_uses].bb    = bb;
+        c->uses[c->num_uses].type  = use_type;
+        c->uses[c->num_uses].field = field;
+        c->num_uses++;
+        if (use_type == USE_SET) {
+            if (c->num_aliases == MAX_ALIASES)
+                return 0;
+            new_alias = c->num_aliases++;
+            c->aliases[new_alias] = ins->operands[0];
+            c->live |= 1 << new_alias;
+        }
+    }
+
+    /* Writes to a register holding the object mean it no longer does. If
+     * that happens at a deopt point, it's hard to say whether the object is
+     * wanted there, so give up. */
+    for (i = 0; i < ins->info->num_operands; i++) {
+        if (is_phi ? i != 0 : (ins->info->operands[i] & MVM_operand_rw_mask) != MVM_operand_write_reg)
+            continue;
+        for (a = 0; a < c->num_aliases; a++) {
+            if ((MVMint32)a == new_alias || !(c->live & (1 << a)))
+                continue;
+            if (c->aliases[a].reg.orig == ins->operands[i].reg.orig) {
+                if (num_before || num_after)
+                    return 0;
+                c->live &= ~(1 << a);
+            }
+        }
+    }
+
+    for (i = 0; i < num_after; i++)
+        if (!add_snapshot(c, deopt_after[i]))
+            return 0;
+
+    return 1;
+}
+
+/* Follows the object from its allocation until no register holds it any
+ * more. Returns non-zero if it never escapes. */
+static MVMint32 analyze(MVMThreadContext *tc, Candidate *c) {
+    MVMSpeshBB  *bb  = c->alloc_bb;
+    MVMSpeshIns *ins = c->alloc->next;
+    while (1) {
+        while (ins) {
+            if (!analyze_ins(tc, c, bb, ins))
+                return 0;
+            if (!c->live)
+                return 1;
+            ins = ins->next;
+        }
+
+        /* Only carry on into a successor if it's the only one, and we're the
+         * only way to get there. */
+        if (bb->num_succ != 1 || bb->succ[0]->num_pred != 1 || bb->succ[0] == c->alloc_bb)
+            return 0;
+        bb  = bb->succ[0];
+        ins = bb->first_ins;
+    }
+}
+
+/* Grows an array in a materialization table of a graph, if needed. */
+static void * grow(MVMThreadContext *tc, MVMSpeshGraph *g, void *array, size_t size,
+                   MVMuint32 num, MVMuint32 *alloc, MVMuint32 needed) {
+    if (num + needed > *alloc) {
+        void      *new_array;
+        MVMuint32  new_alloc = *alloc ? *alloc * 2 : 8;
+        while (new_alloc < num + needed)
+            new_alloc *= 2;
+        new_array = MVM_spesh_alloc(tc, g, new_alloc * size);
+        if (num)
+            memcpy(new_array, array, num * size);
+        *alloc = new_alloc;
+        return new_array;
+    }
+    return array;
+}
+
+static MVMSpeshMaterializations * get_table(MVMThreadContext *tc, MVMSpeshGraph *g) {
+    if (!g->materializations)
+        g->materializations = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshMaterializations));
+    return g->materializations;
+}
+
+/* Records how to materialize the object at a deopt point, given the
+ * registers holding the fields at that point (and which are bound). */
+static void add_materialization(MVMThreadContext *tc, MVMSpeshGraph *g, Candidate *c,
+                                Snapshot *s, MVMSpeshOperand *temps, MVMuint8 *bound) {
+    MVMSpeshMaterializations *m = get_table(tc, g);
+    MVMSpeshMaterialization  *obj;
+    MVMuint32 i;
+
+    m->objects = grow(tc, g, m->objects, sizeof(MVMSpeshMaterialization),
+        m->num_objects, &(m->alloc_objects), 1);
+    m->fields = grow(tc, g, m->fields, sizeof(MVMSpeshMaterializedField),
+        m->num_fields, &(m->alloc_fields), c->num_fields);
+    m->targets = grow(tc, g, m->targets, sizeof(MVMuint16),
+        m->num_targets, &(m->alloc_targets), c->num_aliases);
+
+    obj               = &(m->objects[m->num_objects++]);
+    obj->deopt_idx    = s->deopt_idx;
+    obj->type_slot    = c->type_slot;
+    obj->is_box       = c->is_box;
+    obj->first_field  = m->num_fields;
+    obj->num_fields   = 0;
+    obj->first_target = m->num_targets;
+    obj->num_targets  = 0;
+
+    for (i = 0; i < c->num_fields; i++) {
+        MVMSpeshMaterializedField *field;
+        if (!bound[i])
+            continue;
+        field         = &(m->fields[m->num_fields++]);
+        field->offset = c->field_offsets[i];
+        field->kind   = c->field_kinds[i];
+        field->reg    = temps[i].reg.orig;
+        obj->num_fields++;
+
+        /* Deopt reads the register, so its writer must stay. */
+        MVM_spesh_get_facts(tc, g, temps[i])->usages++;
+    }
+
+    for (i = 0; i < c->num_aliases; i++) {
+        if (s->live & (1 << i)) {
+            m->targets[m->num_targets++] = c->aliases[i].reg.orig;
+            obj->num_targets++;
+        }
+    }
+}
+
+static MVMSpeshOperand new_temp(MVMThreadContext *tc, MVMSpeshGraph *g, MVMuint16 kind,
+                                MVMSpeshIns *writer) {
+    MVMSpeshOperand temp = MVM_spesh_manipulate_get_temp_reg(tc, g, kind);
+    MVM_spesh_get_facts(tc, g, temp)->writer = writer;
+    return temp;
+}
+
+/* Turns an instruction into a set of one register to another. */
+static void make_set(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshIns *ins,
+                     MVMSpeshOperand target, MVMSpeshOperand source) {
+    ins->info        = MVM_op_get_op(MVM_OP_set);
+    ins->operands    = MVM_spesh_alloc(tc, g, 2 * sizeof(MVMSpeshOperand));
+    ins->operands[0] = target;
+    ins->operands[1] = source;
+}
+
+/* Replaces the allocation and all uses of the object with registers. The
+ * temporaries are never released, so each is written once and still holds
+ * its value at any later deopt point. */
+static void replace(MVMThreadContext *tc, MVMSpeshGraph *g, Candidate *c) {
+    MVMSpeshOperand temps[MAX_FIELDS];
+    MVMuint8        bound[MAX_FIELDS];
+    MVMuint32       i, s = 0;
+    memset(bound, 0, sizeof(bound));
+
+    MVM_spesh_get_facts(tc, g, c->alloc->operands[0])->dead_writer = 1;
+    if (c->is_box) {
+        MVMSpeshOperand value = c->alloc->operands[1];
+        MVM_spesh_get_facts(tc, g, c->alloc->operands[2])->usages--;
+        temps[0] = new_temp(tc, g, c->field_kinds[0], c->alloc);
+        bound[0] = 1;
+        make_set(tc, g, c->alloc, temps[0], value);
+        c->type_slot = MVM_spesh_add_spesh_slot_try_reuse(tc, g, (MVMCollectable *)c->box_type);
+    }
+    else {
+        MVM_spesh_manipulate_delete_ins(tc, g, c->alloc_bb, c->alloc);
+    }
+
+    for (i = 0; i < c->num_uses; i++) {
+        Use         *use = &(c->uses[i]);
+        MVMSpeshIns *ins = use->ins;
+        MVMuint16    f   = use->field;
+
+        for (; s < c->num_snapshots && c->snapshots[s].num_uses == i; s++)
+            add_materialization(tc, g, c, &(c->snapshots[s]), temps, bound);
+
+        switch (use->type) {
+            case USE_SET:
+                MVM_spesh_get_facts(tc, g, ins->operands[0])->dead_writer = 1;
+                MVM_spesh_manipulate_delete_ins(tc, g, use->bb, ins);
+                break;
+            case USE_BIND: {
+                MVMSpeshOperand value = ins->operands[2];
+                MVM_spesh_get_facts(tc, g, ins->operands[0])->usages--;
+                temps[f] = new_temp(tc, g, c->field_kinds[f], ins);
+                bound[f] = 1;
+                make_set(tc, g, ins, temps[f], value);
+                break;
+            }
+            case USE_GET:
+                MVM_spesh_get_facts(tc, g, ins->operands[1])->usages--;
+                if (bound[f]) {
+                    make_set(tc, g, ins, ins->operands[0], temps[f]);
+                    MVM_spesh_get_facts(tc, g, temps[f])->usages++;
+                }
+                else {
+                    /* Never bound, so read what a fresh object holds. */
+                    switch (c->field_kinds[f]) {
+                        case MVM_reg_int64:
+                            ins->info = MVM_op_get_op(MVM_OP_const_i64_16);
+                            ins->operands[1].lit_i16 = 0;
+                            break;
+                        case MVM_reg_num64:
+                            ins->info = MVM_op_get_op(MVM_OP_const_n64);
+                            ins->operands[1].lit_n64 = 0.0;
+                            break;
+                        case MVM_reg_str:
+                            ins->info = MVM_op_get_op(MVM_OP_null_s);
+                            break;
+                        default:
+                            ins->info = MVM_op_get_op(MVM_OP_null);
+                            break;
+                    }
+                }
+                break;
+            case USE_UNBOX:
+                MVM_spesh_get_facts(tc, g, ins->operands[1])->usages--;
+                make_set(tc, g, ins, ins->operands[0], temps[0]);
+                MVM_spesh_get_facts(tc, g, temps[0])->usages++;
+                break;
+        }
+    }
+    for (; s < c->num_snapshots; s++)
+        add_materialization(tc, g, c, &(c->snapshots[s]), temps, bound);
+}
+
+/* Looks through the graph for allocations that don't escape, and replaces
+ * them with registers. */
+void MVM_spesh_escape_analysis(MVMThreadContext *tc, MVMSpeshGraph *g) {
+    Candidate   c;
+    MVMSpeshBB *bb = g->entry;
+    while (bb) {
+        MVMSpeshIns *ins = bb->first_ins;
+        while (ins) {
+            MVMSpeshIns *prev = ins->prev;
+            if (init_candidate(tc, g, &c, bb, ins) && analyze(tc, &c)) {
+                /* A box became a set; a create was deleted. */
+                replace(tc, g, &c);
+                ins = c.is_box ? ins->next : prev ? prev->next : bb->first_ins;
+            }
+            else {
+                ins = ins->next;
+            }
+        }
+        bb = bb->linear_next;
+    }
+}
+
+/* Makes a copy of the materialization table of a graph for a candidate, or
+ * NULL if there's nothing in it. */
+MVMSpeshMaterializations * MVM_spesh_escape_materializations_for_cand(MVMThreadContext *tc,
+        MVMSpeshGraph *g) {
+    MVMSpeshMaterializations *from = g->materializations;
+    MVMSpeshMaterializations *to;
+    if (!from || !from->num_objects)
+        return NULL;
+    to = MVM_calloc(1, sizeof(MVMSpeshMaterializations));
+    to->num_objects = to->alloc_objects = from->num_objects;
+    to->objects     = MVM_malloc(from->num_objects * sizeof(MVMSpeshMaterialization));
+    memcpy(to->objects, from->objects, from->num_objects * sizeof(MVMSpeshMaterialization));
+    to->num_fields  = to->alloc_fields = from->num_fields;
+    if (from->num_fields) {
+        to->fields  = MVM_malloc(from->num_fields * sizeof(MVMSpeshMaterializedField));
+        memcpy(to->fields, from->fields, from->num_fields * sizeof(MVMSpeshMaterializedField));
+    }
+    to->num_targets = to->alloc_targets = from->num_targets;
+    if (from->num_targets) {
+        to->targets = MVM_malloc(from->num_targets * sizeof(MVMuint16));
+        memcpy(to->targets, from->targets, from->num_targets * sizeof(MVMuint16));
+    }
+    return to;
+}
+
+/* Sets up the materialization table of a graph formed from a candidate (for
+ * inlining it). The arrays are shared with the candidate; since they are
+ * exactly sized, anything added to them will be done in a copy. As usages
+ * were counted afresh when building the graph, we count those made by the
+ * deopt points once more, lest the registers be considered dead. */
+void MVM_spesh_escape_materializations_from_cand(MVMThreadContext *tc, MVMSpeshGraph *g,
+        MVMSpeshCandidate *cand) {
+    MVMuint32 i, j;
+    if (!cand->materializations)
+        return;
+    g->materializations = MVM_spesh_alloc(tc, g, sizeof(MVMSpeshMaterializations));
+    memcpy(g->materializations, cand->materializations, sizeof(MVMSpeshMaterializations));
+    if (g->facts) {
+        for (i = 0; i < cand->materializations->num_fields; i++) {
+            MVMuint16 reg = cand->materializations->fields[i].reg;
+            for (j = 0; j < g->fact_counts[reg]; j++)
+                g->facts[reg][j].usages++;
+        }
+    }
+}
+
+/* Adds the materialization table of a graph being inlined to that of the
+ * graph it is inlined into. Must be called before the inlinee's deopt
+ * addresses and spesh slots are added to those of the inliner, and before
+ * its count of locals is updated. */
+void MVM_spesh_escape_merge_materializations(MVMThreadContext *tc, MVMSpeshGraph *inliner,
+        MVMSpeshGraph *inlinee) {
+    MVMSpeshMaterializations *from = inlinee->materializations;
+    MVMSpeshMaterializations *to;
+    MVMuint32 i;
+    if (!from || !from->num_objects)
+        return;
+    to = get_table(tc, inliner);
+
+    to->objects = grow(tc, inliner, to->objects, sizeof(MVMSpeshMaterialization),
+        to->num_objects, &(to->alloc_objects), from->num_objects);
+    for (i = 0; i < from->num_objects; i++) {
+        MVMSpeshMaterialization *obj = &(to->objects[to->num_objects++]);
+        *obj = from->objects[i];
+        obj->deopt_idx    += inliner->num_deopt_addrs;
+        obj->type_slot    += inliner->num_spesh_slots;
+        obj->first_field  += to->num_fields;
+        obj->first_target += to->num_targets;
+    }
+
+    to->fields = grow(tc, inliner, to->fields, sizeof(MVMSpeshMaterializedField),
+        to->num_fields, &(to->alloc_fields), from->num_fields);
+    for (i = 0; i < from->num_fields; i++) {
+        MVMSpeshMaterializedField *field = &(to->fields[to->num_fields++]);
+        *field = from->fields[i];
+        field->reg += inliner->num_locals;
+    }
+
+    to->targets = grow(tc, inliner, to->targets, sizeof(MVMuint16),
+        to->num_targets, &(to->alloc_targets), from->num_targets);
+    for (i = 0; i < from->num_targets; i++)
+        to->targets[to->num_targets++] = from->targets[i] + inliner->num_locals;
+}
+
+/* Frees a candidate's materialization table. */
+void MVM_spesh_escape_destroy_materializations(MVMThreadContext *tc,
+        MVMSpeshMaterializations *m) {
+    if (!m)
+        return;
+    MVM_free(m->objects);
+    MVM_free(m->fields);
+    MVM_free(m->targets);
+    MVM_free(m);
+}
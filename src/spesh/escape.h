@@ -0,0 +1,60 @@
+/* Information needed to materialize, on deoptimization, an object whose
+ * allocation was replaced by registers. There is one of these per object per
+ * deopt point at which the object is still referenced; the fields and the
+ * registers it must be put into are slices of the arrays in the table. */
+struct MVMSpeshMaterialization {
+    /* The deopt index this applies at. */
+    MVMint32 deopt_idx;
+
+    /* The spesh slot holding the STable to allocate from, or the type to
+     * box with if this is a box. */
+    MVMuint16 type_slot;
+
+    /* Whether this is a box (which has a single field, the boxed value). */
+    MVMuint16 is_box;
+
+    /* The fields that had been bound by the deopt point. */
+    MVMuint32 first_field;
+    MVMuint32 num_fields;
+
+    /* The registers the object should be put into. */
+    MVMuint32 first_target;
+    MVMuint32 num_targets;
+};
+
+/* A field of an object to materialize. */
+struct MVMSpeshMaterializedField {
+    /* Offset of the attribute in the P6opaque body (unused for boxes). */
+    MVMuint16 offset;
+
+    /* The kind of the register holding the value, and the register. */
+    MVMuint16 kind;
+    MVMuint16 reg;
+};
+
+/* The materialization table of a graph or candidate. In a graph, this is
+ * allocated from the spesh region, and the arrays grow as needed; in a
+ * candidate, it is malloc'd and sized exactly. */
+struct MVMSpeshMaterializations {
+    MVMSpeshMaterialization  *objects;
+    MVMuint32                 num_objects;
+    MVMuint32                 alloc_objects;
+
+    MVMSpeshMaterializedField *fields;
+    MVMuint32                  num_fields;
+    MVMuint32                  alloc_fields;
+
+    MVMuint16 *targets;
+    MVMuint32  num_targets;
+    MVMuint32  alloc_targets;
+};
+
+void MVM_spesh_escape_analysis(MVMThreadContext *tc, MVMSpeshGraph *g);
+MVMSpeshMaterializations * MVM_spesh_escape_materializations_for_cand(MVMThreadContext *tc,
+    MVMSpeshGraph *g);
+void MVM_spesh_escape_materializations_from_cand(MVMThreadContext *tc, MVMSpeshGraph *g,
+    MVMSpeshCandidate *cand);
+void MVM_spesh_escape_merge_materializations(MVMThreadContext *tc, MVMSpeshGraph *inliner,
+    MVMSpeshGraph *inlinee);
+void MVM_spesh_escape_destroy_materializations(MVMThreadContext *tc,
+    MVMSpeshMaterializations *m);
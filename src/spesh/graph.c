@@ -823,6 +823,48 @@ static MVMint32 * compute_dominators(MVMThreadContext *tc, MVMSpeshGraph *g, MVM
     return doms;
 }
 
+/* Computes the immediate dominators of the basic blocks afresh, for passes
+ * that need dominance information once the graph has been changed, which the
+ * dominator tree children lists don't keep up with. The blocks are first
+ * renumbered along the linear_next chain, and must all be reachable. Hands
+ * back the blocks in reverse postorder; doms[i] is the index in that array
+ * of the immediate dominator of rpo[i]. Both must be freed by the caller. */
+MVMSpeshBB ** MVM_spesh_graph_dominators(MVMThreadContext *tc, MVMSpeshGraph *g, MVMint32 **doms) {
+    MVMSpeshBB **rpo;
+    MVMSpeshBB  *bb  = g->entry;
+    MVMint32     idx = 0;
+    while (bb) {
+        bb->idx = idx++;
+        bb = bb->linear_next;
+    }
+    g->num_bbs = idx;
+    rpo   = reverse_postorder(tc, g);
+    *doms = compute_dominators(tc, g, rpo);
+    return rpo;
+}
+
+/* Checks that the register version is the only one of its register that is
+ * ever written or read. Since there is no register allocation after spesh,
+ * only then does the register hold its value everywhere that it dominates,
+ * which passes moving a write or reusing a result rely on. */
+MVMint32 MVM_spesh_graph_is_only_version(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshOperand o) {
+    MVMuint16 orig = o.reg.orig;
+    MVMuint16 i;
+    for (i = 0; i < g->num_temps; i++)
+        if (g->temps[i].orig == orig)
+            return 0;
+    for (i = 0; i < g->fact_counts[orig]; i++) {
+        MVMSpeshFacts *facts = &(g->facts[orig][i]);
+        if (i == o.reg.i)
+            continue;
+        if (facts->usages)
+            return 0;
+        if (facts->writer ? !facts->dead_writer : i > 0)
+            return 0;
+    }
+    return 1;
+}
+
 /* Builds the dominance tree children lists for each node. */
 static void add_child(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *target, MVMSpeshBB *to_add) {
     MVMSpeshBB **new_children;
@@ -1254,6 +1296,7 @@ MVMSpeshGraph * MVM_spesh_graph_create_from_cand(MVMThreadContext *tc, MVMStatic
         add_predecessors(tc, g);
         ssa(tc, g);
     }
+    MVM_spesh_escape_materializations_from_cand(tc, g, cand);
 
     /* Hand back the completed graph. */
     return g;
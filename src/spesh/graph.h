@@ -64,6 +64,14 @@ struct MVMSpeshGraph {
      * don't typically don't update the array in specialized code. */
     MVMuint64 deopt_named_used_bit_field;
 
+    /* How to materialize objects whose allocations were replaced by escape
+     * analysis, should we deopt while they're live; NULL if none. */
+    MVMSpeshMaterializations *materializations;
+
+    /* Loops found by loop-invariant code motion, for spesh dumps. */
+    MVMSpeshLoop *loops;
+    MVMuint32     num_loops;
+
     /* Table of information about inlines, laid out in order of nesting
      * depth. Thus, going through the table in order and finding when we
      * are within the bounds will show up each call frame that needs to
@@ -252,6 +260,8 @@ MVMSpeshGraph * MVM_spesh_graph_create(MVMThreadContext *tc, MVMStaticFrame *sf,
 MVMSpeshGraph * MVM_spesh_graph_create_from_cand(MVMThreadContext *tc, MVMStaticFrame *sf,
     MVMSpeshCandidate *cand, MVMuint32 cfg_only);
 MVMSpeshBB * MVM_spesh_graph_linear_prev(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *search);
+MVMSpeshBB ** MVM_spesh_graph_dominators(MVMThreadContext *tc, MVMSpeshGraph *g, MVMint32 **doms);
+MVMint32 MVM_spesh_graph_is_only_version(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshOperand o);
 void MVM_spesh_graph_add_deopt_annotation(MVMThreadContext *tc, MVMSpeshGraph *g,
     MVMSpeshIns *ins_node, MVMuint32 deopt_target, MVMint32 type);
 void MVM_spesh_graph_mark(MVMThreadContext *tc, MVMSpeshGraph *g, MVMGCWorklist *worklist);
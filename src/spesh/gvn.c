@@ -0,0 +1,391 @@
+#include "moar.h"
+
+/* Global value numbering. Each SSA register version has a value number,
+ * which is the register itself unless it was copied from another, in which
+ * case it's the value number of that. As optimize_bb walks the dominator
+ * tree, computations are entered into a table keyed on their op and the value
+ * numbers of their inputs. When a computation is already in the table, we
+ * turn it into a set from the earlier result; when a guard is, we delete it.
+ *
+ * Reads of object attributes, lexicals and containers are only available
+ * until something that may write to memory, and (since there may be writes on
+ * other paths to it) don't carry over into a block unless it can only be
+ * reached from the block that dominates it. Temporary registers are not in
+ * SSA form, so we leave alone anything that touches them. As there is no
+ * register allocation after spesh, an earlier result is only reused if no
+ * other version of its register is written, as for LICM. */
+
+/* What kind of thing an instruction is as far as we are concerned. */
+#define GVN_NONE    0
+#define GVN_PURE    1
+#define GVN_MEMORY  2
+#define GVN_GUARD   3
+
+static MVMint32 gvn_kind(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshIns *ins) {
+    switch (ins->info->opcode) {
+        case MVM_OP_add_i:
+        case MVM_OP_sub_i:
+        case MVM_OP_mul_i:
+        case MVM_OP_div_i:
+        case MVM_OP_mod_i:
+        case MVM_OP_neg_i:
+        case MVM_OP_abs_i:
+        case MVM_OP_band_i:
+        case MVM_OP_bor_i:
+        case MVM_OP_bxor_i:
+        case MVM_OP_bnot_i:
+        case MVM_OP_blshift_i:
+        case MVM_OP_brshift_i:
+        case MVM_OP_eq_i:
+        case MVM_OP_ne_i:
+        case MVM_OP_lt_i:
+        case MVM_OP_le_i:
+        case MVM_OP_gt_i:
+        case MVM_OP_ge_i:
+        case MVM_OP_cmp_i:
+        case MVM_OP_not_i:
+        case MVM_OP_add_n:
+        case MVM_OP_sub_n:
+        case MVM_OP_mul_n:
+        case MVM_OP_div_n:
+        case MVM_OP_neg_n:
+        case MVM_OP_abs_n:
+        case MVM_OP_eq_n:
+        case MVM_OP_ne_n:
+        case MVM_OP_lt_n:
+        case MVM_OP_le_n:
+        case MVM_OP_gt_n:
+        case MVM_OP_ge_n:
+        case MVM_OP_cmp_n:
+        case MVM_OP_coerce_in:
+        case MVM_OP_coerce_ni:
+        case MVM_OP_eq_s:
+        case MVM_OP_ne_s:
+        case MVM_OP_chars:
+        case MVM_OP_isnull:
+        case MVM_OP_isnull_s:
+        case MVM_OP_isconcrete:
+        case MVM_OP_eqaddr:
+        case MVM_OP_getwhat:
+        case MVM_OP_gethow:
+        case MVM_OP_objprimspec:
+            return GVN_PURE;
+        case MVM_OP_sp_p6oget_o:
+        case MVM_OP_sp_p6oget_i:
+        case MVM_OP_sp_p6oget_n:
+        case MVM_OP_sp_p6oget_s:
+        case MVM_OP_sp_get_o:
+        case MVM_OP_sp_get_i64:
+        case MVM_OP_sp_get_i32:
+        case MVM_OP_sp_get_i16:
+        case MVM_OP_sp_get_i8:
+        case MVM_OP_sp_get_n:
+        case MVM_OP_sp_get_s:
+        case MVM_OP_sp_getlex_o:
+        case MVM_OP_sp_getlex_ins:
+        case MVM_OP_istype:
+            return GVN_MEMORY;
+        case MVM_OP_sp_decont: {
+            /* Only if we know fetching from the container won't run code. */
+            MVMSpeshFacts *facts = MVM_spesh_get_facts(tc, g, ins->operands[1]);
+            if (facts->flags & MVM_SPESH_FACT_KNOWN_TYPE && facts->type) {
+                MVMContainerSpec const *contspec = STABLE(facts->type)->container_spec;
+                if (contspec && contspec->fetch_never_invokes)
+                    return GVN_MEMORY;
+            }
+            return GVN_NONE;
+        }
+        case MVM_OP_sp_guard:
+        case MVM_OP_sp_guardconc:
+        case MVM_OP_sp_guardtype:
+        case MVM_OP_sp_guardsf:
+        case MVM_OP_sp_guardsfouter:
+            return GVN_GUARD;
+        default:
+            return GVN_NONE;
+    }
+}
+
+/* Checks if an instruction may write to memory (or run code that could). */
+static MVMint32 may_write_memory(MVMSpeshIns *ins, MVMint32 kind) {
+    MVMuint32 i;
+    if (kind == GVN_GUARD || ins->info->opcode == MVM_SSA_PHI)
+        return 0;
+    if (ins->info->jittivity & MVM_JIT_INFO_INVOKISH)
+        return 1;
+    if (kind != GVN_NONE || ins->info->pure)
+        return 0;
+    for (i = 0; i < ins->info->num_operands; i++)
+        if ((ins->info->operands[i] & MVM_operand_type_mask) == MVM_operand_ins)
+            return 0;
+    return 1;
+}
+
+static MVMint32 is_temp(MVMSpeshGraph *g, MVMSpeshOperand o) {
+    MVMuint16 i;
+    for (i = 0; i < g->num_temps; i++)
+        if (g->temps[i].orig == o.reg.orig)
+            return 1;
+    return 0;
+}
+
+/* Keys for register versions, which are never 0. */
+static MVMuint64 reg_key(MVMSpeshOperand o) {
+    return ((MVMuint64)(o.reg.orig + 1) << 32) | (MVMuint32)o.reg.i;
+}
+
+static MVMuint32 hash_key(MVMuint64 key) {
+    key ^= key >> 29;
+    key *= 0x9E3779B97F4A7C15ULL;
+    return (MVMuint32)(key >> 32);
+}
+
+/* Gets the value number of a register version. */
+static MVMuint64 value_number(MVMSpeshGVN *gvn, MVMSpeshOperand o) {
+    MVMuint64 key = reg_key(o);
+    if (gvn->num_copies) {
+        MVMuint32 mask = gvn->alloc_copies - 1;
+        MVMuint32 slot = hash_key(key) & mask;
+        while (gvn->copies[slot].reg) {
+            if (gvn->copies[slot].reg == key)
+                return gvn->copies[slot].value;
+            slot = (slot + 1) & mask;
+        }
+    }
+    return key;
+}
+
+/* Records that a register version holds a given value number. */
+static void add_copy(MVMSpeshGVN *gvn, MVMuint64 key, MVMuint64 value) {
+    MVMuint32 mask, slot;
+    if (key == value)
+        return;
+    if (2 * (gvn->num_copies + 1) > gvn->alloc_copies) {
+        MVMSpeshGVNCopy *old       = gvn->copies;
+        MVMuint32        old_alloc = gvn->alloc_copies;
+        MVMuint32        i;
+        gvn->alloc_copies = old_alloc ? old_alloc * 2 : 64;
+        gvn->copies       = MVM_calloc(gvn->alloc_copies, sizeof(MVMSpeshGVNCopy));
+        gvn->num_copies   = 0;
+        for (i = 0; i < old_alloc; i++)
+            if (old[i].reg)
+                add_copy(gvn, old[i].reg, old[i].value);
+        MVM_free(old);
+    }
+    mask = gvn->alloc_copies - 1;
+    slot = hash_key(key) & mask;
+    while (gvn->copies[slot].reg && gvn->copies[slot].reg != key)
+        slot = (slot + 1) & mask;
+    if (!gvn->copies[slot].reg)
+        gvn->num_copies++;
+    gvn->copies[slot].reg   = key;
+    gvn->copies[slot].value = value;
+}
+
+/* Works out the key of a computation or guard. Returns zero if it's not one
+ * we can handle. */
+static MVMint32 make_key(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshGVN *gvn,
+                         MVMSpeshIns *ins, MVMint32 kind, MVMSpeshGVNEntry *key) {
+    MVMint32 i, first = kind == GVN_GUARD ? 0 : 1;
+    if (ins->info->num_operands - first > 3)
+        return 0;
+    memset(key, 0, sizeof(MVMSpeshGVNEntry));
+    key->opcode = ins->info->opcode;
+    for (i = 0; i < ins->info->num_operands; i++) {
+        MVMuint8        flags = ins->info->operands[i];
+        MVMSpeshOperand o     = ins->operands[i];
+        MVMuint64      *input = i >= first ? &(key->inputs[i - first]) : NULL;
+        switch (flags & MVM_operand_rw_mask) {
+            case MVM_operand_read_reg:
+                if (is_temp(g, o))
+                    return 0;
+                *input = value_number(gvn, o);
+                break;
+            case MVM_operand_write_reg:
+                if (i != 0 || is_temp(g, o))
+                    return 0;
+                break;
+            case MVM_operand_read_lex:
+                *input = ((MVMuint64)o.lex.outers << 16) | o.lex.idx;
+                break;
+            case MVM_operand_literal:
+                switch (flags & MVM_operand_type_mask) {
+                    case MVM_operand_int16:
+                    case MVM_operand_spesh_slot:
+                        *input = (MVMuint16)o.lit_i16;
+                        break;
+                    case MVM_operand_str:
+                        *input = o.lit_str_idx;
+                        break;
+                    case MVM_operand_uint32:
+                        /* Deopt target of a guard; doesn't matter which. */
+                        break;
+                    default:
+                        return 0;
+                }
+                break;
+            default:
+                return 0;
+        }
+    }
+    return 1;
+}
+
+static MVMuint32 hash_entry(MVMSpeshGVNEntry *e) {
+    MVMuint64 h = e->opcode;
+    h = h * 31 + e->inputs[0];
+    h = h * 31 + e->inputs[1];
+    h = h * 31 + e->inputs[2];
+    return hash_key(h) % MVM_SPESH_GVN_BUCKETS;
+}
+
+/* Looks for an available computation with the given key, allowing for a
+ * different opcode (to find guards that are stronger than the one we have). */
+static MVMSpeshGVNEntry * find_entry(MVMSpeshGVN *gvn, MVMSpeshGVNEntry *key, MVMuint16 opcode,
+                                     MVMint32 kind) {
+    MVMuint16 orig_opcode = key->opcode;
+    MVMuint32 idx;
+    key->opcode = opcode;
+    idx = gvn->buckets[hash_entry(key)];
+    key->opcode = orig_opcode;
+    while (idx) {
+        MVMSpeshGVNEntry *e = &(gvn->entries[idx - 1]);
+        if (e->opcode == opcode && e->inputs[0] == key->inputs[0] &&
+                e->inputs[1] == key->inputs[1] && e->inputs[2] == key->inputs[2] &&
+                (kind != GVN_MEMORY || e->epoch == gvn->epoch))
+            return e;
+        idx = e->next;
+    }
+    return NULL;
+}
+
+static void add_entry(MVMSpeshGVN *gvn, MVMSpeshGVNEntry *key, MVMSpeshIns *ins) {
+    MVMuint32         bucket = hash_entry(key);
+    MVMSpeshGVNEntry *e;
+    if (gvn->num_entries == gvn->alloc_entries) {
+        gvn->alloc_entries = gvn->alloc_entries ? gvn->alloc_entries * 2 : 64;
+        gvn->entries = MVM_realloc(gvn->entries, gvn->alloc_entries * sizeof(MVMSpeshGVNEntry));
+    }
+    e        = &(gvn->entries[gvn->num_entries++]);
+    *e       = *key;
+    e->epoch = gvn->epoch;
+    e->ins   = ins;
+    e->next  = gvn->buckets[bucket];
+    gvn->buckets[bucket] = gvn->num_entries;
+}
+
+/* Checks if a guard is in the log guards table; if so, it's left to
+ * eliminate_unused_log_guards, which holds on to it. */
+static MVMint32 is_log_guard(MVMSpeshGraph *g, MVMSpeshIns *ins) {
+    MVMint32 i;
+    for (i = 0; i < g->num_log_guards; i++)
+        if (g->log_guards[i].ins == ins)
+            return 1;
+    return 0;
+}
+
+/* Handles a guard, deleting it if an earlier guard checked the same. */
+static void gvn_guard(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshGVN *gvn,
+                      MVMSpeshBB *bb, MVMSpeshIns *ins, MVMSpeshGVNEntry *key) {
+    MVMSpeshGVNEntry *found = find_entry(gvn, key, key->opcode, GVN_GUARD);
+    if (!found && key->opcode == MVM_OP_sp_guard) {
+        found = find_entry(gvn, key, MVM_OP_sp_guardconc, GVN_GUARD);
+        if (!found)
+            found = find_entry(gvn, key, MVM_OP_sp_guardtype, GVN_GUARD);
+    }
+    if (found && !is_log_guard(g, ins)) {
+        /* We now rely on the earlier guard, so if it is a log guard it must
+         * not be thrown out. */
+        MVM_spesh_get_and_use_facts(tc, g, found->ins->operands[0]);
+        MVM_spesh_manipulate_delete_ins(tc, g, bb, ins);
+    }
+    else if (!found) {
+        add_entry(gvn, key, ins);
+    }
+}
+
+/* Initializes value numbering state. */
+void MVM_spesh_gvn_init(MVMThreadContext *tc, MVMSpeshGVN *gvn) {
+    memset(gvn, 0, sizeof(MVMSpeshGVN));
+    gvn->buckets = MVM_calloc(MVM_SPESH_GVN_BUCKETS, sizeof(MVMuint32));
+}
+
+/* Gets a marker for the current scope, to leave it again later. */
+MVMuint32 MVM_spesh_gvn_scope(MVMThreadContext *tc, MVMSpeshGVN *gvn) {
+    return gvn->num_entries;
+}
+
+/* Called before visiting a child of a block in the dominator tree, to decide
+ * if memory reads available at the end of the parent are available in it. */
+void MVM_spesh_gvn_enter_bb(MVMThreadContext *tc, MVMSpeshGVN *gvn, MVMSpeshBB *parent,
+                            MVMSpeshBB *bb, MVMuint32 parent_epoch) {
+    gvn->epoch = bb->num_pred == 1 && bb->pred[0] == parent
+        ? parent_epoch
+        : ++gvn->next_epoch;
+}
+
+/* Value numbers an instruction, after optimize_bb has done what else it will
+ * with it. Returns non-zero if it was turned into a set from an earlier
+ * result, in which case the caller may want to copy facts over. */
+MVMint32 MVM_spesh_gvn_ins(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshGVN *gvn,
+                           MVMSpeshBB *bb, MVMSpeshIns *ins) {
+    MVMSpeshGVNEntry  key;
+    MVMSpeshGVNEntry *found;
+    MVMint32          kind = gvn_kind(tc, g, ins);
+    MVMuint32         i;
+
+    if (ins->info->opcode == MVM_OP_set) {
+        if (!is_temp(g, ins->operands[0]) && !is_temp(g, ins->operands[1]))
+            add_copy(gvn, reg_key(ins->operands[0]), value_number(gvn, ins->operands[1]));
+        return 0;
+    }
+
+    if (kind == GVN_NONE || !make_key(tc, g, gvn, ins, kind, &key)) {
+        if (may_write_memory(ins, kind))
+            gvn->epoch = ++gvn->next_epoch;
+        return 0;
+    }
+
+    if (kind == GVN_GUARD) {
+        gvn_guard(tc, g, gvn, bb, ins, &key);
+        return 0;
+    }
+
+    /* Turn it into a set from the earlier result, provided that the earlier
+     * result's register still holds it here; otherwise this one becomes the
+     * available computation. */
+    found = find_entry(gvn, &key, key.opcode, kind);
+    if (found && MVM_spesh_graph_is_only_version(tc, g, found->ins->operands[0])) {
+        MVMSpeshOperand earlier = found->ins->operands[0];
+        for (i = 1; i < ins->info->num_operands; i++)
+            if ((ins->info->operands[i] & MVM_operand_rw_mask) == MVM_operand_read_reg)
+                MVM_spesh_get_facts(tc, g, ins->operands[i])->usages--;
+        ins->info        = MVM_op_get_op(MVM_OP_set);
+        ins->operands[1] = earlier;
+        MVM_spesh_get_facts(tc, g, earlier)->usages++;
+        add_copy(gvn, reg_key(ins->operands[0]), value_number(gvn, earlier));
+        return 1;
+    }
+
+    /* A type check may run code, but we still take it as giving the same
+     * answer the next time. */
+    if (may_write_memory(ins, kind))
+        gvn->epoch = ++gvn->next_epoch;
+    add_entry(gvn, &key, ins);
+    return 0;
+}
+
+/* Leaves a scope, making what was computed in it unavailable. */
+void MVM_spesh_gvn_leave_scope(MVMThreadContext *tc, MVMSpeshGVN *gvn, MVMuint32 scope) {
+    while (gvn->num_entries > scope) {
+        MVMSpeshGVNEntry *e = &(gvn->entries[--gvn->num_entries]);
+        gvn->buckets[hash_entry(e)] = e->next;
+    }
+}
+
+/* Frees value numbering state. */
+void MVM_spesh_gvn_destroy(MVMThreadContext *tc, MVMSpeshGVN *gvn) {
+    MVM_free(gvn->entries);
+    MVM_free(gvn->buckets);
+    MVM_free(gvn->copies);
+}
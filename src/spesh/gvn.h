@@ -0,0 +1,61 @@
+/* State for global value numbering, which is done during the walk of the
+ * dominator tree in optimize_bb. Computations and guards are entered into a
+ * table as they are seen, and removed again once we leave the part of the
+ * tree that they dominate. */
+struct MVMSpeshGVN {
+    /* The available computations, in the order they were seen, and the
+     * hash buckets chaining them (holding index + 1, so 0 is the end). A
+     * bucket always chains the most recently seen entry first, so leaving a
+     * scope can simply unwind them. */
+    MVMSpeshGVNEntry *entries;
+    MVMuint32         num_entries;
+    MVMuint32         alloc_entries;
+    MVMuint32        *buckets;
+
+    /* Register versions known to hold the same value as another, because
+     * they were copied from it; an open addressing hash keyed on the
+     * register, with alloc_copies a power of two. */
+    MVMSpeshGVNCopy  *copies;
+    MVMuint32         num_copies;
+    MVMuint32         alloc_copies;
+
+    /* Memory reads are only available until something that may write to
+     * memory happens; each such thing starts a new epoch. */
+    MVMuint32 epoch;
+    MVMuint32 next_epoch;
+};
+
+/* Number of hash buckets for available computations. */
+#define MVM_SPESH_GVN_BUCKETS 256
+
+/* An available computation. */
+struct MVMSpeshGVNEntry {
+    /* The op and its inputs, by value number or literal value. */
+    MVMuint16 opcode;
+    MVMuint64 inputs[3];
+
+    /* The epoch, for memory reads. */
+    MVMuint32 epoch;
+
+    /* The instruction, which holds the result register. */
+    MVMSpeshIns *ins;
+
+    /* Index + 1 of the next entry in the hash bucket. */
+    MVMuint32 next;
+};
+
+/* A register version that was copied from another. Both are in the form
+ * given by register keys in gvn.c, and 0 marks an empty slot. */
+struct MVMSpeshGVNCopy {
+    MVMuint64 reg;
+    MVMuint64 value;
+};
+
+void MVM_spesh_gvn_init(MVMThreadContext *tc, MVMSpeshGVN *gvn);
+MVMuint32 MVM_spesh_gvn_scope(MVMThreadContext *tc, MVMSpeshGVN *gvn);
+void MVM_spesh_gvn_enter_bb(MVMThreadContext *tc, MVMSpeshGVN *gvn, MVMSpeshBB *parent,
+    MVMSpeshBB *bb, MVMuint32 parent_epoch);
+MVMint32 MVM_spesh_gvn_ins(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshGVN *gvn,
+    MVMSpeshBB *bb, MVMSpeshIns *ins);
+void MVM_spesh_gvn_leave_scope(MVMThreadContext *tc, MVMSpeshGVN *gvn, MVMuint32 scope);
+void MVM_spesh_gvn_destroy(MVMThreadContext *tc, MVMSpeshGVN *gvn);
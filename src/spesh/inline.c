@@ -378,6 +378,9 @@ static void merge_graph(MVMThreadContext *tc, MVMSpeshGraph *inliner,
         inlinee->num_locals * sizeof(MVMuint16));
     inliner->fact_counts = merged_fact_counts;
 
+    /* Merge tables of objects to materialize on deopt. */
+    MVM_spesh_escape_merge_materializations(tc, inliner, inlinee);
+
     /* Copy over spesh slots. */
     for (i = 0; i < inlinee->num_spesh_slots; i++)
         MVM_spesh_add_spesh_slot(tc, inliner, inlinee->spesh_slots[i]);
@@ -0,0 +1,516 @@
+#include "moar.h"
+
+/* Loop detection and loop-invariant code motion. We find natural loops by
+ * looking for edges to a block that dominates their source, then move
+ * instructions whose operands don't change within the loop out to the end
+ * of the block that leads into it (the preheader), so they run once rather
+ * than on every iteration.
+ *
+ * Since there is no register allocation after spesh, moving a write earlier
+ * means the register holds the value over the whole loop; we thus only move
+ * instructions writing a register that nothing else writes or reads another
+ * version of. We move only instructions that can't throw, and only from
+ * blocks run on every iteration. Guards are moved too, but are then made to
+ * deopt to the top of the loop, so the interpreter starts the loop afresh.
+ * Reads of attributes and lexicals are only moved if nothing in the loop
+ * may write to memory.
+ *
+ * Loops are often entered by OSR at their header. In that case, the OSR entry
+ * point is moved to the start of the hoisted code, so it is run then too. An
+ * OSR entry point anywhere else in a loop would skip the hoisted code, so we
+ * leave such loops alone (which means hoisting only from innermost loops in
+ * frames that may OSR). */
+
+/* What we may do with an instruction. */
+#define HOIST_NO        0
+#define HOIST_PURE      1
+#define HOIST_MEMORY    2
+#define HOIST_GUARD     3
+
+/* A loop being worked on. Blocks are identified by reverse postorder index,
+ * which is how the body set is indexed. */
+typedef struct {
+    MVMint32   header;
+    MVMint32  *latches;
+    MVMuint32  num_latches;
+    MVMuint8  *body;
+    MVMuint32  num_bbs;
+} Loop;
+
+/* State for the pass over a graph. */
+typedef struct {
+    MVMSpeshBB **rpo;
+    MVMint32    *doms;
+    MVMint32     num_bbs;
+
+    /* Flags for each version of each register as to whether it is written
+     * inside the loop being worked on. */
+    MVMuint32   *def_base;
+    MVMuint8    *defined_in_loop;
+    MVMuint32    num_defs;
+} LICMState;
+
+static MVMint32 hoist_kind(MVMuint16 opcode) {
+    switch (opcode) {
+        case MVM_OP_const_i64:
+        case MVM_OP_const_i64_16:
+        case MVM_OP_const_i64_32:
+        case MVM_OP_const_n64:
+        case MVM_OP_const_s:
+        case MVM_OP_null:
+        case MVM_OP_null_s:
+        case MVM_OP_sp_getspeshslot:
+        case MVM_OP_set:
+        case MVM_OP_add_i:
+        case MVM_OP_sub_i:
+        case MVM_OP_mul_i:
+        case MVM_OP_neg_i:
+        case MVM_OP_band_i:
+        case MVM_OP_bor_i:
+        case MVM_OP_bxor_i:
+        case MVM_OP_bnot_i:
+        case MVM_OP_add_n:
+        case MVM_OP_sub_n:
+        case MVM_OP_mul_n:
+        case MVM_OP_div_n:
+        case MVM_OP_neg_n:
+        case MVM_OP_eq_i:
+        case MVM_OP_ne_i:
+        case MVM_OP_lt_i:
+        case MVM_OP_le_i:
+        case MVM_OP_gt_i:
+        case MVM_OP_ge_i:
+        case MVM_OP_eq_n:
+        case MVM_OP_ne_n:
+        case MVM_OP_lt_n:
+        case MVM_OP_le_n:
+        case MVM_OP_gt_n:
+        case MVM_OP_ge_n:
+        case MVM_OP_not_i:
+        case MVM_OP_coerce_in:
+        case MVM_OP_coerce_ni:
+        case MVM_OP_isnull:
+        case MVM_OP_isconcrete:
+        case MVM_OP_eqaddr:
+        case MVM_OP_hllboxtype_i:
+        case MVM_OP_hllboxtype_n:
+        case MVM_OP_hllboxtype_s:
+            return HOIST_PURE;
+        case MVM_OP_sp_p6oget_o:
+        case MVM_OP_sp_p6oget_i:
+        case MVM_OP_sp_p6oget_n:
+        case MVM_OP_sp_p6oget_s:
+        case MVM_OP_sp_get_o:
+        case MVM_OP_sp_get_i64:
+        case MVM_OP_sp_get_n:
+        case MVM_OP_sp_get_s:
+        case MVM_OP_sp_getlex_o:
+        case MVM_OP_sp_getlex_ins:
+            return HOIST_MEMORY;
+        case MVM_OP_sp_guard:
+        case MVM_OP_sp_guardconc:
+        case MVM_OP_sp_guardtype:
+            return HOIST_GUARD;
+        default:
+            return HOIST_NO;
+    }
+}
+
+/* Checks if the instruction might write to memory (or run code that does). */
+static MVMint32 has_side_effects(MVMSpeshIns *ins) {
+    MVMuint32 i;
+    if (ins->info->opcode == MVM_SSA_PHI || hoist_kind(ins->info->opcode) == HOIST_GUARD)
+        return 0;
+    if (ins->info->jittivity & MVM_JIT_INFO_INVOKISH)
+        return 1;
+    if (ins->info->pure)
+        return 0;
+    for (i = 0; i < ins->info->num_operands; i++)
+        if ((ins->info->operands[i] & MVM_operand_type_mask) == MVM_operand_ins)
+            return 0;
+    return 1;
+}
+
+static MVMSpeshAnn * find_ann(MVMSpeshIns *ins, MVMint32 type) {
+    MVMSpeshAnn *ann = ins ? ins->annotations : NULL;
+    while (ann) {
+        if (ann->type == type)
+            return ann;
+        ann = ann->next;
+    }
+    return NULL;
+}
+
+static void remove_ann(MVMSpeshIns *ins, MVMSpeshAnn *to_remove) {
+    MVMSpeshAnn **ann = &(ins->annotations);
+    while (*ann) {
+        if (*ann == to_remove) {
+            *ann = to_remove->next;
+            to_remove->next = NULL;
+            return;
+        }
+        ann = &((*ann)->next);
+    }
+}
+
+/* Checks if block a dominates block b (both by reverse postorder index). */
+static MVMint32 dominates(LICMState *st, MVMint32 a, MVMint32 b) {
+    while (b != a) {
+        if (b == 0)
+            return 0;
+        b = st->doms[b];
+    }
+    return 1;
+}
+
+/* Finds the natural loops of the graph. Each edge to a block that dominates
+ * its source is a back edge; the loop is all blocks from which the source
+ * can be reached without passing through the header. */
+static Loop * find_loops(MVMThreadContext *tc, LICMState *st, MVMuint32 *num_loops) {
+    Loop      *loops = NULL;
+    MVMint32  *stack;
+    MVMuint32  alloc_loops = 0;
+    MVMint32   i, j;
+    MVMuint32  k;
+
+    *num_loops = 0;
+    for (i = 0; i < st->num_bbs; i++) {
+        MVMSpeshBB *bb = st->rpo[i];
+        for (j = 0; j < bb->num_succ; j++) {
+            MVMint32 header = bb->succ[j]->rpo_idx;
+            Loop    *loop   = NULL;
+            if (!dominates(st, header, i))
+                continue;
+            for (k = 0; k < *num_loops; k++)
+                if (loops[k].header == header)
+                    loop = &(loops[k]);
+            if (!loop) {
+                if (*num_loops == alloc_loops) {
+                    alloc_loops = alloc_loops ? alloc_loops * 2 : 4;
+                    loops = MVM_realloc(loops, alloc_loops * sizeof(Loop));
+                }
+                loop = &(loops[(*num_loops)++]);
+                loop->header      = header;
+                loop->latches     = NULL;
+                loop->num_latches = 0;
+                loop->body        = MVM_calloc(st->num_bbs, 1);
+                loop->num_bbs     = 0;
+            }
+            loop->latches = MVM_realloc(loop->latches, (loop->num_latches + 1) * sizeof(MVMint32));
+            loop->latches[loop->num_latches++] = i;
+        }
+    }
+
+    /* Work out the blocks in each loop. Blocks are added to the body as they
+     * are pushed, so each is pushed at most once. */
+    stack = MVM_malloc(st->num_bbs * sizeof(MVMint32));
+    for (k = 0; k < *num_loops; k++) {
+        Loop     *loop = &(loops[k]);
+        MVMint32  top  = 0;
+        MVMuint32 l;
+        loop->body[loop->header] = 1;
+        loop->num_bbs = 1;
+        for (l = 0; l < loop->num_latches; l++) {
+            MVMint32 latch = loop->latches[l];
+            if (!loop->body[latch]) {
+                loop->body[latch] = 1;
+                loop->num_bbs++;
+                stack[top++] = latch;
+            }
+        }
+        while (top) {
+            MVMSpeshBB *bb = st->rpo[stack[--top]];
+            for (j = 0; j < bb->num_pred; j++) {
+                MVMint32 pred = bb->pred[j]->rpo_idx;
+                if (!loop->body[pred]) {
+                    loop->body[pred] = 1;
+                    loop->num_bbs++;
+                    stack[top++] = pred;
+                }
+            }
+        }
+    }
+    MVM_free(stack);
+
+    /* Sort loops smallest first, so inner loops are done before the loops
+     * they are nested in, which may then hoist things further. */
+    for (k = 1; k < *num_loops; k++) {
+        Loop     tmp = loops[k];
+        MVMint32 m   = k - 1;
+        while (m >= 0 && loops[m].num_bbs > tmp.num_bbs) {
+            loops[m + 1] = loops[m];
+            m--;
+        }
+        loops[m + 1] = tmp;
+    }
+    return loops;
+}
+
+static MVMint32 is_defined_in_loop(LICMState *st, MVMSpeshOperand o) {
+    return st->defined_in_loop[st->def_base[o.reg.orig] + o.reg.i];
+}
+
+/* Checks if an instruction can be hoisted out of the loop. */
+static MVMint32 can_hoist(MVMThreadContext *tc, MVMSpeshGraph *g, LICMState *st,
+                          MVMSpeshIns *ins, MVMint32 memory_ok, MVMint32 guard_target) {
+    MVMint32     kind   = hoist_kind(ins->info->opcode);
+    MVMuint32    writes = 0;
+    MVMSpeshAnn *ann;
+    MVMuint32    i;
+
+    if (kind == HOIST_NO)
+        return 0;
+    if (kind == HOIST_MEMORY && !memory_ok)
+        return 0;
+    if (kind == HOIST_GUARD && guard_target < 0)
+        return 0;
+
+    /* Line number annotations are moved on to the next instruction, and
+     * logged ones are no longer needed; anything else stays put. */
+    for (ann = ins->annotations; ann; ann = ann->next) {
+        switch (ann->type) {
+            case MVM_SPESH_ANN_DEOPT_ONE_INS:
+                if (kind != HOIST_GUARD)
+                    return 0;
+                break;
+            case MVM_SPESH_ANN_LINENO:
+                if (!ins->next)
+                    return 0;
+                break;
+            case MVM_SPESH_ANN_LOGGED:
+                break;
+            default:
+                return 0;
+        }
+    }
+
+    for (i = 0; i < ins->info->num_operands; i++) {
+        switch (ins->info->operands[i] & MVM_operand_rw_mask) {
+            case MVM_operand_read_reg:
+                if (is_defined_in_loop(st, ins->operands[i]))
+                    return 0;
+                break;
+            case MVM_operand_write_reg:
+                if (writes++ || !MVM_spesh_graph_is_only_version(tc, g, ins->operands[i]))
+                    return 0;
+                break;
+            case MVM_operand_write_lex:
+                return 0;
+        }
+    }
+    return 1;
+}
+
+/* Moves an instruction to the preheader, after the given instruction. */
+static void hoist(MVMThreadContext *tc, MVMSpeshGraph *g, LICMState *st, MVMSpeshBB *bb,
+                  MVMSpeshIns *ins, MVMSpeshBB *preheader, MVMSpeshIns *after,
+                  MVMint32 guard_target) {
+    MVMSpeshAnn *ann = ins->annotations;
+    MVMuint32    i;
+
+    /* Unlink it, moving along line numbers and dropping deopt points. */
+    ins->annotations = NULL;
+    while (ann) {
+        MVMSpeshAnn *next = ann->next;
+        if (ann->type == MVM_SPESH_ANN_LINENO) {
+            ann->next = ins->next->annotations;
+            ins->next->annotations = ann;
+        }
+        ann = next;
+    }
+    if (ins->prev)
+        ins->prev->next = ins->next;
+    else
+        bb->first_ins = ins->next;
+    if (ins->next)
+        ins->next->prev = ins->prev;
+    else
+        bb->last_ins = ins->prev;
+    MVM_spesh_manipulate_insert_ins(tc, preheader, after, ins);
+
+    /* A guard now deopts to the top of the loop. */
+    if (hoist_kind(ins->info->opcode) == HOIST_GUARD) {
+        ins->operands[2].lit_ui32 = guard_target;
+        MVM_spesh_graph_add_deopt_annotation(tc, g, ins, guard_target,
+            MVM_SPESH_ANN_DEOPT_ONE_INS);
+    }
+
+    /* What it writes is now defined outside of the loop. */
+    for (i = 0; i < ins->info->num_operands; i++)
+        if ((ins->info->operands[i] & MVM_operand_rw_mask) == MVM_operand_write_reg)
+            st->defined_in_loop[st->def_base[ins->operands[i].reg.orig] + ins->operands[i].reg.i] = 0;
+}
+
+/* Finds the block to hoist into and the instruction to insert after, if the
+ * loop has a suitable one. */
+static MVMSpeshBB * find_preheader(MVMThreadContext *tc, MVMSpeshGraph *g, LICMState *st,
+                                   Loop *loop, MVMSpeshIns **after, MVMint32 *osr_entry) {
+    MVMSpeshBB  *header    = st->rpo[loop->header];
+    MVMSpeshBB  *preheader = NULL;
+    MVMSpeshIns *last;
+    MVMint32     i;
+
+    /* There should be one way in from outside the loop, plus maybe an OSR
+     * entry from the entry block. */
+    *osr_entry = 0;
+    for (i = 0; i < header->num_pred; i++) {
+        MVMSpeshBB *pred = header->pred[i];
+        if (loop->body[pred->rpo_idx])
+            continue;
+        if (pred == g->entry)
+            *osr_entry = 1;
+        else if (preheader)
+            return NULL;
+        else
+            preheader = pred;
+    }
+    if (!preheader || preheader->num_succ != 1 || preheader->jumplist)
+        return NULL;
+    if (preheader->inlined || header->inlined)
+        return NULL;
+
+    /* Insert before a goto ending it, or at the end if it falls through. */
+    last = preheader->last_ins;
+    if (last && last->info->opcode == MVM_OP_goto) {
+        *after = last->prev;
+        return preheader;
+    }
+    if (preheader->linear_next != header)
+        return NULL;
+    if (last) {
+        for (i = 0; i < last->info->num_operands; i++)
+            if ((last->info->operands[i] & MVM_operand_type_mask) == MVM_operand_ins)
+                return NULL;
+        if (!last->info->pure)
+            return NULL;
+    }
+    *after = last;
+    return preheader;
+}
+
+static void optimize_loop(MVMThreadContext *tc, MVMSpeshGraph *g, LICMState *st, Loop *loop,
+                          MVMSpeshLoop *stats) {
+    MVMSpeshBB  *header = st->rpo[loop->header];
+    MVMSpeshBB  *preheader;
+    MVMSpeshIns *after, *first, *first_hoisted = NULL;
+    MVMSpeshAnn *osr_ann;
+    MVMint32     osr_entry, guard_target, memory_ok, i;
+    MVMuint32    l;
+
+    stats->header         = header;
+    stats->num_bbs        = loop->num_bbs;
+    stats->num_back_edges = loop->num_latches;
+
+    preheader = find_preheader(tc, g, st, loop, &after, &osr_entry);
+    if (!preheader)
+        return;
+
+    /* Find the OSR entry point of the loop, if any; that's also where the
+     * top of the loop is in the original bytecode, for guards to deopt to. */
+    first = header->first_ins;
+    while (first && first->info->opcode == MVM_SSA_PHI)
+        first = first->next;
+    osr_ann = find_ann(first, MVM_SPESH_ANN_DEOPT_OSR);
+    if (osr_entry && !osr_ann)
+        return;
+    guard_target = osr_ann ? g->deopt_addrs[2 * osr_ann->data.deopt_idx] : -1;
+
+    /* Look for other OSR entry points, and for anything with side effects;
+     * also note what is written in the loop. */
+    memset(st->defined_in_loop, 0, st->num_defs);
+    for (i = 0; i < st->num_bbs; i++) {
+        MVMSpeshIns *ins;
+        if (!loop->body[i])
+            continue;
+        for (ins = st->rpo[i]->first_ins; ins; ins = ins->next) {
+            MVMuint32 j;
+            MVMint32  is_phi = ins->info->opcode == MVM_SSA_PHI;
+            if (ins != first && find_ann(ins, MVM_SPESH_ANN_DEOPT_OSR))
+                return;
+            if (has_side_effects(ins))
+                stats->side_effects = 1;
+            for (j = 0; j < ins->info->num_operands; j++)
+                if (is_phi ? j == 0 : (ins->info->operands[j] & MVM_operand_rw_mask) == MVM_operand_write_reg)
+                    st->defined_in_loop[st->def_base[ins->operands[j].reg.orig] + ins->operands[j].reg.i] = 1;
+        }
+    }
+    stats->preheader = preheader;
+
+    /* The OSR entry point will go on the first instruction we hoist. */
+    if (osr_ann)
+        remove_ann(first, osr_ann);
+
+    /* Go through the blocks run on every iteration, in dominance order. */
+    memory_ok = !stats->side_effects;
+    for (i = loop->header; i < st->num_bbs; i++) {
+        MVMSpeshBB  *bb = st->rpo[i];
+        MVMSpeshIns *ins;
+        if (!loop->body[i])
+            continue;
+        for (l = 0; l < loop->num_latches; l++)
+            if (!dominates(st, i, loop->latches[l]))
+                break;
+        if (l < loop->num_latches)
+            continue;
+        ins = bb->first_ins;
+        while (ins) {
+            MVMSpeshIns *next = ins->next;
+            if (can_hoist(tc, g, st, ins, memory_ok, guard_target)) {
+                if (hoist_kind(ins->info->opcode) == HOIST_GUARD)
+                    stats->hoisted_guards++;
+                hoist(tc, g, st, bb, ins, preheader, after, guard_target);
+                if (!first_hoisted)
+                    first_hoisted = ins;
+                after = ins;
+                stats->hoisted++;
+            }
+            else if (hoist_kind(ins->info->opcode) == HOIST_GUARD) {
+                /* Reads after a guard we leave in the loop may rely on it. */
+                memory_ok = 0;
+            }
+            ins = next;
+        }
+    }
+
+    if (osr_ann) {
+        MVMSpeshIns *target = first_hoisted ? first_hoisted : first;
+        osr_ann->next = target->annotations;
+        target->annotations = osr_ann;
+    }
+}
+
+/* Finds the loops in a graph, and hoists invariant code out of them. */
+void MVM_spesh_licm(MVMThreadContext *tc, MVMSpeshGraph *g) {
+    LICMState  st;
+    Loop      *loops;
+    MVMuint32  num_loops, i;
+
+    st.rpo     = MVM_spesh_graph_dominators(tc, g, &(st.doms));
+    st.num_bbs = g->num_bbs;
+    loops      = find_loops(tc, &st, &num_loops);
+    if (num_loops) {
+        st.def_base = MVM_malloc(g->num_locals * sizeof(MVMuint32));
+        st.num_defs = 0;
+        for (i = 0; i < g->num_locals; i++) {
+            st.def_base[i] = st.num_defs;
+            st.num_defs   += g->fact_counts[i];
+        }
+        st.defined_in_loop = MVM_malloc(st.num_defs ? st.num_defs : 1);
+
+        g->loops     = MVM_spesh_alloc(tc, g, num_loops * sizeof(MVMSpeshLoop));
+        g->num_loops = num_loops;
+        memset(g->loops, 0, num_loops * sizeof(MVMSpeshLoop));
+        for (i = 0; i < num_loops; i++)
+            optimize_loop(tc, g, &st, &(loops[i]), &(g->loops[i]));
+
+        MVM_free(st.def_base);
+        MVM_free(st.defined_in_loop);
+    }
+    for (i = 0; i < num_loops; i++) {
+        MVM_free(loops[i].latches);
+        MVM_free(loops[i].body);
+    }
+    MVM_free(loops);
+    MVM_free(st.rpo);
+    MVM_free(st.doms);
+}
@@ -0,0 +1,22 @@
+/* Information about a loop found in a spesh graph, kept for dumps. */
+struct MVMSpeshLoop {
+    /* The loop header, and the block we hoist into (NULL if there's no
+     * suitable one, in which case nothing is hoisted). */
+    MVMSpeshBB *header;
+    MVMSpeshBB *preheader;
+
+    /* The number of blocks in the loop and of edges back to the header. */
+    MVMuint32 num_bbs;
+    MVMuint32 num_back_edges;
+
+    /* Whether anything in the loop may write to memory, and so stop reads
+     * of object attributes and lexicals being hoisted. */
+    MVMuint32 side_effects;
+
+    /* How many instructions were hoisted, and how many of those were
+     * guards. */
+    MVMuint32 hoisted;
+    MVMuint32 hoisted_guards;
+};
+
+void MVM_spesh_licm(MVMThreadContext *tc, MVMSpeshGraph *g);
@@ -1903,9 +1903,11 @@ static void analyze_phi(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshIns *ins
 }
 /* Visits the blocks in dominator tree order, recursively. */
 static void optimize_bb(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb,
-                        MVMSpeshPlanned *p) {
+                        MVMSpeshPlanned *p, MVMSpeshGVN *gvn) {
     MVMSpeshCallInfo arg_info;
     MVMint32 i;
+    MVMuint32 gvn_scope = MVM_spesh_gvn_scope(tc, gvn);
+    MVMuint32 gvn_epoch;
 
     /* Look for instructions that are interesting to optimize. */
     MVMSpeshIns *ins = bb->first_ins;
@@ -2145,13 +2147,21 @@ static void optimize_bb(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshBB *bb,
                 optimize_extop(tc, g, bb, ins);
         }
 
+        /* See if it repeats an earlier computation or guard. If it becomes a
+         * set, the result may know less than the earlier one did. */
+        if (MVM_spesh_gvn_ins(tc, g, gvn, bb, ins) && !get_facts_direct(tc, g, ins->operands[0])->flags)
+            copy_facts(tc, g, ins->operands[0], ins->operands[1]);
 
         ins = ins->next;
     }
 
     /* Visit children. */
-    for (i = 0; i < bb->num_children; i++)
-        optimize_bb(tc, g, bb->children[i], p);
+    gvn_epoch = gvn->epoch;
+    for (i = 0; i < bb->num_children; i++) {
+        MVM_spesh_gvn_enter_bb(tc, gvn, bb, bb->children[i], gvn_epoch);
+        optimize_bb(tc, g, bb->children[i], p, gvn);
+    }
+    MVM_spesh_gvn_leave_scope(tc, gvn, gvn_scope);
 }
 
 /* Eliminates any unused instructions. */
@@ -2283,13 +2293,19 @@ static void eliminate_pointless_gotos(MVMThreadContext *tc, MVMSpeshGraph *g) {
 
 /* Drives the overall optimization work taking place on a spesh graph. */
 void MVM_spesh_optimize(MVMThreadContext *tc, MVMSpeshGraph *g, MVMSpeshPlanned *p) {
+    MVMSpeshGVN gvn;
+
     /* Before starting, we eliminate dead basic blocks that were tossed by
      * arg spesh, to simplify the graph. */
     MVM_spesh_eliminate_dead_bbs(tc, g, 1);
-    optimize_bb(tc, g, g->entry, p);
+    MVM_spesh_gvn_init(tc, &gvn);
+    optimize_bb(tc, g, g->entry, p, &gvn);
+    MVM_spesh_gvn_destroy(tc, &gvn);
     MVM_spesh_eliminate_dead_bbs(tc, g, 1);
     eliminate_unused_log_guards(tc, g);
     eliminate_pointless_gotos(tc, g);
+    MVM_spesh_licm(tc, g);
+    MVM_spesh_escape_analysis(tc, g);
     eliminate_dead_ins(tc, g);
     second_pass(tc, g, g->entry);
 }
@@ -127,6 +127,8 @@ MVMSpeshPlan * MVM_spesh_plan(MVMThreadContext *tc, MVMObject *updated_static_fr
     MVMSpeshPlan *plan = MVM_calloc(1, sizeof(MVMSpeshPlan));
     MVMint64 updated = MVM_repr_elems(tc, updated_static_frames);
     MVMint64 i;
+    if (tc->instance->spesh_plan_cache)
+        MVM_spesh_plan_cache_schedule(tc, plan);
 #if MVM_GC_DEBUG
     tc->in_spesh = 1;
 #endif
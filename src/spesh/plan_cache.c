@@ -0,0 +1,875 @@
+#include "moar.h"
+#include <sha1.h>
+
+/* The first line of a cache file. A cache written by any other version of
+ * MoarVM is ignored, since what it specialized may no longer match. */
+#define CACHE_HEADER "MoarVM specialization plan cache v1 " MVM_VERSION
+
+/* A growable buffer, used to form and to read lines of the cache file. */
+typedef struct {
+    char   *buffer;
+    size_t  alloc;
+    size_t  pos;
+} LineBuffer;
+
+static void ensure_space(LineBuffer *lb, size_t needed) {
+    if (lb->pos + needed >= lb->alloc) {
+        lb->alloc = (lb->pos + needed) * 2;
+        lb->buffer = MVM_realloc(lb->buffer, lb->alloc);
+    }
+}
+static void append(LineBuffer *lb, const char *str) {
+    size_t len = strlen(str);
+    ensure_space(lb, len + 1);
+    memcpy(lb->buffer + lb->pos, str, len + 1);
+    lb->pos += len;
+}
+static void append_uint(LineBuffer *lb, MVMuint64 value) {
+    char tmp[24];
+    snprintf(tmp, sizeof(tmp), "%"PRIu64, value);
+    append(lb, tmp);
+}
+
+/* Appends data as hex, so it can't contain separators. Empty data is written
+ * as a "-" so every field is non-empty. */
+static void append_hex(LineBuffer *lb, const char *data, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    size_t i;
+    if (len == 0) {
+        append(lb, "-");
+        return;
+    }
+    ensure_space(lb, len * 2 + 1);
+    for (i = 0; i < len; i++) {
+        MVMuint8 byte = (MVMuint8)data[i];
+        lb->buffer[lb->pos++] = digits[byte >> 4];
+        lb->buffer[lb->pos++] = digits[byte & 0xF];
+    }
+    lb->buffer[lb->pos] = '\0';
+}
+
+/* Reads a line, without its line ending, into the buffer. Returns zero if
+ * there are no more lines. */
+static MVMint32 read_line(FILE *fh, LineBuffer *lb) {
+    lb->pos = 0;
+    ensure_space(lb, 256);
+    lb->buffer[0] = '\0';
+    while (fgets(lb->buffer + lb->pos, lb->alloc - lb->pos, fh)) {
+        lb->pos += strlen(lb->buffer + lb->pos);
+        if (lb->pos && lb->buffer[lb->pos - 1] == '\n') {
+            lb->buffer[--lb->pos] = '\0';
+            if (lb->pos && lb->buffer[lb->pos - 1] == '\r')
+                lb->buffer[--lb->pos] = '\0';
+            return 1;
+        }
+        ensure_space(lb, 256);
+    }
+    return lb->pos > 0;
+}
+
+/* Splits off the next space-separated token, returning NULL if there are no
+ * more. */
+static char * next_token(char **pos) {
+    char *start = *pos;
+    while (*start == ' ')
+        start++;
+    if (!*start)
+        return NULL;
+    *pos = start;
+    while (**pos && **pos != ' ')
+        (*pos)++;
+    if (**pos)
+        *((*pos)++) = '\0';
+    return start;
+}
+
+/* Decodes a hex token into a freshly allocated NULL-terminated string; "-"
+ * decodes to the empty string. Returns NULL if it is not valid hex. */
+static MVMint32 hex_digit(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+static char * decode_hex(const char *token, size_t *len_out) {
+    size_t  len, i;
+    char   *result;
+    if (strcmp(token, "-") == 0) {
+        if (len_out)
+            *len_out = 0;
+        return MVM_calloc(1, 1);
+    }
+    len = strlen(token);
+    if (len % 2)
+        return NULL;
+    result = MVM_malloc(len / 2 + 1);
+    for (i = 0; i < len / 2; i++) {
+        MVMint32 high = hex_digit(token[i * 2]);
+        MVMint32 low  = hex_digit(token[i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            MVM_free(result);
+            return NULL;
+        }
+        result[i] = (char)((high << 4) | low);
+    }
+    result[len / 2] = '\0';
+    if (len_out)
+        *len_out = len / 2;
+    return result;
+}
+
+/* Parses an unsigned integer token, up to the specified maximum. */
+static MVMint32 parse_uint(const char *token, MVMuint64 max, MVMuint64 *result) {
+    char *end;
+    if (!token || *token < '0' || *token > '9')
+        return 0;
+    *result = strtoull(token, &end, 10);
+    return *end == '\0' && *result <= max;
+}
+
+/* Copies a C string. */
+static char * copy_string(const char *str) {
+    size_t  len    = strlen(str);
+    char   *result = MVM_malloc(len + 1);
+    memcpy(result, str, len + 1);
+    return result;
+}
+
+/* Frees an entry. */
+static void destroy_entry(MVMSpeshPlanCacheEntry *e) {
+    MVMuint32 i;
+    MVM_free(e->cu_sha1);
+    MVM_free(e->cu_filename);
+    MVM_free(e->cuuid);
+    MVM_free(e->arg_flags);
+    for (i = 0; i < e->num_arg_names; i++)
+        MVM_free(e->arg_names[i]);
+    MVM_free(e->arg_names);
+    if (e->arg_types) {
+        for (i = 0; i < e->flag_count; i++) {
+            MVM_free(e->arg_types[i].type_sc);
+            MVM_free(e->arg_types[i].decont_sc);
+        }
+        MVM_free(e->arg_types);
+    }
+    MVM_free(e);
+}
+
+/* Parses a type token, which is either "-" or the SC handle (hex), index in
+ * the SC, and concreteness, separated by colons. */
+static MVMint32 parse_type(char *token, char **sc, MVMint64 *idx, MVMuint8 *concrete) {
+    char      *idx_part, *concrete_part;
+    MVMuint64  value;
+    if (!token)
+        return 0;
+    if (strcmp(token, "-") == 0)
+        return 1;
+    idx_part = strchr(token, ':');
+    if (!idx_part)
+        return 0;
+    *idx_part++ = '\0';
+    concrete_part = strchr(idx_part, ':');
+    if (!concrete_part)
+        return 0;
+    *concrete_part++ = '\0';
+    if (!parse_uint(idx_part, UINT32_MAX, &value))
+        return 0;
+    *idx = (MVMint64)value;
+    if (!parse_uint(concrete_part, 1, &value))
+        return 0;
+    *concrete = (MVMuint8)value;
+    *sc = decode_hex(token, NULL);
+    return *sc && **sc;
+}
+
+/* Parses a line of the cache file into an entry. Returns NULL if the line is
+ * not a valid entry. */
+static MVMSpeshPlanCacheEntry * parse_entry(char *line) {
+    MVMSpeshPlanCacheEntry *e = MVM_calloc(1, sizeof(MVMSpeshPlanCacheEntry));
+    char      *pos = line;
+    char      *token;
+    size_t     len;
+    MVMuint64  value;
+    MVMuint32  i, num_named = 0;
+
+    /* Compilation unit SHA-1, file name, and frame. */
+    token = next_token(&pos);
+    if (!token || strlen(token) != 40)
+        goto bad;
+    e->cu_sha1 = copy_string(token);
+    if (!(token = next_token(&pos)) || !(e->cu_filename = decode_hex(token, NULL)))
+        goto bad;
+    if (!*e->cu_filename) {
+        MVM_free(e->cu_filename);
+        e->cu_filename = NULL;
+    }
+    if (!parse_uint(next_token(&pos), UINT32_MAX, &value))
+        goto bad;
+    e->frame_idx = (MVMuint32)value;
+    if (!(token = next_token(&pos)) || !(e->cuuid = decode_hex(token, NULL)))
+        goto bad;
+    if (!parse_uint(next_token(&pos), UINT32_MAX, &value))
+        goto bad;
+    e->max_depth = (MVMuint32)value;
+
+    /* Callsite flags. Only callsites that can be interned are of interest,
+     * so there can be no flattening, and positionals come first. */
+    if (!(token = next_token(&pos)) || !(e->arg_flags = (MVMCallsiteEntry *)decode_hex(token, &len)))
+        goto bad;
+    if (len >= MVM_INTERN_ARITY_LIMIT)
+        goto bad;
+    e->flag_count = (MVMuint16)len;
+    for (i = 0; i < e->flag_count; i++) {
+        if (e->arg_flags[i] & (MVM_CALLSITE_ARG_FLAT | MVM_CALLSITE_ARG_FLAT_NAMED))
+            goto bad;
+        if (e->arg_flags[i] & MVM_CALLSITE_ARG_NAMED)
+            num_named++;
+        else if (num_named)
+            goto bad;
+    }
+
+    /* Argument names. */
+    if (!parse_uint(next_token(&pos), num_named, &value) || value != num_named)
+        goto bad;
+    if (num_named)
+        e->arg_names = MVM_calloc(num_named, sizeof(char *));
+    for (i = 0; i < num_named; i++) {
+        if (!(token = next_token(&pos)) || !(e->arg_names[i] = decode_hex(token, NULL)))
+            goto bad;
+        e->num_arg_names++;
+    }
+
+    /* Argument types, if this isn't a certain specialization. */
+    if (!parse_uint(next_token(&pos), 1, &value))
+        goto bad;
+    if (value) {
+        if (!e->flag_count)
+            goto bad;
+        e->arg_types = MVM_calloc(e->flag_count, sizeof(MVMSpeshPlanCacheArgType));
+        for (i = 0; i < e->flag_count; i++) {
+            MVMSpeshPlanCacheArgType *t = &(e->arg_types[i]);
+            if ((e->arg_flags[i] & MVM_CALLSITE_ARG_MASK) != MVM_CALLSITE_ARG_OBJ)
+                continue;
+            if (!parse_type(next_token(&pos), &(t->type_sc), &(t->type_idx), &(t->type_concrete)))
+                goto bad;
+            if (!parse_type(next_token(&pos), &(t->decont_sc), &(t->decont_idx), &(t->decont_type_concrete)))
+                goto bad;
+            if (!parse_uint(next_token(&pos), 1, &value))
+                goto bad;
+            t->rw_cont = (MVMuint8)value;
+        }
+    }
+
+    if (next_token(&pos))
+        goto bad;
+    return e;
+
+  bad:
+    destroy_entry(e);
+    return NULL;
+}
+
+/* Loads the cache file, if there is one, and sets up the cache. */
+MVMSpeshPlanCache * MVM_spesh_plan_cache_load(MVMThreadContext *tc, const char *filename) {
+    MVMSpeshPlanCache *cache = MVM_calloc(1, sizeof(MVMSpeshPlanCache));
+    MVMuint32          alloc_pending = 0;
+    LineBuffer         lb;
+    FILE              *fh;
+    int                init_stat;
+
+    cache->filename = copy_string(filename);
+    if ((init_stat = uv_mutex_init(&cache->mutex)) < 0) {
+        fprintf(stderr, "MoarVM: Initialization of specialization plan cache mutex failed\n    %s\n",
+            uv_strerror(init_stat));
+        exit(1);
+    }
+
+    fh = fopen(filename, "r");
+    if (!fh)
+        return cache;
+    lb.buffer = NULL;
+    lb.alloc  = 0;
+    lb.pos    = 0;
+    if (read_line(fh, &lb) && strcmp(lb.buffer, CACHE_HEADER) == 0) {
+        while (read_line(fh, &lb)) {
+            MVMSpeshPlanCacheEntry *e;
+            if (lb.buffer[0] == '#' || lb.buffer[0] == '\0')
+                continue;
+            e = parse_entry(lb.buffer);
+            if (!e)
+                continue;
+            if (cache->num_pending == alloc_pending) {
+                alloc_pending = alloc_pending ? alloc_pending * 2 : 64;
+                cache->pending = MVM_realloc(cache->pending,
+                    alloc_pending * sizeof(MVMSpeshPlanCacheEntry *));
+            }
+            cache->pending[cache->num_pending++] = e;
+        }
+        cache->num_read = cache->num_pending;
+    }
+    MVM_free(lb.buffer);
+    fclose(fh);
+    return cache;
+}
+
+/* Computes the SHA-1 of a compilation unit's bytecode, as 40 hex digits. */
+static void compute_sha1(MVMCompUnit *cu, char *output) {
+    SHA1Context context;
+    SHA1Init(&context);
+    SHA1Update(&context, cu->body.data_start, cu->body.data_size);
+    SHA1Final(&context, output);
+}
+
+/* Called when a compilation unit is loaded. Pending entries for it are tied
+ * to it, while those for an earlier version of the same file are thrown
+ * out. */
+void MVM_spesh_plan_cache_cu_loaded(MVMThreadContext *tc, MVMCompUnit *cu) {
+    MVMSpeshPlanCache *cache = tc->instance->spesh_plan_cache;
+    char      sha1[41];
+    char     *filename;
+    MVMuint32 i;
+
+    if (!cache->num_pending || !cu->body.data_start)
+        return;
+    compute_sha1(cu, sha1);
+    filename = cu->body.filename
+        ? MVM_string_utf8_c8_encode_C_string(tc, cu->body.filename)
+        : NULL;
+
+    uv_mutex_lock(&cache->mutex);
+    for (i = 0; i < cache->num_pending; i++) {
+        MVMSpeshPlanCacheEntry *e = cache->pending[i];
+        if (e->cu || e->invalid)
+            continue;
+        if (strcmp(e->cu_sha1, sha1) == 0)
+            e->cu = cu;
+        else if (filename && e->cu_filename && strcmp(e->cu_filename, filename) == 0)
+            e->invalid = 1;
+    }
+    uv_mutex_unlock(&cache->mutex);
+
+    MVM_free(filename);
+}
+
+/* Finds the static frame an entry is for, checking it has the cuuid that was
+ * recorded. */
+static MVMStaticFrame * find_frame(MVMThreadContext *tc, MVMSpeshPlanCacheEntry *e) {
+    MVMCompUnit    *cu = e->cu;
+    MVMStaticFrame *sf;
+    char           *cuuid;
+    MVMint32        match;
+    if (e->frame_idx >= cu->body.orig_frames)
+        return NULL;
+    sf = ((MVMCode *)cu->body.coderefs[e->frame_idx])->body.sf;
+    cuuid = MVM_string_utf8_encode_C_string(tc, sf->body.cuuid);
+    match = strcmp(cuuid, e->cuuid) == 0;
+    MVM_free(cuuid);
+    return match ? sf : NULL;
+}
+
+/* Forms and interns the callsite for an entry. Returns zero if it could not
+ * be interned. */
+static MVMint32 make_callsite(MVMThreadContext *tc, MVMSpeshPlanCacheEntry *e) {
+    MVMCallsite *cs = MVM_calloc(1, sizeof(MVMCallsite));
+    MVMCallsite *orig;
+    MVMuint16    i;
+
+    cs->flag_count = e->flag_count;
+    if (e->flag_count) {
+        cs->arg_flags = MVM_malloc(e->flag_count * sizeof(MVMCallsiteEntry));
+        memcpy(cs->arg_flags, e->arg_flags, e->flag_count * sizeof(MVMCallsiteEntry));
+    }
+    for (i = 0; i < e->flag_count; i++) {
+        if (e->arg_flags[i] & MVM_CALLSITE_ARG_NAMED) {
+            cs->arg_count += 2;
+        }
+        else {
+            cs->num_pos++;
+            cs->arg_count++;
+        }
+    }
+    if (e->num_arg_names) {
+        cs->arg_names = MVM_calloc(e->num_arg_names, sizeof(MVMString *));
+        for (i = 0; i < e->num_arg_names; i++) {
+            cs->arg_names[i] = MVM_string_utf8_decode(tc, tc->instance->VMString,
+                e->arg_names[i], strlen(e->arg_names[i]));
+            MVM_gc_root_temp_push(tc, (MVMCollectable **)&(cs->arg_names[i]));
+        }
+        MVM_gc_root_temp_pop_n(tc, e->num_arg_names);
+    }
+
+    /* If an equal callsite is already interned, ours is freed and we get
+     * that one. If ours got interned, the names must be kept alive. */
+    orig = cs;
+    MVM_callsite_try_intern(tc, &cs);
+    if (cs == orig) {
+        if (!cs->is_interned) {
+            MVM_callsite_destroy(cs);
+            return 0;
+        }
+        for (i = 0; i < e->num_arg_names; i++)
+            MVM_gc_root_add_permanent_desc(tc, (MVMCollectable **)&(cs->arg_names[i]),
+                "Specialization plan cache callsite name");
+    }
+    e->cs_stats.cs = cs;
+    return 1;
+}
+
+/* Looks up an object by SC handle and index. Objects that were not yet
+ * deserialized are not forced into existence, and give NULL. */
+static MVMObject * resolve_object(MVMThreadContext *tc, const char *handle, MVMint64 idx) {
+    MVMInstance *instance = tc->instance;
+    MVMObject   *result   = NULL;
+    MVMuint32    i;
+    uv_mutex_lock(&instance->mutex_sc_weakhash);
+    for (i = 1; i < instance->all_scs_next_idx; i++) {
+        MVMSerializationContextBody *scb = instance->all_scs[i];
+        char     *c_handle;
+        MVMint32  match;
+        if (!scb || !scb->handle)
+            continue;
+        c_handle = MVM_string_utf8_encode_C_string(tc, scb->handle);
+        match = strcmp(c_handle, handle) == 0;
+        MVM_free(c_handle);
+        if (match) {
+            if (scb->root_objects && idx < (MVMint64)scb->num_objects)
+                result = scb->root_objects[idx];
+            break;
+        }
+    }
+    uv_mutex_unlock(&instance->mutex_sc_weakhash);
+    return result;
+}
+
+/* Resolves the argument types of an entry into a type tuple. Returns NULL if
+ * any of the types are not available yet. */
+static MVMSpeshStatsType * resolve_type_tuple(MVMThreadContext *tc, MVMSpeshPlanCacheEntry *e) {
+    MVMSpeshStatsType *tuple = MVM_calloc(e->flag_count, sizeof(MVMSpeshStatsType));
+    MVMuint16 i;
+    for (i = 0; i < e->flag_count; i++) {
+        MVMSpeshPlanCacheArgType *t = &(e->arg_types[i]);
+        if (t->type_sc) {
+            tuple[i].type = resolve_object(tc, t->type_sc, t->type_idx);
+            if (!tuple[i].type)
+                goto not_yet;
+            tuple[i].type_concrete = t->type_concrete;
+        }
+        if (t->decont_sc) {
+            tuple[i].decont_type = resolve_object(tc, t->decont_sc, t->decont_idx);
+            if (!tuple[i].decont_type)
+                goto not_yet;
+            tuple[i].decont_type_concrete = t->decont_type_concrete;
+        }
+        tuple[i].rw_cont = t->rw_cont;
+    }
+    return tuple;
+
+  not_yet:
+    MVM_free(tuple);
+    return NULL;
+}
+
+/* Adds specializations from the cache to a plan that is being formed, for
+ * frames that are now ready for them. Called by the specialization worker
+ * before the plan is formed from the statistics, since interning callsites
+ * may allocate. */
+void MVM_spesh_plan_cache_schedule(MVMThreadContext *tc, MVMSpeshPlan *plan) {
+    MVMSpeshPlanCache       *cache = tc->instance->spesh_plan_cache;
+    MVMSpeshPlanCacheEntry **ready;
+    MVMuint32                num_ready = 0, i, insert;
+
+    if (!cache->num_pending)
+        return;
+
+    /* Take the entries whose compilation unit was loaded. Only this thread
+     * updates those, so we can work on them without holding the lock. */
+    uv_mutex_lock(&cache->mutex);
+    ready = MVM_malloc(cache->num_pending * sizeof(MVMSpeshPlanCacheEntry *));
+    for (i = 0; i < cache->num_pending; i++) {
+        MVMSpeshPlanCacheEntry *e = cache->pending[i];
+        if (e->cu && !e->invalid && !e->planned)
+            ready[num_ready++] = e;
+    }
+    uv_mutex_unlock(&cache->mutex);
+
+    /* Form callsites first, as this may GC. */
+    for (i = 0; i < num_ready; i++) {
+        MVMSpeshPlanCacheEntry *e = ready[i];
+        if (!e->cs_stats.cs) {
+            MVMStaticFrame *sf = find_frame(tc, e);
+            if (!sf || !make_callsite(tc, e))
+                e->invalid = 1;
+        }
+    }
+
+    /* Now add to the plan those for frames that have been invoked. */
+    for (i = 0; i < num_ready; i++) {
+        MVMSpeshPlanCacheEntry *e = ready[i];
+        MVMStaticFrame    *sf;
+        MVMSpeshStatsType *type_tuple = NULL;
+        MVMSpeshPlanned   *p;
+        if (e->invalid)
+            continue;
+        sf = find_frame(tc, e);
+        if (!sf || !sf->body.spesh || sf->body.instrumentation_level != tc->instance->instrumentation_level)
+            continue;
+        if (e->arg_types) {
+            type_tuple = resolve_type_tuple(tc, e);
+            if (!type_tuple)
+                continue;
+        }
+        e->planned = 1;
+        if (sf->body.bytecode_size > MVM_SPESH_MAX_BYTECODE_SIZE ||
+                MVM_spesh_arg_guard_exists(tc, sf->body.spesh->body.spesh_arg_guard,
+                    e->cs_stats.cs, type_tuple)) {
+            MVM_free(type_tuple);
+            continue;
+        }
+        e->cs_stats.max_depth = e->max_depth;
+        if (plan->num_planned == plan->alloc_planned) {
+            plan->alloc_planned += 16;
+            plan->planned = MVM_realloc(plan->planned,
+                plan->alloc_planned * sizeof(MVMSpeshPlanned));
+        }
+        p = &(plan->planned[plan->num_planned++]);
+        p->kind = type_tuple ? MVM_SPESH_PLANNED_OBSERVED_TYPES : MVM_SPESH_PLANNED_CERTAIN;
+        p->max_depth = e->max_depth;
+        p->sf = sf;
+        p->cs_stats = &(e->cs_stats);
+        p->type_tuple = type_tuple;
+        p->type_stats = NULL;
+        p->num_type_stats = 0;
+    }
+    MVM_free(ready);
+
+    /* Move planned entries out of the pending list, and throw away invalid
+     * ones. */
+    uv_mutex_lock(&cache->mutex);
+    insert = 0;
+    for (i = 0; i < cache->num_pending; i++) {
+        MVMSpeshPlanCacheEntry *e = cache->pending[i];
+        if (e->invalid) {
+            destroy_entry(e);
+            cache->num_invalidated++;
+        }
+        else if (e->planned) {
+            if (cache->num_planned == cache->alloc_planned) {
+                cache->alloc_planned = cache->alloc_planned ? cache->alloc_planned * 2 : 32;
+                cache->planned = MVM_realloc(cache->planned,
+                    cache->alloc_planned * sizeof(MVMSpeshPlanCacheEntry *));
+            }
+            cache->planned[cache->num_planned++] = e;
+            cache->num_hits++;
+        }
+        else {
+            cache->pending[insert++] = e;
+        }
+    }
+    cache->num_pending = insert;
+    uv_mutex_unlock(&cache->mutex);
+}
+
+/* Records a specialization that was just installed, so it is saved to the
+ * cache. */
+void MVM_spesh_plan_cache_record(MVMThreadContext *tc, MVMSpeshPlanned *p) {
+    MVMSpeshPlanCache       *cache = tc->instance->spesh_plan_cache;
+    MVMSpeshPlanCacheRecord *r;
+    uv_mutex_lock(&cache->mutex);
+    if (cache->num_records == cache->alloc_records) {
+        cache->alloc_records = cache->alloc_records ? cache->alloc_records * 2 : 64;
+        cache->records = MVM_realloc(cache->records,
+            cache->alloc_records * sizeof(MVMSpeshPlanCacheRecord));
+    }
+    r = &(cache->records[cache->num_records++]);
+    r->sf = p->sf;
+    r->cs = p->cs_stats->cs;
+    r->max_depth = p->max_depth;
+    if (p->type_tuple && r->cs) {
+        size_t tuple_size = r->cs->flag_count * sizeof(MVMSpeshStatsType);
+        r->type_tuple = MVM_malloc(tuple_size);
+        memcpy(r->type_tuple, p->type_tuple, tuple_size);
+    }
+    else {
+        r->type_tuple = NULL;
+    }
+    uv_mutex_unlock(&cache->mutex);
+}
+
+/* Information about a compilation unit, worked out once while saving. */
+typedef struct {
+    MVMStaticFrame *sf;
+    MVMuint32       idx;
+} FrameIndex;
+typedef struct {
+    MVMCompUnit *cu;
+    char         sha1[41];
+    char        *filename;
+    FrameIndex  *frames;
+    MVMuint32    num_frames;
+} CUInfo;
+typedef struct {
+    CUInfo    *cus;
+    MVMuint32  num_cus;
+    MVMuint32  alloc_cus;
+} SaveState;
+
+static int compare_frame_index(const void *a, const void *b) {
+    uintptr_t sf_a = (uintptr_t)((const FrameIndex *)a)->sf;
+    uintptr_t sf_b = (uintptr_t)((const FrameIndex *)b)->sf;
+    return sf_a < sf_b ? -1 : sf_a > sf_b ? 1 : 0;
+}
+
+static CUInfo * get_cu_info(MVMThreadContext *tc, SaveState *ss, MVMCompUnit *cu) {
+    CUInfo    *info;
+    MVMuint32  i;
+    for (i = 0; i < ss->num_cus; i++)
+        if (ss->cus[i].cu == cu)
+            return &(ss->cus[i]);
+    if (ss->num_cus == ss->alloc_cus) {
+        ss->alloc_cus = ss->alloc_cus ? ss->alloc_cus * 2 : 16;
+        ss->cus = MVM_realloc(ss->cus, ss->alloc_cus * sizeof(CUInfo));
+    }
+    info = &(ss->cus[ss->num_cus++]);
+    info->cu = cu;
+    compute_sha1(cu, info->sha1);
+    info->filename = cu->body.filename
+        ? MVM_string_utf8_c8_encode_C_string(tc, cu->body.filename)
+        : NULL;
+    info->num_frames = cu->body.orig_frames;
+    info->frames = MVM_malloc((info->num_frames ? info->num_frames : 1) * sizeof(FrameIndex));
+    for (i = 0; i < info->num_frames; i++) {
+        info->frames[i].sf  = ((MVMCode *)cu->body.coderefs[i])->body.sf;
+        info->frames[i].idx = i;
+    }
+    qsort(info->frames, info->num_frames, sizeof(FrameIndex), compare_frame_index);
+    return info;
+}
+
+/* Works out how to refer to a type in the cache file. Returns zero if it
+ * can't be, because it is not in an SC. */
+static MVMint32 type_identity(MVMThreadContext *tc, MVMObject *type, char **sc_out,
+        MVMint64 *idx_out) {
+    MVMSerializationContext *sc;
+    MVMuint32 idx;
+    if (!type)
+        return 1;
+    sc = MVM_sc_get_obj_sc(tc, type);
+    if (!sc)
+        return 0;
+    idx = MVM_sc_get_idx_in_sc(&(type->header));
+    if (idx >= sc->body->num_objects || sc->body->root_objects[idx] != type)
+        return 0;
+    *sc_out = MVM_string_utf8_encode_C_string(tc, sc->body->handle);
+    *idx_out = idx;
+    return 1;
+}
+
+/* Turns a record of a specialization produced into an entry, so it can be
+ * written out. Returns NULL if it can't be cached. */
+static MVMSpeshPlanCacheEntry * entry_from_record(MVMThreadContext *tc, SaveState *ss,
+        MVMSpeshPlanCacheRecord *r) {
+    MVMSpeshPlanCacheEntry *e;
+    CUInfo     *info;
+    FrameIndex  key, *found;
+    MVMuint16   i;
+
+    if (!r->cs)
+        return NULL;
+    info = get_cu_info(tc, ss, r->sf->body.cu);
+    key.sf = r->sf;
+    found = bsearch(&key, info->frames, info->num_frames, sizeof(FrameIndex),
+        compare_frame_index);
+    if (!found)
+        return NULL;
+
+    e = MVM_calloc(1, sizeof(MVMSpeshPlanCacheEntry));
+    e->cu_sha1 = copy_string(info->sha1);
+    e->cu_filename = info->filename ? copy_string(info->filename) : NULL;
+    e->frame_idx = found->idx;
+    e->cuuid = MVM_string_utf8_encode_C_string(tc, r->sf->body.cuuid);
+    e->max_depth = r->max_depth;
+    e->flag_count = r->cs->flag_count;
+    if (e->flag_count) {
+        e->arg_flags = MVM_malloc(e->flag_count * sizeof(MVMCallsiteEntry));
+        memcpy(e->arg_flags, r->cs->arg_flags, e->flag_count * sizeof(MVMCallsiteEntry));
+    }
+    e->num_arg_names = MVM_callsite_num_nameds(tc, r->cs);
+    if (e->num_arg_names) {
+        e->arg_names = MVM_calloc(e->num_arg_names, sizeof(char *));
+        for (i = 0; i < e->num_arg_names; i++)
+            e->arg_names[i] = MVM_string_utf8_encode_C_string(tc, r->cs->arg_names[i]);
+    }
+    if (r->type_tuple) {
+        e->arg_types = MVM_calloc(e->flag_count, sizeof(MVMSpeshPlanCacheArgType));
+        for (i = 0; i < e->flag_count; i++) {
+            MVMSpeshPlanCacheArgType *t  = &(e->arg_types[i]);
+            MVMSpeshStatsType        *tt = &(r->type_tuple[i]);
+            if ((e->arg_flags[i] & MVM_CALLSITE_ARG_MASK) != MVM_CALLSITE_ARG_OBJ)
+                continue;
+            if (!type_identity(tc, tt->type, &(t->type_sc), &(t->type_idx)) ||
+                    !type_identity(tc, tt->decont_type, &(t->decont_sc), &(t->decont_idx))) {
+                destroy_entry(e);
+                return NULL;
+            }
+            t->type_concrete = tt->type_concrete;
+            t->decont_type_concrete = tt->decont_type_concrete;
+            t->rw_cont = tt->rw_cont;
+        }
+    }
+    return e;
+}
+
+/* Writes an entry as a line of the cache file. */
+static void append_type(LineBuffer *lb, const char *sc, MVMint64 idx, MVMuint8 concrete) {
+    append(lb, " ");
+    if (sc) {
+        append_hex(lb, sc, strlen(sc));
+        append(lb, ":");
+        append_uint(lb, idx);
+        append(lb, concrete ? ":1" : ":0");
+    }
+    else {
+        append(lb, "-");
+    }
+}
+static void write_entry(FILE *fh, LineBuffer *lb, MVMSpeshPlanCacheEntry *e) {
+    MVMuint32 i;
+    lb->pos = 0;
+    append(lb, e->cu_sha1);
+    append(lb, " ");
+    append_hex(lb, e->cu_filename, e->cu_filename ? strlen(e->cu_filename) : 0);
+    append(lb, " ");
+    append_uint(lb, e->frame_idx);
+    append(lb, " ");
+    append_hex(lb, e->cuuid, strlen(e->cuuid));
+    append(lb, " ");
+    append_uint(lb, e->max_depth);
+    append(lb, " ");
+    append_hex(lb, (char *)e->arg_flags, e->flag_count);
+    append(lb, " ");
+    append_uint(lb, e->num_arg_names);
+    for (i = 0; i < e->num_arg_names; i++) {
+        append(lb, " ");
+        append_hex(lb, e->arg_names[i], strlen(e->arg_names[i]));
+    }
+    append(lb, e->arg_types ? " 1" : " 0");
+    if (e->arg_types) {
+        for (i = 0; i < e->flag_count; i++) {
+            MVMSpeshPlanCacheArgType *t = &(e->arg_types[i]);
+            if ((e->arg_flags[i] & MVM_CALLSITE_ARG_MASK) != MVM_CALLSITE_ARG_OBJ)
+                continue;
+            append_type(lb, t->type_sc, t->type_idx, t->type_concrete);
+            append_type(lb, t->decont_sc, t->decont_idx, t->decont_type_concrete);
+            append(lb, t->rw_cont ? " 1" : " 0");
+        }
+    }
+    fprintf(fh, "%s\n", lb->buffer);
+}
+
+/* Writes the cache file: everything specialized in this run, along with the
+ * entries for compilation units that were not loaded this time. The file is
+ * written under a temporary name and then moved into place, so a concurrent
+ * run never sees it half-written. */
+void MVM_spesh_plan_cache_save(MVMThreadContext *tc) {
+    MVMSpeshPlanCache *cache = tc->instance->spesh_plan_cache;
+    SaveState   ss;
+    LineBuffer  lb;
+    char       *tmp_filename;
+    size_t      tmp_len;
+    FILE       *fh;
+    MVMuint32   i;
+
+    tmp_len = strlen(cache->filename) + 32;
+    tmp_filename = MVM_malloc(tmp_len);
+    snprintf(tmp_filename, tmp_len, "%s.%"PRId64, cache->filename, MVM_proc_getpid(tc));
+    fh = fopen(tmp_filename, "w");
+    if (!fh) {
+        MVM_free(tmp_filename);
+        return;
+    }
+
+    ss.cus       = NULL;
+    ss.num_cus   = 0;
+    ss.alloc_cus = 0;
+    lb.buffer    = NULL;
+    lb.alloc     = 0;
+    lb.pos       = 0;
+
+    uv_mutex_lock(&cache->mutex);
+    fprintf(fh, "%s\n", CACHE_HEADER);
+    fprintf(fh, "# %u read, %u planned, %u invalidated, %u produced\n",
+        cache->num_read, cache->num_hits, cache->num_invalidated, cache->num_records);
+    for (i = 0; i < cache->num_records; i++) {
+        MVMSpeshPlanCacheEntry *e = entry_from_record(tc, &ss, &(cache->records[i]));
+        if (e) {
+            write_entry(fh, &lb, e);
+            destroy_entry(e);
+        }
+    }
+    for (i = 0; i < cache->num_pending; i++)
+        if (!cache->pending[i]->cu && !cache->pending[i]->invalid)
+            write_entry(fh, &lb, cache->pending[i]);
+    uv_mutex_unlock(&cache->mutex);
+
+    for (i = 0; i < ss.num_cus; i++) {
+        MVM_free(ss.cus[i].filename);
+        MVM_free(ss.cus[i].frames);
+    }
+    MVM_free(ss.cus);
+    MVM_free(lb.buffer);
+
+    if (fclose(fh) == 0) {
+#ifdef _WIN32
+        remove(cache->filename);
+#endif
+        if (rename(tmp_filename, cache->filename) != 0)
+            remove(tmp_filename);
+    }
+    else {
+        remove(tmp_filename);
+    }
+    MVM_free(tmp_filename);
+}
+
+/* Marks the objects held by the cache. */
+void MVM_spesh_plan_cache_gc_mark(MVMThreadContext *tc, MVMSpeshPlanCache *cache, MVMGCWorklist *worklist) {
+    MVMuint32 i, j;
+    if (!cache)
+        return;
+    for (i = 0; i < cache->num_pending; i++)
+        MVM_gc_worklist_add(tc, worklist, &(cache->pending[i]->cu));
+    for (i = 0; i < cache->num_planned; i++)
+        MVM_gc_worklist_add(tc, worklist, &(cache->planned[i]->cu));
+    for (i = 0; i < cache->num_records; i++) {
+        MVMSpeshPlanCacheRecord *r = &(cache->records[i]);
+        MVM_gc_worklist_add(tc, worklist, &(r->sf));
+        if (r->type_tuple) {
+            for (j = 0; j < r->cs->flag_count; j++) {
+                if (r->cs->arg_flags[j] & MVM_CALLSITE_ARG_OBJ) {
+                    MVM_gc_worklist_add(tc, worklist, &(r->type_tuple[j].type));
+                    MVM_gc_worklist_add(tc, worklist, &(r->type_tuple[j].decont_type));
+                }
+            }
+        }
+    }
+}
+
+/* Frees all memory associated with the cache. */
+void MVM_spesh_plan_cache_destroy(MVMThreadContext *tc, MVMSpeshPlanCache *cache) {
+    MVMuint32 i;
+    for (i = 0; i < cache->num_pending; i++)
+        destroy_entry(cache->pending[i]);
+    MVM_free(cache->pending);
+    for (i = 0; i < cache->num_planned; i++)
+        destroy_entry(cache->planned[i]);
+    MVM_free(cache->planned);
+    for (i = 0; i < cache->num_records; i++)
+        MVM_free(cache->records[i].type_tuple);
+    MVM_free(cache->records);
+    uv_mutex_destroy(&cache->mutex);
+    MVM_free(cache->filename);
+    MVM_free(cache);
+}
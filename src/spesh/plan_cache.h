@@ -0,0 +1,109 @@
+/* The specialization plan cache remembers, across runs, which specializations
+ * were produced. It is enabled by setting MVM_SPESH_PLAN_CACHE to the name of
+ * a file. At exit, every specialization produced is written out, identified
+ * by the SHA-1 of its compilation unit's bytecode, the index and cuuid of the
+ * static frame in it, the callsite shape, and the argument types (by SC handle
+ * and index in the SC). On the next run, once a compilation unit with the
+ * same bytecode is loaded and the frame has been prepared, the specialization
+ * is added to the next plan the specializer forms, without waiting for the
+ * statistics to build up again. Since no statistics come with it, it will be
+ * based on the argument types only.
+ *
+ * Entries for a compilation unit that is loaded from the same file name but
+ * has different bytecode are invalidated. The whole cache is ignored if it
+ * was written by a different version of MoarVM. */
+
+/* The type of an argument in a cached type tuple. A NULL SC handle means no
+ * type was logged for it. */
+struct MVMSpeshPlanCacheArgType {
+    char      *type_sc;
+    MVMint64   type_idx;
+    char      *decont_sc;
+    MVMint64   decont_idx;
+    MVMuint8   type_concrete;
+    MVMuint8   decont_type_concrete;
+    MVMuint8   rw_cont;
+};
+
+/* A specialization read from the cache file, waiting to be planned. */
+struct MVMSpeshPlanCacheEntry {
+    /* Hex SHA-1 of the compilation unit bytecode, and the file name it was
+     * loaded from (or NULL). */
+    char *cu_sha1;
+    char *cu_filename;
+
+    /* The index of the static frame in the compilation unit, and its cuuid
+     * (checked as a sanity measure). */
+    MVMuint32  frame_idx;
+    char      *cuuid;
+
+    /* The maximum call depth it was seen at, for ordering the plan. */
+    MVMuint32 max_depth;
+
+    /* The callsite flags, and the names of any named args. */
+    MVMuint16          flag_count;
+    MVMCallsiteEntry  *arg_flags;
+    MVMuint16          num_arg_names;
+    char             **arg_names;
+
+    /* Argument types, one per callsite flag; NULL for a certain
+     * specialization. */
+    MVMSpeshPlanCacheArgType *arg_types;
+
+    /* The compilation unit, once one with matching bytecode is loaded. */
+    MVMCompUnit *cu;
+
+    /* Set if the entry turned out not to match what was loaded, and once it
+     * has been planned, respectively. */
+    MVMuint8 invalid;
+    MVMuint8 planned;
+
+    /* Once planned, this stands in for the statistics the plan would usually
+     * refer to. */
+    MVMSpeshStatsByCallsite cs_stats;
+};
+
+/* A specialization produced in this run, to be written out at exit. */
+struct MVMSpeshPlanCacheRecord {
+    MVMStaticFrame    *sf;
+    MVMCallsite       *cs;
+    MVMSpeshStatsType *type_tuple;
+    MVMuint32          max_depth;
+};
+
+struct MVMSpeshPlanCache {
+    /* The file we read from and will write to. */
+    char *filename;
+
+    /* Entries read from the file that are not yet planned. */
+    MVMSpeshPlanCacheEntry **pending;
+    MVMuint32 num_pending;
+
+    /* Entries that were planned; kept since plans point into them. */
+    MVMSpeshPlanCacheEntry **planned;
+    MVMuint32 num_planned;
+    MVMuint32 alloc_planned;
+
+    /* Specializations produced in this run. */
+    MVMSpeshPlanCacheRecord *records;
+    MVMuint32 num_records;
+    MVMuint32 alloc_records;
+
+    /* Protects the above against concurrent updates. Never held while doing
+     * anything that might GC. */
+    uv_mutex_t mutex;
+
+    /* Statistics: entries read, entries planned (cache hits), and entries
+     * thrown out as invalid. */
+    MVMuint32 num_read;
+    MVMuint32 num_hits;
+    MVMuint32 num_invalidated;
+};
+
+MVMSpeshPlanCache * MVM_spesh_plan_cache_load(MVMThreadContext *tc, const char *filename);
+void MVM_spesh_plan_cache_cu_loaded(MVMThreadContext *tc, MVMCompUnit *cu);
+void MVM_spesh_plan_cache_schedule(MVMThreadContext *tc, MVMSpeshPlan *plan);
+void MVM_spesh_plan_cache_record(MVMThreadContext *tc, MVMSpeshPlanned *p);
+void MVM_spesh_plan_cache_save(MVMThreadContext *tc);
+void MVM_spesh_plan_cache_gc_mark(MVMThreadContext *tc, MVMSpeshPlanCache *cache, MVMGCWorklist *worklist);
+void MVM_spesh_plan_cache_destroy(MVMThreadContext *tc, MVMSpeshPlanCache *cache);
@@ -1,8 +1,62 @@
 #include "moar.h"
 
-/* The specialization worker thread receives logs from other threads about
- * calls and types that showed up at runtime. It uses this to produce
- * specialized versions of code. */
+/* The specialization worker threads receive logs from other threads about
+ * calls and types that showed up at runtime. They use this to produce
+ * specialized versions of code. By default there is just one of them; when
+ * there are more, each takes logs from the queue, updates statistics and
+ * plans in the order the logs were queued, and then produces the planned
+ * specializations in parallel with the other workers. */
+
+/* Takes the next log from the queue, numbering it so that the statistics
+ * will be updated in the order logs were sent. */
+static MVMObject * take_log(MVMThreadContext *tc, MVMuint64 *log_number) {
+    MVMInstance *instance = tc->instance;
+    MVMObject *log_obj;
+    MVM_gc_mark_thread_blocked(tc);
+    uv_mutex_lock(&instance->mutex_spesh_dequeue);
+    MVM_gc_mark_thread_unblocked(tc);
+    log_obj = MVM_repr_shift_o(tc, instance->spesh_queue);
+    *log_number = instance->spesh_next_log_number++;
+    uv_mutex_unlock(&instance->mutex_spesh_dequeue);
+    return log_obj;
+}
+
+/* Waits until it's the turn of the log with the specified number to update
+ * the statistics, and until no worker is producing specializations (since
+ * they read the statistics). New productions are held off meanwhile. */
+static void begin_stats_update(MVMThreadContext *tc, MVMuint64 log_number) {
+    MVMInstance *instance = tc->instance;
+    MVM_gc_mark_thread_blocked(tc);
+    uv_mutex_lock(&instance->mutex_spesh_workers);
+    while (instance->spesh_stats_log_number != log_number)
+        uv_cond_wait(&instance->cond_spesh_workers, &instance->mutex_spesh_workers);
+    instance->spesh_stats_busy = 1;
+    while (instance->spesh_producers)
+        uv_cond_wait(&instance->cond_spesh_workers, &instance->mutex_spesh_workers);
+    uv_mutex_unlock(&instance->mutex_spesh_workers);
+    MVM_gc_mark_thread_unblocked(tc);
+}
+
+/* Ends a statistics update, letting the next log have its turn. We become
+ * one of the workers producing specializations in the same step, so that no
+ * other update can touch the statistics our plan refers to until we are done
+ * with it. */
+static void end_stats_update(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    uv_mutex_lock(&instance->mutex_spesh_workers);
+    instance->spesh_stats_busy = 0;
+    instance->spesh_stats_log_number++;
+    instance->spesh_producers++;
+    uv_cond_broadcast(&instance->cond_spesh_workers);
+    uv_mutex_unlock(&instance->mutex_spesh_workers);
+}
+static void end_production(MVMThreadContext *tc) {
+    MVMInstance *instance = tc->instance;
+    uv_mutex_lock(&instance->mutex_spesh_workers);
+    if (--instance->spesh_producers == 0)
+        uv_cond_broadcast(&instance->cond_spesh_workers);
+    uv_mutex_unlock(&instance->mutex_spesh_workers);
+}
 
 /* Enters the work loop. */
 static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *args) {
@@ -14,11 +68,12 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
     MVMROOT(tc, previous_static_frames, {
         while (1) {
             MVMObject *log_obj;
+            MVMuint64 log_number;
             MVMuint64 start_time;
             unsigned int interval_id;
             if (tc->instance->spesh_log_fh)
                 start_time = uv_hrtime();
-            log_obj = MVM_repr_shift_o(tc, tc->instance->spesh_queue);
+            log_obj = take_log(tc, &log_number);
             if (tc->instance->spesh_log_fh) {
                 fprintf(tc->instance->spesh_log_fh,
                     "Received Logs\n"
@@ -30,9 +85,13 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
             interval_id = MVM_telemetry_interval_start(tc, "spesh worker consuming a log");
 
             uv_mutex_lock(&(tc->instance->mutex_spesh_sync));
-            tc->instance->spesh_working = 1;
+            tc->instance->spesh_working++;
             uv_mutex_unlock(&(tc->instance->mutex_spesh_sync));
 
+            /* We may be waiting for our turn across a GC run. */
+            MVM_gc_root_temp_push(tc, (MVMCollectable **)&log_obj);
+            begin_stats_update(tc, log_number);
+            MVM_gc_root_temp_pop(tc);
             tc->instance->spesh_stats_version++;
             if (log_obj->st->REPR->ID == MVM_REPR_ID_MVMSpeshLog) {
                 MVMSpeshLog *sl = (MVMSpeshLog *)log_obj;
@@ -67,9 +126,9 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
                     /* Form a specialization plan. */
                     if (tc->instance->spesh_log_fh)
                         start_time = uv_hrtime();
-                    tc->instance->spesh_plan = MVM_spesh_plan(tc, updated_static_frames);
+                    tc->spesh_plan = MVM_spesh_plan(tc, updated_static_frames);
                     if (tc->instance->spesh_log_fh) {
-                        n = tc->instance->spesh_plan->num_planned;
+                        n = tc->spesh_plan->num_planned;
                         fprintf(tc->instance->spesh_log_fh,
                             "Specialization Plan\n"
                             "===================\n"
@@ -77,36 +136,42 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
                             n, (int)((uv_hrtime() - start_time) / 1000));
                         for (i = 0; i < n; i++) {
                             char *dump = MVM_spesh_dump_planned(tc,
-                                &(tc->instance->spesh_plan->planned[i]));
+                                &(tc->spesh_plan->planned[i]));
                             fprintf(tc->instance->spesh_log_fh, "%s==========\n\n", dump);
                             MVM_free(dump);
                         }
                     }
-                    MVM_telemetry_interval_annotate((uintptr_t)tc->instance->spesh_plan->num_planned, interval_id,
+                    MVM_telemetry_interval_annotate((uintptr_t)tc->spesh_plan->num_planned, interval_id,
                             "this many specializations planned");
-                    GC_SYNC_POINT(tc);
-
-                    /* Implement the plan and then discard it. */
-                    n = tc->instance->spesh_plan->num_planned;
-                    for (i = 0; i < n; i++) {
-                        MVM_spesh_candidate_add(tc, &(tc->instance->spesh_plan->planned[i]));
-                        GC_SYNC_POINT(tc);
-                    }
-                    MVM_spesh_plan_destroy(tc, tc->instance->spesh_plan);
-                    tc->instance->spesh_plan = NULL;
 
                     /* Clear up stats that didn't get updated for a while,
                      * then add frames updated this time into the previously
-                     * updated array. */
+                     * updated array. This is done before implementing the
+                     * plan, since that can happen in parallel with other
+                     * workers, but changing stats can not. The plan only
+                     * refers to stats that were just updated, so it is not
+                     * affected. */
                     MVM_spesh_stats_cleanup(tc, previous_static_frames);
                     n = MVM_repr_elems(tc, updated_static_frames);
                     for (i = 0; i < n; i++)
                         MVM_repr_push_o(tc, previous_static_frames,
                             MVM_repr_at_pos_o(tc, updated_static_frames, i));
+                    end_stats_update(tc);
+                    GC_SYNC_POINT(tc);
 
                     /* Clear updated static frames array. */
                     MVM_repr_pos_set_elems(tc, updated_static_frames, 0);
 
+                    /* Implement the plan and then discard it. */
+                    n = tc->spesh_plan->num_planned;
+                    for (i = 0; i < n; i++) {
+                        MVM_spesh_candidate_add(tc, &(tc->spesh_plan->planned[i]));
+                        GC_SYNC_POINT(tc);
+                    }
+                    end_production(tc);
+                    MVM_spesh_plan_destroy(tc, tc->spesh_plan);
+                    tc->spesh_plan = NULL;
+
                     /* Allow the sending thread to produce more logs again,
                      * putting a new spesh log in place if needed. */
                     stc = sl->body.thread->body.tc;
@@ -132,8 +197,8 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
             MVM_telemetry_interval_stop(tc, interval_id, "spesh worker finished");
 
             uv_mutex_lock(&(tc->instance->mutex_spesh_sync));
-            tc->instance->spesh_working = 0;
-            uv_cond_broadcast(&(tc->instance->cond_spesh_sync));
+            if (--tc->instance->spesh_working == 0)
+                uv_cond_broadcast(&(tc->instance->cond_spesh_sync));
             uv_mutex_unlock(&(tc->instance->mutex_spesh_sync));
         }
     });
@@ -143,9 +208,13 @@ static void worker(MVMThreadContext *tc, MVMCallsite *callsite, MVMRegister *arg
 void MVM_spesh_worker_setup(MVMThreadContext *tc) {
     if (tc->instance->spesh_enabled) {
         MVMObject *worker_entry_point;
+        MVMuint32 i;
         tc->instance->spesh_queue = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTQueue);
         worker_entry_point = MVM_repr_alloc_init(tc, tc->instance->boot_types.BOOTCCode);
         ((MVMCFunction *)worker_entry_point)->body.func = worker;
-        MVM_thread_run(tc, MVM_thread_new(tc, worker_entry_point, 1));
+        MVMROOT(tc, worker_entry_point, {
+            for (i = 0; i < tc->instance->spesh_num_workers; i++)
+                MVM_thread_run(tc, MVM_thread_new(tc, worker_entry_point, 1));
+        });
     }
 }
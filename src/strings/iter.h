@@ -2,17 +2,18 @@
 struct MVMGraphemeIter {
     /* The blob we're currently iterating over. */
     union {
-        MVMGrapheme32    *blob_32;
-        MVMGraphemeASCII *blob_ascii;
-        MVMGrapheme8     *blob_8;
-        void             *any;
+        MVMGrapheme32     *blob_32;
+        MVMGraphemeASCII  *blob_ascii;
+        MVMGrapheme8      *blob_8;
+        MVMGraphemeLatin1 *blob_latin1;
+        void              *any;
     } active_blob;
 
     /* The type of blob we have. */
     MVMuint16 blob_type;
 
     /* The number of strands remaining, if any. */
-    MVMuint16 strands_remaining;
+    MVMuint32 strands_remaining;
 
     /* The current position, and the end position. */
     MVMStringIndex pos;
@@ -25,13 +26,26 @@ struct MVMGraphemeIter {
 
     /* The next strand, if we're doing a strand-based iteration. */
     MVMStringStrand *next_strand;
+
+    /* The grapheme offset of the next strand, if we're iterating a rope;
+     * NULL otherwise. Lets us binary search for a position. */
+    MVMStringIndex *next_offset;
 };
 
 /* Initializes a grapheme iterator. */
 MVM_STATIC_INLINE void MVM_string_gi_init(MVMThreadContext *tc, MVMGraphemeIter *gi, MVMString *s) {
-    if (s->body.storage_type == MVM_STRING_STRAND) {
-        MVMStringStrand *strands = s->body.storage.strands;
-        MVMString       *first   = strands[0].blob_string;
+    if (s->body.storage_type == MVM_STRING_STRAND || s->body.storage_type == MVM_STRING_ROPE) {
+        MVMStringStrand *strands;
+        MVMString       *first;
+        if (s->body.storage_type == MVM_STRING_ROPE) {
+            strands         = s->body.storage.rope->strands;
+            gi->next_offset = s->body.storage.rope->offsets + 1;
+        }
+        else {
+            strands         = s->body.storage.strands;
+            gi->next_offset = NULL;
+        }
+        first                    = strands[0].blob_string;
         gi->active_blob.any      = first->body.storage.any;
         gi->blob_type            = first->body.storage_type;
         gi->strands_remaining    = s->body.num_strands - 1;
@@ -48,6 +62,7 @@ MVM_STATIC_INLINE void MVM_string_gi_init(MVMThreadContext *tc, MVMGraphemeIter
         gi->pos               = 0;
         gi->end               = s->body.num_graphs;
         gi->repetitions       = 0;
+        gi->next_offset       = NULL;
     }
 };
 
@@ -57,6 +72,39 @@ MVM_STATIC_INLINE void MVM_string_gi_move_to(MVMThreadContext *tc, MVMGraphemeIt
     MVMuint32 remaining = pos;
     MVMuint32 strand_graphs;
 
+    /* In a rope, binary search for the last strand starting before the
+     * target, then fall into the walk below. */
+    if (gi->next_offset && gi->strands_remaining) {
+        MVMStringStrand *cur    = gi->next_strand - 1;
+        MVMuint32       left   = (gi->end - gi->pos) + gi->repetitions * (gi->end - gi->start);
+        MVMStringIndex  target = gi->next_offset[-1] + remaining - left
+                                   + (cur->end - cur->start) * (cur->repetitions + 1);
+        MVMuint32       lo     = 0;
+        MVMuint32       hi     = gi->strands_remaining;
+        MVMStringStrand *next;
+        while (lo < hi) {
+            MVMuint32 mid = lo + (hi - lo) / 2;
+            if (gi->next_offset[mid] < target)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo > 0) {
+            /* Strand lo - 1 is the last one starting before the target. */
+            next = gi->next_strand + (lo - 1);
+            gi->active_blob.any    = next->blob_string->body.storage.any;
+            gi->blob_type          = next->blob_string->body.storage_type;
+            gi->pos                = next->start;
+            gi->end                = next->end;
+            gi->start              = next->start;
+            gi->repetitions        = next->repetitions;
+            remaining              = target - gi->next_offset[lo - 1];
+            gi->strands_remaining -= lo;
+            gi->next_strand       += lo;
+            gi->next_offset       += lo;
+        }
+    }
+
     /* Find the appropriate strand. */
     while (remaining > (strand_graphs = (gi->end - gi->pos) * (gi->repetitions + 1))) {
         MVMStringStrand *next = gi->next_strand;
@@ -70,6 +118,8 @@ MVM_STATIC_INLINE void MVM_string_gi_move_to(MVMThreadContext *tc, MVMGraphemeIt
         gi->repetitions     = next->repetitions;
         gi->strands_remaining--;
         gi->next_strand++;
+        if (gi->next_offset)
+            gi->next_offset++;
         remaining -= strand_graphs;
     }
 
@@ -120,6 +170,8 @@ MVM_STATIC_INLINE MVMGrapheme32 MVM_string_gi_get_grapheme(MVMThreadContext *tc,
                 return gi->active_blob.blob_ascii[gi->pos++];
             case MVM_STRING_GRAPHEME_8:
                 return gi->active_blob.blob_8[gi->pos++];
+            case MVM_STRING_GRAPHEME_LATIN1:
+                return gi->active_blob.blob_latin1[gi->pos++];
             }
         }
         else if (gi->repetitions) {
@@ -136,6 +188,8 @@ MVM_STATIC_INLINE MVMGrapheme32 MVM_string_gi_get_grapheme(MVMThreadContext *tc,
             gi->repetitions     = next->repetitions;
             gi->strands_remaining--;
             gi->next_strand++;
+            if (gi->next_offset)
+                gi->next_offset++;
         }
         else {
             MVM_exception_throw_adhoc(tc, "Iteration past end of grapheme iterator");
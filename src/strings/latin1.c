@@ -1,15 +1,34 @@
 #include "moar.h"
 
+/* Switches a string being decoded into one of the 8-bit forms over to 32-bit
+ * storage, with room for the specified number of graphemes. */
+static void widen_to_32bit(MVMThreadContext *tc, MVMString *result, size_t result_graphs, size_t bytes) {
+    MVMGrapheme8 *old_storage = result->body.storage.blob_8;
+    size_t k;
+
+    result->body.storage.blob_32 = MVM_malloc(sizeof(MVMGrapheme32) * bytes);
+    if (result->body.storage_type == MVM_STRING_GRAPHEME_LATIN1)
+        for (k = 0; k < result_graphs; k++)
+            result->body.storage.blob_32[k] = (MVMGraphemeLatin1)old_storage[k];
+    else
+        for (k = 0; k < result_graphs; k++)
+            result->body.storage.blob_32[k] = old_storage[k];
+    result->body.storage_type = MVM_STRING_GRAPHEME_32;
+    MVM_free(old_storage);
+}
+
 /* Decodes the specified number of bytes of latin1 into an NFG string,
  * creating a result of the specified type. The type must have the MVMString
- * REPR. */
+ * REPR. We start out in the 8-bit form, which can hold \r\n, and switch to
+ * the Latin-1 form when we see a byte above 127; only if we see both do we
+ * need 32-bit storage. */
 MVMString * MVM_string_latin1_decode(MVMThreadContext *tc, const MVMObject *result_type,
                                      char *latin1_c, size_t bytes) {
     MVMuint8  *latin1 = (MVMuint8 *)latin1_c;
     MVMString *result = (MVMString *)REPR(result_type)->allocate(tc, STABLE(result_type));
-    size_t i, k, result_graphs;
+    size_t i, result_graphs;
 
-    MVMuint8 writing_32bit = 0;
+    MVMuint8 seen_crlf = 0;
 
     result->body.storage_type   = MVM_STRING_GRAPHEME_8;
     result->body.storage.blob_8 = MVM_malloc(sizeof(MVMint8) * bytes);
@@ -17,28 +36,28 @@ MVMString * MVM_string_latin1_decode(MVMThreadContext *tc, const MVMObject *resu
     result_graphs = 0;
     for (i = 0; i < bytes; i++) {
         if (latin1[i] == '\r' && i + 1 < bytes && latin1[i + 1] == '\n') {
-            if (writing_32bit)
+            if (result->body.storage_type == MVM_STRING_GRAPHEME_LATIN1)
+                widen_to_32bit(tc, result, result_graphs, bytes);
+            if (result->body.storage_type == MVM_STRING_GRAPHEME_32)
                 result->body.storage.blob_32[result_graphs++] = MVM_nfg_crlf_grapheme(tc);
             else
                 result->body.storage.blob_8[result_graphs++] = MVM_nfg_crlf_grapheme(tc);
+            seen_crlf = 1;
             i++;
         }
         else {
-            if (latin1[i] > 127 && !writing_32bit) {
-                MVMGrapheme8 *old_storage = result->body.storage.blob_8;
-
-                result->body.storage.blob_32 = MVM_malloc(sizeof(MVMGrapheme32) * bytes);
-                result->body.storage_type = MVM_STRING_GRAPHEME_32;
-                writing_32bit = 1;
-
-                for (k = 0; k < i; k++)
-                    result->body.storage.blob_32[k] = old_storage[k];
-                MVM_free(old_storage);
+            if (latin1[i] > 127 && result->body.storage_type == MVM_STRING_GRAPHEME_8) {
+                /* Everything so far is ASCII or \r\n; if it's all ASCII,
+                 * then the bytes mean the same in the Latin-1 form. */
+                if (seen_crlf)
+                    widen_to_32bit(tc, result, result_graphs, bytes);
+                else
+                    result->body.storage_type = MVM_STRING_GRAPHEME_LATIN1;
             }
-            if (writing_32bit)
+            if (result->body.storage_type == MVM_STRING_GRAPHEME_32)
                 result->body.storage.blob_32[result_graphs++] = latin1[i];
             else
-                result->body.storage.blob_8[result_graphs++] = latin1[i];
+                result->body.storage.blob_latin1[result_graphs++] = latin1[i];
         }
     }
     result->body.num_graphs = result_graphs;
@@ -169,6 +188,13 @@ char * MVM_string_latin1_encode_substr(MVMThreadContext *tc, MVMString *str, MVM
         if (output_size)
             *output_size = lengthu;
     }
+    else if (str->body.storage_type == MVM_STRING_GRAPHEME_LATIN1 && !translate_newlines) {
+        /* Already Latin-1; directly copy. */
+        memcpy(result, str->body.storage.blob_latin1 + start, lengthu);
+        result[lengthu] = 0;
+        if (output_size)
+            *output_size = lengthu;
+    }
     else {
         MVMuint32 i = 0;
         MVMCodepointIter ci;
@@ -124,6 +124,28 @@ MVM_STATIC_INLINE MVMint32 MVM_unicode_normalizer_process_codepoint_to_grapheme(
     return MVM_unicode_normalizer_process_codepoint(tc, n, in, (MVMGrapheme32 *)out);
 }
 
+/* Processes a run of printable ASCII codepoints (0x20 to 0x7E) all at once,
+ * provided the normalizer is in a state where each of them would take the
+ * composition fast path above: it holds exactly one codepoint, that is below
+ * the first significant one, and not after a prepend character. In that case
+ * the held codepoint and all but the last of the run are written to out, the
+ * last of the run is held, and the length of the run is returned. Otherwise,
+ * nothing is done and 0 is returned. */
+MVM_STATIC_INLINE MVMint32 MVM_unicode_normalizer_process_ascii_run(MVMThreadContext *tc, MVMNormalizer *n, const MVMuint8 *in, MVMint32 num, MVMGrapheme32 *out) {
+    MVMint32 i;
+    if (!MVM_NORMALIZE_COMPOSE(n->form) || n->prepend_buffer || n->first_significant <= 0x7E)
+        return 0;
+    if (n->buffer_end - n->buffer_start != 1 || n->buffer_norm_end != n->buffer_start)
+        return 0;
+    if (n->buffer[n->buffer_start] >= n->first_significant)
+        return 0;
+    out[0] = (MVMGrapheme32)n->buffer[n->buffer_start];
+    for (i = 1; i < num; i++)
+        out[i] = in[i - 1];
+    n->buffer[n->buffer_start] = in[num - 1];
+    return num;
+}
+
 /* Push a number of codepoints into the "to normalize" buffer. */
 void MVM_unicode_normalizer_push_codepoints(MVMThreadContext *tc, MVMNormalizer *n, const MVMCodepoint *in, MVMint32 num_codepoints);
 
@@ -161,13 +161,13 @@ static void NFG_check_concat (MVMThreadContext *tc, MVMString *result, MVMString
 MVM_STATIC_INLINE MVMint64 string_equal_at_ignore_case_INTERNAL_loop(MVMThreadContext *tc, MVMString *Haystack, MVMString *needle_fc, MVMint64 H_start, MVMint64 H_graphs, MVMint64 n_fc_graphs, int ignoremark, int ignorecase);
 
 /* Allocates strand storage. */
-static MVMStringStrand * allocate_strands(MVMThreadContext *tc, MVMuint16 num_strands) {
+static MVMStringStrand * allocate_strands(MVMThreadContext *tc, MVMuint32 num_strands) {
     return MVM_malloc(num_strands * sizeof(MVMStringStrand));
 }
 
 /* Copies strands from one strand string to another. */
-static void copy_strands(MVMThreadContext *tc, const MVMString *from, MVMuint16 from_offset,
-        MVMString *to, MVMuint16 to_offset, MVMuint16 num_strands) {
+static void copy_strands(MVMThreadContext *tc, const MVMString *from, MVMuint32 from_offset,
+        MVMString *to, MVMuint32 to_offset, MVMuint32 num_strands) {
     assert(from->body.storage_type == MVM_STRING_STRAND);
     assert(to->body.storage_type == MVM_STRING_STRAND);
     memcpy(
@@ -176,8 +176,8 @@ static void copy_strands(MVMThreadContext *tc, const MVMString *from, MVMuint16
         num_strands * sizeof(MVMStringStrand));
 }
 /* Move strands inside the same strand string. */
-static void move_strands(MVMThreadContext *tc, const MVMString *from, MVMuint16 from_offset,
-        MVMString *to, MVMuint16 to_offset, MVMuint16 num_strands) {
+static void move_strands(MVMThreadContext *tc, const MVMString *from, MVMuint32 from_offset,
+        MVMString *to, MVMuint32 to_offset, MVMuint32 num_strands) {
     assert(from->body.storage_type == MVM_STRING_STRAND);
     assert(to->body.storage_type == MVM_STRING_STRAND);
     memmove(
@@ -186,12 +186,141 @@ static void move_strands(MVMThreadContext *tc, const MVMString *from, MVMuint16
         num_strands * sizeof(MVMStringStrand));
 }
 
+/* Gets the strands of a strand string or a rope. */
+MVM_STATIC_INLINE MVMStringStrand * strands_of(MVMString *s) {
+    return s->body.storage_type == MVM_STRING_ROPE
+        ? s->body.storage.rope->strands
+        : s->body.storage.strands;
+}
+
+/* Checks if a string is made of strands (whether a strand string or a
+ * rope). */
+MVM_STATIC_INLINE int has_strands(MVMString *s) {
+    return s->body.storage_type == MVM_STRING_STRAND || s->body.storage_type == MVM_STRING_ROPE;
+}
+
+/* Gets the number of strands a string will take up in a strand string or a
+ * rope. */
+MVM_STATIC_INLINE MVMuint32 num_strands_of(MVMString *s) {
+    return has_strands(s) ? s->body.num_strands : 1;
+}
+
+/* Allocates the strands for a rope, with room for at least num_strands. We
+ * allocate double that, so that ropes built by repeated concatenation can
+ * grow in place most of the time. */
+static MVMStringRope * allocate_rope(MVMThreadContext *tc, MVMuint32 num_strands) {
+    MVMStringRope *rope = MVM_malloc(sizeof(MVMStringRope));
+    rope->alloc_strands = num_strands * 2;
+    rope->strands       = MVM_malloc(rope->alloc_strands * sizeof(MVMStringStrand));
+    rope->offsets       = MVM_malloc(rope->alloc_strands * sizeof(MVMStringIndex));
+    rope->num_strands   = num_strands;
+    rope->refs          = 1;
+    return rope;
+}
+
+/* Writes the strands of a string into a rope, starting at the given strand
+ * index. Returns the index after the last one written. */
+static MVMuint32 put_rope_strands(MVMThreadContext *tc, MVMStringRope *rope, MVMuint32 idx, MVMString *s) {
+    if (has_strands(s)) {
+        memcpy(rope->strands + idx, strands_of(s), s->body.num_strands * sizeof(MVMStringStrand));
+        return idx + s->body.num_strands;
+    }
+    else {
+        MVMStringStrand *ss = &(rope->strands[idx]);
+        ss->blob_string = s;
+        ss->start       = 0;
+        ss->end         = s->body.num_graphs;
+        ss->repetitions = 0;
+        return idx + 1;
+    }
+}
+
+/* Concatenates a and b into result as a rope. If a is a rope whose strands
+ * nothing has been appended after yet, and there's room, b's strands are
+ * appended in place, and the strands shared; otherwise a new rope is made.
+ * If there's a renormalized section at the join, then consumed_a graphemes
+ * are taken off the end of a and consumed_b off the start of b, and the
+ * section goes between them. */
+static void concatenate_into_rope(MVMThreadContext *tc, MVMString *result, MVMString *a,
+        MVMString *b, MVMString *renormalized_section, MVMuint32 consumed_a, MVMuint32 consumed_b) {
+    MVMuint32      strands_a = num_strands_of(a);
+    MVMuint32      strands_b = num_strands_of(b);
+    MVMStringRope *rope      = NULL;
+    MVMuint32      idx, first_new, i;
+
+    /* Try to claim the space after a's strands. (With a renormalized
+     * section, a's last strand would need changing, so we can't.) */
+    if (a->body.storage_type == MVM_STRING_ROPE && !renormalized_section) {
+        MVMStringRope *a_rope = a->body.storage.rope;
+        if (strands_a + strands_b <= a_rope->alloc_strands &&
+                MVM_trycas(&(a_rope->num_strands), strands_a, strands_a + strands_b)) {
+            rope = a_rope;
+            MVM_incr(&(rope->refs));
+            idx       = strands_a;
+            first_new = strands_a;
+        }
+    }
+
+    /* Otherwise, make a new rope, and copy a's strands into it. */
+    if (!rope) {
+        rope      = allocate_rope(tc, strands_a + strands_b + (renormalized_section ? 1 : 0));
+        idx       = put_rope_strands(tc, rope, 0, a);
+        first_new = 0;
+        if (renormalized_section) {
+            MVMStringStrand *ss_a = &(rope->strands[idx - 1]);
+            ss_a->end -= consumed_a;
+            if (ss_a->start == ss_a->end)
+                idx--;
+            rope->strands[idx].blob_string = renormalized_section;
+            rope->strands[idx].start       = 0;
+            rope->strands[idx].end         = renormalized_section->body.num_graphs;
+            rope->strands[idx].repetitions = 0;
+            idx++;
+        }
+    }
+
+    /* Add b's strands, and tweak the start of its first if needed. */
+    if (renormalized_section) {
+        MVMuint32 index_ss_b = idx;
+        idx = put_rope_strands(tc, rope, idx, b);
+        rope->strands[index_ss_b].start += consumed_b;
+        if (rope->strands[index_ss_b].start == rope->strands[index_ss_b].end) {
+            memmove(rope->strands + index_ss_b, rope->strands + index_ss_b + 1,
+                (idx - index_ss_b - 1) * sizeof(MVMStringStrand));
+            idx--;
+        }
+        result->body.num_graphs += renormalized_section->body.num_graphs - consumed_a - consumed_b;
+    }
+    else {
+        idx = put_rope_strands(tc, rope, idx, b);
+    }
+
+    /* Record the grapheme offset of each new strand. */
+    if (first_new == 0) {
+        rope->offsets[0]  = 0;
+        rope->num_strands = idx;
+        first_new = 1;
+    }
+    for (i = first_new; i < idx; i++) {
+        MVMStringStrand *prev = &(rope->strands[i - 1]);
+        rope->offsets[i] = rope->offsets[i - 1]
+            + (prev->end - prev->start) * (prev->repetitions + 1);
+    }
+
+    result->body.storage_type = MVM_STRING_ROPE;
+    result->body.storage.rope = rope;
+    result->body.num_strands  = idx;
+}
+
 MVM_STATIC_INLINE int can_fit_into_8bit (MVMGrapheme32 g) {
     return -128 <= g && g <= 127;
 }
 MVM_STATIC_INLINE int can_fit_into_ascii (MVMGrapheme32 g) {
     return 0 <= g && g <= 127;
 }
+MVM_STATIC_INLINE int can_fit_into_latin1 (MVMGrapheme32 g) {
+    return 0 <= g && g <= 255;
+}
 /* If a string is currently using 32bit storage, turn it into using
  * 8 bit storage. Doesn't do any checks at all. */
 static void turn_32bit_into_8bit_unchecked(MVMThreadContext *tc, MVMString *str) {
@@ -206,22 +335,63 @@ static void turn_32bit_into_8bit_unchecked(MVMThreadContext *tc, MVMString *str)
 
     MVM_free(old_buf);
 }
+/* If a string is currently using 32bit storage, turn it into using
+ * Latin-1 storage. Doesn't do any checks at all. */
+static void turn_32bit_into_latin1_unchecked(MVMThreadContext *tc, MVMString *str) {
+    MVMGrapheme32 *old_buf = str->body.storage.blob_32;
+    MVMStringIndex i;
+    str->body.storage_type = MVM_STRING_GRAPHEME_LATIN1;
+    str->body.storage.blob_latin1 = MVM_malloc(str->body.num_graphs * sizeof(MVMGraphemeLatin1));
+
+    for (i = 0; i < str->body.num_graphs; i++) {
+        str->body.storage.blob_latin1[i] = old_buf[i];
+    }
+
+    MVM_free(old_buf);
+}
+
+/* Takes a string using 32bit storage, along with the lowest and highest
+ * graphemes in it, and switches it to one of the 8-bit storage forms if
+ * they allow. */
+void MVM_string_compact_32bit(MVMThreadContext *tc, MVMString *str, MVMGrapheme32 lowest,
+        MVMGrapheme32 highest) {
+    if (lowest >= -128 && highest <= 127)
+        turn_32bit_into_8bit_unchecked(tc, str);
+    else if (lowest >= 0 && highest <= 255)
+        turn_32bit_into_latin1_unchecked(tc, str);
+}
 
 /* Accepts an allocated string that should have body.num_graphs set but the blob
  * unallocated. This function will allocate the space for the blob and iterate
  * the supplied grapheme iterator for the length of body.num_graphs */
 static void iterate_gi_into_string(MVMThreadContext *tc, MVMGraphemeIter *gi, MVMString *result) {
     MVMuint64 i;
+    MVMuint8  has_synthetic = 0;
+    MVMuint8  is_latin1     = 0;
     result->body.storage_type    = MVM_STRING_GRAPHEME_8;
     result->body.storage.blob_8  = MVM_malloc(result->body.num_graphs * sizeof(MVMGrapheme8));
     for (i = 0; i < result->body.num_graphs; i++) {
         MVMGrapheme32 g = MVM_string_gi_get_grapheme(tc, gi);
-        result->body.storage.blob_8[i] = g;
-        if (!can_fit_into_8bit(g)) {
-            /* If we get here, we saw a codepoint lower than -127 or higher than 127
-             * so turn it into a 32 bit string instead */
+        /* We can stay 8-bit so long as we don't see both synthetics (which
+         * need the signed form) and codepoints above 127 (which need the
+         * Latin-1 form). */
+        if (can_fit_into_ascii(g)) {
+            result->body.storage.blob_8[i] = g;
+        }
+        else if (can_fit_into_8bit(g) && !is_latin1) {
+            result->body.storage.blob_8[i] = g;
+            has_synthetic = 1;
+        }
+        else if (can_fit_into_latin1(g) && !has_synthetic) {
+            result->body.storage.blob_latin1[i] = g;
+            is_latin1 = 1;
+        }
+        else {
+            /* If we get here, we saw a grapheme that fits in neither of the
+             * 8-bit forms, so turn it into a 32 bit string instead */
             /* Store the old string pointer and previous value of i */
-            MVMGrapheme8 *old_ref = result->body.storage.blob_8;
+            MVMGrapheme8      *old_ref        = result->body.storage.blob_8;
+            MVMGraphemeLatin1 *old_ref_latin1 = result->body.storage.blob_latin1;
             MVMuint64 prev_i = i;
             /* Set up the string as 32bit now and allocate space for it */
             result->body.storage_type    = MVM_STRING_GRAPHEME_32;
@@ -229,7 +399,7 @@ static void iterate_gi_into_string(MVMThreadContext *tc, MVMGraphemeIter *gi, MV
             /* Copy the data so far copied from the 8bit blob since it's faster than
              * setting up the grapheme iterator again */
             for (i = 0; i < prev_i; i++) {
-                result->body.storage.blob_32[i] = old_ref[i];
+                result->body.storage.blob_32[i] = is_latin1 ? old_ref_latin1[i] : old_ref[i];
             }
             MVM_free(old_ref);
             /* Store the grapheme which interupted the sequence. After that we can
@@ -238,8 +408,11 @@ static void iterate_gi_into_string(MVMThreadContext *tc, MVMGraphemeIter *gi, MV
             for (i = prev_i + 1; i < result->body.num_graphs; i++) {
                 result->body.storage.blob_32[i] = MVM_string_gi_get_grapheme(tc, gi);
             }
+            return;
         }
     }
+    if (is_latin1)
+        result->body.storage_type = MVM_STRING_GRAPHEME_LATIN1;
 }
 
 /* Collapses a bunch of strands into a single blob string. */
@@ -334,6 +507,13 @@ MVMint64 MVM_string_substrings_equal_nocheck(MVMThreadContext *tc, MVMString *a,
                 b->body.storage.blob_8 + startb,
                 length);
         break;
+    case MVM_STRING_GRAPHEME_LATIN1:
+        if (b->body.storage_type == MVM_STRING_GRAPHEME_LATIN1)
+            return 0 == memcmp(
+                a->body.storage.blob_latin1 + starta,
+                b->body.storage.blob_latin1 + startb,
+                length);
+        break;
     }
 
     /* Normal path, for the rest of the time. */
@@ -356,7 +536,10 @@ MVMGrapheme32 MVM_string_get_grapheme_at_nocheck(MVMThreadContext *tc, MVMString
         return a->body.storage.blob_ascii[index];
     case MVM_STRING_GRAPHEME_8:
         return a->body.storage.blob_8[index];
-    case MVM_STRING_STRAND: {
+    case MVM_STRING_GRAPHEME_LATIN1:
+        return a->body.storage.blob_latin1[index];
+    case MVM_STRING_STRAND:
+    case MVM_STRING_ROPE: {
         MVMGraphemeIter gi;
         MVM_string_gi_init(tc, &gi, a);
         MVM_string_gi_move_to(tc, &gi, index);
@@ -428,6 +611,20 @@ MVMint64 MVM_string_index(MVMThreadContext *tc, MVMString *Haystack, MVMString *
                     return (MVMGrapheme8*)mm_return_8 -  Haystack->body.storage.blob_8;
             }
             break;
+        case MVM_STRING_GRAPHEME_LATIN1:
+            if (needle->body.storage_type == MVM_STRING_GRAPHEME_LATIN1) {
+                void *mm_return_latin1 = MVM_memmem(
+                    Haystack->body.storage.blob_latin1 + start, /* start position */
+                    (H_graphs - start) * sizeof(MVMGraphemeLatin1), /* length of Haystack from start position to end */
+                    needle->body.storage.blob_latin1, /* needle start */
+                    n_graphs * sizeof(MVMGraphemeLatin1) /* needle length */
+                );
+                if (mm_return_latin1 == NULL)
+                    return -1;
+                else
+                    return (MVMGraphemeLatin1*)mm_return_latin1 - Haystack->body.storage.blob_latin1;
+            }
+            break;
     }
 
     /* brute force for now. horrible, yes. halp. */
@@ -532,7 +729,7 @@ MVMString * MVM_string_substring(MVMThreadContext *tc, MVMString *a, MVMint64 of
     MVMROOT(tc, a, {
         result = (MVMString *)MVM_repr_alloc_init(tc, tc->instance->VMString);
         result->body.num_graphs = end_pos - start_pos;
-        if (a->body.storage_type != MVM_STRING_STRAND) {
+        if (a->body.storage_type != MVM_STRING_STRAND && a->body.storage_type != MVM_STRING_ROPE) {
             /* It's some kind of buffer. Construct a strand view into it. */
             result->body.storage_type    = MVM_STRING_STRAND;
             result->body.storage.strands = allocate_strands(tc, 1);
@@ -542,7 +739,8 @@ MVMString * MVM_string_substring(MVMThreadContext *tc, MVMString *a, MVMint64 of
             result->body.storage.strands[0].end         = end_pos;
             result->body.storage.strands[0].repetitions = 0;
         }
-        else if (a->body.num_strands == 1 && a->body.storage.strands[0].repetitions == 0) {
+        else if (a->body.storage_type == MVM_STRING_STRAND && a->body.num_strands == 1
+                && a->body.storage.strands[0].repetitions == 0) {
             /* Single strand string; quite possibly already a substring. We'll
              * just produce an updated view. */
             MVMStringStrand *orig_strand = &(a->body.storage.strands[0]);
@@ -620,8 +818,8 @@ MVMString * MVM_string_concatenate(MVMThreadContext *tc, MVMString *a, MVMString
     is_concat_stable = MVM_nfg_is_concat_stable(tc, a, b);
 
     /* If is_concat_stable equals 0 and a and b are not repetitions. */
-    if (is_concat_stable == 0 && !(a->body.storage_type == MVM_STRING_STRAND && a->body.storage.strands[a->body.num_strands - 1].repetitions)
-    && !(b->body.storage_type == MVM_STRING_STRAND && b->body.storage.strands[0].repetitions)) {
+    if (is_concat_stable == 0 && !(has_strands(a) && strands_of(a)[a->body.num_strands - 1].repetitions)
+    && !(has_strands(b) && strands_of(b)[0].repetitions)) {
         MVMCodepoint last_a_first_b[2] = {
             MVM_string_get_grapheme_at_nocheck(tc, a, a->body.num_graphs - 1),
             MVM_string_get_grapheme_at_nocheck(tc, b, 0)
@@ -692,30 +890,20 @@ MVMString * MVM_string_concatenate(MVMThreadContext *tc, MVMString *a, MVMString
             result->body.num_strands = a->body.num_strands;
         }
 
+        /* If either side is already a rope, or we'd have too many strands
+         * between the two, make a rope rather than flattening anything. */
+        else if (a->body.storage_type == MVM_STRING_ROPE || b->body.storage_type == MVM_STRING_ROPE
+                || num_strands_of(a) + num_strands_of(b) > MVM_STRING_MAX_STRANDS) {
+            concatenate_into_rope(tc, result, a, b, renormalized_section, consumed_a, consumed_b);
+        }
+
         /* Otherwise, construct a new strand string. */
         else {
-            /* See if we have too many strands between the two. If so, we will
-             * collapse the biggest side. */
-            MVMuint16 strands_a = a->body.storage_type == MVM_STRING_STRAND
-                ? a->body.num_strands
-                : 1;
-            MVMuint16 strands_b = b->body.storage_type == MVM_STRING_STRAND
-                ? b->body.num_strands
-                : 1;
+            MVMuint32  strands_a   = num_strands_of(a);
+            MVMuint32  strands_b   = num_strands_of(b);
             MVMString *effective_a = a;
             MVMString *effective_b = b;
-            if (strands_a + strands_b > MVM_STRING_MAX_STRANDS) {
-                MVMROOT(tc, result, {
-                    if (strands_a >= strands_b) {
-                        effective_a = collapse_strands(tc, effective_a);
-                        strands_a   = 1;
-                    }
-                    else {
-                        effective_b = collapse_strands(tc, effective_b);
-                        strands_b   = 1;
-                    }
-                });
-            }
+
             /* Assemble the result. */
             result->body.num_strands = strands_a + strands_b + (renormalized_section_graphs ? 1 : 0);
             result->body.storage.strands = allocate_strands(tc, result->body.num_strands);
@@ -843,8 +1031,9 @@ MVMString * MVM_string_repeat(MVMThreadContext *tc, MVMString *a, MVMint64 count
         result->body.num_graphs      = agraphs * count;
         result->body.storage_type    = MVM_STRING_STRAND;
         result->body.storage.strands = allocate_strands(tc, 1);
-        if (a->body.storage_type == MVM_STRING_STRAND) {
-            if (a->body.num_strands == 1 && a->body.storage.strands[0].repetitions == 0) {
+        if (has_strands(a)) {
+            if (a->body.storage_type == MVM_STRING_STRAND && a->body.num_strands == 1
+                    && a->body.storage.strands[0].repetitions == 0) {
                 copy_strands(tc, a, 0, result, 0, 1);
             }
             else {
@@ -1504,7 +1693,7 @@ MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObjec
     MVMString  *result;
     MVMString **pieces;
     MVMint64    elems, num_pieces, sgraphs, i, is_str_array, total_graphs;
-    MVMuint16   sstrands, total_strands;
+    MVMuint32   sstrands, total_strands;
     MVMint32    concats_stable = 1;
 
     MVM_string_check_arg(tc, separator, "join separator");
@@ -1531,9 +1720,7 @@ MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObjec
      * strings (to we only have to do the indirect calls once). */
     sgraphs  = MVM_string_graphs_nocheck(tc, separator);
     if (sgraphs)
-        sstrands = separator->body.storage_type == MVM_STRING_STRAND
-            ? separator->body.num_strands
-            : 1;
+        sstrands = num_strands_of(separator);
     else
         sstrands = 1;
     pieces        = MVM_malloc(elems * sizeof(MVMString *));
@@ -1565,9 +1752,7 @@ MVMString * MVM_string_join(MVMThreadContext *tc, MVMString *separator, MVMObjec
         /* Add on the piece's strands and graphs. */
         piece_graphs = MVM_string_graphs(tc, piece);
         if (piece_graphs) {
-            total_strands += piece->body.storage_type == MVM_STRING_STRAND
-                ? piece->body.num_strands
-                : 1;
+            total_strands += num_strands_of(piece);
             total_graphs += piece_graphs;
         }
 
@@ -1709,7 +1894,16 @@ MVMint64 MVM_string_char_at_in_string(MVMThreadContext *tc, MVMString *a, MVMint
                     return i;
         }
         break;
-    case MVM_STRING_STRAND: {
+    case MVM_STRING_GRAPHEME_LATIN1:
+        if (can_fit_into_latin1(search)) {
+            MVMStringIndex i;
+            for (i = 0; i < bgraphs; i++)
+                if (b->body.storage.blob_latin1[i] == search)
+                    return i;
+        }
+        break;
+    case MVM_STRING_STRAND:
+    case MVM_STRING_ROPE: {
         MVMGraphemeIter gi;
         MVMStringIndex  i;
         MVM_string_gi_init(tc, &gi, b);
@@ -1744,7 +1938,7 @@ MVMint64 MVM_string_offset_has_unicode_property_value(MVMThreadContext *tc, MVMS
  * into heavily (when evaluating regexes, for example). */
 MVMString * MVM_string_indexing_optimized(MVMThreadContext *tc, MVMString *s) {
     MVM_string_check_arg(tc, s, "indexingoptimized");
-    if (s->body.storage_type == MVM_STRING_STRAND)
+    if (has_strands(s))
         return collapse_strands(tc, s);
     else
         return s;
@@ -1759,7 +1953,8 @@ MVMString * MVM_string_escape(MVMThreadContext *tc, MVMString *s) {
     MVMStringIndex  sgraphs, balloc;
     MVMGrapheme32  *buffer;
     MVMGrapheme32   crlf;
-    MVMint8         string_can_fit_into_8bit = 1;
+    MVMGrapheme32   lowest  = 0;
+    MVMGrapheme32   highest = 0;
 
     MVM_string_check_arg(tc, s, "escape");
 
@@ -1806,8 +2001,10 @@ MVMString * MVM_string_escape(MVMThreadContext *tc, MVMString *s) {
                 balloc += 32;
                 buffer = MVM_realloc(buffer, sizeof(MVMGrapheme32) * balloc);
             }
-            if (!can_fit_into_8bit(graph))
-                string_can_fit_into_8bit = 0;
+            if (graph < lowest)
+                lowest = graph;
+            if (graph > highest)
+                highest = graph;
             buffer[bpos++] = graph;
         }
     }
@@ -1817,8 +2014,7 @@ MVMString * MVM_string_escape(MVMThreadContext *tc, MVMString *s) {
     res->body.storage.blob_32 = buffer;
     res->body.num_graphs      = bpos;
 
-    if (string_can_fit_into_8bit)
-        turn_32bit_into_8bit_unchecked(tc, res);
+    MVM_string_compact_32bit(tc, res, lowest, highest);
 
     STRAND_CHECK(tc, res);
     return res;
@@ -1835,15 +2031,18 @@ MVMString * MVM_string_flip(MVMThreadContext *tc, MVMString *s) {
     sgraphs = MVM_string_graphs_nocheck(tc, s);
     rpos    = sgraphs;
 
-    if (s->body.storage_type == MVM_STRING_GRAPHEME_8) {
+    if (s->body.storage_type == MVM_STRING_GRAPHEME_8 || s->body.storage_type == MVM_STRING_GRAPHEME_LATIN1) {
+        /* Both 8-bit forms can be flipped bytewise. */
         MVMGrapheme8   *rbuffer;
         rbuffer = MVM_malloc(sizeof(MVMGrapheme8) * sgraphs);
 
         for (; spos < sgraphs; spos++)
             rbuffer[--rpos] = s->body.storage.blob_8[spos];
 
-        res = (MVMString *)MVM_repr_alloc_init(tc, tc->instance->VMString);
-        res->body.storage_type    = MVM_STRING_GRAPHEME_8;
+        MVMROOT(tc, s, {
+            res = (MVMString *)MVM_repr_alloc_init(tc, tc->instance->VMString);
+        });
+        res->body.storage_type    = s->body.storage_type;
         res->body.storage.blob_8  = rbuffer;
     } else {
         MVMGrapheme32  *rbuffer;
@@ -2353,6 +2552,10 @@ MVMString * MVM_string_chr(MVMThreadContext *tc, MVMint64 cp) {
         s->body.storage_type       = MVM_STRING_GRAPHEME_8;
         s->body.storage.blob_8     = MVM_malloc(sizeof(MVMGrapheme8));
         s->body.storage.blob_8[0]  = g;
+    } else if (can_fit_into_latin1(g)) {
+        s->body.storage_type           = MVM_STRING_GRAPHEME_LATIN1;
+        s->body.storage.blob_latin1    = MVM_malloc(sizeof(MVMGraphemeLatin1));
+        s->body.storage.blob_latin1[0] = g;
     } else {
         s->body.storage_type       = MVM_STRING_GRAPHEME_32;
         s->body.storage.blob_32    = MVM_malloc(sizeof(MVMGrapheme32));
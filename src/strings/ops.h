@@ -96,6 +96,7 @@ MVMint64 MVM_unicode_codepoint_get_property_int(MVMThreadContext *tc, MVMint64 g
 MVMint64 MVM_unicode_codepoint_get_property_bool(MVMThreadContext *tc, MVMint64 grapheme, MVMint64 property_code);
 MVMString * MVM_unicode_get_name(MVMThreadContext *tc, MVMint64 grapheme);
 MVMString * MVM_string_indexing_optimized(MVMThreadContext *tc, MVMString *s);
+void MVM_string_compact_32bit(MVMThreadContext *tc, MVMString *str, MVMGrapheme32 lowest, MVMGrapheme32 highest);
 MVMString * MVM_string_escape(MVMThreadContext *tc, MVMString *s);
 MVMString * MVM_string_flip(MVMThreadContext *tc, MVMString *s);
 MVMint64 MVM_string_compare(MVMThreadContext *tc, MVMString *a, MVMString *b);
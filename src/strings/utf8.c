@@ -168,6 +168,75 @@ static MVMint32 utf8_encode(MVMuint8 *bp, MVMCodepoint cp) {
 
 #define UTF8_MAXINC (32 * 1024 * 1024)
 
+/* Most UTF-8 we decode is mostly ASCII, which needs no decoding, so we look
+ * for runs of it ahead of the decoder. We do this 16 bytes at a time using
+ * SSE2 where the compiler targets it (which all x86-64 compilers do), and 8
+ * bytes at a time otherwise. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UTF8_HAVE_SSE2 1
+#endif
+#define UTF8_BYTES(b) (0x0101010101010101ULL * (b))
+#define UTF8_HAS_ZERO_BYTE(w) (((w) - UTF8_BYTES(0x01)) & ~(w) & UTF8_BYTES(0x80))
+
+/* Finds the length of the run of printable ASCII (0x20 to 0x7E) at the start
+ * of a buffer. Besides needing no decoding, these are not significant to the
+ * normalizer, nor are they normalization terminators. */
+static size_t printable_ascii_run(const MVMuint8 *s, size_t len) {
+    size_t i = 0;
+#ifdef UTF8_HAVE_SSE2
+    const __m128i below = _mm_set1_epi8(0x1F);
+    const __m128i above = _mm_set1_epi8(0x7E);
+    while (i + 16 <= len) {
+        /* Bytes from 0x80 up are negative, so aren't greater than 0x1F. */
+        __m128i v  = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i ok = _mm_andnot_si128(_mm_cmpgt_epi8(v, above), _mm_cmpgt_epi8(v, below));
+        if (_mm_movemask_epi8(ok) != 0xFFFF)
+            break;
+        i += 16;
+    }
+#else
+    while (i + 8 <= len) {
+        MVMuint64 w;
+        memcpy(&w, s + i, 8);
+        if ((w & UTF8_BYTES(0x80))
+                || ((w - UTF8_BYTES(0x20)) & ~w & UTF8_BYTES(0x80))
+                || UTF8_HAS_ZERO_BYTE(w ^ UTF8_BYTES(0x7F)))
+            break;
+        i += 8;
+    }
+#endif
+    while (i < len && s[i] >= 0x20 && s[i] <= 0x7E)
+        i++;
+    return i;
+}
+
+/* Finds the length of the run of ASCII other than \r at the start of a
+ * buffer, which the decode stream fast path can take without decoding. */
+static size_t ascii_run_without_cr(const MVMuint8 *s, size_t len) {
+    size_t i = 0;
+#ifdef UTF8_HAVE_SSE2
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (i + 16 <= len) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        if (_mm_movemask_epi8(v) | _mm_movemask_epi8(_mm_cmpeq_epi8(v, cr)))
+            break;
+        i += 16;
+    }
+#else
+    while (i + 8 <= len) {
+        MVMuint64 w;
+        memcpy(&w, s + i, 8);
+        if ((w & UTF8_BYTES(0x80)) || UTF8_HAS_ZERO_BYTE(w ^ UTF8_BYTES('\r')))
+            break;
+        i += 8;
+    }
+#endif
+    while (i < len && s[i] < 0x80 && s[i] != '\r')
+        i++;
+    return i;
+}
+
 /* Decodes the specified number of bytes of utf8 into an NFG string, creating
  * a result of the specified type. The type must have the MVMString REPR. */
 MVMString * MVM_string_utf8_decode(MVMThreadContext *tc, const MVMObject *result_type, const char *utf8, size_t bytes) {
@@ -194,6 +263,32 @@ MVMString * MVM_string_utf8_decode(MVMThreadContext *tc, const MVMObject *result
     orig_utf8 = utf8;
 
     for (; bytes; ++utf8, --bytes) {
+        /* Take runs of printable ASCII in one go, when the normalizer is in
+         * a state to let us. */
+        if (state == UTF8_ACCEPT && (MVMuint8)*utf8 >= 0x20 && (MVMuint8)*utf8 <= 0x7E) {
+            MVMint32 run = (MVMint32)printable_ascii_run((const MVMuint8 *)utf8,
+                bytes > 0x7FFFFFFF ? 0x7FFFFFFF : bytes);
+            if (run > 1) {
+                while (count + run >= bufsize) { /* if the buffer's full make a bigger one */
+                    buffer = MVM_realloc(buffer, sizeof(MVMGrapheme32) * (
+                        bufsize >= UTF8_MAXINC ? (bufsize += UTF8_MAXINC) : (bufsize *= 2)
+                    ));
+                }
+                if (MVM_unicode_normalizer_process_ascii_run(tc, &norm,
+                        (const MVMuint8 *)utf8, run, buffer + count)) {
+                    MVMGrapheme32 g = buffer[count];
+                    lowest_graph  = g < lowest_graph ? g : lowest_graph;
+                    lowest_graph  = 0x20 < lowest_graph ? 0x20 : lowest_graph;
+                    highest_graph = g > highest_graph ? g : highest_graph;
+                    highest_graph = 0x7E > highest_graph ? 0x7E : highest_graph;
+                    count += run;
+                    utf8  += run - 1;
+                    bytes -= run - 1;
+                    continue;
+                }
+            }
+        }
+
         switch(decode_utf8_byte(&state, &codepoint, (MVMuint8)*utf8)) {
         case UTF8_ACCEPT: { /* got a codepoint */
             MVMGrapheme32 g;
@@ -277,15 +372,13 @@ MVMString * MVM_string_utf8_decode(MVMThreadContext *tc, const MVMObject *result
 
     /* If we're lucky, we can fit our string in 8 bits per grapheme.
      * That happens when our lowest value is bigger than -129 and our
-     * highest value is lower than 128. */
-    if (lowest_graph >= -128 && highest_graph < 128) {
-        MVMGrapheme8 *new_buffer = MVM_malloc(sizeof(MVMGrapheme8) * count);
-        for (ready = 0; ready < count; ready++) {
-            new_buffer[ready] = buffer[ready];
-        }
-        MVM_free(buffer);
-        result->body.storage.blob_8  = new_buffer;
-        result->body.storage_type    = MVM_STRING_GRAPHEME_8;
+     * highest value is lower than 128, or when there are no synthetics and
+     * our highest value is lower than 256. */
+    if ((lowest_graph >= -128 && highest_graph < 128) || (lowest_graph >= 0 && highest_graph < 256)) {
+        result->body.storage.blob_32 = buffer;
+        result->body.storage_type    = MVM_STRING_GRAPHEME_32;
+        result->body.num_graphs      = count;
+        MVM_string_compact_32bit(tc, result, lowest_graph, highest_graph);
     } else {
         /* just keep the same buffer as the MVMString's buffer.  Later
          * we can add heuristics to resize it if we have enough free
@@ -295,8 +388,8 @@ MVMString * MVM_string_utf8_decode(MVMThreadContext *tc, const MVMObject *result
         }
         result->body.storage.blob_32 = buffer;
         result->body.storage_type    = MVM_STRING_GRAPHEME_32;
+        result->body.num_graphs      = count;
     }
-    result->body.num_graphs      = count;
 
     return result;
 }
@@ -381,6 +474,7 @@ MVMuint32 MVM_string_utf8_decodestream(MVMThreadContext *tc, MVMDecodeStream *ds
             /* Lift the no lag codepoint case out of the hot loop below,
              * to save on a couple of branches. */
             MVMCodepoint first_significant = ds->norm.first_significant;
+            MVMint32     ascii_end;
             while (lag_codepoint == -1 && pos < cur_bytes->length) {
                 switch(decode_utf8_byte(&state, &codepoint, bytes[pos++])) {
                 case UTF8_ACCEPT: {
@@ -399,8 +493,24 @@ MVMuint32 MVM_string_utf8_decodestream(MVMThreadContext *tc, MVMDecodeStream *ds
                 }
             }
 
+            ascii_end = pos;
             while (pos < cur_bytes->length) {
-                switch(decode_utf8_byte(&state, &codepoint, bytes[pos++])) {
+                MVMint32 decoded;
+
+                /* Runs of ASCII other than \r need no decoding; look for the
+                 * next one whenever we're at the start of a codepoint. */
+                if (pos >= ascii_end && state == UTF8_ACCEPT)
+                    ascii_end = pos + (MVMint32)ascii_run_without_cr(
+                        (MVMuint8 *)bytes + pos, cur_bytes->length - pos);
+                if (pos < ascii_end) {
+                    codepoint = (MVMuint8)bytes[pos++];
+                    decoded   = UTF8_ACCEPT;
+                }
+                else {
+                    decoded = decode_utf8_byte(&state, &codepoint, bytes[pos++]);
+                }
+
+                switch(decoded) {
                 case UTF8_ACCEPT: {
                     /* If we hit something that needs the normalizer, we put
                      * any lagging codepoint into its buffer and jump to it. */
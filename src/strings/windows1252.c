@@ -227,6 +227,8 @@ MVMString * MVM_string_windows1252_decode(MVMThreadContext *tc,
     MVMuint8 *windows1252 = (MVMuint8 *)windows1252_c;
     MVMString *result = (MVMString *)REPR(result_type)->allocate(tc, STABLE(result_type));
     size_t i, result_graphs;
+    MVMGrapheme32 lowest  = 0;
+    MVMGrapheme32 highest = 0;
 
     result->body.storage_type    = MVM_STRING_GRAPHEME_32;
     result->body.storage.blob_32 = MVM_malloc(sizeof(MVMGrapheme32) * bytes);
@@ -234,15 +236,22 @@ MVMString * MVM_string_windows1252_decode(MVMThreadContext *tc,
     result_graphs = 0;
     for (i = 0; i < bytes; i++) {
         if (windows1252[i] == '\r' && i + 1 < bytes && windows1252[i + 1] == '\n') {
-            result->body.storage.blob_32[result_graphs++] = MVM_nfg_crlf_grapheme(tc);
+            lowest = MVM_nfg_crlf_grapheme(tc);
+            result->body.storage.blob_32[result_graphs++] = lowest;
             i++;
         }
         else {
-            result->body.storage.blob_32[result_graphs++] = WINDOWS1252_CHAR_TO_CP(windows1252[i]);
+            MVMGrapheme32 g = WINDOWS1252_CHAR_TO_CP(windows1252[i]);
+            if (g > highest)
+                highest = g;
+            result->body.storage.blob_32[result_graphs++] = g;
         }
     }
     result->body.num_graphs = result_graphs;
 
+    /* Most text will fit in one of the 8-bit forms. */
+    MVM_string_compact_32bit(tc, result, lowest, highest);
+
     return result;
 }
 
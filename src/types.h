@@ -9,6 +9,7 @@ typedef struct MVMArrayREPRData MVMArrayREPRData;
 typedef struct MVMAsyncTask MVMAsyncTask;
 typedef struct MVMAsyncTaskBody MVMAsyncTaskBody;
 typedef struct MVMAsyncTaskOps MVMAsyncTaskOps;
+typedef struct MVMEventLoop MVMEventLoop;
 typedef struct MVMAttributeIdentifier MVMAttributeIdentifier;
 typedef struct MVMBoolificationSpec MVMBoolificationSpec;
 typedef struct MVMBootTypes MVMBootTypes;
@@ -46,6 +47,7 @@ typedef struct MVMRegionAlloc MVMRegionAlloc;
 typedef struct MVMRegionBlock MVMRegionBlock;
 typedef struct MVMFixedSizeAlloc MVMFixedSizeAlloc;
 typedef struct MVMFixedSizeAllocFreeListEntry MVMFixedSizeAllocFreeListEntry;
+typedef struct MVMFixedSizeAllocPage MVMFixedSizeAllocPage;
 typedef struct MVMFixedSizeAllocSafepointFreeListEntry MVMFixedSizeAllocSafepointFreeListEntry;
 typedef struct MVMFixedSizeAllocSizeClass MVMFixedSizeAllocSizeClass;
 typedef struct MVMFixedSizeAllocThread MVMFixedSizeAllocThread;
@@ -55,6 +57,8 @@ typedef struct MVMFrameExtra MVMFrameExtra;
 typedef struct MVMFrameHandler MVMFrameHandler;
 typedef struct MVMGen2Allocator MVMGen2Allocator;
 typedef struct MVMGen2SizeClass MVMGen2SizeClass;
+typedef struct MVMGCDeque MVMGCDeque;
+typedef struct MVMGCDequeArray MVMGCDequeArray;
 typedef struct MVMGCPassedWork MVMGCPassedWork;
 typedef struct MVMGCWorklist MVMGCWorklist;
 typedef struct MVMHash MVMHash;
@@ -77,6 +81,8 @@ typedef struct MVMLoadedCompUnitName MVMLoadedCompUnitName;
 typedef struct MVMNFA MVMNFA;
 typedef struct MVMNFABody MVMNFABody;
 typedef struct MVMNFAStateInfo MVMNFAStateInfo;
+typedef struct MVMNFADFA MVMNFADFA;
+typedef struct MVMNFADFAState MVMNFADFAState;
 typedef struct MVMNFGState MVMNFGState;
 typedef struct MVMNFGSynthetic MVMNFGSynthetic;
 typedef struct MVMNFGTrieNode MVMNFGTrieNode;
@@ -124,7 +130,7 @@ typedef struct MVMSemaphore MVMSemaphore;
 typedef struct MVMSemaphoreBody MVMSemaphoreBody;
 typedef struct MVMConcBlockingQueue MVMConcBlockingQueue;
 typedef struct MVMConcBlockingQueueBody MVMConcBlockingQueueBody;
-typedef struct MVMConcBlockingQueueNode MVMConcBlockingQueueNode;
+typedef struct MVMConcBlockingQueueSegment MVMConcBlockingQueueSegment;
 typedef struct MVMConcBlockingQueueLocks MVMConcBlockingQueueLocks;
 typedef struct MVMObject MVMObject;
 typedef struct MVMObjectId MVMObjectId;
@@ -190,8 +196,19 @@ typedef struct MVMSpeshSimStackFrame MVMSpeshSimStackFrame;
 typedef struct MVMSpeshSimCallType MVMSpeshSimCallType;
 typedef struct MVMSpeshPlan MVMSpeshPlan;
 typedef struct MVMSpeshPlanned MVMSpeshPlanned;
+typedef struct MVMSpeshPlanCache MVMSpeshPlanCache;
+typedef struct MVMSpeshPlanCacheArgType MVMSpeshPlanCacheArgType;
+typedef struct MVMSpeshPlanCacheEntry MVMSpeshPlanCacheEntry;
+typedef struct MVMSpeshPlanCacheRecord MVMSpeshPlanCacheRecord;
 typedef struct MVMSpeshArgGuard MVMSpeshArgGuard;
 typedef struct MVMSpeshArgGuardNode MVMSpeshArgGuardNode;
+typedef struct MVMSpeshMaterialization MVMSpeshMaterialization;
+typedef struct MVMSpeshMaterializedField MVMSpeshMaterializedField;
+typedef struct MVMSpeshMaterializations MVMSpeshMaterializations;
+typedef struct MVMSpeshLoop MVMSpeshLoop;
+typedef struct MVMSpeshGVN MVMSpeshGVN;
+typedef struct MVMSpeshGVNEntry MVMSpeshGVNEntry;
+typedef struct MVMSpeshGVNCopy MVMSpeshGVNCopy;
 typedef struct MVMSTable MVMSTable;
 typedef struct MVMStaticFrame MVMStaticFrame;
 typedef struct MVMStaticFrameBody MVMStaticFrameBody;
@@ -203,6 +220,9 @@ typedef struct MVMString MVMString;
 typedef struct MVMStringBody MVMStringBody;
 typedef struct MVMStringConsts MVMStringConsts;
 typedef struct MVMStringStrand MVMStringStrand;
+typedef struct MVMStringRope MVMStringRope;
+typedef struct MVMStrHashSlot MVMStrHashSlot;
+typedef struct MVMStrHashTable MVMStrHashTable;
 typedef struct MVMGraphemeIter MVMGraphemeIter;
 typedef struct MVMCodepointIter MVMCodepointIter;
 typedef struct MVMThread MVMThread;
@@ -246,11 +266,20 @@ typedef struct MVMJitJumpList MVMJitJumpList;
 typedef struct MVMJitControl MVMJitControl;
 typedef struct MVMJitData MVMJitData;
 typedef struct MVMJitCode MVMJitCode;
+typedef struct MVMJitExprNode MVMJitExprNode;
+typedef struct MVMJitExprStore MVMJitExprStore;
+typedef struct MVMJitExprTree MVMJitExprTree;
+typedef struct MVMJitBailOp MVMJitBailOp;
+typedef struct MVMJitBailReport MVMJitBailReport;
 typedef struct MVMProfileThreadData MVMProfileThreadData;
 typedef struct MVMProfileGC MVMProfileGC;
 typedef struct MVMProfileCallNode MVMProfileCallNode;
 typedef struct MVMProfileAllocationCount MVMProfileAllocationCount;
 typedef struct MVMProfileContinuationData MVMProfileContinuationData;
+typedef struct MVMProfileSampleNode MVMProfileSampleNode;
+typedef struct MVMProfileSampleFrame MVMProfileSampleFrame;
+typedef struct MVMProfileSampleThread MVMProfileSampleThread;
+typedef struct MVMProfileSampler MVMProfileSampler;
 typedef struct MVMHeapSnapshotCollection MVMHeapSnapshotCollection;
 typedef struct MVMHeapSnapshot MVMHeapSnapshot;
 typedef struct MVMHeapSnapshotType MVMHeapSnapshotType;